@@ -0,0 +1,84 @@
+#include "base/block_store.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include "base/fingerprint2011.hpp"
+#include "base/flags.hpp"
+#include "glog/logging.h"
+
+namespace principia {
+namespace base {
+namespace internal_block_store {
+
+BlockStore::BlockStore(std::filesystem::path directory)
+    : directory_(std::move(directory)) {
+  std::filesystem::create_directories(directory_);
+}
+
+std::uint64_t BlockStore::Put(std::string_view const bytes) const {
+  std::uint64_t const fingerprint = Fingerprint2011(bytes.data(), bytes.size());
+  if (Contains(fingerprint)) {
+    return fingerprint;
+  }
+
+  // Write to a temporary file and rename it, so that a block is never seen
+  // partially written, even if the game crashes.  The temporary file is
+  // specific to this thread in case another thread writes the same block.
+  std::filesystem::path const path = BlockPath(fingerprint);
+  std::ostringstream temporary_extension;
+  temporary_extension << "." << std::this_thread::get_id() << ".tmp";
+  std::filesystem::path temporary_path = path;
+  temporary_path += temporary_extension.str();
+  {
+    std::ofstream stream(temporary_path, std::ios::out | std::ios::binary);
+    CHECK(stream.good()) << temporary_path;
+    stream.write(bytes.data(), bytes.size());
+    CHECK(stream.good()) << temporary_path;
+  }
+  std::filesystem::rename(temporary_path, path);
+  return fingerprint;
+}
+
+bool BlockStore::Contains(std::uint64_t const fingerprint) const {
+  return std::filesystem::exists(BlockPath(fingerprint));
+}
+
+StatusOr<std::string> BlockStore::Get(std::uint64_t const fingerprint) const {
+  std::filesystem::path const path = BlockPath(fingerprint);
+  std::ifstream stream(path, std::ios::in | std::ios::binary);
+  if (!stream.good()) {
+    return Status(Error::NOT_FOUND, "Missing block " + path.string());
+  }
+  std::stringstream bytes;
+  bytes << stream.rdbuf();
+  std::string result = std::move(bytes).str();
+  if (fingerprint != Fingerprint2011(result.data(), result.size())) {
+    return Status(Error::DATA_LOSS, "Corrupted block " + path.string());
+  }
+  return result;
+}
+
+std::optional<BlockStore> BlockStore::FromFlags() {
+  auto const values = Flags::Values("block_store");
+  if (values.empty()) {
+    return std::nullopt;
+  }
+  CHECK_EQ(1, values.size()) << "Multiple block stores";
+  return BlockStore(*values.begin());
+}
+
+std::filesystem::path BlockStore::BlockPath(
+    std::uint64_t const fingerprint) const {
+  std::ostringstream name;
+  name << std::hex << std::setfill('0') << std::setw(16) << fingerprint
+       << ".block";
+  return directory_ / name.str();
+}
+
+}  // namespace internal_block_store
+}  // namespace base
+}  // namespace principia
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "base/status_or.hpp"
+
+namespace principia {
+namespace base {
+namespace internal_block_store {
+
+// A store of immutable blocks of bytes identified by their fingerprint, kept
+// in a directory as one file per block.  The blocks are shared by all the saves
+// that use the same directory, so a block that is common to several saves is
+// written only once.  Nothing is cached in memory: the presence of a block is
+// checked on disk each time, so a block that was deleted is written again by
+// the next save that uses it.  Blocks are never removed from the directory,
+// which grows with each block that is written; deleting a block makes the saves
+// that refer to it unreadable.  This class is thread-safe.
+// Example of usage: create a file block_store.cfg containing:
+//   principia_flags {
+//     block_store = saves/principia_blocks
+//   }
+class BlockStore {
+ public:
+  explicit BlockStore(std::filesystem::path directory);
+
+  // Stores |bytes| if no block with the same fingerprint is present, and
+  // returns that fingerprint.
+  std::uint64_t Put(std::string_view bytes) const;
+
+  // Returns true if a file for the block with the given |fingerprint| exists.
+  bool Contains(std::uint64_t fingerprint) const;
+
+  // Returns the block with the given |fingerprint|, or |NOT_FOUND| if it is
+  // missing, or |DATA_LOSS| if it doesn't match its fingerprint.
+  StatusOr<std::string> Get(std::uint64_t fingerprint) const;
+
+  // Returns the store in the directory given by the flag |block_store|, or
+  // nullopt if that flag is not set.
+  static std::optional<BlockStore> FromFlags();
+
+ private:
+  std::filesystem::path BlockPath(std::uint64_t fingerprint) const;
+
+  std::filesystem::path directory_;
+};
+
+}  // namespace internal_block_store
+
+using internal_block_store::BlockStore;
+
+}  // namespace base
+}  // namespace principia
@@ -0,0 +1,92 @@
+#include "base/block_store.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <optional>
+
+#include "base/flags.hpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace principia {
+namespace base {
+namespace internal_block_store {
+
+using ::testing::Eq;
+using ::testing::Ne;
+
+class BlockStoreTest : public ::testing::Test {
+ protected:
+  BlockStoreTest() : directory_(TEMP_DIR / "block_store_test") {
+    std::filesystem::remove_all(directory_);
+  }
+
+  ~BlockStoreTest() override {
+    Flags::Clear();
+    std::filesystem::remove_all(directory_);
+  }
+
+  std::int64_t NumberOfFiles() const {
+    return std::distance(std::filesystem::directory_iterator(directory_),
+                         std::filesystem::directory_iterator());
+  }
+
+  std::filesystem::path const directory_;
+};
+
+TEST_F(BlockStoreTest, PutAndGet) {
+  BlockStore store(directory_);
+  std::uint64_t const hello = store.Put("hello");
+  std::uint64_t const world = store.Put("world");
+  EXPECT_THAT(hello, Ne(world));
+  EXPECT_TRUE(store.Contains(hello));
+  EXPECT_FALSE(store.Contains(hello + world));
+  EXPECT_THAT(store.Get(hello).ValueOrDie(), Eq("hello"));
+  EXPECT_THAT(store.Get(world).ValueOrDie(), Eq("world"));
+
+  // Identical blocks are stored once.
+  EXPECT_THAT(store.Put("hello"), Eq(hello));
+  EXPECT_THAT(NumberOfFiles(), Eq(2));
+
+  // The blocks are visible to another store using the same directory.
+  BlockStore other_store(directory_);
+  EXPECT_TRUE(other_store.Contains(world));
+  EXPECT_THAT(other_store.Get(world).ValueOrDie(), Eq("world"));
+}
+
+TEST_F(BlockStoreTest, MissingAndCorrupted) {
+  BlockStore store(directory_);
+  std::uint64_t const hello = store.Put("hello");
+  std::filesystem::path const path =
+      std::filesystem::directory_iterator(directory_)->path();
+
+  // A block deleted behind the store's back is reported as missing, and is
+  // written again by the next |Put|.
+  std::filesystem::remove(path);
+  EXPECT_FALSE(store.Contains(hello));
+  EXPECT_THAT(store.Get(hello).status().error(), Eq(Error::NOT_FOUND));
+  EXPECT_THAT(store.Put("hello"), Eq(hello));
+  EXPECT_THAT(store.Get(hello).ValueOrDie(), Eq("hello"));
+
+  // A block whose contents don't match its fingerprint is reported as
+  // corrupted.
+  std::ofstream(path, std::ios::out | std::ios::binary) << "jello";
+  EXPECT_THAT(store.Get(hello).status().error(), Eq(Error::DATA_LOSS));
+}
+
+TEST_F(BlockStoreTest, FromFlags) {
+  EXPECT_FALSE(BlockStore::FromFlags().has_value());
+  Flags::Set("block_store", directory_.string());
+  std::optional<BlockStore> const store = BlockStore::FromFlags();
+  ASSERT_TRUE(store.has_value());
+  std::uint64_t const fingerprint = store->Put("hello");
+  EXPECT_TRUE(std::filesystem::is_directory(directory_));
+  EXPECT_THAT(NumberOfFiles(), Eq(1));
+  EXPECT_THAT(BlockStore::FromFlags()->Get(fingerprint).ValueOrDie(),
+              Eq("hello"));
+}
+
+}  // namespace internal_block_store
+}  // namespace base
+}  // namespace principia
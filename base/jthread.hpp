@@ -45,6 +45,10 @@ class stop_token {
 // https://en.cppreference.com/w/cpp/thread/stop_source
 class stop_source {
  public:
+  // Constructs a stop_source with a new stop-state, which lives as long as this
+  // object or its copies.
+  stop_source();
+
   bool request_stop();
 
   bool stop_requested() const;
@@ -54,7 +58,9 @@ class stop_source {
  private:
   explicit stop_source(not_null<StopState*> stop_state);
 
-  not_null<StopState*> const stop_state_;
+  // Only set if the stop-state is owned by this object.
+  std::shared_ptr<StopState> owned_stop_state_;
+  not_null<StopState*> stop_state_;
 
   friend class jthread;
 };
@@ -122,6 +128,22 @@ class this_stoppable_thread {
 
   template<typename Function, typename... Args>
   friend jthread MakeStoppableThread(Function&& f, Args&&... args);
+  friend class StopTokenScope;
+};
+
+// Makes |this_stoppable_thread::get_stop_token| return the given token on the
+// current thread for the lifetime of this object.  This makes it possible to
+// stop a task that is executed by a thread that outlives it.
+class StopTokenScope {
+ public:
+  explicit StopTokenScope(stop_token const& st);
+  ~StopTokenScope();
+
+  StopTokenScope(StopTokenScope const&) = delete;
+  StopTokenScope& operator=(StopTokenScope const&) = delete;
+
+ private:
+  stop_token const previous_stop_token_;
 };
 
 #define RETURN_IF_STOPPED                                                   \
@@ -140,6 +162,7 @@ using internal_jthread::jthread;
 using internal_jthread::stop_callback;
 using internal_jthread::stop_source;
 using internal_jthread::stop_token;
+using internal_jthread::StopTokenScope;
 using internal_jthread::this_stoppable_thread;
 
 }  // namespace base
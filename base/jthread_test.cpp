@@ -140,7 +140,18 @@ TEST(JThreadTest, ThisJThread) {
   EXPECT_TRUE(observed_stop);
 }
 
-
+TEST(JThreadTest, StopTokenScope) {
+  EXPECT_FALSE(this_stoppable_thread::get_stop_token().stop_requested());
+  stop_source source;
+  {
+    StopTokenScope scope(source.get_token());
+    EXPECT_FALSE(this_stoppable_thread::get_stop_token().stop_requested());
+    source.request_stop();
+    EXPECT_TRUE(this_stoppable_thread::get_stop_token().stop_requested());
+  }
+  EXPECT_TRUE(source.stop_requested());
+  EXPECT_FALSE(this_stoppable_thread::get_stop_token().stop_requested());
+}
 
 }  // namespace base
 }  // namespace principia
@@ -2,16 +2,19 @@
 #pragma once
 
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <queue>
 #include <thread>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
 #include "base/array.hpp"
 #include "base/macros.hpp"
 #include "base/not_null.hpp"
+#include "base/thread_pool.hpp"
 #include "gipfeli/compression.h"
 #include "google/protobuf/message.h"
 #include "google/protobuf/io/zero_copy_stream.h"
@@ -58,6 +61,8 @@ class DelegatingArrayOutputStream
 // finally destroys the |PullSerializer|.  |PullSerializer| is intended for use
 // in memory-critical contexts as it bounds the amount of memory used
 // irrespective of the size of the message to serialize.
+// In the presence of compression, the chunks are compressed in parallel by a
+// pool of workers, and returned by |Pull| in order.
 class PullSerializer final {
  public:
   // The |size| of the data objects enqueued by |Push| is never greater than
@@ -65,10 +70,12 @@ class PullSerializer final {
   // queue.  This class uses at most
   // |number_of_chunks * (chunk_size + O(1)) + O(1)| bytes.  Note that in the
   // presence of compression |chunk_size| is replaced by |compressed_chunk_size|
-  // in this formula.
+  // in this formula.  If |new_compressor| is not null, it is used to create a
+  // compressor for each worker, and each chunk is compressed independently.
+  // The number of workers is bounded by the number of chunks.
   PullSerializer(int chunk_size,
                  int number_of_chunks,
-                 std::unique_ptr<Compressor> compressor);
+                 std::function<std::unique_ptr<Compressor>()> new_compressor);
   ~PullSerializer();
 
   // Starts the serializer, which will proceed to serialize |message|.  This
@@ -89,17 +96,32 @@ class PullSerializer final {
   Array<std::uint8_t> Pull();
 
  private:
+  // An element of the |queue_|.  If the chunk is being compressed, |bytes| is
+  // set when the compression completes.
+  struct Chunk {
+    Array<std::uint8_t> bytes;
+    bool ready = false;
+  };
+
   // Enqueues the chunk of data to be returned to |Pull| and returns a free
   // chunk.  Blocks if there are no free chunks.  Used as a callback for the
-  // underlying |DelegatingArrayOutputStream|.
+  // underlying |DelegatingArrayOutputStream|.  In the presence of compression,
+  // the compression of |bytes| is started asynchronously.  A |bytes| of size 0
+  // marks the end of the stream.
   Array<std::uint8_t> Push(Array<std::uint8_t> bytes);
 
+  // Compresses |bytes| into |compressed_bytes| and makes the result available
+  // in |chunk|.  Runs on the |compression_pool_|.
+  void Compress(Array<std::uint8_t> bytes,
+                Array<std::uint8_t> compressed_bytes,
+                Chunk& chunk) EXCLUDES(lock_);
+
   // |owned_message_| is null if this object doesn't own the message.
   // |message_| is non-null after Start.
   std::unique_ptr<google::protobuf::Message const> owned_message_;
   google::protobuf::Message const* message_ = nullptr;
 
-  std::unique_ptr<Compressor> const compressor_;
+  std::function<std::unique_ptr<Compressor>()> const new_compressor_;
 
   // The chunk size passed at construction.  The stream outputs chunks of that
   // size.
@@ -126,17 +148,24 @@ class PullSerializer final {
 
   absl::Mutex lock_;
 
-  // The |queue_| contains the |Array<std::uint8_t>| objects filled by |Push|
-  // and not yet consumed by |Pull|.  If a |Array<std::uint8_t>| object has been
-  // handed over to the caller by |Pull| it stays in the queue until the next
-  // call to |Pull|, to make sure that the pointer is not reused while the
-  // caller processes it.
-  std::queue<Array<std::uint8_t>> queue_ GUARDED_BY(lock_);
+  // The |queue_| contains the chunks filled by |Push| and not yet consumed by
+  // |Pull|, in the order of the stream.  If a chunk has been handed over to the
+  // caller by |Pull| it stays in the queue until the next call to |Pull|, to
+  // make sure that the pointer is not reused while the caller processes it.
+  // References to the elements are stable as the queue only grows at the back
+  // and shrinks at the front.
+  std::deque<Chunk> queue_ GUARDED_BY(lock_);
 
-  // The |free_| queue contains the start addresses of chunks that are not yet
-  // ready to be returned by |Pull|.  That includes the chunk currently being
-  // filled by the stream.
+  // The |free_| queue contains the start addresses of the chunks that are
+  // neither in the |queue_|, nor filled by the stream, nor being compressed.
   std::queue<not_null<std::uint8_t*>> free_ GUARDED_BY(lock_);
+
+  // The compressors that are not used by a compression.
+  std::vector<std::unique_ptr<Compressor>> idle_compressors_ GUARDED_BY(lock_);
+
+  // Null in the absence of compression.  Must be the last member so that the
+  // compressions complete before the other members are destroyed.
+  std::unique_ptr<ThreadPool<void>> compression_pool_;
 };
 
 }  // namespace internal_pull_serializer
@@ -4,6 +4,7 @@
 #include "base/pull_serializer.hpp"
 
 #include <algorithm>
+#include <thread>
 
 #include "base/sink_source.hpp"
 
@@ -62,17 +63,18 @@ inline std::int64_t DelegatingArrayOutputStream::ByteCount() const {
   return byte_count_;
 }
 
-inline PullSerializer::PullSerializer(int const chunk_size,
-                                      int const number_of_chunks,
-                                      std::unique_ptr<Compressor> compressor)
-    : compressor_(std::move(compressor)),
+inline PullSerializer::PullSerializer(
+    int const chunk_size,
+    int const number_of_chunks,
+    std::function<std::unique_ptr<Compressor>()> new_compressor)
+    : new_compressor_(std::move(new_compressor)),
       chunk_size_(chunk_size),
       compressed_chunk_size_(
-          compressor_ == nullptr
+          new_compressor_ == nullptr
               ? chunk_size_
-              : compressor_->MaxCompressedLength(chunk_size_)),
+              : new_compressor_()->MaxCompressedLength(chunk_size_)),
       number_of_chunks_(number_of_chunks),
-      number_of_compression_chunks_(compressor_ == nullptr ? 0 : 1),
+      number_of_compression_chunks_(new_compressor_ == nullptr ? 0 : 1),
       data_(std::make_unique<std::uint8_t[]>(compressed_chunk_size_ *
                                              number_of_chunks_)),
       stream_(Array<std::uint8_t>(data_.get(), chunk_size_),
@@ -80,16 +82,28 @@ inline PullSerializer::PullSerializer(int const chunk_size,
   // Check the compatibility of the wait conditions in Push and Pull.
   CHECK_GT(number_of_chunks_ - number_of_compression_chunks_ - 1, 1);
 
-  // Mark all the chunks as free except the last one which is a sentinel for the
-  // |queue_|.  The 0th chunk has been passed to the stream, but it's still free
-  // until the first call to |on_full|.  Note that the last
-  // |compressed_chunk_size_ - chunk_size_| bytes of each chunk are not
-  // considered as free.
-  for (int i = 0; i < number_of_chunks_ - 1; ++i) {
+  // Mark all the chunks as free except the 0th one which has been passed to
+  // the stream and the last one which is a sentinel for the |queue_|.  Note
+  // that the last |compressed_chunk_size_ - chunk_size_| bytes of each chunk
+  // are not considered as free.
+  for (int i = 1; i < number_of_chunks_ - 1; ++i) {
     free_.push(data_.get() + i * compressed_chunk_size_);
   }
-  queue_.push(Array<std::uint8_t>(
-      data_.get() + (number_of_chunks_ - 1) * compressed_chunk_size_, 0));
+  queue_.push_back(
+      {Array<std::uint8_t>(
+           data_.get() + (number_of_chunks_ - 1) * compressed_chunk_size_, 0),
+       /*ready=*/true});
+
+  if (new_compressor_ != nullptr) {
+    // Each compression holds two chunks, and we need two more for the stream
+    // and for the sentinel, so there is no point in having more workers than
+    // this.
+    int const number_of_workers =
+        std::max(1,
+                 std::min(static_cast<int>(std::thread::hardware_concurrency()),
+                          (number_of_chunks_ - 2) / 2));
+    compression_pool_ = std::make_unique<ThreadPool<void>>(number_of_workers);
+  }
 }
 
 inline PullSerializer::~PullSerializer() {
@@ -112,13 +126,7 @@ inline void PullSerializer::Start(
     CHECK(message_->SerializeToZeroCopyStream(&stream_));
     // Put a sentinel at the end of the serialized stream so that the client
     // knows that this is the end.
-    Array<std::uint8_t> bytes;
-    {
-      absl::MutexLock l(&lock_);
-      CHECK(!free_.empty());
-      bytes = Array<std::uint8_t>(free_.front(), 0);
-    }
-    Push(bytes);
+    Push(Array<std::uint8_t>());
   });
 }
 
@@ -128,64 +136,87 @@ inline Array<std::uint8_t> PullSerializer::Pull() {
     absl::MutexLock l(&lock_);
 
     // The element at the front of the queue is the one that was last returned
-    // by |Pull| and must be dropped and freed.
-    auto const queue_has_elements = [this]() { return queue_.size() > 1; };
-    lock_.Await(absl::Condition(&queue_has_elements));
-
-    CHECK_LE(2, queue_.size());
-    free_.push(queue_.front().data);
-    queue_.pop();
-    result = queue_.front();
-    CHECK_EQ(number_of_chunks_, queue_.size() + free_.size());
+    // by |Pull| and must be dropped and freed.  The next element may still be
+    // being compressed.
+    auto const next_element_is_ready = [this]() {
+      return queue_.size() > 1 && queue_[1].ready;
+    };
+    lock_.Await(absl::Condition(&next_element_is_ready));
+
+    free_.push(queue_.front().bytes.data);
+    queue_.pop_front();
+    result = queue_.front().bytes;
   }
   return result;
 }
 
-inline Array<std::uint8_t> PullSerializer::Push(Array<std::uint8_t> bytes) {
-  Array<std::uint8_t> result;
+inline Array<std::uint8_t> PullSerializer::Push(
+    Array<std::uint8_t> const bytes) {
   CHECK_GE(chunk_size_, bytes.size);
-  if (bytes.size > 0 && compressor_ != nullptr) {
-    Array<std::uint8_t> compressed_bytes;
-    {
-      absl::MutexLock l(&lock_);
-      CHECK_LE(1 + number_of_compression_chunks_, free_.size());
-      free_.pop();
-      compressed_bytes =
-          Array<std::uint8_t>(free_.front(), compressed_chunk_size_);
-      free_.push(bytes.data);
-    }
-    // We maintain the invariant that the chunk being filled is at the front of
-    // the |free_| queue.
-    ArraySource<std::uint8_t> source(bytes);
-    ArraySink<std::uint8_t> sink(compressed_bytes);
-    compressor_->CompressStream(&source, &sink);
-    {
-      absl::MutexLock l(&lock_);
-      bytes = sink.array();
-    }
+  absl::MutexLock l(&lock_);
+
+  if (bytes.size == 0) {
+    // The end of the stream.  The sentinel uses a free chunk, and the stream
+    // doesn't need a new one.
+    auto const has_free_chunk = [this]() { return !free_.empty(); };
+    lock_.Await(absl::Condition(&has_free_chunk));
+    queue_.push_back({Array<std::uint8_t>(free_.front(), 0), /*ready=*/true});
+    free_.pop();
+    return Array<std::uint8_t>();
   }
-  {
-    absl::MutexLock l(&lock_);
-
-    auto const queue_has_room = [this]() {
-      // -1 here is because we want to ensure that there is an entry in the
-      // free list, in addition to |result| and to
-      // |number_of_compression_chunks_| (if present).
-      return queue_.size() < static_cast<std::size_t>(number_of_chunks_) -
-                                 number_of_compression_chunks_ - 1;
-    };
-    lock_.Await(absl::Condition(&queue_has_room));
 
-    queue_.emplace(bytes.data, bytes.size);
-    CHECK_LE(2 + number_of_compression_chunks_, free_.size());
-    CHECK_EQ(free_.front(), bytes.data);
+  if (new_compressor_ == nullptr) {
+    queue_.push_back({bytes, /*ready=*/true});
+    auto const has_free_chunk = [this]() { return !free_.empty(); };
+    lock_.Await(absl::Condition(&has_free_chunk));
+  } else {
+    // We need a chunk to compress into, and a chunk for the stream to fill
+    // while the compression proceeds.  The chunk |bytes| is freed when the
+    // compression completes.
+    auto const has_free_chunks = [this]() { return free_.size() >= 2; };
+    lock_.Await(absl::Condition(&has_free_chunks));
+    Array<std::uint8_t> const compressed_bytes(free_.front(),
+                                               compressed_chunk_size_);
     free_.pop();
-    result = Array<std::uint8_t>(free_.front(), chunk_size_);
-    CHECK_EQ(number_of_chunks_, queue_.size() + free_.size());
+    Chunk& chunk = queue_.emplace_back();
+    compression_pool_->Add([this, bytes, compressed_bytes, &chunk]() {
+      Compress(bytes, compressed_bytes, chunk);
+    });
   }
+  Array<std::uint8_t> const result(free_.front(), chunk_size_);
+  free_.pop();
   return result;
 }
 
+inline void PullSerializer::Compress(
+    Array<std::uint8_t> const bytes,
+    Array<std::uint8_t> const compressed_bytes,
+    Chunk& chunk) {
+  // Compressors are stateful, so each compression needs its own.  We create
+  // them lazily, so there are never more of them than there are workers.
+  std::unique_ptr<Compressor> compressor;
+  {
+    absl::MutexLock l(&lock_);
+    if (!idle_compressors_.empty()) {
+      compressor = std::move(idle_compressors_.back());
+      idle_compressors_.pop_back();
+    }
+  }
+  if (compressor == nullptr) {
+    compressor = new_compressor_();
+  }
+
+  ArraySource<std::uint8_t> source(bytes);
+  ArraySink<std::uint8_t> sink(compressed_bytes);
+  compressor->CompressStream(&source, &sink);
+
+  absl::MutexLock l(&lock_);
+  idle_compressors_.push_back(std::move(compressor));
+  chunk.bytes = sink.array();
+  chunk.ready = true;
+  free_.push(bytes.data);
+}
+
 }  // namespace internal_pull_serializer
 }  // namespace base
 }  // namespace principia
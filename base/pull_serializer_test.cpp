@@ -37,7 +37,7 @@ class PullSerializerTest : public ::testing::Test {
       : pull_serializer_(
             std::make_unique<PullSerializer>(chunk_size,
                                              number_of_chunks,
-                                             /*compressor=*/nullptr)),
+                                             /*new_compressor=*/nullptr)),
         stream_(Array<std::uint8_t>(data_, small_chunk_size),
                 std::bind(&PullSerializerTest::OnFull,
                           this,
@@ -145,7 +145,7 @@ TEST_F(PullSerializerTest, SerializationGipfeli) {
         std::make_unique<PullSerializer>(
             chunk_size,
             /*number_of_chunks=*/4,
-            google::compression::NewGipfeliCompressor());
+            &google::compression::NewGipfeliCompressor);
     auto trajectory = BuildTrajectory();
     compressed_pull_serializer->Start(std::move(trajectory));
     auto compressor = google::compression::NewGipfeliCompressor();
@@ -185,9 +185,10 @@ TEST_F(PullSerializerTest, SerializationThreading) {
     std::uint8_t* data = &actual_serialized_trajectory[0];
 
     // The serialization happens concurrently with the test.
-    pull_serializer_ = std::make_unique<PullSerializer>(chunk_size,
-                                                        number_of_chunks,
-                                                        /*compressor=*/nullptr);
+    pull_serializer_ =
+        std::make_unique<PullSerializer>(chunk_size,
+                                         number_of_chunks,
+                                         /*new_compressor=*/nullptr);
     pull_serializer_->Start(std::move(trajectory));
     for (;;) {
       Array<std::uint8_t> const bytes = pull_serializer_->Pull();
@@ -2,16 +2,19 @@
 #pragma once
 
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <queue>
 #include <thread>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
 #include "base/array.hpp"
 #include "base/macros.hpp"
 #include "base/not_null.hpp"
+#include "base/thread_pool.hpp"
 #include "gipfeli/compression.h"
 #include "google/protobuf/message.h"
 #include "google/protobuf/io/zero_copy_stream.h"
@@ -54,16 +57,20 @@ class DelegatingArrayInputStream
 // deserialization, and finally destroys the |PushDeserializer|.
 // |PushDeserializer| is intended for use in memory-critical contexts as it
 // bounds the amount of memory used irrespective of the size of the message to
-// deserialize.
+// deserialize.  In the presence of compression, the chunks are uncompressed in
+// parallel by a pool of workers, and deserialized in order.
 class PushDeserializer final {
  public:
   // The |size| of the data chunks sent to |Pull| are never greater than
   // |chunk_size|.  The internal queue holds at most |number_of_chunks| chunks.
   // Therefore, this class uses at most
-  // |number_of_chunks * (chunk_size + O(1)) + O(1)| bytes.
+  // |number_of_chunks * (chunk_size + O(1)) + O(1)| bytes.  In the presence of
+  // compression, it additionally uses |(number_of_chunks + 1) * chunk_size|
+  // bytes for the uncompressed chunks.  If |new_compressor| is not null, it is
+  // used to create a compressor for each worker.
   PushDeserializer(int chunk_size,
                    int number_of_chunks,
-                   std::unique_ptr<Compressor> compressor);
+                   std::function<std::unique_ptr<Compressor>()> new_compressor);
   ~PushDeserializer();
 
   // Starts the deserializer, which will proceed to deserialize data into
@@ -89,17 +96,30 @@ class PushDeserializer final {
   void Push(UniqueArray<std::uint8_t> bytes);
 
  private:
+  // An element of the |queue_|.  If the chunk is being uncompressed, |bytes| is
+  // set when the decompression completes.
+  struct Chunk {
+    Array<std::uint8_t> bytes;
+    bool ready = false;
+  };
+
   // Obtains the next chunk of data from the internal queue.  Blocks if no data
   // is available.  Used as a callback for the underlying
   // |DelegatingArrayOutputStream|.
   Array<std::uint8_t> Pull();
 
+  // Uncompresses |compressed_bytes| into |bytes| and makes the result available
+  // in |chunk|.  Runs on the |decompression_pool_|.
+  void Uncompress(Array<std::uint8_t> compressed_bytes,
+                  Array<std::uint8_t> bytes,
+                  Chunk& chunk) EXCLUDES(lock_);
+
   // |owned_message_| is null if this object doesn't own the message.
   // |message_| is non-null after Start.
   std::unique_ptr<google::protobuf::Message> owned_message_;
   google::protobuf::Message* message_ = nullptr;
 
-  std::unique_ptr<Compressor> const compressor_;
+  std::function<std::unique_ptr<Compressor>()> const new_compressor_;
 
   // The chunk size passed at construction.  The stream consumes chunks of that
   // size.
@@ -120,13 +140,28 @@ class PushDeserializer final {
 
   absl::Mutex lock_;
 
-  // The |queue_| contains the |Array<std::uint8_t>| object filled by |Push| and
-  // not yet consumed by |Pull|.  The |done_| queue contains the callbacks.  The
-  // two queues are out of step: an element is removed from |queue_| by |Pull|
-  // when it returns a chunk to the stream, but the corresponding callback is
-  // removed from |done_| (and executed) when |Pull| returns.
-  std::queue<Array<std::uint8_t>> queue_ GUARDED_BY(lock_);
+  // The |queue_| contains the chunks filled by |Push| and not yet consumed by
+  // |Pull|, in the order of the stream.  The |done_| queue contains the
+  // callbacks.  The two queues are out of step: an element is removed from
+  // |queue_| by |Pull| when it returns a chunk to the stream, but the
+  // corresponding callback is removed from |done_| (and executed) when |Pull|
+  // returns.  References to the elements of |queue_| are stable as it only
+  // grows at the back and shrinks at the front.
+  std::deque<Chunk> queue_ GUARDED_BY(lock_);
   std::queue<std::function<void()>> done_ GUARDED_BY(lock_);
+
+  // The start addresses of the chunks of |uncompressed_data_| that are neither
+  // being uncompressed, nor in the |queue_|, nor read by the stream.
+  std::queue<not_null<std::uint8_t*>> free_ GUARDED_BY(lock_);
+  // The chunk of |uncompressed_data_| read by the stream, if any.
+  std::uint8_t* in_use_ GUARDED_BY(lock_) = nullptr;
+
+  // The compressors that are not used by a decompression.
+  std::vector<std::unique_ptr<Compressor>> idle_compressors_ GUARDED_BY(lock_);
+
+  // Null in the absence of compression.  Must be the last member so that the
+  // decompressions complete before the other members are destroyed.
+  std::unique_ptr<ThreadPool<void>> decompression_pool_;
 };
 
 }  // namespace internal_push_deserializer
@@ -4,6 +4,7 @@
 #include "base/push_deserializer.hpp"
 
 #include <algorithm>
+#include <thread>
 
 #include "base/sink_source.hpp"
 #include "glog/logging.h"
@@ -78,18 +79,33 @@ inline std::int64_t DelegatingArrayInputStream::ByteCount() const {
 inline PushDeserializer::PushDeserializer(
     int const chunk_size,
     int const number_of_chunks,
-    std::unique_ptr<Compressor> compressor)
-    : compressor_(std::move(compressor)),
+    std::function<std::unique_ptr<Compressor>()> new_compressor)
+    : new_compressor_(std::move(new_compressor)),
       chunk_size_(chunk_size),
       compressed_chunk_size_(
-          compressor_ == nullptr
+          new_compressor_ == nullptr
               ? chunk_size_
-              : compressor_->MaxCompressedLength(chunk_size_)),
+              : new_compressor_()->MaxCompressedLength(chunk_size_)),
       number_of_chunks_(number_of_chunks),
-      uncompressed_data_(chunk_size_),
+      uncompressed_data_(new_compressor_ == nullptr
+                             ? 0
+                             : (number_of_chunks_ + 1) * chunk_size_),
       stream_(std::bind(&PushDeserializer::Pull, this)) {
   // This sentinel ensures that the two queue are correctly out of step.
   done_.push(nullptr);
+
+  if (new_compressor_ != nullptr) {
+    // Each element of the |queue_| may hold an uncompressed chunk, and the
+    // stream holds one more.
+    for (int i = 0; i < number_of_chunks_ + 1; ++i) {
+      free_.push(uncompressed_data_.data.get() + i * chunk_size_);
+    }
+    int const number_of_workers =
+        std::max(1,
+                 std::min(static_cast<int>(std::thread::hardware_concurrency()),
+                          number_of_chunks_));
+    decompression_pool_ = std::make_unique<ThreadPool<void>>(number_of_workers);
+  }
 }
 
 inline PushDeserializer::~PushDeserializer() {
@@ -150,7 +166,7 @@ inline void PushDeserializer::Push(Array<std::uint8_t> const bytes,
   // absence of compression we have a stream so we can cut into as many chunks
   // as we like.
   int queued_chunk_size;
-  if (compressor_ == nullptr) {
+  if (new_compressor_ == nullptr) {
     queued_chunk_size = chunk_size_;
   } else {
     CHECK_LE(bytes.size, compressed_chunk_size_);
@@ -168,9 +184,24 @@ inline void PushDeserializer::Push(Array<std::uint8_t> const bytes,
       };
       lock_.Await(absl::Condition(&queue_has_room));
 
-      queue_.emplace(current.data,
-                     std::min(current.size,
-                              static_cast<std::int64_t>(queued_chunk_size)));
+      Array<std::uint8_t> const chunk_bytes(
+          current.data,
+          std::min(current.size, static_cast<std::int64_t>(queued_chunk_size)));
+      if (chunk_bytes.size == 0 || new_compressor_ == nullptr) {
+        queue_.push_back({chunk_bytes, /*ready=*/true});
+      } else {
+        // Since the |queue_| has room, there is a free chunk to uncompress
+        // into.
+        CHECK(!free_.empty());
+        Array<std::uint8_t> const uncompressed_bytes(free_.front(),
+                                                     chunk_size_);
+        free_.pop();
+        Chunk& chunk = queue_.emplace_back();
+        decompression_pool_->Add(
+            [this, chunk_bytes, uncompressed_bytes, &chunk]() {
+              Uncompress(chunk_bytes, uncompressed_bytes, chunk);
+            });
+      }
       done_.emplace(is_last ? std::move(done) : nullptr);
     }
     current.data = &current.data[queued_chunk_size];
@@ -190,8 +221,10 @@ inline Array<std::uint8_t> PushDeserializer::Pull() {
   {
     absl::MutexLock l(&lock_);
 
-    auto const queue_has_elements =  [this]() { return !queue_.empty(); };
-    lock_.Await(absl::Condition(&queue_has_elements));
+    auto const front_is_ready = [this]() {
+      return !queue_.empty() && queue_.front().ready;
+    };
+    lock_.Await(absl::Condition(&front_is_ready));
 
     // The front of |done_| is the callback for the |Array<std::uint8_t>| object
     // that was just processed.  Run it now.
@@ -201,22 +234,50 @@ inline Array<std::uint8_t> PushDeserializer::Pull() {
       done();
     }
     done_.pop();
+    // The stream is done with the chunk that it was reading.
+    if (in_use_ != nullptr) {
+      free_.push(in_use_);
+      in_use_ = nullptr;
+    }
     // Get the next |Array<std::uint8_t>| object to process and remove it from
-    // |queue_|.  Uncompress it if needed.
-    auto const& front = queue_.front();
-    if (front.size == 0 || compressor_ == nullptr) {
-      result = front;
-    } else {
-      ArraySource<std::uint8_t> source(front);
-      ArraySink<std::uint8_t> sink(uncompressed_data_.get());
-      CHECK(compressor_->UncompressStream(&source, &sink));
-      result = sink.array();
+    // |queue_|.  It has already been uncompressed if needed.
+    result = queue_.front().bytes;
+    if (result.size > 0 && new_compressor_ != nullptr) {
+      in_use_ = result.data;
     }
-    queue_.pop();
+    queue_.pop_front();
   }
   return result;
 }
 
+inline void PushDeserializer::Uncompress(
+    Array<std::uint8_t> const compressed_bytes,
+    Array<std::uint8_t> const bytes,
+    Chunk& chunk) {
+  // Compressors are stateful, so each decompression needs its own.  We create
+  // them lazily, so there are never more of them than there are workers.
+  std::unique_ptr<Compressor> compressor;
+  {
+    absl::MutexLock l(&lock_);
+    if (!idle_compressors_.empty()) {
+      compressor = std::move(idle_compressors_.back());
+      idle_compressors_.pop_back();
+    }
+  }
+  if (compressor == nullptr) {
+    compressor = new_compressor_();
+  }
+
+  ArraySource<std::uint8_t> source(compressed_bytes);
+  ArraySink<std::uint8_t> sink(bytes);
+  CHECK(compressor->UncompressStream(&source, &sink));
+
+  absl::MutexLock l(&lock_);
+  idle_compressors_.push_back(std::move(compressor));
+  chunk.bytes = sink.array();
+  chunk.ready = true;
+}
+
 }  // namespace internal_push_deserializer
 }  // namespace base
 }  // namespace principia
@@ -52,11 +52,11 @@ class PushDeserializerTest : public ::testing::Test {
       : pull_serializer_(
             std::make_unique<PullSerializer>(serializer_chunk_size,
                                              number_of_chunks,
-                                             /*compressor=*/nullptr)),
+                                             /*new_compressor=*/nullptr)),
         push_deserializer_(
             std::make_unique<PushDeserializer>(deserializer_chunk_size,
                                                number_of_chunks,
-                                               /*compressor=*/nullptr)),
+                                               /*new_compressor=*/nullptr)),
         stream_(std::bind(&PushDeserializerTest::OnEmpty,
                           this,
                           std::ref(strings_))) {}
@@ -109,8 +109,10 @@ class PushDeserializerTest : public ::testing::Test {
 
   // Exercises concurrent serialization and deserialization.
   void TestSerializationDeserialization(
-      std::unique_ptr<Compressor> serializer_compressor,
-      std::unique_ptr<Compressor> deserializer_compressor) {
+      std::function<std::unique_ptr<Compressor>()> new_serializer_compressor,
+      std::function<std::unique_ptr<Compressor>()> new_deserializer_compressor,
+      int const serializer_number_of_chunks = 4,
+      int const deserializer_number_of_chunks = number_of_chunks) {
     auto const trajectory = BuildTrajectory();
     int const byte_size = trajectory->ByteSize();
     for (int i = 0; i < runs_per_test; ++i) {
@@ -121,13 +123,13 @@ class PushDeserializerTest : public ::testing::Test {
 
       pull_serializer_ =
           std::make_unique<PullSerializer>(serializer_chunk_size,
-                                           /*number_of_chunks=*/4,
-                                           std::move(serializer_compressor));
+                                           serializer_number_of_chunks,
+                                           new_serializer_compressor);
       push_deserializer_ =
           std::make_unique<PushDeserializer>(
               deserializer_chunk_size,
-              number_of_chunks,
-              std::move(deserializer_compressor));
+              deserializer_number_of_chunks,
+              new_deserializer_compressor);
 
       pull_serializer_->Start(std::move(written_trajectory));
       push_deserializer_->Start(std::move(read_trajectory),
@@ -234,7 +236,7 @@ TEST_F(PushDeserializerTest, DeserializationGipfeli) {
         std::make_unique<PushDeserializer>(
             deserializer_chunk_size,
             number_of_chunks,
-            google::compression::NewGipfeliCompressor());
+            &google::compression::NewGipfeliCompressor);
     auto const written_trajectory = BuildTrajectory();
     auto const uncompressed = written_trajectory->SerializePartialAsString();
 
@@ -282,7 +284,7 @@ TEST_F(PushDeserializerTest, DeserializationThreading) {
   for (int i = 0; i < runs_per_test; ++i) {
     auto read_trajectory = make_not_null_unique<DiscreteTrajectory>();
     push_deserializer_ = std::make_unique<PushDeserializer>(
-        deserializer_chunk_size, number_of_chunks, /*compressor=*/nullptr);
+        deserializer_chunk_size, number_of_chunks, /*new_compressor=*/nullptr);
 
     written_trajectory->SerializePartialToArray(&serialized_trajectory[0],
                                                 byte_size);
@@ -299,11 +301,23 @@ TEST_F(PushDeserializerTest, DeserializationThreading) {
 }
 
 TEST_F(PushDeserializerTest, SerializationDeserialization) {
-  TestSerializationDeserialization(/*serializer_compressor=*/nullptr,
-                                   /*deserializer_compressor=*/nullptr);
+  TestSerializationDeserialization(/*new_serializer_compressor=*/nullptr,
+                                   /*new_deserializer_compressor=*/nullptr);
   TestSerializationDeserialization(
-      /*serializer_compressor=*/google::compression::NewGipfeliCompressor(),
-      /*deserializer_compressor=*/google::compression::NewGipfeliCompressor());
+      /*new_serializer_compressor=*/&google::compression::NewGipfeliCompressor,
+      /*new_deserializer_compressor=*/
+      &google::compression::NewGipfeliCompressor);
+}
+
+// Check that the chunks are reassembled in order when many of them are
+// compressed and uncompressed concurrently.
+TEST_F(PushDeserializerTest, ParallelCompression) {
+  TestSerializationDeserialization(
+      /*new_serializer_compressor=*/&google::compression::NewGipfeliCompressor,
+      /*new_deserializer_compressor=*/
+      &google::compression::NewGipfeliCompressor,
+      /*serializer_number_of_chunks=*/16,
+      /*deserializer_number_of_chunks=*/16);
 }
 
 // Check that deserialization fails if we stomp on one extra byte.
@@ -7,6 +7,10 @@
 #include "benchmark/benchmark.h"
 #include "geometry/frame.hpp"
 #include "ksp_plugin/frames.hpp"
+#include "quantities/elementary_functions.hpp"
+#include "quantities/numbers.hpp"
+#include "quantities/si.hpp"
+#include "serialization/physics.pb.h"
 
 namespace principia {
 namespace physics {
@@ -16,9 +20,18 @@ using base::not_null;
 using geometry::Frame;
 using geometry::Handedness;
 using geometry::Inertial;
+using geometry::Displacement;
 using geometry::Instant;
 using geometry::Velocity;
 using ksp_plugin::World;
+using quantities::AngularFrequency;
+using quantities::Cos;
+using quantities::Length;
+using quantities::Sin;
+using quantities::Speed;
+using quantities::Time;
+using quantities::si::Metre;
+using quantities::si::Radian;
 using quantities::si::Second;
 
 namespace {
@@ -48,6 +61,31 @@ not_null<DiscreteTrajectory<World>*> ForkAt(DiscreteTrajectory<World>& parent,
   return parent.NewForkWithCopy(fork_it->time);
 }
 
+// Creates a downsampled history of a vessel in a low circular orbit, with the
+// given number of 10 s steps.
+not_null<std::unique_ptr<DiscreteTrajectory<World>>> CreateHistory(
+    int const steps) {
+  auto history = make_not_null_unique<DiscreteTrajectory<World>>();
+  history->SetDownsampling(/*max_dense_intervals=*/10'000,
+                           /*tolerance=*/10 * Metre);
+  AngularFrequency const ω = 2 * π * Radian / (5'800 * Second);
+  Length const r = 7'000'000 * Metre;
+  Speed const v = ω * r / Radian;
+  Instant t;
+  for (int i = 0; i < steps; ++i, t += 10 * Second) {
+    Time const τ = t - Instant();
+    history->Append(
+        t,
+        {World::origin + Displacement<World>({r * Cos(ω * τ),
+                                               r * Sin(ω * τ),
+                                               0 * Metre}),
+         Velocity<World>({-v * Sin(ω * τ),
+                          v * Cos(ω * τ),
+                          0 * Metre / Second})});
+  }
+  return history;
+}
+
 }  // namespace
 
 void BM_DiscreteTrajectoryFront(benchmark::State& state) {
@@ -157,6 +195,21 @@ void BM_DiscreteTrajectoryLowerBound(benchmark::State& state) {
   }
 }
 
+// The cost of writing a history to a save, as a function of its length.
+void BM_DiscreteTrajectoryWriteToMessage(benchmark::State& state) {
+  int const steps = state.range(0);
+  not_null<std::unique_ptr<DiscreteTrajectory<World>>> const history =
+      CreateHistory(steps);
+  std::int64_t bytes = 0;
+  for (auto _ : state) {
+    serialization::DiscreteTrajectory message;
+    history->WriteToMessage(&message, /*forks=*/{});
+    bytes = message.ByteSizeLong();
+  }
+  state.counters["points"] = history->Size();
+  state.counters["bytes"] = bytes;
+}
+
 BENCHMARK(BM_DiscreteTrajectoryFront);
 BENCHMARK(BM_DiscreteTrajectoryBack);
 BENCHMARK(BM_DiscreteTrajectoryBegin);
@@ -166,6 +219,10 @@ BENCHMARK(BM_DiscreteTrajectoryIterate)->Range(8, 1024);
 BENCHMARK(BM_DiscreteTrajectoryReverseIterate)->Range(8, 1024);
 BENCHMARK(BM_DiscreteTrajectoryFind)->Range(8, 1024);
 BENCHMARK(BM_DiscreteTrajectoryLowerBound)->Range(8, 1024);
+BENCHMARK(BM_DiscreteTrajectoryWriteToMessage)
+    ->RangeMultiplier(4)
+    ->Range(1 << 14, 1 << 22)
+    ->Unit(benchmark::kMillisecond);
 
 }  // namespace physics
 }  // namespace principia
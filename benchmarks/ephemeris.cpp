@@ -1,11 +1,13 @@
 ﻿
 // .\Release\x64\benchmarks.exe --benchmark_repetitions=3 --benchmark_filter=Ephemeris                                                                     // NOLINT(whitespace/line_length)
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <list>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "astronomy/frames.hpp"
@@ -400,6 +402,83 @@ void BM_EphemerisMultithreadingBenchmark(benchmark::State& state) {
   state.SetLabel(ss.str());
 }
 
+// Simulates the frames of the plugin at high warp: each frame prolongs the
+// ephemeris and advances the vessels in parallel.  If |state.range(1)| is
+// nonzero, the ephemeris is prolonged in the background a couple of frames
+// ahead, as done by |Plugin::AdvanceTime|.
+void BM_EphemerisPipelinedFrames(benchmark::State& state) {
+  auto const at_спутник_1_launch =
+      SolarSystemAtСпутник1Launch(
+          SolarSystemFactory::Accuracy::AllBodiesAndDampedOblateness);
+  Instant const epoch = at_спутник_1_launch->epoch();
+  auto const ephemeris =
+      at_спутник_1_launch->MakeEphemeris(
+          /*accuracy_parameters=*/{/*fitting_tolerance=*/1 * Milli(Metre),
+                                   /*geopotential_tolerance=*/0x1p-24},
+          EphemerisParameters());
+  std::string const& earth_name =
+      SolarSystemFactory::name(SolarSystemFactory::Earth);
+  auto const earth_massive_body =
+      at_спутник_1_launch->massive_body(*ephemeris, earth_name);
+  auto const earth_degrees_of_freedom =
+      at_спутник_1_launch->degrees_of_freedom(earth_name);
+  bool const pipelined = state.range(1) != 0;
+
+  MasslessBody probe;
+  std::list<DiscreteTrajectory<Barycentric>> trajectories;
+  std::vector<not_null<std::unique_ptr<Integrator<Ephemeris<
+      Barycentric>::NewtonianMotionEquation>::Instance>>>
+      instances;
+  for (int i = 0; i < state.range(0); ++i) {
+    KeplerianElements<Barycentric> elements;
+    elements.eccentricity = 0;
+    elements.semimajor_axis = 7000 * Kilo(Metre) + i * 100 * Kilo(Metre);
+    elements.inclination = 0 * Radian;
+    elements.longitude_of_ascending_node = 0 * Radian;
+    elements.argument_of_periapsis = 0 * Radian;
+    elements.true_anomaly = 0 * Radian;
+    KeplerOrbit<Barycentric> const orbit(
+        *earth_massive_body, probe, elements, epoch);
+    auto& trajectory = trajectories.emplace_back();
+    trajectory.Append(epoch,
+                      earth_degrees_of_freedom + orbit.StateVectors(epoch));
+    instances.push_back(ephemeris->NewInstance(
+        {&trajectory},
+        Ephemeris<Barycentric>::NoIntrinsicAccelerations,
+        Ephemeris<Barycentric>::FixedStepParameters(
+            SymmetricLinearMultistepIntegrator<Quinlan1999Order8A,
+                                               Position<Barycentric>>(),
+            /*step=*/10 * Second)));
+  }
+
+  ThreadPool<void> pool(
+      /*pool_size=*/std::max(1u, std::thread::hardware_concurrency()));
+  static constexpr int warp_factor = 100'000;
+  static constexpr Frequency refresh_frequency = 50 * Hertz;
+  static constexpr Time step = warp_factor / refresh_frequency;
+  Instant final_time = epoch;
+  for (auto _ : state) {
+    final_time += step;
+    ephemeris->Prolong(final_time);
+    if (pipelined) {
+      ephemeris->RequestProlongation(final_time + 2 * step);
+    }
+
+    std::vector<std::future<void>> futures;
+    for (auto& instance : instances) {
+      futures.push_back(pool.Add([&ephemeris, &instance, final_time]() {
+        ephemeris->FlowWithFixedStep(final_time, *instance);
+      }));
+    }
+    for (auto const& future : futures) {
+      future.wait();
+    }
+  }
+  state.SetLabel(std::to_string(state.iterations()) + " frames, " +
+                 quantities::DebugString((final_time - epoch) / Second) +
+                 " s");
+}
+
 template<SolarSystemFactory::Accuracy accuracy, Flow* flow>
 void EphemerisL4ProbeBenchmark(Time const integration_duration,
                                benchmark::State& state) {
@@ -588,6 +667,11 @@ BENCHMARK(BM_EphemerisMultithreadingBenchmark)
     ->ArgPair(3, 3)
     ->ArgPair(3, 4)
     ->ArgPair(3, 5);
+BENCHMARK(BM_EphemerisPipelinedFrames)
+    ->ArgPair(100, 0)
+    ->ArgPair(100, 1)
+    ->ArgPair(1000, 0)
+    ->ArgPair(1000, 1);
 BENCHMARK(BM_EphemerisKSPSystem)->Arg(-3);
 BENCHMARK_TEMPLATE(BM_EphemerisSolarSystem,
                    SolarSystemFactory::Accuracy::MajorBodiesOnly)
@@ -0,0 +1,103 @@
+// .\Release\x64\benchmarks.exe --benchmark_repetitions=3 --benchmark_filter=KeplerOrbit  // NOLINT(whitespace/line_length)
+
+#include <vector>
+
+#include "astronomy/frames.hpp"
+#include "base/not_null.hpp"
+#include "benchmark/benchmark.h"
+#include "geometry/named_quantities.hpp"
+#include "physics/kepler_orbit.hpp"
+#include "physics/massive_body.hpp"
+#include "physics/massless_body.hpp"
+#include "quantities/astronomy.hpp"
+#include "quantities/si.hpp"
+
+namespace principia {
+
+using astronomy::ICRS;
+using base::not_null;
+using geometry::Instant;
+using quantities::Pow;
+using quantities::astronomy::AstronomicalUnit;
+using quantities::astronomy::JulianYear;
+using quantities::si::Degree;
+using quantities::si::Radian;
+
+namespace physics {
+
+namespace {
+
+KeplerOrbit<ICRS> MakeOrbit(double const eccentricity) {
+  MassiveBody const primary(Pow<3>(AstronomicalUnit) / Pow<2>(JulianYear));
+  MasslessBody const secondary;
+  KeplerianElements<ICRS> elements;
+  elements.eccentricity = eccentricity;
+  elements.semimajor_axis =
+      (eccentricity < 1 ? 1 : -1) * AstronomicalUnit;
+  elements.inclination = 10 * Degree;
+  elements.longitude_of_ascending_node = 20 * Degree;
+  elements.argument_of_periapsis = 30 * Degree;
+  elements.mean_anomaly = 1 * Radian;
+  elements.hyperbolic_mean_anomaly = 1 * Radian;
+  if (eccentricity < 1) {
+    elements.hyperbolic_mean_anomaly.reset();
+  } else {
+    elements.mean_anomaly.reset();
+  }
+  return KeplerOrbit<ICRS>(primary, secondary, elements, Instant());
+}
+
+std::vector<Instant> MakeTimes(int const size) {
+  std::vector<Instant> times;
+  for (int i = 0; i < size; ++i) {
+    times.push_back(Instant() + i * JulianYear / size);
+  }
+  return times;
+}
+
+}  // namespace
+
+// The argument is the eccentricity in thousandths.
+void BM_KeplerOrbitScalarStateVectors(benchmark::State& state) {
+  auto const orbit = MakeOrbit(state.range(0) / 1000.0);
+  auto const times = MakeTimes(1000);
+  for (auto _ : state) {
+    for (Instant const& t : times) {
+      benchmark::DoNotOptimize(orbit.StateVectors(t));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * times.size());
+}
+
+void BM_KeplerOrbitBatchStateVectors(benchmark::State& state) {
+  auto const orbit = MakeOrbit(state.range(0) / 1000.0);
+  auto const times = MakeTimes(1000);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(orbit.StateVectors(times));
+  }
+  state.SetItemsProcessed(state.iterations() * times.size());
+}
+
+void BM_KeplerOrbitBatchManyOrbits(benchmark::State& state) {
+  std::vector<KeplerOrbit<ICRS>> orbits;
+  std::vector<not_null<KeplerOrbit<ICRS> const*>> orbit_pointers;
+  for (int i = 0; i < 1000; ++i) {
+    orbits.push_back(MakeOrbit(i / 1000.0));
+  }
+  for (auto const& orbit : orbits) {
+    orbit_pointers.push_back(&orbit);
+  }
+  Instant const t = Instant() + 1 * JulianYear;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        KeplerOrbit<ICRS>::StateVectors(orbit_pointers, t));
+  }
+  state.SetItemsProcessed(state.iterations() * orbits.size());
+}
+
+BENCHMARK(BM_KeplerOrbitScalarStateVectors)->Arg(100)->Arg(900)->Arg(1500);
+BENCHMARK(BM_KeplerOrbitBatchStateVectors)->Arg(100)->Arg(900)->Arg(1500);
+BENCHMARK(BM_KeplerOrbitBatchManyOrbits);
+
+}  // namespace physics
+}  // namespace principia
@@ -3,6 +3,8 @@
 
 #include <memory>
 #include <random>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "astronomy/frames.hpp"
@@ -12,7 +14,11 @@
 #include "numerics/newhall.hpp"
 #include "numerics/polynomial.hpp"
 #include "numerics/polynomial_evaluators.hpp"
+#include "physics/continuous_trajectory.hpp"
+#include "physics/degrees_of_freedom.hpp"
+#include "quantities/elementary_functions.hpp"
 #include "quantities/named_quantities.hpp"
+#include "quantities/numbers.hpp"
 #include "quantities/si.hpp"
 
 namespace principia {
@@ -21,8 +27,19 @@ using astronomy::ICRS;
 using base::not_null;
 using geometry::Displacement;
 using geometry::Instant;
+using geometry::Velocity;
+using physics::ContinuousTrajectory;
+using physics::DegreesOfFreedom;
+using quantities::Angle;
+using quantities::AngularFrequency;
+using quantities::Cos;
+using quantities::Length;
+using quantities::Sin;
+using quantities::Time;
 using quantities::Variation;
 using quantities::si::Metre;
+using quantities::si::Milli;
+using quantities::si::Radian;
 using quantities::si::Second;
 
 namespace numerics {
@@ -92,6 +109,67 @@ void BM_NewhallApproximationDisplacement(benchmark::State& state) {
   }
 }
 
+void BM_NewhallApproximationErrorEstimate(benchmark::State& state) {
+  int const degree = state.range_x();
+  std::mt19937_64 random(42);
+  std::vector<Displacement<ICRS>> p;
+  std::vector<Variation<Displacement<ICRS>>> v;
+  Instant const t0;
+  Instant const t_min = t0 + static_cast<double>(random()) * Second;
+  Instant const t_max = t_min + static_cast<double>(random()) * Second;
+
+  for (int i = 0; i <= 8; ++i) {
+    p.push_back(Displacement<ICRS>({static_cast<double>(random()) * Metre,
+                                    static_cast<double>(random()) * Metre,
+                                    static_cast<double>(random()) * Metre}));
+    v.push_back(Variation<Displacement<ICRS>>(
+        {static_cast<double>(random()) * Metre / Second,
+         static_cast<double>(random()) * Metre / Second,
+         static_cast<double>(random()) * Metre / Second}));
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        NewhallApproximationErrorEstimate(degree, p, v, t_min, t_max));
+  }
+}
+
+// Fits a circular orbit with |ContinuousTrajectory|, which selects the degree
+// and computes the approximations.  The items are the fitted polynomials.
+void BM_NewhallApproximationContinuousTrajectory(benchmark::State& state) {
+  int const number_of_polynomials = 1000;
+  Length const radius = 1e10 * Metre;
+  Time const period = 3e7 * Second;
+  Time const step = state.range_x() * Second;
+  AngularFrequency const ω = 2 * π * Radian / period;
+  std::vector<std::pair<Instant, DegreesOfFreedom<ICRS>>> points;
+  Instant const t0;
+  for (int i = 0; i <= 8 * number_of_polynomials; ++i) {
+    Instant const t = t0 + i * step;
+    Angle const angle = ω * (t - t0);
+    points.emplace_back(
+        t,
+        DegreesOfFreedom<ICRS>(
+            ICRS::origin + Displacement<ICRS>({radius * Cos(angle),
+                                               radius * Sin(angle),
+                                               0 * Metre}),
+            Velocity<ICRS>({-ω * radius * Sin(angle) / Radian,
+                            ω * radius * Cos(angle) / Radian,
+                            0 * Metre / Second})));
+  }
+
+  double average_degree;
+  for (auto _ : state) {
+    ContinuousTrajectory<ICRS> trajectory(step,
+                                          /*tolerance=*/1 * Milli(Metre));
+    for (auto const& [t, degrees_of_freedom] : points) {
+      CHECK_OK(trajectory.Append(t, degrees_of_freedom));
+    }
+    average_degree = trajectory.average_degree();
+  }
+  state.SetItemsProcessed(state.iterations() * number_of_polynomials);
+  state.SetLabel("average degree " + std::to_string(average_degree));
+}
+
 using ResultЧебышёвDouble = ЧебышёвSeries<double>;
 using ResultЧебышёвDisplacement = ЧебышёвSeries<Displacement<ICRS>>;
 using ResultMonomialDouble =
@@ -120,6 +198,9 @@ BENCHMARK_TEMPLATE(
     (&NewhallApproximationInMonomialBasis<Displacement<ICRS>,
                                           EstrinEvaluator>))
     ->Arg(4)->Arg(8)->Arg(16);
+BENCHMARK(BM_NewhallApproximationErrorEstimate)->DenseRange(3, 17);
+BENCHMARK(BM_NewhallApproximationContinuousTrajectory)
+    ->Arg(60)->Arg(3600)->Arg(86400);
 
 }  // namespace numerics
 }  // namespace principia
@@ -4,6 +4,7 @@
 #include "ksp_plugin/planetarium.hpp"
 
 #include <algorithm>
+#include <vector>
 
 #include "astronomy/time_scales.hpp"
 #include "benchmark/benchmark.h"
@@ -159,6 +160,10 @@ class Satellites {
     return goes_8_trajectory_;
   }
 
+  Ephemeris<Barycentric> const& ephemeris() const {
+    return *ephemeris_;
+  }
+
   Planetarium MakePlanetarium(
       Perspective<Navigation, Camera> const& perspective) const {
     // No dark area, human visual acuity, wide field of view.
@@ -251,10 +256,57 @@ void BM_PlanetariumPlotMethod2FarEquatorialPerspective(
   RunBenchmark(state, EquatorialPerspective(far));
 }
 
+// Plots the past and future trajectories of all the bodies of the real solar
+// system, in sequence if |state.range(0)| is 0, in parallel otherwise.
+void BM_PlanetariumPlotCelestialTrajectories(benchmark::State& state) {
+  bool const parallel = state.range(0) != 0;
+  Satellites satellites;
+  Planetarium planetarium = satellites.MakePlanetarium(PolarPerspective(far));
+  // This is the time of a lunar eclipse in January 2000.
+  constexpr Instant now = "2000-01-21T04:41:30,5"_TT;
+  std::vector<Planetarium::PlottingRequest> requests;
+  for (not_null<MassiveBody const*> const body :
+       satellites.ephemeris().bodies()) {
+    auto const trajectory = satellites.ephemeris().trajectory(body);
+    requests.push_back({trajectory,
+                        /*first_time=*/trajectory->t_min(),
+                        /*last_time=*/now,
+                        /*reverse=*/true});
+    requests.push_back({trajectory,
+                        /*first_time=*/now,
+                        /*last_time=*/now + 30 * Day,
+                        /*reverse=*/false});
+  }
+  std::vector<RP2Lines<Length, Camera>> rp2_lines_list;
+  while (state.KeepRunning()) {
+    if (parallel) {
+      rp2_lines_list = planetarium.PlotMethod2(requests, now);
+    } else {
+      rp2_lines_list.clear();
+      for (auto const& request : requests) {
+        rp2_lines_list.push_back(planetarium.PlotMethod2(*request.trajectory,
+                                                         request.first_time,
+                                                         request.last_time,
+                                                         now,
+                                                         request.reverse));
+      }
+    }
+  }
+  int points = 0;
+  for (auto const& rp2_lines : rp2_lines_list) {
+    for (auto const& rp2_line : rp2_lines) {
+      points += rp2_line.size();
+    }
+  }
+  state.SetLabel(std::to_string(requests.size()) + " trajectories, " +
+                 std::to_string(points) + " points");
+}
+
 BENCHMARK(BM_PlanetariumPlotMethod2NearPolarPerspective);
 BENCHMARK(BM_PlanetariumPlotMethod2FarPolarPerspective);
 BENCHMARK(BM_PlanetariumPlotMethod2NearEquatorialPerspective);
 BENCHMARK(BM_PlanetariumPlotMethod2FarEquatorialPerspective);
+BENCHMARK(BM_PlanetariumPlotCelestialTrajectories)->Arg(0)->Arg(1);
 
 }  // namespace geometry
 }  // namespace principia
@@ -0,0 +1,57 @@
+// .\Release\x64\benchmarks.exe --benchmark_min_time=2 --benchmark_repetitions=10 --benchmark_filter=Protector  // NOLINT(whitespace/line_length)
+
+#include "benchmark/benchmark.h"
+#include "geometry/named_quantities.hpp"
+#include "physics/protector.hpp"
+#include "quantities/si.hpp"
+
+namespace principia {
+namespace physics {
+
+using geometry::Instant;
+using quantities::si::Second;
+
+Protector& ProtectorWithoutDelayedCallback() {
+  static Protector* const protector = new Protector;
+  return *protector;
+}
+
+// A protector with a long-lived protection and a callback delayed by it, so
+// that each unprotection has to look at the delayed callbacks.
+Protector& ProtectorWithDelayedCallback() {
+  static Protector* const protector = []() {
+    auto* const protector = new Protector;
+    protector->Protect(Instant());
+    protector->RunWhenUnprotected(Instant() + 1 * Second, []() {});
+    return protector;
+  }();
+  return *protector;
+}
+
+// Each thread repeatedly protects and unprotects a range, as a prognosticator
+// does when it takes and releases an |Ephemeris::Guard|.
+void BM_ProtectorProtectUnprotect(benchmark::State& state) {
+  Protector& protector = ProtectorWithoutDelayedCallback();
+  Instant const t_min = Instant() + 10 * Second;
+  for (auto _ : state) {
+    protector.Protect(t_min);
+    protector.Unprotect(t_min);
+  }
+}
+
+void BM_ProtectorProtectUnprotectWithDelayedCallback(benchmark::State& state) {
+  Protector& protector = ProtectorWithDelayedCallback();
+  Instant const t_min = Instant() + 10 * Second;
+  for (auto _ : state) {
+    protector.Protect(t_min);
+    protector.Unprotect(t_min);
+  }
+}
+
+BENCHMARK(BM_ProtectorProtectUnprotect)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK(BM_ProtectorProtectUnprotectWithDelayedCallback)
+    ->ThreadRange(1, 32)
+    ->UseRealTime();
+
+}  // namespace physics
+}  // namespace principia
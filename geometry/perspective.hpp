@@ -43,10 +43,19 @@ class Perspective final {
 
   Length const& focal() const;
 
+  // The position of the camera in |FromFrame|.
+  Position<FromFrame> const& camera() const;
+
   // Returns the ℝP² element resulting from the projection of |point|.  This
   // is properly defined for all points other than the camera origin.
   RP2Point<Length, ToFrame> operator()(Position<FromFrame> const& point) const;
 
+  // Returns the projections of the |points|.  This is equivalent to applying
+  // the above operator to each point, up to rounding, but it transforms all
+  // the points at once.
+  std::vector<RP2Point<Length, ToFrame>> operator()(
+      std::vector<Position<FromFrame>> const& points) const;
+
   // Returns the part of |segment| that is behind the focal plane as seen from
   // the camera.  Returns nullopt if |segment| is entirely in front of the focal
   // plane.
@@ -62,6 +71,12 @@ class Perspective final {
   bool IsHiddenBySphere(Position<FromFrame> const& point,
                         Sphere<FromFrame> const& sphere) const;
 
+  // Returns true iff the |sphere| lies entirely in front of the focal plane or
+  // outside the cone of half-angle arctan(|tan_field_of_view|) around the axis
+  // of the camera.  In that case nothing that it contains is visible.
+  bool IsOutOfView(Sphere<FromFrame> const& sphere,
+                   double tan_field_of_view) const;
+
   // Returns sin² ɑ where ɑ is the half angle under which the |sphere| is seen.
   double SphereSin²HalfAngle(Sphere<FromFrame> const& sphere) const;
 
@@ -78,6 +93,19 @@ class Perspective final {
       Segment<FromFrame> const& segment,
       std::vector<Sphere<FromFrame>> const& spheres) const;
 
+  // Returns the visible parts of the segments of the polyline defined by
+  // |points|, after clipping by the focal plane and hiding by the |spheres|.
+  // The segments that lie entirely outside the cone of half-angle
+  // arctan(|tan_field_of_view|) around the axis of the camera are dropped.
+  // Other than that, this is equivalent to calling |SegmentBehindFocalPlane|
+  // and |VisibleSegments| for each segment, but the geometry of the points and
+  // of the spheres is computed in bulk, and each segment is only tested
+  // against the spheres that may possibly hide it.
+  Segments<FromFrame> VisibleSegments(
+      std::vector<Position<FromFrame>> const& points,
+      std::vector<Sphere<FromFrame>> const& spheres,
+      double tan_field_of_view) const;
+
  private:
   RigidTransformation<ToFrame, FromFrame> const from_camera_;
   RigidTransformation<FromFrame, ToFrame> const to_camera_;
@@ -4,13 +4,16 @@
 #include "geometry/perspective.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <deque>
 #include <limits>
 #include <vector>
 
 #include "geometry/barycentre_calculator.hpp"
 #include "numerics/root_finders.hpp"
+#include "quantities/elementary_functions.hpp"
 #include "quantities/named_quantities.hpp"
+#include "quantities/si.hpp"
 
 namespace principia {
 namespace geometry {
@@ -20,7 +23,9 @@ using geometry::InnerProduct;
 using numerics::SolveQuadraticEquation;
 using quantities::Pow;
 using quantities::Product;
+using quantities::Sqrt;
 using quantities::Square;
+using quantities::si::Metre;
 
 template<typename FromFrame, typename ToFrame>
 Perspective<FromFrame, ToFrame>::Perspective(
@@ -45,6 +50,11 @@ Length const& Perspective<FromFrame, ToFrame>::focal() const {
   return focal_;
 }
 
+template<typename FromFrame, typename ToFrame>
+Position<FromFrame> const& Perspective<FromFrame, ToFrame>::camera() const {
+  return camera_;
+}
+
 template<typename FromFrame, typename ToFrame>
 RP2Point<Length, ToFrame> Perspective<FromFrame, ToFrame>::
 operator()(Position<FromFrame> const& point) const {
@@ -59,6 +69,49 @@ operator()(Position<FromFrame> const& point) const {
                                    coordinates_in_camera.z / focal_);
 }
 
+template<typename FromFrame, typename ToFrame>
+std::vector<RP2Point<Length, ToFrame>> Perspective<FromFrame, ToFrame>::
+operator()(std::vector<Position<FromFrame>> const& points) const {
+  // The columns of the matrix of the rotation to the camera frame.
+  auto const& linear_map = to_camera_.linear_map();
+  R3Element<double> const m_x =
+      linear_map(Vector<double, FromFrame>({1.0, 0.0, 0.0})).coordinates();
+  R3Element<double> const m_y =
+      linear_map(Vector<double, FromFrame>({0.0, 1.0, 0.0})).coordinates();
+  R3Element<double> const m_z =
+      linear_map(Vector<double, FromFrame>({0.0, 0.0, 1.0})).coordinates();
+  double const focal = focal_ / Metre;
+
+  // The coordinates are stored as a structure of arrays, in metres, so that the
+  // loop that applies the rotation may be vectorized.
+  int const size = points.size();
+  std::vector<double> x(size);
+  std::vector<double> y(size);
+  std::vector<double> z(size);
+  for (int i = 0; i < size; ++i) {
+    R3Element<Length> const camera_to_point =
+        (points[i] - camera_).coordinates();
+    x[i] = camera_to_point.x / Metre;
+    y[i] = camera_to_point.y / Metre;
+    z[i] = camera_to_point.z / Metre;
+  }
+  for (int i = 0; i < size; ++i) {
+    double const x_in_camera = m_x.x * x[i] + m_y.x * y[i] + m_z.x * z[i];
+    double const y_in_camera = m_x.y * x[i] + m_y.y * y[i] + m_z.y * z[i];
+    double const z_in_camera = m_x.z * x[i] + m_y.z * y[i] + m_z.z * z[i];
+    x[i] = x_in_camera;
+    y[i] = y_in_camera;
+    z[i] = z_in_camera / focal;
+  }
+
+  std::vector<RP2Point<Length, ToFrame>> projections;
+  projections.reserve(size);
+  for (int i = 0; i < size; ++i) {
+    projections.emplace_back(x[i] * Metre, y[i] * Metre, z[i]);
+  }
+  return projections;
+}
+
 template<typename FromFrame, typename ToFrame>
 std::optional<Segment<FromFrame>>
 Perspective<FromFrame, ToFrame>::SegmentBehindFocalPlane(
@@ -142,6 +195,38 @@ bool Perspective<FromFrame, ToFrame>::IsHiddenBySphere(
   return !is_in_front_of_horizon;
 }
 
+template<typename FromFrame, typename ToFrame>
+bool Perspective<FromFrame, ToFrame>::IsOutOfView(
+    Sphere<FromFrame> const& sphere,
+    double const tan_field_of_view) const {
+  Vector<double, FromFrame> const z =
+      from_camera_.linear_map()(Vector<double, ToFrame>({0.0, 0.0, 1.0}));
+  Displacement<FromFrame> const camera_to_centre = sphere.centre() - camera_;
+  Length const depth = InnerProduct(camera_to_centre, z);
+  if (depth + sphere.radius() < focal_) {
+    return true;
+  }
+  auto const camera_to_centre² = camera_to_centre.Norm²();
+  if (camera_to_centre² <= sphere.radius²()) {
+    return false;
+  }
+
+  // Compare the angle θ between the axis of the camera and the centre to the
+  // sum of the field of view and of the half-angle ɑ under which the sphere is
+  // seen.  Both angles are less than π/2, so this may be done on the cosines.
+  Length const camera_to_centre_norm = Sqrt(camera_to_centre²);
+  double const cos_θ = depth / camera_to_centre_norm;
+  double const sin_ɑ = sphere.radius() / camera_to_centre_norm;
+  double const cos_ɑ = Sqrt(1.0 - sin_ɑ * sin_ɑ);
+  if (std::isinf(tan_field_of_view)) {
+    return cos_θ < -sin_ɑ;
+  }
+  double const cos_field_of_view =
+      1.0 / Sqrt(1.0 + tan_field_of_view * tan_field_of_view);
+  double const sin_field_of_view = tan_field_of_view * cos_field_of_view;
+  return cos_θ < cos_field_of_view * cos_ɑ - sin_field_of_view * sin_ɑ;
+}
+
 template<typename FromFrame, typename ToFrame>
 double Perspective<FromFrame, ToFrame>::SphereSin²HalfAngle(
     Sphere<FromFrame> const& sphere) const {
@@ -413,6 +498,161 @@ Segments<FromFrame> Perspective<FromFrame, ToFrame>::VisibleSegments(
   return segments;
 }
 
+template<typename FromFrame, typename ToFrame>
+Segments<FromFrame> Perspective<FromFrame, ToFrame>::VisibleSegments(
+    std::vector<Position<FromFrame>> const& points,
+    std::vector<Sphere<FromFrame>> const& spheres,
+    double const tan_field_of_view) const {
+  Segments<FromFrame> all_segments;
+  int const points_size = points.size();
+  int const spheres_size = spheres.size();
+  if (points_size < 2) {
+    return all_segments;
+  }
+
+  // If the camera is inside a sphere, everything is hidden.
+  for (auto const& sphere : spheres) {
+    if ((sphere.centre() - camera_).Norm²() <= sphere.radius²()) {
+      return all_segments;
+    }
+  }
+
+  // The culling below works with cones having their apex at the camera.  A cone
+  // is represented by the unit vector of its axis and by the cosine and sine of
+  // its half-angle.  The segment AB is contained in the cone whose axis is the
+  // bisector of KA and KB and whose half-angle β is half the angle AKB.  It may
+  // only be hidden by a sphere seen under a half-angle ɑ if the angle between
+  // the axes is less than ɑ + β, and it may only be visible if the angle
+  // between its axis and that of the camera is less than the field of view
+  // plus β.  All the angles are at most π/2, so these conditions may be
+  // checked by comparing cosines.  The vectors are stored as structures of
+  // arrays, in metres, so that the loops may be vectorized.
+  R3Element<double> const axis =
+      from_camera_.linear_map()(Vector<double, ToFrame>({0.0, 0.0, 1.0}))
+          .coordinates();
+  double const focal = focal_ / Metre;
+  double const cos_field_of_view =
+      std::isinf(tan_field_of_view)
+          ? 0.0
+          : 1.0 / std::sqrt(1.0 + tan_field_of_view * tan_field_of_view);
+  double const sin_field_of_view =
+      std::isinf(tan_field_of_view) ? 1.0
+                                    : tan_field_of_view * cos_field_of_view;
+
+  // The unit vectors from the camera to the points, and the distances of the
+  // points to the camera along its axis.
+  std::vector<double> point_x(points_size);
+  std::vector<double> point_y(points_size);
+  std::vector<double> point_z(points_size);
+  std::vector<double> depth(points_size);
+  for (int i = 0; i < points_size; ++i) {
+    R3Element<Length> const camera_to_point =
+        (points[i] - camera_).coordinates();
+    point_x[i] = camera_to_point.x / Metre;
+    point_y[i] = camera_to_point.y / Metre;
+    point_z[i] = camera_to_point.z / Metre;
+  }
+  for (int i = 0; i < points_size; ++i) {
+    // Same operations as |SegmentBehindFocalPlane|, so that the points are
+    // classified identically.
+    depth[i] = point_x[i] * axis.x + point_y[i] * axis.y + point_z[i] * axis.z;
+    double const norm = std::sqrt(point_x[i] * point_x[i] +
+                                  point_y[i] * point_y[i] +
+                                  point_z[i] * point_z[i]);
+    point_x[i] /= norm;
+    point_y[i] /= norm;
+    point_z[i] /= norm;
+  }
+
+  // The cones under which the spheres are seen.
+  std::vector<double> sphere_x(spheres_size);
+  std::vector<double> sphere_y(spheres_size);
+  std::vector<double> sphere_z(spheres_size);
+  std::vector<double> sphere_cos(spheres_size);
+  std::vector<double> sphere_sin(spheres_size);
+  for (int j = 0; j < spheres_size; ++j) {
+    Displacement<FromFrame> const camera_to_centre =
+        spheres[j].centre() - camera_;
+    Length const distance = camera_to_centre.Norm();
+    R3Element<double> const unit = (camera_to_centre / distance).coordinates();
+    sphere_x[j] = unit.x;
+    sphere_y[j] = unit.y;
+    sphere_z[j] = unit.z;
+    sphere_sin[j] = spheres[j].radius() / distance;
+    sphere_cos[j] = std::sqrt(1.0 - sphere_sin[j] * sphere_sin[j]);
+  }
+
+  // A small margin to make sure that the culling doesn't change the result of
+  // the exact computation near tangency.
+  constexpr double margin = 0x1p-20;
+  std::vector<double> excess(spheres_size);
+  std::vector<Sphere<FromFrame>> candidate_spheres;
+  candidate_spheres.reserve(spheres_size);
+  for (int i = 0; i < points_size - 1; ++i) {
+    bool const first_is_visible = depth[i] >= focal;
+    bool const second_is_visible = depth[i + 1] >= focal;
+    if (!first_is_visible && !second_is_visible) {
+      continue;
+    }
+
+    // The cone containing the segment.  The negated comparisons ensure that
+    // nothing is culled if the segment is seen under a flat angle, in which
+    // case its axis is NaN.
+    double const sum_x = point_x[i] + point_x[i + 1];
+    double const sum_y = point_y[i] + point_y[i + 1];
+    double const sum_z = point_z[i] + point_z[i + 1];
+    double const difference_x = point_x[i] - point_x[i + 1];
+    double const difference_y = point_y[i] - point_y[i + 1];
+    double const difference_z = point_z[i] - point_z[i + 1];
+    double const sum_norm =
+        std::sqrt(sum_x * sum_x + sum_y * sum_y + sum_z * sum_z);
+    double const cos_β = 0.5 * sum_norm;
+    double const sin_β = 0.5 * std::sqrt(difference_x * difference_x +
+                                         difference_y * difference_y +
+                                         difference_z * difference_z);
+    double const segment_x = sum_x / sum_norm;
+    double const segment_y = sum_y / sum_norm;
+    double const segment_z = sum_z / sum_norm;
+
+    if (segment_x * axis.x + segment_y * axis.y + segment_z * axis.z <
+        cos_field_of_view * cos_β - sin_field_of_view * sin_β - margin) {
+      continue;
+    }
+
+    for (int j = 0; j < spheres_size; ++j) {
+      excess[j] = segment_x * sphere_x[j] + segment_y * sphere_y[j] +
+                  segment_z * sphere_z[j] -
+                  (sphere_cos[j] * cos_β - sphere_sin[j] * sin_β);
+    }
+    candidate_spheres.clear();
+    for (int j = 0; j < spheres_size; ++j) {
+      if (!(excess[j] <= -margin)) {
+        candidate_spheres.push_back(spheres[j]);
+      }
+    }
+
+    std::optional<Segment<FromFrame>> segment_behind_focal_plane =
+        Segment<FromFrame>(points[i], points[i + 1]);
+    if (!first_is_visible || !second_is_visible) {
+      segment_behind_focal_plane =
+          SegmentBehindFocalPlane(*segment_behind_focal_plane);
+      if (!segment_behind_focal_plane) {
+        continue;
+      }
+    }
+    if (candidate_spheres.empty()) {
+      all_segments.push_back(*segment_behind_focal_plane);
+    } else {
+      auto segments =
+          VisibleSegments(*segment_behind_focal_plane, candidate_spheres);
+      std::move(segments.begin(),
+                segments.end(),
+                std::back_inserter(all_segments));
+    }
+  }
+  return all_segments;
+}
+
 template<typename FromFrame, typename ToFrame>
 std::ostream& operator<<(std::ostream& out,
                          Perspective<FromFrame, ToFrame> const& perspective) {
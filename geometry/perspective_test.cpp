@@ -1,5 +1,6 @@
 ﻿
 #include <limits>
+#include <vector>
 
 #include "geometry/affine_map.hpp"
 #include "geometry/frame.hpp"
@@ -22,7 +23,9 @@ namespace principia {
 namespace geometry {
 namespace internal_perspective {
 
+using quantities::Cos;
 using quantities::Length;
+using quantities::Sin;
 using quantities::Sqrt;
 using quantities::si::Metre;
 using quantities::si::Radian;
@@ -119,6 +122,38 @@ TEST_F(PerspectiveTest, Basic) {
                             AlmostEquals(2.0 / 0.3 * Metre, 2)));
 }
 
+TEST_F(PerspectiveTest, BatchProjection) {
+  Position<World> const camera_origin =
+      World::origin + Displacement<World>({1 * Metre, 2 * Metre, -3 * Metre});
+  Rotation<World, Camera> const world_to_camera_rotation(
+      π / 6 * Radian,
+      π / 4 * Radian,
+      π / 3 * Radian,
+      CardanoAngles::ZYX,
+      DefinesFrame<Camera>());
+  RigidTransformation<World, Camera> const world_to_camera_transformation(
+      camera_origin,
+      Camera::origin,
+      world_to_camera_rotation.Forget<OrthogonalMap>());
+  Perspective<World, Camera> perspective(world_to_camera_transformation,
+                                         /*focal=*/10 * Metre);
+
+  std::vector<Position<World>> points;
+  for (int i = 0; i < 10; ++i) {
+    points.push_back(
+        World::origin +
+        Displacement<World>({i * Metre, (10 - i * i) * Metre, 7 * Metre}));
+  }
+  auto const projections = perspective(points);
+  ASSERT_THAT(projections, SizeIs(points.size()));
+  for (int i = 0; i < points.size(); ++i) {
+    auto const projection = perspective(points[i]);
+    EXPECT_THAT(projections[i],
+                Componentwise(AlmostEquals(projection.x(), 0, 40),
+                              AlmostEquals(projection.y(), 0, 40)));
+  }
+}
+
 TEST_F(PerspectiveTest, SegmentBehindFocalPlane) {
   Perspective<World, Camera> perspective(
       RigidTransformation<World, Camera>::Identity(),
@@ -618,6 +653,86 @@ TEST_F(VisibleSegmentsTest, MultipleSpheres) {
               SizeIs(3));
 }
 
+// A polyline around two spheres.  Without culling by the field of view, the
+// batch computation must give the same result as the segment-by-segment one.
+TEST_F(VisibleSegmentsTest, Polyline) {
+  Sphere<World> const sphere2(
+      World::origin + Displacement<World>({0 * Metre, 2 * Metre, 5 * Metre}),
+      /*radius=*/1.5 * Metre);
+  std::vector<Sphere<World>> const spheres = {sphere_, sphere2};
+  std::vector<Position<World>> points;
+  for (int i = 0; i <= 200; ++i) {
+    double const t = i / 10.0;
+    points.push_back(World::origin +
+                     Displacement<World>({3 * Cos(t * Radian) * Metre,
+                                          3 * Sin(t * Radian) * Metre,
+                                          (t - 10.05) * Metre}));
+  }
+
+  Segments<World> expected_segments;
+  for (int i = 0; i + 1 < points.size(); ++i) {
+    auto const segment_behind_focal_plane =
+        perspective_.SegmentBehindFocalPlane({points[i], points[i + 1]});
+    if (segment_behind_focal_plane) {
+      auto const segments =
+          perspective_.VisibleSegments(*segment_behind_focal_plane, spheres);
+      expected_segments.insert(
+          expected_segments.end(), segments.begin(), segments.end());
+    }
+  }
+  EXPECT_THAT(
+      perspective_.VisibleSegments(
+          points, spheres, std::numeric_limits<double>::infinity()),
+      Eq(expected_segments));
+}
+
+TEST_F(VisibleSegmentsTest, FieldOfView) {
+  // The camera looks towards the positive z.
+  Position<World> const p1 =
+      World::origin + Displacement<World>({-10 * Metre, 0 * Metre, 10 * Metre});
+  Position<World> const p2 =
+      World::origin + Displacement<World>({-9 * Metre, 0 * Metre, 10 * Metre});
+  Position<World> const p3 =
+      World::origin +
+      Displacement<World>({-10 * Metre, 100 * Metre, 2 * Metre});
+  Position<World> const p4 =
+      World::origin + Displacement<World>({-9 * Metre, 100 * Metre, 2 * Metre});
+  EXPECT_THAT(
+      perspective_.VisibleSegments({p1, p2, p3, p4},
+                                   {sphere_},
+                                   /*tan_field_of_view=*/1),
+      ElementsAre(Segment<World>{p1, p2}, Segment<World>{p2, p3}));
+  EXPECT_THAT(
+      perspective_.VisibleSegments({p1, p2, p3, p4},
+                                   {sphere_},
+                                   std::numeric_limits<double>::infinity()),
+      SizeIs(3));
+}
+
+TEST_F(VisibleSegmentsTest, IsOutOfView) {
+  // The camera looks towards the positive z.
+  double const infinity = std::numeric_limits<double>::infinity();
+  Sphere<World> const in_view(
+      World::origin + Displacement<World>({-10 * Metre, 0 * Metre, 10 * Metre}),
+      /*radius=*/1 * Metre);
+  Sphere<World> const behind(
+      World::origin + Displacement<World>({-10 * Metre, 0 * Metre, -5 * Metre}),
+      /*radius=*/1 * Metre);
+  Sphere<World> const on_the_side(
+      World::origin +
+          Displacement<World>({-10 * Metre, 100 * Metre, 2 * Metre}),
+      /*radius=*/1 * Metre);
+  Sphere<World> const around_the_camera(
+      World::origin + Displacement<World>({-10 * Metre, 0 * Metre, -1 * Metre}),
+      /*radius=*/3 * Metre);
+  EXPECT_FALSE(perspective_.IsOutOfView(in_view, /*tan_field_of_view=*/1));
+  EXPECT_TRUE(perspective_.IsOutOfView(behind, infinity));
+  EXPECT_TRUE(perspective_.IsOutOfView(on_the_side, /*tan_field_of_view=*/1));
+  EXPECT_FALSE(perspective_.IsOutOfView(on_the_side, infinity));
+  EXPECT_FALSE(
+      perspective_.IsOutOfView(around_the_camera, /*tan_field_of_view=*/1));
+}
+
 }  // namespace internal_perspective
 }  // namespace geometry
 }  // namespace principia
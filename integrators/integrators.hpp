@@ -2,7 +2,10 @@
 #define PRINCIPIA_INTEGRATORS_INTEGRATORS_HPP_
 
 #include <functional>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/not_null.hpp"
 #include "base/status.hpp"
@@ -86,6 +89,17 @@ class FixedStepSizeIntegrator : public Integrator<ODE_> {
     // The integrator corresponding to this instance.
     virtual FixedStepSizeIntegrator const& integrator() const = 0;
 
+    // Returns an instance of the same integrator for the given |equation| and
+    // |append_state| that continues the integrations of existing instances:
+    // its component of index |i| starts from the state of the component of
+    // index |states[i].second| of |*states[i].first|.  Returns null if these
+    // instances are not at the same point of the same integration, or if this
+    // integrator doesn't support recombination.
+    virtual std::unique_ptr<typename Integrator<ODE>::Instance> Recombine(
+        std::vector<std::pair<not_null<Instance const*>, int>> const& states,
+        ODE const& equation,
+        AppendState const& append_state) const;
+
     void WriteToMessage(
         not_null<serialization::IntegratorInstance*> message) const override;
     template<typename S = typename ODE::SystemState,
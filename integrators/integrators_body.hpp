@@ -416,6 +416,15 @@ void FixedStepSizeIntegrator<ODE_>::Instance::WriteToMessage(
   integrator().WriteToMessage(extension->mutable_integrator());
 }
 
+template<typename ODE_>
+std::unique_ptr<typename Integrator<ODE_>::Instance>
+FixedStepSizeIntegrator<ODE_>::Instance::Recombine(
+    std::vector<std::pair<not_null<Instance const*>, int>> const& states,
+    ODE const& equation,
+    AppendState const& append_state) const {
+  return nullptr;
+}
+
 #define PRINCIPIA_READ_FSS_INTEGRATOR_INSTANCE_SLMS(method)         \
   auto const& integrator =                                          \
       SymmetricLinearMultistepIntegrator<methods::method,           \
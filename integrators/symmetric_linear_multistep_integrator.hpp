@@ -10,6 +10,8 @@
 #define PRINCIPIA_INTEGRATORS_SYMMETRIC_LINEAR_MULTISTEP_INTEGRATOR_HPP_
 
 #include <list>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "base/status.hpp"
@@ -45,6 +47,12 @@ class SymmetricLinearMultistepIntegrator
     SymmetricLinearMultistepIntegrator const& integrator() const override;
     not_null<std::unique_ptr<typename Integrator<ODE>::Instance>> Clone()
         const override;
+    std::unique_ptr<typename Integrator<ODE>::Instance> Recombine(
+        std::vector<std::pair<
+            not_null<typename FixedStepSizeIntegrator<ODE>::Instance const*>,
+            int>> const& states,
+        ODE const& equation,
+        AppendState const& append_state) const override;
 
     void WriteToMessage(
         not_null<serialization::IntegratorInstance*> message) const override;
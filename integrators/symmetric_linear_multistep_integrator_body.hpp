@@ -162,6 +162,57 @@ SymmetricLinearMultistepIntegrator<Method, Position>::Instance::Clone() const {
   return std::unique_ptr<Instance>(new Instance(*this));
 }
 
+template<typename Method, typename Position>
+std::unique_ptr<typename Integrator<
+    typename SymmetricLinearMultistepIntegrator<Method, Position>::ODE>::
+                    Instance>
+SymmetricLinearMultistepIntegrator<Method, Position>::Instance::Recombine(
+    std::vector<std::pair<
+        not_null<typename FixedStepSizeIntegrator<ODE>::Instance const*>,
+        int>> const& states,
+    ODE const& equation,
+    AppendState const& append_state) const {
+  IntegrationProblem<ODE> problem;
+  problem.equation = equation;
+  problem.initial_state.time = this->current_state_.time;
+  std::list<Step> previous_steps(previous_steps_.size());
+  for (auto const& [state_instance, index] : states) {
+    auto const* const instance =
+        dynamic_cast<Instance const*>(&*state_instance);
+    // The instances must be at the same point of the startup, and their
+    // previous steps must be at the same times.
+    if (instance == nullptr ||
+        instance->step_ != this->step_ ||
+        instance->current_state_.time != this->current_state_.time ||
+        instance->startup_step_index_ != startup_step_index_ ||
+        instance->previous_steps_.size() != previous_steps_.size()) {
+      return nullptr;
+    }
+    auto const& current_state = instance->current_state_;
+    problem.initial_state.positions.push_back(current_state.positions[index]);
+    problem.initial_state.velocities.push_back(
+        current_state.velocities[index]);
+    auto it = previous_steps.begin();
+    auto previous_it = previous_steps_.begin();
+    for (Step const& step : instance->previous_steps_) {
+      if (step.time != previous_it->time) {
+        return nullptr;
+      }
+      it->displacements.push_back(step.displacements[index]);
+      it->accelerations.push_back(step.accelerations[index]);
+      it->time = step.time;
+      ++it;
+      ++previous_it;
+    }
+  }
+  return std::unique_ptr<Instance>(new Instance(problem,
+                                                append_state,
+                                                this->step_,
+                                                startup_step_index_,
+                                                std::move(previous_steps),
+                                                integrator_));
+}
+
 template<typename Method, typename Position>
 void SymmetricLinearMultistepIntegrator<Method, Position>::
 Instance::WriteToMessage(
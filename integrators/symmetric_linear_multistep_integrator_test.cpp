@@ -22,6 +22,7 @@
 
 namespace principia {
 
+using base::Status;
 using geometry::Instant;
 using quantities::Abs;
 using quantities::Acceleration;
@@ -450,5 +451,80 @@ TEST_P(SymmetricLinearMultistepIntegratorTest, Serialization) {
   EXPECT_THAT(message1, EqualsProto(message2));
 }
 
+// Tests that recombined instances continue the integrations of their sources.
+TEST_P(SymmetricLinearMultistepIntegratorTest, Recombination) {
+  LOG(INFO) << GetParam();
+  Instant const t_initial;
+  Time const step = 0.2 * Second;
+
+  std::vector<ODE::SystemState> solution;
+  // Independent harmonic oscillators, one per component.
+  ODE harmonic_oscillator;
+  harmonic_oscillator.compute_acceleration =
+      [](Instant const& t,
+         std::vector<Length> const& q,
+         std::vector<Acceleration>& result) {
+        for (int i = 0; i < q.size(); ++i) {
+          result[i] = -q[i] * (si::Unit<Stiffness> / si::Unit<Mass>);
+        }
+        return Status::OK;
+      };
+  auto const append_state = [&solution](ODE::SystemState const& state) {
+    solution.push_back(state);
+  };
+  auto const new_instance = [&](std::vector<Length> const& q_initial,
+                                Instant const& t) {
+    IntegrationProblem<ODE> problem;
+    problem.equation = harmonic_oscillator;
+    problem.initial_state = {q_initial,
+                             std::vector<Speed>(q_initial.size()),
+                             t};
+    return GetParam().integrator.NewInstance(problem, append_state, step);
+  };
+  auto const fixed_step = [](auto const& instance) {
+    return dynamic_cast<FixedStepSizeIntegrator<ODE>::Instance const*>(
+        &*instance);
+  };
+
+  // The two oscillators are integrated together by |reference|, and
+  // separately by |instance1| and |instance2|.
+  auto const reference = new_instance({1 * Metre, 2 * Metre}, t_initial);
+  auto const instance1 = new_instance({1 * Metre}, t_initial);
+  auto const instance2 = new_instance({2 * Metre}, t_initial);
+  Instant const t1 = t_initial + 20 * step;
+  EXPECT_OK(reference->Solve(t1));
+  EXPECT_OK(instance1->Solve(t1));
+  EXPECT_OK(instance2->Solve(t1));
+
+  // An instance that is still starting up cannot be recombined with them.
+  auto const late_instance = new_instance({3 * Metre}, t1 - 2 * step);
+  EXPECT_OK(late_instance->Solve(t1));
+  EXPECT_EQ(nullptr,
+            fixed_step(instance1)->Recombine(
+                {{fixed_step(instance1), 0}, {fixed_step(late_instance), 0}},
+                harmonic_oscillator,
+                append_state));
+
+  auto const recombined = fixed_step(instance2)->Recombine(
+      {{fixed_step(instance1), 0}, {fixed_step(instance2), 0}},
+      harmonic_oscillator,
+      append_state);
+  ASSERT_NE(nullptr, recombined);
+  Instant const t2 = t_initial + 50 * step;
+  EXPECT_OK(reference->Solve(t2));
+  EXPECT_OK(recombined->Solve(t2));
+  EXPECT_EQ(reference->state(), recombined->state());
+
+  // The state can be split again.
+  auto const split = fixed_step(recombined)->Recombine(
+      {{fixed_step(recombined), 1}}, harmonic_oscillator, append_state);
+  ASSERT_NE(nullptr, split);
+  Instant const t3 = t_initial + 60 * step;
+  EXPECT_OK(reference->Solve(t3));
+  EXPECT_OK(split->Solve(t3));
+  EXPECT_EQ(reference->state().positions[1], split->state().positions[0]);
+  EXPECT_EQ(reference->state().velocities[1], split->state().velocities[0]);
+}
+
 }  // namespace integrators
 }  // namespace principia
@@ -85,6 +85,12 @@ class SymplecticRungeKuttaNyströmIntegrator
     SymplecticRungeKuttaNyströmIntegrator const& integrator() const override;
     not_null<std::unique_ptr<typename Integrator<ODE>::Instance>> Clone()
         const override;
+    std::unique_ptr<typename Integrator<ODE>::Instance> Recombine(
+        std::vector<std::pair<
+            not_null<typename FixedStepSizeIntegrator<ODE>::Instance const*>,
+            int>> const& states,
+        ODE const& equation,
+        AppendState const& append_state) const override;
 
     void WriteToMessage(
         not_null<serialization::IntegratorInstance*> message) const override;
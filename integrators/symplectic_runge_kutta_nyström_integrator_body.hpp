@@ -151,6 +151,36 @@ Instance::Clone() const {
   return std::unique_ptr<Instance>(new Instance(*this));
 }
 
+template<typename Method, typename Position>
+std::unique_ptr<typename Integrator<
+    typename SymplecticRungeKuttaNyströmIntegrator<Method, Position>::ODE>::
+                    Instance>
+SymplecticRungeKuttaNyströmIntegrator<Method, Position>::Instance::Recombine(
+    std::vector<std::pair<
+        not_null<typename FixedStepSizeIntegrator<ODE>::Instance const*>,
+        int>> const& states,
+    ODE const& equation,
+    AppendState const& append_state) const {
+  IntegrationProblem<ODE> problem;
+  problem.equation = equation;
+  problem.initial_state.time = this->current_state_.time;
+  for (auto const& [state_instance, index] : states) {
+    auto const* const instance =
+        dynamic_cast<Instance const*>(&*state_instance);
+    if (instance == nullptr ||
+        instance->step_ != this->step_ ||
+        instance->current_state_.time != this->current_state_.time) {
+      return nullptr;
+    }
+    auto const& current_state = instance->current_state_;
+    problem.initial_state.positions.push_back(current_state.positions[index]);
+    problem.initial_state.velocities.push_back(
+        current_state.velocities[index]);
+  }
+  return std::unique_ptr<Instance>(
+      new Instance(problem, append_state, this->step_, integrator_));
+}
+
 template<typename Method, typename Position>
 void SymplecticRungeKuttaNyströmIntegrator<Method, Position>::
 Instance::WriteToMessage(
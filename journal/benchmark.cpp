@@ -0,0 +1,162 @@
+﻿
+#include "journal/player.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "glog/logging.h"
+
+namespace {
+
+// The number of calls to |operator new| while |counting_allocations| is set.
+// On Windows, the plugin DLL has its own |operator new|, so only the
+// allocations made by the player itself are counted.
+std::atomic<bool> counting_allocations = false;
+std::atomic<std::int64_t> number_of_allocations = 0;
+
+}  // namespace
+
+void* operator new(std::size_t const size) {
+  if (counting_allocations.load(std::memory_order_relaxed)) {
+    number_of_allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (void* const p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* const p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* const p, std::size_t) noexcept {
+  std::free(p);
+}
+
+namespace principia {
+namespace journal {
+
+// Each journal of this directory is replayed by a benchmark.  A journal may be
+// accompanied by a file with the additional extension ".slice", which contains
+// the indices of the first and last (excluded) methods to replay; the methods
+// before the first one are fast-forwarded, possibly from a snapshot, and are
+// not timed.  Use --benchmark_filter to select journals and
+// --benchmark_out=<file> --benchmark_out_format=json to export the results.
+std::filesystem::path const journals_directory =
+    SOLUTION_DIR / "journal" / "benchmark_journals";
+
+// The number of methods reported individually, by decreasing total duration.
+constexpr int reported_methods = 10;
+
+struct Slice {
+  int first = 0;
+  int last = std::numeric_limits<int>::max();
+};
+
+// The CPU time is that of the process, so the ratio of the CPU time to the
+// real time is the average number of busy threads during the replay.  The
+// counters give the number of methods replayed, the number of allocations, and
+// the time spent in the most expensive methods, per replay.
+void BM_ReplayJournal(benchmark::State& state,
+                      std::filesystem::path const& path,
+                      Slice const& slice) {
+  std::int64_t methods = 0;
+  std::int64_t allocations = 0;
+  std::map<std::string, std::chrono::nanoseconds> method_durations;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto player = std::make_unique<Player>(path);
+    CHECK(player->FastForwardTo(slice.first)) << path;
+    for (auto const& statistics : player->latencies().Get()) {
+      method_durations[statistics.method] -= statistics.total;
+    }
+    int index = slice.first;
+    std::int64_t const allocations_before = number_of_allocations;
+    counting_allocations = true;
+    state.ResumeTiming();
+
+    while (index < slice.last && player->Play(index)) {
+      ++index;
+    }
+
+    state.PauseTiming();
+    counting_allocations = false;
+    allocations += number_of_allocations - allocations_before;
+    methods += index - slice.first;
+    for (auto const& statistics : player->latencies().Get()) {
+      method_durations[statistics.method] += statistics.total;
+    }
+    player.reset();
+    state.ResumeTiming();
+  }
+
+  state.counters["methods"] =
+      benchmark::Counter(methods, benchmark::Counter::kAvgIterations);
+  state.counters["allocations"] =
+      benchmark::Counter(allocations, benchmark::Counter::kAvgIterations);
+
+  std::vector<std::pair<std::chrono::nanoseconds, std::string>> by_duration;
+  for (auto const& [method, duration] : method_durations) {
+    by_duration.emplace_back(duration, method);
+  }
+  std::sort(by_duration.rbegin(), by_duration.rend());
+  if (by_duration.size() > reported_methods) {
+    by_duration.resize(reported_methods);
+  }
+  for (auto const& [duration, method] : by_duration) {
+    state.counters[method + "[ms]"] = benchmark::Counter(
+        std::chrono::duration<double, std::milli>(duration).count(),
+        benchmark::Counter::kAvgIterations);
+  }
+}
+
+// Registers a |BM_ReplayJournal| for each journal of |journals_directory|.
+bool RegisterJournalBenchmarks() {
+  if (!std::filesystem::is_directory(journals_directory)) {
+    return false;
+  }
+  for (auto const& entry :
+       std::filesystem::directory_iterator(journals_directory)) {
+    std::filesystem::path const& path = entry.path();
+    if (!entry.is_regular_file() ||
+        path.extension() == ".index" ||
+        path.extension() == ".slice" ||
+        path.extension() == ".snapshot") {
+      continue;
+    }
+    Slice slice;
+    std::ifstream slice_stream(std::filesystem::path(path) += ".slice");
+    if (slice_stream.is_open()) {
+      CHECK(slice_stream >> slice.first >> slice.last) << path;
+      CHECK_LE(slice.first, slice.last) << path;
+    }
+    benchmark::RegisterBenchmark(
+        ("BM_ReplayJournal/" + path.filename().string()).c_str(),
+        &BM_ReplayJournal,
+        path,
+        slice)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime()
+        ->MeasureProcessCPUTime();
+  }
+  return true;
+}
+
+bool const journal_benchmarks_registered = RegisterJournalBenchmarks();
+
+}  // namespace journal
+}  // namespace principia
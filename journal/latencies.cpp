@@ -0,0 +1,208 @@
+﻿
+#include "journal/latencies.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+#include "glog/logging.h"
+
+namespace principia {
+namespace journal {
+namespace internal_latencies {
+
+namespace {
+
+std::atomic<std::int64_t> next_id = 0;
+
+}  // namespace
+
+void LatencyHistogram::Add(std::chrono::nanoseconds const latency) {
+  std::int64_t const nanoseconds = std::max<std::int64_t>(latency.count(), 0);
+  Increment(buckets_[Bucket(nanoseconds)], 1);
+  Increment(count_, 1);
+  Increment(total_, nanoseconds);
+  if (nanoseconds > max_.load(std::memory_order_relaxed)) {
+    max_.store(nanoseconds, std::memory_order_relaxed);
+  }
+}
+
+void LatencyHistogram::AddTo(LatencyHistogram& histogram) const {
+  for (int i = 0; i < number_of_buckets; ++i) {
+    Increment(histogram.buckets_[i], buckets_[i].load());
+  }
+  Increment(histogram.count_, count_.load());
+  Increment(histogram.total_, total_.load());
+  histogram.max_.store(std::max(histogram.max_.load(), max_.load()));
+}
+
+std::int64_t LatencyHistogram::count() const {
+  return count_.load();
+}
+
+std::chrono::nanoseconds LatencyHistogram::total() const {
+  return std::chrono::nanoseconds(total_.load());
+}
+
+std::chrono::nanoseconds LatencyHistogram::max() const {
+  return std::chrono::nanoseconds(max_.load());
+}
+
+std::chrono::nanoseconds LatencyHistogram::Quantile(double const q) const {
+  CHECK_LE(0, q);
+  CHECK_LE(q, 1);
+  // The rank of the requested duration, in [1, count].  Note that the buckets
+  // are read after |count_|, so they may have been incremented since.
+  std::int64_t const rank =
+      std::max<std::int64_t>(std::ceil(q * count_.load()), 1);
+  std::int64_t cumulative_count = 0;
+  for (int i = 0; i < number_of_buckets; ++i) {
+    cumulative_count += buckets_[i].load();
+    if (cumulative_count >= rank) {
+      return std::chrono::nanoseconds(LowerBound(i));
+    }
+  }
+  return std::chrono::nanoseconds(0);
+}
+
+int LatencyHistogram::Bucket(std::int64_t const nanoseconds) {
+  if (nanoseconds < sub_buckets) {
+    return nanoseconds;
+  }
+  // The durations in [2^e, 2^(e+1)[ are split in |sub_buckets| buckets.
+  int const e = std::bit_width(static_cast<std::uint64_t>(nanoseconds)) - 1;
+  int const shift = e - sub_bucket_bits;
+  return sub_buckets * (shift + 1) + (nanoseconds >> shift) - sub_buckets;
+}
+
+std::int64_t LatencyHistogram::LowerBound(int const bucket) {
+  if (bucket < sub_buckets) {
+    return bucket;
+  }
+  int const shift = bucket / sub_buckets - 1;
+  return static_cast<std::int64_t>(sub_buckets + bucket % sub_buckets)
+         << shift;
+}
+
+void LatencyHistogram::Increment(std::atomic<std::int64_t>& counter,
+                                 std::int64_t const increment) {
+  // There is a single writer, so no read-modify-write is needed.
+  counter.store(counter.load(std::memory_order_relaxed) + increment,
+                std::memory_order_relaxed);
+}
+
+Latencies::Latencies() : id_(next_id++) {}
+
+Latencies::~Latencies() {
+  absl::MutexLock l(&lock_);
+  for (auto const& histograms : thread_histograms_) {
+    for (auto const& histogram : *histograms) {
+      delete histogram.load();
+    }
+  }
+}
+
+int Latencies::Register(std::string const& method) {
+  absl::MutexLock l(&lock_);
+  CHECK_LT(methods_.size(), max_methods) << method;
+  methods_.push_back(method);
+  return methods_.size() - 1;
+}
+
+void Latencies::Record(int const method,
+                       std::chrono::nanoseconds const latency) {
+  std::atomic<LatencyHistogram*>& histogram = ThisThreadHistograms()[method];
+  if (histogram.load(std::memory_order_relaxed) == nullptr) {
+    histogram.store(new LatencyHistogram, std::memory_order_release);
+  }
+  histogram.load(std::memory_order_relaxed)->Add(latency);
+}
+
+std::vector<Latencies::Statistics> Latencies::Get() const {
+  absl::ReaderMutexLock l(&lock_);
+  std::vector<Statistics> result;
+  for (int i = 0; i < methods_.size(); ++i) {
+    LatencyHistogram method_histogram;
+    for (auto const& histograms : thread_histograms_) {
+      LatencyHistogram const* const histogram =
+          (*histograms)[i].load(std::memory_order_acquire);
+      if (histogram != nullptr) {
+        histogram->AddTo(method_histogram);
+      }
+    }
+    if (method_histogram.count() > 0) {
+      result.push_back({/*method=*/methods_[i],
+                        /*count=*/method_histogram.count(),
+                        /*total=*/method_histogram.total(),
+                        /*median=*/method_histogram.Quantile(0.5),
+                        /*p90=*/method_histogram.Quantile(0.9),
+                        /*p99=*/method_histogram.Quantile(0.99),
+                        /*p999=*/method_histogram.Quantile(0.999),
+                        /*max=*/method_histogram.max()});
+    }
+  }
+  std::sort(result.begin(),
+            result.end(),
+            [](Statistics const& left, Statistics const& right) {
+              return left.total > right.total;
+            });
+  return result;
+}
+
+void Latencies::Dump(std::filesystem::path const& path) const {
+  std::ofstream stream(path);
+  CHECK(!stream.fail()) << path;
+  auto const microseconds = [](std::chrono::nanoseconds const duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+  };
+  stream << "Durations in microseconds\n";
+  stream << std::left << std::setw(50) << "method" << std::right
+         << std::setw(12) << "count" << std::setw(14) << "total"
+         << std::setw(14) << "median" << std::setw(14) << "p90"
+         << std::setw(14) << "p99" << std::setw(14) << "p99.9"
+         << std::setw(14) << "max" << "\n";
+  stream << std::fixed << std::setprecision(1);
+  for (auto const& statistics : Get()) {
+    stream << std::left << std::setw(50) << statistics.method << std::right
+           << std::setw(12) << statistics.count
+           << std::setw(14) << microseconds(statistics.total)
+           << std::setw(14) << microseconds(statistics.median)
+           << std::setw(14) << microseconds(statistics.p90)
+           << std::setw(14) << microseconds(statistics.p99)
+           << std::setw(14) << microseconds(statistics.p999)
+           << std::setw(14) << microseconds(statistics.max) << "\n";
+  }
+  CHECK(!stream.fail()) << path;
+}
+
+Latencies& Latencies::Default() {
+  static Latencies* const latencies = new Latencies;
+  return *latencies;
+}
+
+Latencies::ThreadHistograms& Latencies::ThisThreadHistograms() {
+  // The histograms of this thread for each |Latencies| object that it used.
+  // The ids are never reused, so the entries of the destroyed objects are never
+  // looked up.  The last object used, almost always |Default()|, is cached.
+  thread_local std::map<std::int64_t, ThreadHistograms*> histograms_by_id;
+  thread_local std::int64_t cached_id = -1;
+  thread_local ThreadHistograms* cached_histograms = nullptr;
+  if (cached_id != id_) {
+    auto& histograms = histograms_by_id[id_];
+    if (histograms == nullptr) {
+      absl::MutexLock l(&lock_);
+      thread_histograms_.push_back(std::make_unique<ThreadHistograms>());
+      histograms = thread_histograms_.back().get();
+    }
+    cached_id = id_;
+    cached_histograms = histograms;
+  }
+  return *cached_histograms;
+}
+
+}  // namespace internal_latencies
+}  // namespace journal
+}  // namespace principia
@@ -0,0 +1,120 @@
+﻿
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "base/macros.hpp"
+
+namespace principia {
+namespace journal {
+namespace internal_latencies {
+
+// An histogram of durations with logarithmic buckets, each divided in
+// |sub_buckets| linear buckets, so that the relative error on the quantiles is
+// at most 1 / |sub_buckets|.  The histogram may be read by any thread while it
+// is being filled by a single thread.
+class LatencyHistogram {
+ public:
+  void Add(std::chrono::nanoseconds latency);
+
+  // Adds the contents of this histogram to |histogram|.
+  void AddTo(LatencyHistogram& histogram) const;
+
+  std::int64_t count() const;
+  std::chrono::nanoseconds total() const;
+  std::chrono::nanoseconds max() const;
+
+  // Returns a lower bound of the given quantile of the durations, with a
+  // relative error of at most 1 / |sub_buckets|.  |q| must be in [0, 1].
+  std::chrono::nanoseconds Quantile(double q) const;
+
+ private:
+  static constexpr int sub_bucket_bits = 3;
+  static constexpr int sub_buckets = 1 << sub_bucket_bits;
+  // Enough buckets for all the nonnegative durations in nanoseconds that fit in
+  // 63 bits.
+  static constexpr int number_of_buckets = sub_buckets * (64 - sub_bucket_bits);
+
+  static int Bucket(std::int64_t nanoseconds);
+  static std::int64_t LowerBound(int bucket);
+
+  // Called only by the thread that fills the histogram.
+  static void Increment(std::atomic<std::int64_t>& counter,
+                        std::int64_t increment);
+
+  std::array<std::atomic<std::int64_t>, number_of_buckets> buckets_{};
+  std::atomic<std::int64_t> count_ = 0;
+  std::atomic<std::int64_t> total_ = 0;
+  std::atomic<std::int64_t> max_ = 0;
+};
+
+// Collects the latencies of the interface methods.  The latencies are recorded
+// in histograms specific to each thread and to each method, so that recording
+// them doesn't take a lock.  This class is thread-safe.
+class Latencies {
+ public:
+  struct Statistics {
+    std::string method;
+    std::int64_t count;
+    std::chrono::nanoseconds total;
+    std::chrono::nanoseconds median;
+    std::chrono::nanoseconds p90;
+    std::chrono::nanoseconds p99;
+    std::chrono::nanoseconds p999;
+    std::chrono::nanoseconds max;
+  };
+
+  Latencies();
+  ~Latencies();
+
+  // Returns the index to pass to |Record| for the method with the given name.
+  int Register(std::string const& method) EXCLUDES(lock_);
+
+  void Record(int method, std::chrono::nanoseconds latency) EXCLUDES(lock_);
+
+  // Returns the statistics of the methods that were called, by decreasing
+  // total duration.
+  std::vector<Statistics> Get() const EXCLUDES(lock_);
+
+  // Writes the statistics to the file at |path|, as a table.
+  void Dump(std::filesystem::path const& path) const EXCLUDES(lock_);
+
+  // The latencies of the interface methods.  Never destroyed.
+  static Latencies& Default();
+
+ private:
+  static constexpr int max_methods = 1024;
+
+  // The histograms of a thread, allocated when a method is first called on
+  // that thread.
+  using ThreadHistograms =
+      std::array<std::atomic<LatencyHistogram*>, max_methods>;
+
+  ThreadHistograms& ThisThreadHistograms() EXCLUDES(lock_);
+
+  // Identifies this object in the cache of |ThisThreadHistograms|.
+  std::int64_t const id_;
+
+  mutable absl::Mutex lock_;
+  std::vector<std::string> methods_ GUARDED_BY(lock_);
+  // The histograms of threads that have exited are kept, so that their
+  // latencies are still reported.
+  std::vector<std::unique_ptr<ThreadHistograms>> thread_histograms_
+      GUARDED_BY(lock_);
+};
+
+}  // namespace internal_latencies
+
+using internal_latencies::Latencies;
+using internal_latencies::LatencyHistogram;
+
+}  // namespace journal
+}  // namespace principia
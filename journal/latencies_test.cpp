@@ -0,0 +1,109 @@
+﻿
+#include "journal/latencies.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace principia {
+namespace journal {
+namespace internal_latencies {
+
+using ::testing::AllOf;
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Field;
+using ::testing::Ge;
+using ::testing::HasSubstr;
+using ::testing::Le;
+using namespace std::chrono_literals;
+
+TEST(LatencyHistogramTest, SmallDurations) {
+  LatencyHistogram histogram;
+  for (int i = 0; i < 8; ++i) {
+    histogram.Add(std::chrono::nanoseconds(i));
+  }
+  EXPECT_THAT(histogram.count(), Eq(8));
+  EXPECT_THAT(histogram.total(), Eq(28ns));
+  EXPECT_THAT(histogram.max(), Eq(7ns));
+  EXPECT_THAT(histogram.Quantile(0), Eq(0ns));
+  EXPECT_THAT(histogram.Quantile(0.5), Eq(3ns));
+  EXPECT_THAT(histogram.Quantile(1), Eq(7ns));
+}
+
+TEST(LatencyHistogramTest, Quantiles) {
+  LatencyHistogram histogram;
+  for (int i = 1; i <= 1000; ++i) {
+    histogram.Add(i * 1us);
+  }
+  EXPECT_THAT(histogram.count(), Eq(1000));
+  EXPECT_THAT(histogram.total(), Eq(500'500us));
+  EXPECT_THAT(histogram.max(), Eq(1000us));
+  // The quantiles are lower bounds, with a relative error of at most 1/8.
+  EXPECT_THAT(histogram.Quantile(0.5), AllOf(Ge(500us * 7 / 8), Le(500us)));
+  EXPECT_THAT(histogram.Quantile(0.99), AllOf(Ge(990us * 7 / 8), Le(990us)));
+  EXPECT_THAT(histogram.Quantile(1), AllOf(Ge(1000us * 7 / 8), Le(1000us)));
+
+  LatencyHistogram sum;
+  histogram.AddTo(sum);
+  histogram.AddTo(sum);
+  EXPECT_THAT(sum.count(), Eq(2000));
+  EXPECT_THAT(sum.max(), Eq(1000us));
+  EXPECT_THAT(sum.Quantile(0.5), Eq(histogram.Quantile(0.5)));
+}
+
+TEST(LatenciesTest, Threads) {
+  Latencies latencies;
+  int const advance_time = latencies.Register("AdvanceTime");
+  int const get_version = latencies.Register("GetVersion");
+  latencies.Record(get_version, 1us);
+  std::thread thread([&latencies, advance_time, get_version]() {
+    latencies.Record(advance_time, 10ms);
+    latencies.Record(get_version, 3us);
+  });
+  thread.join();
+  latencies.Record(advance_time, 20ms);
+
+  EXPECT_THAT(
+      latencies.Get(),
+      ElementsAre(AllOf(Field(&Latencies::Statistics::method, "AdvanceTime"),
+                        Field(&Latencies::Statistics::count, 2),
+                        Field(&Latencies::Statistics::total, 30ms)),
+                  AllOf(Field(&Latencies::Statistics::method, "GetVersion"),
+                        Field(&Latencies::Statistics::count, 2),
+                        Field(&Latencies::Statistics::total, 4us))));
+
+  std::filesystem::path const path = "latencies_test.txt";
+  latencies.Dump(path);
+  std::ifstream stream(path);
+  std::stringstream contents;
+  contents << stream.rdbuf();
+  EXPECT_THAT(contents.str(), HasSubstr("AdvanceTime"));
+  EXPECT_THAT(contents.str(), HasSubstr("GetVersion"));
+}
+
+TEST(LatenciesTest, SeveralObjects) {
+  Latencies latencies1;
+  Latencies latencies2;
+  int const method1 = latencies1.Register("AdvanceTime");
+  int const method2 = latencies2.Register("AdvanceTime");
+  for (int i = 0; i < 3; ++i) {
+    latencies1.Record(method1, 1us);
+    latencies2.Record(method2, 2us);
+  }
+  EXPECT_THAT(latencies1.Get(),
+              ElementsAre(AllOf(Field(&Latencies::Statistics::count, 3),
+                                Field(&Latencies::Statistics::total, 3us))));
+  EXPECT_THAT(latencies2.Get(),
+              ElementsAre(AllOf(Field(&Latencies::Statistics::count, 3),
+                                Field(&Latencies::Statistics::total, 6us))));
+}
+
+}  // namespace internal_latencies
+}  // namespace journal
+}  // namespace principia
@@ -1,6 +1,7 @@
 ﻿
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <type_traits>
@@ -95,6 +96,9 @@ class Method final {
   std::function<void(not_null<typename Profile::Message*> message)>
       return_filler_;
   bool returned_ = false;
+  // For measuring the latency of the method.
+  std::chrono::steady_clock::time_point const start_ =
+      std::chrono::steady_clock::now();
 };
 
 }  // namespace internal_method
@@ -5,6 +5,7 @@
 
 #include <list>
 
+#include "journal/latencies.hpp"
 #include "journal/recorder.hpp"
 
 namespace principia {
@@ -79,6 +80,11 @@ Method<Profile>::~Method() {
     }
     Recorder::active_recorder_->WriteAtDestruction(method);
   }
+
+  static int const latencies_index = Latencies::Default().Register(
+      Profile::Message::descriptor()->name());
+  Latencies::Default().Record(latencies_index,
+                              std::chrono::steady_clock::now() - start_);
 }
 
 template<typename Profile>
@@ -3,12 +3,20 @@
 
 #include <chrono>
 #include <filesystem>
+#include <memory>
+#include <optional>
+#include <sstream>
 #include <string>
 
 #include "base/array.hpp"
 #include "base/get_line.hpp"
 #include "base/hexadecimal.hpp"
+#include "gipfeli/gipfeli.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/util/delimited_message_util.h"
 #include "journal/profiles.hpp"
+#include "journal/recorder.hpp"
+#include "ksp_plugin/plugin.hpp"
 #include "glog/logging.h"
 
 namespace principia {
@@ -16,14 +24,48 @@ namespace principia {
 using base::GetLine;
 using base::HexadecimalEncoder;
 using base::UniqueArray;
+using google::protobuf::io::ArrayInputStream;
+using google::protobuf::io::CodedInputStream;
+using google::protobuf::io::IstreamInputStream;
+using google::protobuf::io::ZeroCopyInputStream;
+using google::protobuf::util::ParseDelimitedFromZeroCopyStream;
 using interface::principia__ActivatePlayer;
 
 namespace journal {
 
+// The number of messages decoded ahead of their execution.
+constexpr std::size_t max_decoded_methods = 1000;
+
 Player::Player(std::filesystem::path const& path)
-    : stream_(path, std::ios::in) {
+    : path_(path),
+      stream_(path, std::ios::in | std::ios::binary) {
   principia__ActivatePlayer();
   CHECK(!stream_.fail());
+
+  std::string signature(Recorder::signature.size(), '\0');
+  stream_.read(signature.data(), signature.size());
+  if (stream_.good() && signature == Recorder::signature) {
+    if (stream_.get() != 0) {
+      decompressor_ = google::compression::NewGipfeliCompressor();
+    }
+    binary_stream_ = std::make_unique<IstreamInputStream>(&stream_);
+  } else {
+    // A hexadecimal journal, which must be read in text mode.
+    stream_.close();
+    stream_.open(path, std::ios::in);
+    CHECK(!stream_.fail());
+  }
+  StartDecoding();
+}
+
+Player::~Player() {
+  StopDecoding();
+  for (std::uint64_t const plugin : plugins_) {
+    auto const it = pointer_map_.find(plugin);
+    if (it != pointer_map_.end()) {
+      delete static_cast<ksp_plugin::Plugin*>(it->second);
+    }
+  }
 }
 
 bool Player::Play(int const index) {
@@ -52,6 +94,12 @@ bool Player::Play(int const index) {
   if (after - before > std::chrono::milliseconds(100)) {
     LOG(ERROR) << "Long method:\n" << method_in->DebugString();
   }
+  if (method_out_return->HasExtension(serialization::NewPlugin::extension)) {
+    plugins_.insert(
+        method_out_return->GetExtension(serialization::NewPlugin::extension)
+            .return_()
+            .result());
+  }
 
   last_method_in_.swap(method_in);
   last_method_out_return_.swap(method_out_return);
@@ -59,6 +107,35 @@ bool Player::Play(int const index) {
   return true;
 }
 
+bool Player::FastForwardTo(int const index) {
+  std::int64_t const method_index = 2 * static_cast<std::int64_t>(index);
+
+  // Look for the last snapshot before |method_index| that was not deleted.
+  // There is no index for the hexadecimal journals.
+  std::optional<Recorder::IndexEntry> snapshot;
+  std::ifstream index_stream(Recorder::IndexPath(path_),
+                             std::ios::in | std::ios::binary);
+  Recorder::IndexEntry entry;
+  while (index_stream.read(reinterpret_cast<char*>(&entry), sizeof(entry)) &&
+         entry.method_index <= method_index) {
+    if (entry.plugin != 0 && entry.method_index > method_index_ &&
+        std::filesystem::exists(
+            Recorder::SnapshotPath(path_, entry.method_index))) {
+      snapshot = entry;
+    }
+  }
+  if (snapshot.has_value()) {
+    RestoreSnapshot(*snapshot);
+  }
+
+  while (method_index_ < method_index) {
+    if (!Play(static_cast<int>(method_index_ / 2))) {
+      return false;
+    }
+  }
+  return true;
+}
+
 serialization::Method const& Player::last_method_in() const {
   return *last_method_in_;
 }
@@ -67,7 +144,55 @@ serialization::Method const& Player::last_method_out_return() const {
   return *last_method_out_return_;
 }
 
+Latencies const& Player::latencies() const {
+  return latencies_;
+}
+
 std::unique_ptr<serialization::Method> Player::Read() {
+  absl::MutexLock l(&lock_);
+  auto const has_decoded_method = [this]() {
+    lock_.AssertHeld();
+    return !decoded_methods_.empty();
+  };
+  lock_.Await(absl::Condition(&has_decoded_method));
+  // The end of stream marker is left in the queue, so that the subsequent
+  // calls also return a |nullptr|.
+  if (decoded_methods_.front() == nullptr) {
+    return nullptr;
+  }
+  auto method = std::move(decoded_methods_.front());
+  decoded_methods_.pop_front();
+  ++method_index_;
+  return method;
+}
+
+std::unique_ptr<serialization::Method> Player::Decode() {
+  if (binary_stream_ != nullptr) {
+    for (;;) {
+      ZeroCopyInputStream* const records =
+          decompressor_ == nullptr
+              ? static_cast<ZeroCopyInputStream*>(binary_stream_.get())
+              : frame_stream_.get();
+      if (records != nullptr) {
+        auto method = std::make_unique<serialization::Method>();
+        bool clean_eof;
+        if (ParseDelimitedFromZeroCopyStream(
+                method.get(), records, &clean_eof)) {
+          return method;
+        }
+        // A truncated method is expected if the game crashed while writing
+        // the journal.
+        LOG_IF(ERROR, !clean_eof) << "Truncated method at end of journal";
+        if (decompressor_ == nullptr || !clean_eof) {
+          return nullptr;
+        }
+      }
+      if (!ReadFrame()) {
+        return nullptr;
+      }
+    }
+  }
+
   std::string const line = GetLine(stream_);
   if (line.empty()) {
     return nullptr;
@@ -81,5 +206,90 @@ std::unique_ptr<serialization::Method> Player::Read() {
   return method;
 }
 
+bool Player::ReadFrame() {
+  CodedInputStream coded_stream(binary_stream_.get());
+  std::uint32_t size;
+  if (!coded_stream.ReadVarint32(&size)) {
+    return false;
+  }
+  std::string compressed_frame;
+  if (!coded_stream.ReadString(&compressed_frame, size)) {
+    LOG(ERROR) << "Truncated frame at end of journal";
+    return false;
+  }
+  CHECK(decompressor_->Uncompress(compressed_frame, &frame_));
+  frame_stream_ =
+      std::make_unique<ArrayInputStream>(frame_.data(), frame_.size());
+  return true;
+}
+
+void Player::DecodeMethods() {
+  for (;;) {
+    auto method = Decode();
+    bool const end_of_stream = method == nullptr;
+
+    absl::MutexLock l(&lock_);
+    auto const has_room_or_stop = [this]() {
+      lock_.AssertHeld();
+      return stop_decoding_ || decoded_methods_.size() < max_decoded_methods;
+    };
+    lock_.Await(absl::Condition(&has_room_or_stop));
+    if (stop_decoding_) {
+      return;
+    }
+    decoded_methods_.push_back(std::move(method));
+    if (end_of_stream) {
+      return;
+    }
+  }
+}
+
+void Player::StartDecoding() {
+  decoder_ = std::thread([this]() { DecodeMethods(); });
+}
+
+void Player::StopDecoding() {
+  {
+    absl::MutexLock l(&lock_);
+    stop_decoding_ = true;
+  }
+  decoder_.join();
+  absl::MutexLock l(&lock_);
+  stop_decoding_ = false;
+  decoded_methods_.clear();
+}
+
+void Player::RestoreSnapshot(Recorder::IndexEntry const& entry) {
+  principia::serialization::Plugin message;
+  {
+    std::filesystem::path const path =
+        Recorder::SnapshotPath(path_, entry.method_index);
+    std::ifstream snapshot(path, std::ios::in | std::ios::binary);
+    CHECK(!snapshot.fail()) << path;
+    std::stringstream compressed_bytes;
+    compressed_bytes << snapshot.rdbuf();
+    std::string bytes;
+    std::unique_ptr<google::compression::Compressor> const decompressor(
+        google::compression::NewGipfeliCompressor());
+    CHECK(decompressor->Uncompress(compressed_bytes.str(), &bytes)) << path;
+    CHECK(message.ParseFromString(bytes)) << path;
+  }
+  auto const it = pointer_map_.find(entry.plugin);
+  if (it != pointer_map_.end()) {
+    delete static_cast<ksp_plugin::Plugin*>(it->second);
+  }
+  pointer_map_[entry.plugin] =
+      ksp_plugin::Plugin::ReadFromMessage(message).ValueOrDie().release();
+  plugins_.insert(entry.plugin);
+
+  StopDecoding();
+  stream_.clear();
+  stream_.seekg(entry.offset);
+  binary_stream_ = std::make_unique<IstreamInputStream>(&stream_);
+  frame_stream_.reset();
+  method_index_ = entry.method_index;
+  StartDecoding();
+}
+
 }  // namespace journal
 }  // namespace principia
@@ -1,11 +1,22 @@
 ﻿
 #pragma once
 
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <thread>
 
+#include "absl/synchronization/mutex.h"
+#include "gipfeli/compression.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/io/zero_copy_stream_impl.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "journal/latencies.hpp"
+#include "journal/recorder.hpp"
 #include "serialization/journal.pb.h"
 
 namespace principia {
@@ -17,28 +28,89 @@ class Player final {
 
   explicit Player(std::filesystem::path const& path);
 
+  // Deletes the plugins created by the replay that are still alive.
+  ~Player();
+
   // Replays the next message in the journal.  Returns false at end of journal.
   // |index| is the 0-based index of the message in the journal.
   bool Play(int index);
 
+  // Replays the journal up to the message at |index| excluded, so that the
+  // next call to |Play| replays that message.  If the journal has an index,
+  // restores the last snapshot of the plugin before that message and starts
+  // replaying from there.  Note that the objects other than the plugin that
+  // were live at the time of the snapshot are not restored.  Returns false if
+  // the end of the journal is reached first.
+  bool FastForwardTo(int index);
+
   // Return the last replayed messages.
   serialization::Method const& last_method_in() const;
   serialization::Method const& last_method_out_return() const;
 
+  // The durations of the methods replayed by this player, excluding the
+  // decoding of the journal.
+  Latencies const& latencies() const;
+
  private:
+  // Returns the next message decoded by |decoder_|.  Returns a |nullptr| at
+  // end of stream.
+  std::unique_ptr<serialization::Method> Read() EXCLUDES(lock_);
+
   // Reads one message from the stream.  Returns a |nullptr| at end of stream.
-  std::unique_ptr<serialization::Method> Read();
+  std::unique_ptr<serialization::Method> Decode();
+
+  // Reads and uncompresses the next frame of a compressed journal into
+  // |frame_|.  Returns false at end of stream.
+  bool ReadFrame();
+
+  // The loop executed by |decoder_| to decode the messages ahead of their
+  // execution.
+  void DecodeMethods() EXCLUDES(lock_);
+
+  void StartDecoding();
+  void StopDecoding() EXCLUDES(lock_);
+
+  // Restores the snapshot of the plugin referenced by |entry| and positions
+  // the stream on the following message.
+  void RestoreSnapshot(Recorder::IndexEntry const& entry);
 
   template<typename Profile>
   bool RunIfAppropriate(serialization::Method const& method_in,
                         serialization::Method const& method_out_return);
 
   PointerMap pointer_map_;
+  // The recorded addresses of the plugins created by |NewPlugin| or restored
+  // from a snapshot.  They are deleted with the player unless the replay
+  // deleted them.
+  std::set<std::uint64_t> plugins_;
+  std::filesystem::path const path_;
   std::ifstream stream_;
 
+  // Null for the hexadecimal journals written by earlier versions.
+  std::unique_ptr<google::protobuf::io::IstreamInputStream> binary_stream_;
+  // Null if the journal is not compressed.
+  std::unique_ptr<google::compression::Compressor> decompressor_;
+  std::string frame_;
+  std::unique_ptr<google::protobuf::io::ArrayInputStream> frame_stream_;
+
+  // The index of the next message returned by |Read|, counting separately the
+  // messages written at construction and at destruction.
+  std::int64_t method_index_ = 0;
+
+  absl::Mutex lock_;
+  // A |nullptr| marks the end of the stream.
+  std::deque<std::unique_ptr<serialization::Method>> decoded_methods_
+      GUARDED_BY(lock_);
+  bool stop_decoding_ GUARDED_BY(lock_) = false;
+  std::thread decoder_;
+
   std::unique_ptr<serialization::Method> last_method_in_;
   std::unique_ptr<serialization::Method> last_method_out_return_;
 
+  Latencies latencies_;
+  // The indices of the methods in |latencies_|.
+  std::map<google::protobuf::Descriptor const*, int> latencies_indices_;
+
   friend class PlayerTest;
   friend class RecorderTest;
 };
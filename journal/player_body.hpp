@@ -3,6 +3,7 @@
 
 #include "journal/player.hpp"
 
+#include <chrono>
 #include <list>
 
 #include "glog/logging.h"
@@ -20,8 +21,17 @@ bool Player::RunIfAppropriate(serialization::Method const& method_in,
         << method_out_return.DebugString();
     serialization::Method merged_method = method_in;
     merged_method.MergeFrom(method_out_return);
+    auto const before = std::chrono::steady_clock::now();
     Profile::Run(merged_method.GetExtension(Profile::Message::extension),
                  pointer_map_);
+    auto const after = std::chrono::steady_clock::now();
+
+    auto const descriptor = Profile::Message::descriptor();
+    auto [it, inserted] = latencies_indices_.emplace(descriptor, 0);
+    if (inserted) {
+      it->second = latencies_.Register(descriptor->name());
+    }
+    latencies_.Record(it->second, after - before);
     return true;
   }
   return false;
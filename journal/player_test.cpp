@@ -1,10 +1,15 @@
 ﻿
 #include "journal/player.hpp"
 
+#include <cstdint>
+#include <filesystem>
 #include <list>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "base/not_null.hpp"
+#include "base/serialization.hpp"
 #include "benchmark/benchmark.h"
 #include "glog/logging.h"
 #include "gtest/gtest.h"
@@ -12,11 +17,20 @@
 #include "journal/profiles.hpp"
 #include "journal/recorder.hpp"
 #include "ksp_plugin/interface.hpp"
+#include "ksp_plugin/plugin.hpp"
+#include "quantities/si.hpp"
 #include "serialization/journal.pb.h"
+#include "serialization/ksp_plugin.pb.h"
+#include "testing_utilities/serialization.hpp"
 
 namespace principia {
 namespace journal {
 
+using base::not_null;
+using base::ParseFromBytes;
+using quantities::si::Second;
+using testing_utilities::ReadFromBinaryFile;
+
 void BM_PlayForReal(benchmark::State& state) {
   while (state.KeepRunning()) {
     Player player(
@@ -47,6 +61,10 @@ class PlayerTest : public ::testing::Test {
     return player.RunIfAppropriate<Profile>(method_in, method_out_return);
   }
 
+  static Player::PointerMap const& pointer_map(Player const& player) {
+    return player.pointer_map_;
+  }
+
   ::testing::TestInfo const* const test_info_;
   std::string const test_case_name_;
   std::string const test_name_;
@@ -80,6 +98,77 @@ TEST_F(PlayerTest, PlayTiny) {
   EXPECT_EQ(3, count);
 }
 
+TEST_F(PlayerTest, FastForward) {
+  {
+    Recorder* const r(new Recorder(test_name_ + ".journal.hex"));
+    Recorder::Activate(r);
+
+    {
+      Method<NewPlugin> m({"MJD1", "MJD2", 3});
+      m.Return(plugin_.get());
+    }
+    {
+      const ksp_plugin::Plugin* plugin = plugin_.get();
+      Method<DeletePlugin> m({&plugin}, {&plugin});
+      m.Return();
+    }
+    Recorder::Deactivate();
+  }
+
+  Player player(test_name_ + ".journal.hex");
+  EXPECT_TRUE(player.FastForwardTo(2));
+  EXPECT_TRUE(player.last_method_in().HasExtension(
+      serialization::NewPlugin::extension));
+  EXPECT_TRUE(player.Play(2));
+  EXPECT_TRUE(player.last_method_in().HasExtension(
+      serialization::DeletePlugin::extension));
+  EXPECT_FALSE(player.Play(3));
+  EXPECT_FALSE(player.FastForwardTo(5));
+}
+
+TEST_F(PlayerTest, FastForwardFromSnapshot) {
+  // The creation of this plugin is not journaled, so the calls that use it
+  // can only be replayed from a snapshot.
+  not_null<std::unique_ptr<ksp_plugin::Plugin>> const plugin =
+      ksp_plugin::Plugin::ReadFromMessage(
+          ParseFromBytes<principia::serialization::Plugin>(ReadFromBinaryFile(
+              SOLUTION_DIR / "ksp_plugin_test" / "simple_plugin.proto.bin")))
+      .ValueOrDie();
+  double const game_time =
+      (plugin->CurrentTime() - plugin->GameEpoch()) / Second;
+  {
+    Recorder* const r(new Recorder(test_name_ + ".journal",
+                                   /*compressed=*/true));
+    Recorder::Activate(r);
+    // The first call takes a snapshot before being journaled, the second one
+    // comes too soon after it.
+    interface::principia__AdvanceTime(plugin.get(),
+                                      game_time + 10,
+                                      /*planetarium_rotation=*/45);
+    interface::principia__AdvanceTime(plugin.get(),
+                                      game_time + 20,
+                                      /*planetarium_rotation=*/45);
+    Recorder::Deactivate();
+  }
+  // The snapshot precedes the third method, after |GetVersion|.
+  EXPECT_TRUE(std::filesystem::exists(
+      Recorder::SnapshotPath(test_name_ + ".journal", /*method_index=*/2)));
+
+  Player player(test_name_ + ".journal");
+  EXPECT_TRUE(player.FastForwardTo(2));
+  EXPECT_TRUE(player.last_method_in().HasExtension(
+      serialization::AdvanceTime::extension));
+  EXPECT_TRUE(player.Play(2));
+  EXPECT_TRUE(player.last_method_in().HasExtension(
+      serialization::AdvanceTime::extension));
+  EXPECT_FALSE(player.Play(3));
+
+  // The restored plugin replaced the recorded one and was advanced like it.
+  auto const* const replayed_plugin = static_cast<ksp_plugin::Plugin const*>(
+      pointer_map(player).at(reinterpret_cast<std::uint64_t>(&*plugin)));
+  EXPECT_EQ(plugin->CurrentTime(), replayed_plugin->CurrentTime());
+}
+
 TEST_F(PlayerTest, DISABLED_SECULAR_Benchmarks) {
   benchmark::RunSpecifiedBenchmarks();
 }
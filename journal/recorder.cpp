@@ -1,26 +1,92 @@
 ﻿
 #include "journal/recorder.hpp"
 
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
 
-#include "base/array.hpp"
-#include "base/hexadecimal.hpp"
-#include "base/serialization.hpp"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "base/version.hpp"
+#include "gipfeli/gipfeli.h"
 #include "glog/logging.h"
+#include "google/protobuf/io/coded_stream.h"
 #include "journal/profiles.hpp"
+#include "ksp_plugin/plugin.hpp"
 
 namespace principia {
 
-using base::HexadecimalEncoder;
-using base::SerializeAsBytes;
-using base::UniqueArray;
+using google::protobuf::Arena;
+using google::protobuf::io::CodedOutputStream;
 
 namespace journal {
 
-Recorder::Recorder(std::filesystem::path const& path)
-    : stream_(path, std::ios::out) {
+// The buffered methods are written when their size exceeds |frame_size|, and
+// at least every |flush_period|.  Thus, if the game crashes, at most the calls
+// of the last |flush_period| are missing from the journal.
+constexpr std::size_t frame_size = 1 << 16;
+constexpr absl::Duration flush_period = absl::Milliseconds(100);
+// The interface calls wait if the disk cannot keep up and the buffer reaches
+// this size.
+constexpr std::int64_t max_buffer_size = 1 << 26;
+// When the process dies, the buffered methods are not written if the locks
+// cannot be acquired within that delay.
+constexpr absl::Duration failure_flush_timeout = absl::Seconds(1);
+// Replaying a journal from a snapshot takes at most about that long.
+constexpr std::chrono::steady_clock::duration snapshot_period =
+    std::chrono::minutes(2);
+// The number of snapshots kept on disk, so that a long game does not fill it.
+constexpr std::size_t max_snapshots = 5;
+
+namespace {
+
+// Returns the number of bytes written.
+std::int64_t WriteVarint32(std::uint32_t const value, std::ofstream& stream) {
+  // A varint32 takes at most 5 bytes.
+  std::uint8_t bytes[5];
+  auto const end = CodedOutputStream::WriteVarint32ToArray(value, bytes);
+  stream.write(reinterpret_cast<char const*>(bytes), end - bytes);
+  return end - bytes;
+}
+
+// Returns true if |mutex| was acquired before |deadline|.  Doesn't block if
+// the current thread already holds |mutex|.
+bool TryLockUntil(absl::Mutex& mutex, absl::Time const deadline) {
+  while (!mutex.TryLock()) {
+    if (absl::Now() > deadline) {
+      return false;
+    }
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  return true;
+}
+
+}  // namespace
+
+Recorder::Recorder(std::filesystem::path const& path, bool const compressed)
+    : path_(path),
+      stream_(path, std::ios::out | std::ios::binary),
+      index_stream_(IndexPath(path), std::ios::out | std::ios::binary),
+      compressor_(compressed ? google::compression::NewGipfeliCompressor()
+                             : nullptr),
+      offset_(signature.size() + 1) {
   CHECK(!stream_.fail()) << path;
+  CHECK(!index_stream_.fail()) << IndexPath(path);
+  stream_.write(signature.data(), signature.size());
+  stream_.put(compressed ? 1 : 0);
+  stream_.flush();
+  writer_ = std::thread([this]() { WriteFrames(); });
+}
+
+Recorder::~Recorder() {
+  {
+    absl::MutexLock l(&buffer_lock_);
+    shutdown_ = true;
+  }
+  writer_.join();
 }
 
 void Recorder::WriteAtConstruction(serialization::Method const& method) {
@@ -36,6 +102,7 @@ void Recorder::WriteAtDestruction(serialization::Method const& method) {
 void Recorder::Activate(base::not_null<Recorder*> const recorder) {
   CHECK(active_recorder_ == nullptr);
   active_recorder_ = recorder;
+  google::AddLogSink(&failure_sink_);
 
   // When the recorder gets activated, pretend that we got a GetVersion call.
   // This will record the version at the beginning of the journal, which is
@@ -53,6 +120,7 @@ void Recorder::Activate(base::not_null<Recorder*> const recorder) {
 
 void Recorder::Deactivate() {
   CHECK(active_recorder_ != nullptr);
+  google::RemoveLogSink(&failure_sink_);
   delete active_recorder_;
   active_recorder_ = nullptr;
 }
@@ -61,15 +129,227 @@ bool Recorder::IsActivated() {
   return active_recorder_ != nullptr;
 }
 
+void Recorder::WriteSnapshotIfNeeded(
+    base::not_null<ksp_plugin::Plugin const*> const plugin) {
+  if (active_recorder_ != nullptr) {
+    active_recorder_->WriteSnapshot(plugin);
+  }
+}
+
+std::filesystem::path Recorder::IndexPath(std::filesystem::path const& path) {
+  return std::filesystem::path(path) += ".index";
+}
+
+std::filesystem::path Recorder::SnapshotPath(
+    std::filesystem::path const& path,
+    std::int64_t const method_index) {
+  return std::filesystem::path(path) +=
+         "." + std::to_string(method_index) + ".snapshot";
+}
+
 void Recorder::WriteLocked(serialization::Method const& method) {
-  static auto* const encoder = new HexadecimalEncoder</*null_terminated=*/true>;
-  CHECK_LT(0, method.ByteSize()) << method.DebugString();
-  auto const hexadecimal = encoder->Encode(SerializeAsBytes(method).get());
-  stream_ << hexadecimal.data.get() << "\n";
+  std::size_t const size = method.ByteSizeLong();
+  CHECK_LT(0, size) << method.DebugString();
+
+  absl::MutexLock l(&buffer_lock_);
+  auto const buffer_has_room = [this]() {
+    buffer_lock_.AssertHeld();
+    return buffered_size_ < max_buffer_size;
+  };
+  buffer_lock_.Await(absl::Condition(&buffer_has_room));
+
+  if (frames_.empty() || frames_.back().bytes.size() >= frame_size) {
+    frames_.push_back({/*bytes=*/{},
+                       /*first_method_index=*/number_of_methods_,
+                       /*plugin=*/0});
+  }
+  std::string& bytes = frames_.back().bytes;
+  std::size_t const start = bytes.size();
+  std::size_t const record_size = CodedOutputStream::VarintSize32(size) + size;
+  bytes.resize(start + record_size);
+  auto* const record = reinterpret_cast<std::uint8_t*>(&bytes[start]);
+  method.SerializeWithCachedSizesToArray(
+      CodedOutputStream::WriteVarint32ToArray(size, record));
+  buffered_size_ += record_size;
+  ++number_of_methods_;
+}
+
+void Recorder::WriteSnapshot(
+    base::not_null<ksp_plugin::Plugin const*> const plugin) {
+  // Holding |lock_| ensures that no method is journaled while the plugin is
+  // copied.  As when saving, the copy is allocated on an arena, which makes it
+  // cheaper to build.  It is serialized, compressed and written by |writer_|.
+  absl::MutexLock l(&lock_);
+  auto const now = std::chrono::steady_clock::now();
+  if (last_snapshot_time_.has_value() &&
+      now - *last_snapshot_time_ < snapshot_period) {
+    return;
+  }
+  last_snapshot_time_ = now;
+
+  auto snapshot_arena = std::make_unique<Arena>();
+  not_null<principia::serialization::Plugin*> const snapshot =
+      Arena::CreateMessage<principia::serialization::Plugin>(
+          snapshot_arena.get());
+  plugin->WriteToMessage(snapshot);
+  // The snapshot counts towards the buffer like the methods, by its serialized
+  // size.  The sizes are cached for the serialization by |writer_|.
+  std::int64_t const snapshot_size = snapshot->ByteSizeLong();
+  LOG(INFO) << "Snapshot of the plugin took "
+            << std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - now).count()
+            << " ms for " << snapshot_size << " bytes";
+
+  // The methods that follow the snapshot start a new frame, so that they can
+  // be replayed from it.
+  absl::MutexLock l2(&buffer_lock_);
+  auto const buffer_has_room = [this]() {
+    buffer_lock_.AssertHeld();
+    return buffered_size_ < max_buffer_size;
+  };
+  buffer_lock_.Await(absl::Condition(&buffer_has_room));
+  frames_.push_back(
+      {/*bytes=*/{},
+       /*first_method_index=*/number_of_methods_,
+       /*plugin=*/reinterpret_cast<std::uint64_t>(
+           static_cast<ksp_plugin::Plugin const*>(plugin)),
+       /*snapshot=*/snapshot,
+       /*snapshot_arena=*/std::move(snapshot_arena)});
+  buffered_size_ += snapshot_size;
+}
+
+void Recorder::WriteFrames() {
+  std::deque<Frame> frames;
+  for (;;) {
+    {
+      absl::MutexLock l(&buffer_lock_);
+      auto const frame_full_or_shutdown = [this]() {
+        buffer_lock_.AssertHeld();
+        return shutdown_ || frames_.size() > 1 ||
+               (!frames_.empty() && frames_.back().bytes.size() >= frame_size);
+      };
+      buffer_lock_.AwaitWithTimeout(absl::Condition(&frame_full_or_shutdown),
+                                    flush_period);
+    }
+
+    // The frames are taken from the buffer under |stream_lock_| so that a
+    // concurrent |Flush| cannot write later frames before them.
+    absl::MutexLock l(&stream_lock_);
+    bool shutdown;
+    {
+      absl::MutexLock l2(&buffer_lock_);
+      frames.swap(frames_);
+      buffered_size_ = 0;
+      shutdown = shutdown_;
+    }
+    WriteFramesLocked(frames);
+    if (shutdown) {
+      return;
+    }
+  }
+}
+
+void Recorder::WriteFramesLocked(std::deque<Frame>& frames) {
+  if (frames.empty()) {
+    return;
+  }
+  std::string compressed_bytes;
+  std::string index_entries;
+  for (Frame const& frame : frames) {
+    // The snapshot is only referenced by the index once it is complete.
+    if (frame.snapshot != nullptr) {
+      WriteSnapshotFile(frame.first_method_index, *frame.snapshot);
+    }
+    IndexEntry const entry{/*method_index=*/frame.first_method_index,
+                           /*offset=*/offset_,
+                           /*plugin=*/frame.plugin};
+    index_entries.append(reinterpret_cast<char const*>(&entry),
+                         sizeof(entry));
+    if (frame.bytes.empty()) {
+      continue;
+    }
+    if (compressor_ == nullptr) {
+      stream_.write(frame.bytes.data(), frame.bytes.size());
+      offset_ += frame.bytes.size();
+    } else {
+      compressor_->Compress(frame.bytes, &compressed_bytes);
+      std::int64_t const header_size =
+          WriteVarint32(compressed_bytes.size(), stream_);
+      stream_.write(compressed_bytes.data(), compressed_bytes.size());
+      offset_ += header_size + compressed_bytes.size();
+    }
+  }
+  // The index is written after the journal so that it never refers to frames
+  // that are not on disk.
   stream_.flush();
+  index_stream_.write(index_entries.data(), index_entries.size());
+  index_stream_.flush();
+  CHECK(!stream_.fail());
+  CHECK(!index_stream_.fail());
+  frames.clear();
+}
+
+void Recorder::WriteSnapshotFile(
+    std::int64_t const method_index,
+    principia::serialization::Plugin const& snapshot) {
+  // The sizes were computed by |WriteSnapshot|.
+  std::string bytes(snapshot.GetCachedSize(), '\0');
+  snapshot.SerializeWithCachedSizesToArray(
+      reinterpret_cast<std::uint8_t*>(bytes.data()));
+  std::string compressed_bytes;
+  std::unique_ptr<google::compression::Compressor> const compressor(
+      google::compression::NewGipfeliCompressor());
+  compressor->Compress(bytes, &compressed_bytes);
+  {
+    std::ofstream stream(SnapshotPath(path_, method_index),
+                         std::ios::out | std::ios::binary);
+    stream.write(compressed_bytes.data(), compressed_bytes.size());
+    CHECK(!stream.fail()) << SnapshotPath(path_, method_index);
+  }
+
+  snapshot_method_indices_.push_back(method_index);
+  while (snapshot_method_indices_.size() > max_snapshots) {
+    std::filesystem::remove(
+        SnapshotPath(path_, snapshot_method_indices_.front()));
+    snapshot_method_indices_.pop_front();
+  }
+}
+
+void Recorder::Flush() {
+  absl::Time const deadline = absl::Now() + failure_flush_timeout;
+  if (!TryLockUntil(stream_lock_, deadline)) {
+    return;
+  }
+  std::deque<Frame> frames;
+  if (TryLockUntil(buffer_lock_, deadline)) {
+    frames.swap(frames_);
+    buffered_size_ = 0;
+    buffer_lock_.Unlock();
+  }
+  WriteFramesLocked(frames);
+  stream_lock_.Unlock();
+}
+
+void Recorder::FailureSink::send(google::LogSeverity const severity,
+                                 char const* const full_filename,
+                                 char const* const base_filename,
+                                 int const line,
+                                 tm const* const tm_time,
+                                 char const* const message,
+                                 std::size_t const message_len) {
+  if (severity != google::GLOG_FATAL) {
+    return;
+  }
+  // If the failure happened on the writer thread, the streams are unusable.
+  Recorder* const recorder = active_recorder_;
+  if (recorder != nullptr &&
+      std::this_thread::get_id() != recorder->writer_.get_id()) {
+    recorder->Flush();
+  }
 }
 
 Recorder* Recorder::active_recorder_ = nullptr;
+Recorder::FailureSink Recorder::failure_sink_;
 
 }  // namespace journal
 }  // namespace principia
@@ -1,37 +1,167 @@
 ﻿
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
 
 #include "absl/synchronization/mutex.h"
 #include "base/not_null.hpp"
+#include "gipfeli/compression.h"
+#include "glog/logging.h"
+#include "google/protobuf/arena.h"
 #include "serialization/journal.pb.h"
+#include "serialization/ksp_plugin.pb.h"
 
 namespace principia {
 namespace journal {
 
 FORWARD_DECLARE_FROM(method, template<typename Profile> class, Method);
 
+}  // namespace journal
+
+namespace ksp_plugin {
+FORWARD_DECLARE_FROM(plugin, class, Plugin);
+}  // namespace ksp_plugin
+
+namespace journal {
+
+// The journal is a binary file which starts with |signature|, followed by one
+// byte indicating whether it is compressed.  The rest of the file is a sequence
+// of methods, each prefixed by its size as a varint.  If the journal is
+// compressed, the methods are grouped in frames, each compressed with gipfeli
+// and prefixed by its compressed size as a varint.
+// The methods are appended to a buffer which is written by a background thread,
+// so that the interface calls don't wait for the disk.  If the process dies
+// because of a fatal error, the buffer is written before aborting.
+// An index, which makes it possible to start replaying the journal from a
+// snapshot of the plugin, is written next to the journal.  The snapshots are
+// compressed with gipfeli, and only the most recent ones are kept.
 class Recorder final {
  public:
-  explicit Recorder(std::filesystem::path const& path);
+  static constexpr std::string_view signature = "PRINCIPIA JOURNAL";
+
+  // The index is a sequence of entries, one for each frame of the journal.
+  // For an uncompressed journal, a frame is just a sequence of methods.
+  struct IndexEntry {
+    // The 0-based index of the first method of the frame, counting separately
+    // the methods written at construction and at destruction.
+    std::int64_t method_index;
+    // The offset of the frame in the journal.
+    std::int64_t offset;
+    // If nonzero, a snapshot of the plugin at this address was taken before
+    // the call of the method at |method_index|.  It was written to
+    // |SnapshotPath(path, method_index)|, unless it was since deleted.
+    std::uint64_t plugin;
+  };
+
+  explicit Recorder(std::filesystem::path const& path, bool compressed = false);
+
+  // Writes the methods that are still buffered.
+  ~Recorder();
 
   // Locking is used to ensure that the pairs of writes don't get intermixed.
   void WriteAtConstruction(serialization::Method const& method);
   void WriteAtDestruction(serialization::Method const& method);
 
+  // While a recorder is active, it is flushed by the glog failure function.
   static void Activate(base::not_null<Recorder*> recorder);
   static void Deactivate();
   static bool IsActivated();
 
+  // If a recorder is active and it hasn't taken a snapshot of the plugin
+  // recently, takes one, which is written in the background.  Must be called
+  // outside of the journaled methods.
+  static void WriteSnapshotIfNeeded(
+      base::not_null<ksp_plugin::Plugin const*> plugin);
+
+  static std::filesystem::path IndexPath(std::filesystem::path const& path);
+  static std::filesystem::path SnapshotPath(std::filesystem::path const& path,
+                                            std::int64_t method_index);
+
  private:
+  struct Frame {
+    std::string bytes;
+    std::int64_t first_method_index;
+    std::uint64_t plugin;
+    // If not null, the snapshot of the |plugin|, written before the frame, and
+    // the arena on which it is allocated.
+    principia::serialization::Plugin* snapshot = nullptr;
+    std::unique_ptr<google::protobuf::Arena> snapshot_arena;
+  };
+
   void WriteLocked(serialization::Method const& method);
 
+  void WriteSnapshot(base::not_null<ksp_plugin::Plugin const*> plugin)
+      EXCLUDES(lock_);
+
+  // The loop executed by |writer_|.
+  void WriteFrames() EXCLUDES(stream_lock_) EXCLUDES(buffer_lock_);
+
+  // Writes the |frames|, their snapshots, and their index entries, and clears
+  // |frames|.
+  void WriteFramesLocked(std::deque<Frame>& frames) REQUIRES(stream_lock_);
+
+  // Writes the |snapshot| taken before the method at |method_index| and
+  // deletes the oldest snapshots.
+  void WriteSnapshotFile(std::int64_t method_index,
+                         principia::serialization::Plugin const& snapshot)
+      REQUIRES(stream_lock_);
+
+  // Writes the buffered frames synchronously, unless the locks cannot be
+  // acquired promptly, e.g., because the current thread holds one of them.
+  void Flush() EXCLUDES(stream_lock_) EXCLUDES(buffer_lock_);
+
+  // A glog sink registered while a recorder is active.  glog sends the fatal
+  // messages to the sinks before calling its failure function, so the buffered
+  // frames are written before glog dumps the stack and aborts.
+  class FailureSink final : public google::LogSink {
+   public:
+    void send(google::LogSeverity severity,
+              char const* full_filename,
+              char const* base_filename,
+              int line,
+              tm const* tm_time,
+              char const* message,
+              std::size_t message_len) override;
+  };
+
+  std::filesystem::path const path_;
+
   absl::Mutex lock_;
-  std::ofstream stream_;
+  std::optional<std::chrono::steady_clock::time_point> last_snapshot_time_
+      GUARDED_BY(lock_);
+
+  // Lock order: |stream_lock_| before |buffer_lock_|.
+  absl::Mutex stream_lock_;
+  std::ofstream stream_ GUARDED_BY(stream_lock_);
+  std::ofstream index_stream_ GUARDED_BY(stream_lock_);
+  std::unique_ptr<google::compression::Compressor> const compressor_;
+  // The offset at which the next frame will be written in |stream_|.
+  std::int64_t offset_ GUARDED_BY(stream_lock_);
+  // The method indices of the snapshots that were written and not deleted, in
+  // increasing order.
+  std::deque<std::int64_t> snapshot_method_indices_ GUARDED_BY(stream_lock_);
+
+  absl::Mutex buffer_lock_;
+  // The frames that have not been written yet.  Only the last one may receive
+  // more methods.
+  std::deque<Frame> frames_ GUARDED_BY(buffer_lock_);
+  std::int64_t buffered_size_ GUARDED_BY(buffer_lock_) = 0;
+  std::int64_t number_of_methods_ GUARDED_BY(buffer_lock_) = 0;
+  bool shutdown_ GUARDED_BY(buffer_lock_) = false;
+
+  std::thread writer_;
 
   static Recorder* active_recorder_;
+  static FailureSink failure_sink_;
 
   template<typename>
   friend class Method;
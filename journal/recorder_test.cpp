@@ -1,14 +1,19 @@
 ﻿
 #include "journal/recorder.hpp"
 
+#include <cstdint>
 #include <filesystem>
+#include <fstream>
 #include <list>
 #include <string>
 #include <vector>
 
 #include "base/array.hpp"
 #include "base/hexadecimal.hpp"
+#include "base/serialization.hpp"
 #include "base/version.hpp"
+#include "glog/logging.h"
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "journal/method.hpp"
 #include "journal/profiles.hpp"
@@ -19,6 +24,9 @@
 namespace principia {
 namespace journal {
 
+using ::testing::AllOf;
+using ::testing::HasSubstr;
+
 class RecorderTest : public testing::Test {
  protected:
   RecorderTest()
@@ -30,7 +38,9 @@ class RecorderTest : public testing::Test {
   }
 
   ~RecorderTest() override {
-    Recorder::Deactivate();
+    if (Recorder::IsActivated()) {
+      Recorder::Deactivate();
+    }
   }
 
   static std::vector<serialization::Method> ReadAll(
@@ -73,6 +83,40 @@ TEST_F(JournalDeathTest, Return) {
   "returned_");
 }
 
+TEST_F(JournalDeathTest, FlushOnFailure) {
+  Recorder::Deactivate();
+  std::filesystem::path const path = test_name_ + ".journal";
+  EXPECT_DEATH({
+    Recorder::Activate(new Recorder(path, /*compressed=*/true));
+    Method<NewPlugin> m({"1 s", "2 s", 3});
+    LOG(FATAL) << "Failure in NewPlugin";
+  },
+  "Failure in NewPlugin");
+
+  // The methods that were buffered when the process died were written.
+  std::vector<serialization::Method> const methods = ReadAll(path);
+  ASSERT_EQ(3, methods.size());
+  EXPECT_TRUE(methods[2].HasExtension(serialization::NewPlugin::extension));
+  EXPECT_FALSE(methods[2]
+                   .GetExtension(serialization::NewPlugin::extension)
+                   .has_return_());
+}
+
+TEST_F(JournalDeathTest, StackTrace) {
+  // glog dumps the stack on failure, whether or not a recorder is active.
+  EXPECT_DEATH({
+    LOG(FATAL) << "Failure while journaling";
+  },
+  AllOf(HasSubstr("Failure while journaling"),
+        HasSubstr("JournalDeathTest_StackTrace_Test")));
+  Recorder::Deactivate();
+  EXPECT_DEATH({
+    LOG(FATAL) << "Failure after journaling";
+  },
+  AllOf(HasSubstr("Failure after journaling"),
+        HasSubstr("JournalDeathTest_StackTrace_Test")));
+}
+
 TEST_F(RecorderTest, Recording) {
   {
     const ksp_plugin::Plugin* plugin = plugin_.get();
@@ -83,6 +127,8 @@ TEST_F(RecorderTest, Recording) {
     Method<NewPlugin> m({"1 s", "2 s", 3});
     m.Return(plugin_.get());
   }
+  // Write the buffered methods.
+  Recorder::Deactivate();
 
   std::vector<serialization::Method> const methods =
       ReadAll(test_name_ + ".journal.hex");
@@ -143,5 +189,82 @@ TEST_F(RecorderTest, Recording) {
   }
 }
 
+TEST_F(RecorderTest, CompressedRecording) {
+  Recorder::Deactivate();
+  Recorder::Activate(
+      new Recorder(test_name_ + ".journal", /*compressed=*/true));
+  // Enough methods to fill several frames.
+  for (int i = 0; i < 10'000; ++i) {
+    Method<NewPlugin> m({"1 s", "2 s", 3});
+    m.Return(plugin_.get());
+  }
+  Recorder::Deactivate();
+
+  std::vector<serialization::Method> const methods =
+      ReadAll(test_name_ + ".journal");
+  ASSERT_EQ(20'002, methods.size());
+  EXPECT_TRUE(methods[0].HasExtension(serialization::GetVersion::extension));
+  for (int i = 2; i < methods.size(); i += 2) {
+    EXPECT_EQ("1 s",
+              methods[i].GetExtension(serialization::NewPlugin::extension)
+                  .in().game_epoch());
+    EXPECT_TRUE(methods[i + 1]
+                    .GetExtension(serialization::NewPlugin::extension)
+                    .has_return_());
+  }
+}
+
+TEST_F(RecorderTest, Index) {
+  for (int i = 0; i < 10'000; ++i) {
+    Method<NewPlugin> m({"1 s", "2 s", 3});
+    m.Return(plugin_.get());
+  }
+  Recorder::Deactivate();
+
+  std::vector<Recorder::IndexEntry> entries;
+  std::ifstream index_stream(Recorder::IndexPath(test_name_ + ".journal.hex"),
+                             std::ios::in | std::ios::binary);
+  Recorder::IndexEntry entry;
+  while (index_stream.read(reinterpret_cast<char*>(&entry), sizeof(entry))) {
+    entries.push_back(entry);
+  }
+  ASSERT_LT(1u, entries.size());
+  EXPECT_EQ(0, entries.front().method_index);
+  EXPECT_EQ(static_cast<std::int64_t>(Recorder::signature.size()) + 1,
+            entries.front().offset);
+  for (std::size_t i = 1; i < entries.size(); ++i) {
+    EXPECT_LT(entries[i - 1].method_index, entries[i].method_index);
+    EXPECT_LT(entries[i - 1].offset, entries[i].offset);
+    EXPECT_EQ(0, entries[i].plugin);
+  }
+  EXPECT_GT(20'002, entries.back().method_index);
+}
+
+TEST_F(RecorderTest, HexadecimalJournal) {
+  Recorder::Deactivate();
+  // The journals written by earlier versions can still be read.
+  serialization::Method method;
+  auto* const out =
+      method.MutableExtension(serialization::GetVersion::extension)
+          ->mutable_out();
+  out->set_build_date(base::BuildDate);
+  out->set_version(base::Version);
+  {
+    std::ofstream stream(test_name_ + ".journal.hex");
+    base::HexadecimalEncoder</*null_terminated=*/true> encoder;
+    for (int i = 0; i < 2; ++i) {
+      stream << encoder.Encode(base::SerializeAsBytes(method).get()).data.get()
+             << "\n";
+    }
+  }
+
+  std::vector<serialization::Method> const methods =
+      ReadAll(test_name_ + ".journal.hex");
+  ASSERT_EQ(2, methods.size());
+  EXPECT_EQ(base::Version,
+            methods[1].GetExtension(serialization::GetVersion::extension)
+                .out().version());
+}
+
 }  // namespace journal
 }  // namespace principia
@@ -2,14 +2,20 @@
 #include "ksp_plugin/flight_plan.hpp"
 
 #include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <list>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "base/fingerprint2011.hpp"
 #include "integrators/embedded_explicit_generalized_runge_kutta_nyström_integrator.hpp"
 #include "integrators/embedded_explicit_runge_kutta_nyström_integrator.hpp"
 #include "integrators/methods.hpp"
 #include "ksp_plugin/integrators.hpp"
+#include "ksp_plugin/prediction_scheduler.hpp"
 #include "testing_utilities/make_not_null.hpp"
 
 namespace principia {
@@ -17,6 +23,7 @@ namespace ksp_plugin {
 namespace internal_flight_plan {
 
 using base::Error;
+using base::Fingerprint2011;
 using base::make_not_null_unique;
 using base::Status;
 using geometry::Position;
@@ -42,6 +49,35 @@ inline Status Singular() {
   return Status(FlightPlan::singular, "Singular");
 }
 
+// Returns true if the manœuvres have the same initial mass and burn, except
+// for their frames.
+bool HaveSameInputs(NavigationManœuvre const& left,
+                    NavigationManœuvre const& right) {
+  return left.initial_mass() == right.initial_mass() &&
+         left.initial_time() == right.initial_time() &&
+         left.direction() == right.direction() &&
+         left.duration() == right.duration() &&
+         left.thrust() == right.thrust() &&
+         left.specific_impulse() == right.specific_impulse() &&
+         left.is_inertially_fixed() == right.is_inertially_fixed();
+}
+
+// Returns the fingerprints of the serialized frames of the manœuvres in
+// [begin, end[.  The frames cannot be compared by identity as each burn coming
+// from the interface has its own frame.
+std::vector<std::uint64_t> FrameFingerprints(
+    std::vector<NavigationManœuvre>::const_iterator const begin,
+    std::vector<NavigationManœuvre>::const_iterator const end) {
+  std::vector<std::uint64_t> fingerprints;
+  for (auto it = begin; it != end; ++it) {
+    serialization::DynamicFrame message;
+    it->frame()->WriteToMessage(&message);
+    std::string const bytes = message.SerializeAsString();
+    fingerprints.push_back(Fingerprint2011(bytes.data(), bytes.size()));
+  }
+  return fingerprints;
+}
+
 FlightPlan::FlightPlan(
     Mass const& initial_mass,
     Instant const& initial_time,
@@ -71,6 +107,10 @@ FlightPlan::FlightPlan(
   ComputeSegments(manœuvres_.begin(), manœuvres_.end());
 }
 
+FlightPlan::~FlightPlan() {
+  CancelSpeculations();
+}
+
 Instant FlightPlan::initial_time() const {
   return initial_time_;
 }
@@ -111,9 +151,9 @@ Status FlightPlan::Insert(NavigationManœuvre::Burn const& burn,
                             start_of_burn(index))) {
     return DoesNotFit();
   }
+  PopSegmentsAffectedByManœuvre(index);
   manœuvres_.insert(manœuvres_.begin() + index, manœuvre);
   UpdateInitialMassOfManœuvresAfter(index);
-  PopSegmentsAffectedByManœuvre(index);
   return ComputeSegments(manœuvres_.begin() + index, manœuvres_.end());
 }
 
@@ -159,9 +199,9 @@ void FlightPlan::ForgetBefore(Instant const& time,
 Status FlightPlan::Remove(int index) {
   CHECK_GE(index, 0);
   CHECK_LT(index, number_of_manœuvres());
+  PopSegmentsAffectedByManœuvre(index);
   manœuvres_.erase(manœuvres_.begin() + index);
   UpdateInitialMassOfManœuvresAfter(index);
-  PopSegmentsAffectedByManœuvre(index);
   return ComputeSegments(manœuvres_.begin() + index, manœuvres_.end());
 }
 
@@ -174,11 +214,12 @@ Status FlightPlan::Replace(NavigationManœuvre::Burn const& burn,
   if (manœuvre.IsSingular()) {
     return Singular();
   }
+  Instant desired_final_time = desired_final_time_;
   if (index == number_of_manœuvres() - 1) {
     // This is the last manœuvre.  If it doesn't fit just because the flight
     // plan is too short, extend the flight plan.
     if (manœuvre.IsAfter(start_of_previous_coast(index))) {
-      desired_final_time_ =
+      desired_final_time =
           std::max(desired_final_time_, manœuvre.final_time());
     } else {
       return DoesNotFit();
@@ -188,15 +229,27 @@ Status FlightPlan::Replace(NavigationManœuvre::Burn const& burn,
     return DoesNotFit();
   }
 
+  // Pop the segments that we'll recompute.  If the manœuvre starts at the same
+  // time, the coast that precedes it is unchanged and we keep it.
+  // TODO(phl): Recompute as late as possible.
+  NavigationManœuvre const previous_manœuvre = manœuvres_[index];
+  PopSegmentsAffectedByManœuvre(
+      index,
+      /*keep_last_coast=*/manœuvre.initial_time() ==
+          previous_manœuvre.initial_time());
+
   // Replace the manœuvre at position |index| and rebuild all the ones that
-  // follow as they may have a different initial mass.  Also pop the segments
-  // that we'll recompute.
+  // follow as they may have a different initial mass.
   manœuvres_[index] = manœuvre;
   UpdateInitialMassOfManœuvresAfter(index);
+  desired_final_time_ = desired_final_time;
 
-  // TODO(phl): Recompute as late as possible.
-  PopSegmentsAffectedByManœuvre(index);
-  return ComputeSegments(manœuvres_.begin() + index, manœuvres_.end());
+  Status const status =
+      ComputeSegments(manœuvres_.begin() + index, manœuvres_.end());
+  if (status.ok()) {
+    Speculate(index, previous_manœuvre);
+  }
+  return status;
 }
 
 Status FlightPlan::SetDesiredFinalTime(Instant const& desired_final_time) {
@@ -214,6 +267,12 @@ Status FlightPlan::SetAdaptiveStepParameters(
         adaptive_step_parameters,
     Ephemeris<Barycentric>::GeneralizedAdaptiveStepParameters const&
         generalized_adaptive_step_parameters) {
+  // The cached segments were computed with the old parameters.
+  CancelSpeculations();
+  {
+    absl::MutexLock l(&lock_);
+    cached_segments_.clear();
+  }
   adaptive_step_parameters_ = adaptive_step_parameters;
   generalized_adaptive_step_parameters_ = generalized_adaptive_step_parameters;
   return RecomputeAllSegments();
@@ -251,6 +310,19 @@ void FlightPlan::GetAllSegments(
   CHECK(begin != end);
 }
 
+double FlightPlan::progress_of_speculations() const {
+  absl::ReaderMutexLock l(&lock_);
+  double total_progress = 0;
+  int speculations = 0;
+  for (auto const& cached : cached_segments_) {
+    if (cached.state != CachedSegments::State::Done) {
+      total_progress += cached.progress;
+      ++speculations;
+    }
+  }
+  return speculations == 0 ? 1 : total_progress / speculations;
+}
+
 void FlightPlan::WriteToMessage(
     not_null<serialization::FlightPlan*> const message) const {
   initial_mass_.WriteToMessage(message->mutable_initial_mass());
@@ -405,6 +477,7 @@ Status FlightPlan::ComputeSegments(
 
     if (anomalous_segments_ == 0) {
       Status const status = CoastSegment(manœuvre.initial_time(), coast);
+      UpdateProgress();
       if (!status.ok()) {
         overall_status.Update(status);
         anomalous_segments_ = 1;
@@ -412,11 +485,16 @@ Status FlightPlan::ComputeSegments(
       }
     }
 
+    if (anomalous_segments_ == 0 && ReuseCachedSegments(it, end)) {
+      return overall_status;
+    }
+
     AddLastSegment();
 
     if (anomalous_segments_ == 0) {
       auto& burn = segments_.back();
       Status const status = BurnSegment(manœuvre, burn);
+      UpdateProgress();
       if (!status.ok()) {
         overall_status.Update(status);
         anomalous_segments_ = 1;
@@ -434,6 +512,7 @@ Status FlightPlan::ComputeSegments(
     desired_final_time_ =
         std::max(desired_final_time_, segments_.back()->t_max());
     Status const status = CoastSegment(desired_final_time_, segments_.back());
+    UpdateProgress();
     if (!status.ok()) {
       overall_status.Update(status);
       anomalous_segments_ = 1;
@@ -443,6 +522,223 @@ Status FlightPlan::ComputeSegments(
   return overall_status;
 }
 
+bool FlightPlan::ReuseCachedSegments(
+    std::vector<NavigationManœuvre>::iterator const begin,
+    std::vector<NavigationManœuvre>::iterator const end) {
+  CHECK_EQ(0, anomalous_segments_);
+  auto const& coast = segments_.back();
+  auto const coast_last = coast->back();
+  // Only computed if some cached segments have the other inputs.
+  std::optional<std::vector<std::uint64_t>> frame_fingerprints;
+  absl::MutexLock l(&lock_);
+  for (auto it = cached_segments_.begin(); it != cached_segments_.end(); ++it) {
+    CachedSegments& cached = *it;
+    if (cached.state != CachedSegments::State::Done ||
+        cached.burn == nullptr ||
+        !cached.HasInputs(coast_last.time,
+                          coast_last.degrees_of_freedom,
+                          begin,
+                          end,
+                          desired_final_time_)) {
+      continue;
+    }
+    if (!frame_fingerprints.has_value()) {
+      frame_fingerprints = FrameFingerprints(begin, end);
+    }
+    if (cached.frame_fingerprints != *frame_fingerprints) {
+      continue;
+    }
+
+    coast->AttachFork(std::move(cached.burn));
+    segments_.insert(segments_.end(),
+                     cached.segments.begin(),
+                     cached.segments.end());
+    int const first_segment = 2 * (begin - manœuvres_.begin());
+    for (auto manœuvre = begin; manœuvre != end; ++manœuvre) {
+      manœuvre->set_coasting_trajectory(
+          segments_[first_segment + 2 * (manœuvre - begin)]);
+    }
+    // The segments are not anomalous so the last coast ends exactly at the
+    // desired final time, possibly extended to the end of the last burn.
+    desired_final_time_ = segments_.back()->back().time;
+    cached_segments_.erase(it);
+    return true;
+  }
+  return false;
+}
+
+void FlightPlan::Speculate(int const index,
+                           NavigationManœuvre const& previous_manœuvre) {
+  CancelSpeculations();
+  NavigationManœuvre const& manœuvre = manœuvres_[index];
+  auto const& Δv = manœuvre.intensity().Δv;
+  auto const& previous_Δv = previous_manœuvre.intensity().Δv;
+  if (!Δv.has_value() || !previous_Δv.has_value() || *Δv == *previous_Δv) {
+    return;
+  }
+  auto const& coast_last = segments_[2 * index]->back();
+  for (auto const& speculative_Δv : {*Δv + (*Δv - *previous_Δv),
+                                     *Δv - (*Δv - *previous_Δv)}) {
+    NavigationManœuvre::Burn burn = manœuvre.burn();
+    burn.intensity.Δv = speculative_Δv;
+    std::vector<NavigationManœuvre> manœuvres;
+    manœuvres.emplace_back(manœuvre.initial_mass(), burn);
+
+    // Same checks as in |Replace|, except that we don't speculate on the
+    // manœuvres that would move.
+    auto const& speculative_manœuvre = manœuvres.back();
+    if (speculative_manœuvre.IsSingular() ||
+        speculative_manœuvre.initial_time() != manœuvre.initial_time()) {
+      continue;
+    }
+    Instant desired_final_time = desired_final_time_;
+    if (index == number_of_manœuvres() - 1) {
+      desired_final_time =
+          std::max(desired_final_time, speculative_manœuvre.final_time());
+    } else if (speculative_manœuvre.final_time() >= start_of_next_burn(index)) {
+      continue;
+    }
+    for (int i = index + 1; i < manœuvres_.size(); ++i) {
+      Mass const initial_mass = manœuvres.back().final_mass();
+      manœuvres.emplace_back(initial_mass, manœuvres_[i].burn());
+    }
+    auto frame_fingerprints =
+        FrameFingerprints(manœuvres.begin(), manœuvres.end());
+    Ephemeris<Barycentric>::Guard guard(ephemeris_);
+
+    absl::MutexLock l(&lock_);
+    bool const is_cached = std::any_of(
+        cached_segments_.begin(),
+        cached_segments_.end(),
+        [&coast_last, &manœuvres, &frame_fingerprints, &desired_final_time](
+            CachedSegments const& cached) {
+          return cached.HasInputs(coast_last.time,
+                                  coast_last.degrees_of_freedom,
+                                  manœuvres.begin(),
+                                  manœuvres.end(),
+                                  desired_final_time) &&
+                 cached.frame_fingerprints == frame_fingerprints;
+        });
+    if (is_cached) {
+      continue;
+    }
+    auto& cached = cached_segments_.emplace_back(
+        coast_last.time,
+        coast_last.degrees_of_freedom,
+        std::move(manœuvres),
+        std::move(frame_fingerprints),
+        desired_final_time,
+        CachedSegments::State::Pending);
+    cached.guard = std::move(guard);
+    EvictCachedSegments();
+    // The speculations must not delay the predictions.
+    PredictionScheduler::Default().Schedule(
+        &cached,
+        PredictionScheduler::Priority::Other,
+        [this,
+         cached = &cached,
+         adaptive_step_parameters = adaptive_step_parameters_,
+         generalized_adaptive_step_parameters =
+             generalized_adaptive_step_parameters_]() {
+          ComputeSpeculativeSegments(cached,
+                                     adaptive_step_parameters,
+                                     generalized_adaptive_step_parameters);
+        });
+  }
+}
+
+void FlightPlan::ComputeSpeculativeSegments(
+    not_null<CachedSegments*> const cached,
+    Ephemeris<Barycentric>::AdaptiveStepParameters const&
+        adaptive_step_parameters,
+    Ephemeris<Barycentric>::GeneralizedAdaptiveStepParameters const&
+        generalized_adaptive_step_parameters) {
+  // Held until the end of the computation, and released without holding the
+  // |lock_|.
+  std::optional<Ephemeris<Barycentric>::Guard> guard;
+  {
+    absl::MutexLock l(&lock_);
+    CHECK(cached->state == CachedSegments::State::Pending);
+    cached->state = CachedSegments::State::Running;
+    guard = std::move(cached->guard);
+  }
+
+  // A flight plan that starts at the end of the coast preceding the first
+  // manœuvre, so its first coast is empty.  Its other segments are computed
+  // exactly as they would be by this flight plan.
+  FlightPlan flight_plan(cached->manœuvres.front().initial_mass(),
+                         cached->initial_time,
+                         cached->initial_degrees_of_freedom,
+                         /*desired_final_time=*/cached->initial_time,
+                         ephemeris_,
+                         adaptive_step_parameters,
+                         generalized_adaptive_step_parameters);
+  flight_plan.manœuvres_ = cached->manœuvres;
+  flight_plan.desired_final_time_ = cached->desired_final_time;
+  flight_plan.progress_ = &cached->progress;
+  Status const status = flight_plan.RecomputeAllSegments();
+
+  absl::MutexLock l(&lock_);
+  cached->state = CachedSegments::State::Done;
+  if (status.ok()) {
+    cached->burn = flight_plan.segments_[1]->DetachFork();
+    cached->segments.assign(flight_plan.segments_.begin() + 1,
+                            flight_plan.segments_.end());
+  }
+}
+
+void FlightPlan::CancelSpeculations() {
+  std::vector<CachedSegments const*> speculations;
+  {
+    absl::ReaderMutexLock l(&lock_);
+    for (auto const& cached : cached_segments_) {
+      if (cached.state != CachedSegments::State::Done) {
+        speculations.push_back(&cached);
+      }
+    }
+  }
+  if (speculations.empty()) {
+    return;
+  }
+  // Must not hold the lock as the speculations need it to complete.
+  for (auto const speculation : speculations) {
+    PredictionScheduler::Default().Cancel(speculation);
+  }
+  // The cancelled segments are destroyed without holding the lock, as
+  // releasing their guards locks the ephemeris.  A speculation that was
+  // running when it was cancelled is |Done|, but has no segments.
+  std::list<CachedSegments> cancelled;
+  absl::MutexLock l(&lock_);
+  for (auto it = cached_segments_.begin(); it != cached_segments_.end();) {
+    auto const next = std::next(it);
+    if (std::find(speculations.begin(), speculations.end(), &*it) !=
+        speculations.end()) {
+      cancelled.splice(cancelled.end(), cached_segments_, it);
+    }
+    it = next;
+  }
+}
+
+void FlightPlan::EvictCachedSegments() {
+  auto it = cached_segments_.begin();
+  while (cached_segments_.size() > max_cached_segments &&
+         it != cached_segments_.end()) {
+    if (it->state == CachedSegments::State::Done) {
+      it = cached_segments_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void FlightPlan::UpdateProgress() {
+  if (progress_ != nullptr && desired_final_time_ > initial_time_) {
+    *progress_ = std::min(1.0,
+                          (segments_.back()->back().time - initial_time_) /
+                              (desired_final_time_ - initial_time_));
+  }
+}
+
 void FlightPlan::AddLastSegment() {
   segments_.emplace_back(segments_.back()->NewForkAtLast());
   if (anomalous_segments_ > 0) {
@@ -467,14 +763,37 @@ void FlightPlan::PopLastSegment() {
   }
 }
 
-void FlightPlan::PopSegmentsAffectedByManœuvre(int const index) {
+void FlightPlan::PopSegmentsAffectedByManœuvre(int const index,
+                                               bool const keep_last_coast) {
   // We will keep, for each manœuvre in [0, index[, its burn and the coast
   // preceding it, as well as the coast preceding manœuvre |index|.
   int const segments_kept = 2 * index + 1;
+  if (anomalous_segments_ == 0 && number_of_segments() > segments_kept) {
+    // Detach the following segments and cache them in case the manœuvres come
+    // back to their current state.
+    auto const coast_last = segments_[segments_kept - 1]->back();
+    auto frame_fingerprints =
+        FrameFingerprints(manœuvres_.begin() + index, manœuvres_.end());
+    absl::MutexLock l(&lock_);
+    auto& cached = cached_segments_.emplace_back(
+        coast_last.time,
+        coast_last.degrees_of_freedom,
+        std::vector<NavigationManœuvre>(manœuvres_.begin() + index,
+                                        manœuvres_.end()),
+        std::move(frame_fingerprints),
+        desired_final_time_,
+        CachedSegments::State::Done);
+    cached.burn = segments_[segments_kept]->DetachFork();
+    cached.segments.assign(segments_.begin() + segments_kept, segments_.end());
+    segments_.erase(segments_.begin() + segments_kept, segments_.end());
+    EvictCachedSegments();
+  }
   while (number_of_segments() > segments_kept) {
     PopLastSegment();
   }
-  ResetLastSegment();
+  if (!keep_last_coast || anomalous_segments_ > 0) {
+    ResetLastSegment();
+  }
 }
 
 void FlightPlan::UpdateInitialMassOfManœuvresAfter(int const index) {
@@ -488,6 +807,34 @@ void FlightPlan::UpdateInitialMassOfManœuvresAfter(int const index) {
   }
 }
 
+FlightPlan::CachedSegments::CachedSegments(
+    Instant const& initial_time,
+    DegreesOfFreedom<Barycentric> const& initial_degrees_of_freedom,
+    std::vector<NavigationManœuvre> manœuvres,
+    std::vector<std::uint64_t> frame_fingerprints,
+    Instant const& desired_final_time,
+    State const state)
+    : initial_time(initial_time),
+      initial_degrees_of_freedom(initial_degrees_of_freedom),
+      manœuvres(std::move(manœuvres)),
+      frame_fingerprints(std::move(frame_fingerprints)),
+      desired_final_time(desired_final_time),
+      state(state) {}
+
+bool FlightPlan::CachedSegments::HasInputs(
+    Instant const& initial_time,
+    DegreesOfFreedom<Barycentric> const& initial_degrees_of_freedom,
+    std::vector<NavigationManœuvre>::const_iterator const begin,
+    std::vector<NavigationManœuvre>::const_iterator const end,
+    Instant const& desired_final_time) const {
+  return this->initial_time == initial_time &&
+         this->initial_degrees_of_freedom == initial_degrees_of_freedom &&
+         this->desired_final_time == desired_final_time &&
+         std::equal(manœuvres.begin(), manœuvres.end(),
+                    begin, end,
+                    &HaveSameInputs);
+}
+
 Instant FlightPlan::start_of_last_coast() const {
   return manœuvres_.empty() ? initial_time_ : manœuvres_.back().final_time();
 }
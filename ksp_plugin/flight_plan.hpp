@@ -1,8 +1,14 @@
 ﻿
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <optional>
 #include <vector>
 
+#include "absl/synchronization/mutex.h"
+#include "base/macros.hpp"
 #include "base/not_null.hpp"
 #include "base/status.hpp"
 #include "geometry/named_quantities.hpp"
@@ -50,7 +56,8 @@ class FlightPlan {
                  adaptive_step_parameters,
              Ephemeris<Barycentric>::GeneralizedAdaptiveStepParameters
                  generalized_adaptive_step_parameters);
-  virtual ~FlightPlan() = default;
+  // Cancels the computations started in the background.
+  virtual ~FlightPlan();
 
   // Construction parameters.
   virtual Instant initial_time() const;
@@ -128,6 +135,13 @@ class FlightPlan {
       DiscreteTrajectory<Barycentric>::Iterator& begin,
       DiscreteTrajectory<Barycentric>::Iterator& end) const;
 
+  // When the Δv of a manœuvre is changed by |Replace|, the segments resulting
+  // from changing it again by the same amount, in either direction, are
+  // computed in the background so that they may be reused if the user keeps
+  // dragging the Δv.  The result is in [0, 1]; it tracks the progress of these
+  // computations, and is 1 if there are none.
+  virtual double progress_of_speculations() const;
+
   void WriteToMessage(not_null<serialization::FlightPlan*> message) const;
 
   // This may return a null pointer if the flight plan contained in the
@@ -137,6 +151,8 @@ class FlightPlan {
       not_null<Ephemeris<Barycentric>*> ephemeris);
 
   static constexpr std::int64_t max_ephemeris_steps_per_frame = 1000;
+  // The maximum number of detached chains of segments kept for reuse.
+  static constexpr int max_cached_segments = 4;
 
   static constexpr Error bad_desired_final_time = Error::OUT_OF_RANGE;
   static constexpr Error does_not_fit = Error::OUT_OF_RANGE;
@@ -147,6 +163,57 @@ class FlightPlan {
   FlightPlan();
 
  private:
+  // The segments that follow the coast preceding a manœuvre, i.e., the burn of
+  // that manœuvre and all the segments after it, detached from the flight plan.
+  // They only depend on the end of that coast, on the manœuvres starting with
+  // that one and on the desired final time, so they are reused if these inputs
+  // are unchanged.  The inputs are immutable; the other fields are guarded by
+  // the |lock_| of the flight plan.  The frames of the manœuvres are compared
+  // by fingerprint, see |FrameFingerprints|.
+  struct CachedSegments {
+    enum class State {
+      // Speculative segments not yet being computed.
+      Pending,
+      // Speculative segments being computed in the background.
+      Running,
+      Done,
+    };
+
+    CachedSegments(
+        Instant const& initial_time,
+        DegreesOfFreedom<Barycentric> const& initial_degrees_of_freedom,
+        std::vector<NavigationManœuvre> manœuvres,
+        std::vector<std::uint64_t> frame_fingerprints,
+        Instant const& desired_final_time,
+        State state);
+
+    // Returns true if the inputs, except for the frames of the manœuvres, are
+    // the given ones.
+    bool HasInputs(
+        Instant const& initial_time,
+        DegreesOfFreedom<Barycentric> const& initial_degrees_of_freedom,
+        std::vector<NavigationManœuvre>::const_iterator begin,
+        std::vector<NavigationManœuvre>::const_iterator end,
+        Instant const& desired_final_time) const;
+
+    Instant const initial_time;
+    DegreesOfFreedom<Barycentric> const initial_degrees_of_freedom;
+    std::vector<NavigationManœuvre> const manœuvres;
+    std::vector<std::uint64_t> const frame_fingerprints;
+    Instant const desired_final_time;
+
+    State state;
+    // Prevents the ephemeris from forgetting the start of the speculative
+    // segments before they are computed.
+    std::optional<Ephemeris<Barycentric>::Guard> guard;
+    // Null if the computation failed.  Owns the other |segments| through its
+    // forks.
+    std::unique_ptr<DiscreteTrajectory<Barycentric>> burn;
+    std::vector<not_null<DiscreteTrajectory<Barycentric>*>> segments;
+    // The progress of the computation of speculative segments, in [0, 1].
+    std::atomic<double> progress = 0;
+  };
+
   // Clears and recomputes all trajectories in |segments_|.
   Status RecomputeAllSegments();
 
@@ -170,6 +237,41 @@ class FlightPlan {
   Status ComputeSegments(std::vector<NavigationManœuvre>::iterator begin,
                          std::vector<NavigationManœuvre>::iterator end);
 
+  // If the cache contains segments for the manœuvres in [begin, end[ starting
+  // at the end of the last segment, attaches them to the flight plan and
+  // returns true.  The speculative segments that are not |Done| are not
+  // waited for, and are dropped by the next call to |CancelSpeculations|.
+  bool ReuseCachedSegments(std::vector<NavigationManœuvre>::iterator begin,
+                           std::vector<NavigationManœuvre>::iterator end)
+      EXCLUDES(lock_);
+
+  // Starts computing in the background the segments that result from changing
+  // |manœuvres_[index]| again by the same Δv as it differs from
+  // |previous_manœuvre|, in both directions.  Cancels the previous
+  // speculations.
+  void Speculate(int index, NavigationManœuvre const& previous_manœuvre)
+      EXCLUDES(lock_);
+
+  // Computes the segments of |cached|, which must be |Pending|, by integrating
+  // with the given parameters.  Runs in the background.
+  void ComputeSpeculativeSegments(
+      not_null<CachedSegments*> cached,
+      Ephemeris<Barycentric>::AdaptiveStepParameters const&
+          adaptive_step_parameters,
+      Ephemeris<Barycentric>::GeneralizedAdaptiveStepParameters const&
+          generalized_adaptive_step_parameters) EXCLUDES(lock_);
+
+  // Cancels and removes from the cache the speculative segments that are not
+  // |Done|, including those that become |Done| because they are cancelled.
+  void CancelSpeculations() EXCLUDES(lock_);
+
+  // Removes the oldest segments that are |Done| until the cache has at most
+  // |max_cached_segments| entries.
+  void EvictCachedSegments() REQUIRES(lock_);
+
+  // Updates |*progress_|, if any, after a segment has been computed.
+  void UpdateProgress();
+
   // Adds a trajectory to |segments_|, forked at the end of the last one.  If
   // there are already anomalous trajectories, the newly created trajectory is
   // anomalous too.
@@ -184,9 +286,10 @@ class FlightPlan {
   void PopLastSegment();
 
   // Pops the burn of the manœuvre with the given index and all following
-  // segments, then resets the last segment (which is the coast preceding
-  // |manœuvres_[index]|).
-  void PopSegmentsAffectedByManœuvre(int index);
+  // segments, which are cached if they are not anomalous, then resets the last
+  // segment (which is the coast preceding |manœuvres_[index]|) unless
+  // |keep_last_coast| is true and it is not anomalous.
+  void PopSegmentsAffectedByManœuvre(int index, bool keep_last_coast = false);
 
   // Reconstructs each manœuvre after |manœuvres_[index]| (starting with
   // |manœuvres_[index + 1]|), keeping the same burns but recomputing the
@@ -224,6 +327,14 @@ class FlightPlan {
   Ephemeris<Barycentric>::AdaptiveStepParameters adaptive_step_parameters_;
   Ephemeris<Barycentric>::GeneralizedAdaptiveStepParameters
       generalized_adaptive_step_parameters_;
+
+  // Detached segments, from the oldest to the newest.
+  mutable absl::Mutex lock_;
+  std::list<CachedSegments> cached_segments_ GUARDED_BY(lock_);
+  // Set for the flight plans used to compute speculative segments.
+  std::atomic<double>* progress_ = nullptr;
+
+  friend class FlightPlanTest;
 };
 
 }  // namespace internal_flight_plan
@@ -5,6 +5,7 @@
 #include <cmath>
 #include <cstring>
 #include <filesystem>
+#include <functional>
 #include <iomanip>
 #include <limits>
 #include <map>
@@ -41,6 +42,7 @@
 #include "geometry/r3x3_matrix.hpp"
 #include "geometry/rotation.hpp"
 #include "google/protobuf/arena.h"
+#include "journal/latencies.hpp"
 #include "journal/method.hpp"
 #include "journal/profiles.hpp"
 #include "journal/recorder.hpp"
@@ -134,7 +136,8 @@ constexpr char base64_encoder[] = "base64";
 constexpr char hexadecimal_encoder[] = "hexadecimal";
 
 constexpr int chunk_size = 64 << 10;
-constexpr int number_of_chunks = 8;
+// Large enough to keep the (de)compression workers busy.
+constexpr int number_of_chunks = 32;
 
 not_null<Arena*> arena = []() {
   ArenaOptions options;
@@ -277,12 +280,14 @@ serialization::GravityModel::Body MakeGravityModel(
   return gravity_model;
 }
 
-std::unique_ptr<google::compression::Compressor> NewCompressor(
-    std::string_view const compressor) {
+// Returns a function that creates a new compressor of the given kind, for use
+// by the parallel (de)compression of the chunks.
+std::function<std::unique_ptr<google::compression::Compressor>()>
+CompressorFactory(std::string_view const compressor) {
   if (compressor.empty()) {
     return nullptr;
   } else if (compressor == gipfeli_compressor) {
-    return google::compression::NewGipfeliCompressor();
+    return &google::compression::NewGipfeliCompressor;
   } else {
     LOG(FATAL) << "Unknown compressor " << compressor;
   }
@@ -325,7 +330,8 @@ void __cdecl principia__ActivateRecorder(bool const activate) {
     std::stringstream name;
     name << std::put_time(localtime, "JOURNAL.%Y%m%d-%H%M%S");
     journal::Recorder* const recorder = new journal::Recorder(
-        std::filesystem::path("glog") / "Principia" / name.str());
+        std::filesystem::path("glog") / "Principia" / name.str(),
+        /*compressed=*/true);
     Vessel::MakeSynchronous();
     journal::Recorder::Activate(recorder);
   } else if (!activate && journal::Recorder::IsActivated()) {
@@ -334,6 +340,20 @@ void __cdecl principia__ActivateRecorder(bool const activate) {
   }
 }
 
+// Writes the statistics of the latencies of the interface methods to a file
+// next to the logs.
+void __cdecl principia__DumpLatencies() {
+  // NOTE: Do not journal!  This is not part of the behaviour of the plugin.
+  auto const now = std::chrono::system_clock::now();
+  std::time_t const time = std::chrono::system_clock::to_time_t(now);
+  std::tm* const localtime = std::localtime(&time);
+  std::stringstream name;
+  name << std::put_time(localtime, "LATENCIES.%Y%m%d-%H%M%S");
+  auto const path = std::filesystem::path("glog") / "Principia" / name.str();
+  journal::Latencies::Default().Dump(path);
+  LOG(INFO) << "Latencies written to " << path;
+}
+
 XYZ __cdecl principia__AngularMomentumFromAngularVelocity(
     XYZ world_angular_velocity,
     XYZ moments_of_inertia_in_tonnes,
@@ -378,6 +398,10 @@ XYZ __cdecl principia__AngularMomentumFromAngularVelocity(
 void __cdecl principia__AdvanceTime(Plugin* const plugin,
                                     double const t,
                                     double const planetarium_rotation) {
+  // Must be done before journaling this method.
+  if (plugin != nullptr) {
+    journal::Recorder::WriteSnapshotIfNeeded(plugin);
+  }
   journal::Method<journal::AdvanceTime> m({plugin, t, planetarium_rotation});
   CHECK_NOTNULL(plugin);
   plugin->AdvanceTime(FromGameTime(*plugin, t), planetarium_rotation * Degree);
@@ -525,7 +549,8 @@ void __cdecl principia__DeleteU16String(char16_t const** const native_string) {
 // |*plugin| must be null on the first call and must be passed unchanged to the
 // successive calls.  The caller must perform an extra call with
 // |serialization_size| set to 0 to indicate the end of the input stream.  When
-// this last call returns, |*plugin| is not null and may be used by the caller.
+// this last call returns, |*plugin| may be used by the caller; it is null if
+// the plugin could not be read, in which case the error is logged.
 void __cdecl principia__DeserializePlugin(
     char const* const serialization,
     PushDeserializer** const deserializer,
@@ -548,15 +573,22 @@ void __cdecl principia__DeserializePlugin(
     LOG(INFO) << "Begin plugin deserialization";
     *deserializer = new PushDeserializer(chunk_size,
                                          number_of_chunks,
-                                         NewCompressor(compressor));
+                                         CompressorFactory(compressor));
     CHECK_NOTNULL(arena);
     not_null<serialization::Plugin*> const message =
         Arena::CreateMessage<serialization::Plugin>(arena);
     (*deserializer)->Start(
         message,
         [plugin](google::protobuf::Message const& message) {
-          *plugin = Plugin::ReadFromMessage(
-              static_cast<serialization::Plugin const&>(message)).release();
+          auto status_or_plugin = Plugin::ReadFromMessage(
+              static_cast<serialization::Plugin const&>(message));
+          if (status_or_plugin.ok()) {
+            *plugin = std::move(status_or_plugin).ValueOrDie().release();
+          } else {
+            // |*plugin| stays null, the adapter will keep the serialization.
+            LOG(ERROR) << "Unable to read the plugin: "
+                       << status_or_plugin.status();
+          }
         });
   }
 
@@ -571,6 +603,8 @@ void __cdecl principia__DeserializePlugin(
   if (bytes_size == 0) {
     LOG(INFO) << "End plugin deserialization";
     TakeOwnership(deserializer);
+    LOG(INFO) << "Deserialization used " << arena->SpaceAllocated()
+              << " bytes of arena";
     arena->Reset();
   }
   return m.Return();
@@ -1065,7 +1099,7 @@ char const* __cdecl principia__SerializePlugin(
     LOG(INFO) << "Begin plugin serialization";
     *serializer = new PullSerializer(chunk_size,
                                      number_of_chunks,
-                                     NewCompressor(compressor));
+                                     CompressorFactory(compressor));
     not_null<serialization::Plugin*> const message =
         Arena::CreateMessage<serialization::Plugin>(arena);
     plugin->WriteToMessage(message);
@@ -1081,6 +1115,8 @@ char const* __cdecl principia__SerializePlugin(
   if (bytes.size == 0) {
     LOG(INFO) << "End plugin serialization";
     TakeOwnership(serializer);
+    LOG(INFO) << "Serialization used " << arena->SpaceAllocated()
+              << " bytes of arena";
     arena->Reset();
     return m.Return(nullptr);
   }
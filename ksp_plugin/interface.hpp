@@ -81,6 +81,9 @@ void __cdecl principia__ActivatePlayer();
 extern "C" PRINCIPIA_DLL
 void __cdecl principia__ActivateRecorder(bool activate);
 
+extern "C" PRINCIPIA_DLL
+void __cdecl principia__DumpLatencies();
+
 extern "C" PRINCIPIA_DLL
 void __cdecl principia__InitGoogleLogging();
 
@@ -1,6 +1,7 @@
 ﻿
 #include "ksp_plugin/interface.hpp"
 
+#include <limits>
 #include <vector>
 
 #include "geometry/rp2_point.hpp"
@@ -39,6 +40,58 @@ void __cdecl principia__IteratorDelete(Iterator** const iterator) {
   return m.Return();
 }
 
+int __cdecl principia__IteratorFillDiscreteTrajectoryXYZ(
+    Iterator const* const iterator,
+    XYZ* const xyz,
+    int const capacity) {
+  journal::Method<journal::IteratorFillDiscreteTrajectoryXYZ> m(
+      {iterator, xyz, capacity});
+  CHECK_NOTNULL(iterator);
+  CHECK_LE(0, capacity);
+  auto const typed_iterator = check_not_null(
+      dynamic_cast<TypedIterator<DiscreteTrajectory<World>> const*>(iterator));
+  int size = 0;
+  typed_iterator->ForEach(
+      [capacity, xyz, &size](
+          DiscreteTrajectory<World>::Iterator const& iterator) {
+        if (size < capacity) {
+          xyz[size] = ToXYZ(iterator->degrees_of_freedom.position());
+        }
+        ++size;
+      });
+  return m.Return(size);
+}
+
+int __cdecl principia__IteratorFillRP2LinesXY(Iterator const* const iterator,
+                                              XY* const xy,
+                                              int const capacity) {
+  journal::Method<journal::IteratorFillRP2LinesXY> m({iterator, xy, capacity});
+  CHECK_NOTNULL(iterator);
+  CHECK_LE(0, capacity);
+  auto const typed_iterator = check_not_null(
+      dynamic_cast<TypedIterator<RP2Lines<Length, Camera>> const*>(iterator));
+  int size = 0;
+  auto const append = [capacity, xy, &size](XY const& point) {
+    if (size < capacity) {
+      xy[size] = point;
+    }
+    ++size;
+  };
+  bool first_line = true;
+  typed_iterator->ForEach(
+      [&append, &first_line](RP2Line<Length, Camera> const& rp2_line) {
+        if (!first_line) {
+          append(XY{std::numeric_limits<double>::quiet_NaN(),
+                    std::numeric_limits<double>::quiet_NaN()});
+        }
+        first_line = false;
+        for (auto const& rp2_point : rp2_line) {
+          append(ToXY(rp2_point));
+        }
+      });
+  return m.Return(size);
+}
+
 QP __cdecl principia__IteratorGetDiscreteTrajectoryQP(
     Iterator const* const iterator) {
   journal::Method<journal::IteratorGetDiscreteTrajectoryQP> m({iterator});
@@ -88,6 +141,19 @@ Iterator* __cdecl principia__IteratorGetRP2LinesIterator(
       }));
 }
 
+Iterator* __cdecl principia__IteratorGetRP2LinesListIterator(
+    Iterator const* const iterator) {
+  journal::Method<journal::IteratorGetRP2LinesListIterator> m({iterator});
+  CHECK_NOTNULL(iterator);
+  auto const typed_iterator = check_not_null(
+      dynamic_cast<TypedIterator<std::vector<RP2Lines<Length, Camera>>> const*>(
+          iterator));
+  return m.Return(typed_iterator->Get<Iterator*>(
+      [](RP2Lines<Length, Camera> const& rp2_lines) -> Iterator* {
+        return new TypedIterator<RP2Lines<Length, Camera>>(rp2_lines);
+      }));
+}
+
 XY __cdecl principia__IteratorGetRP2LineXY(Iterator const* const iterator) {
   journal::Method<journal::IteratorGetRP2LineXY> m({iterator});
   CHECK_NOTNULL(iterator);
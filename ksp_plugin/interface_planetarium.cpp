@@ -2,6 +2,9 @@
 #include "ksp_plugin/interface.hpp"
 
 #include <algorithm>
+#include <optional>
+#include <utility>
+#include <vector>
 
 #include "geometry/affine_map.hpp"
 #include "geometry/grassmann.hpp"
@@ -65,6 +68,16 @@ RP2Lines<Length, Camera> PlotMethodN(
   }
 }
 
+// The furthest of the final time of the prediction or that of the flight plan
+// of |vessel|.
+Instant FinalTimeOfPredictionOrFlightPlan(Vessel const& vessel) {
+  Instant const prediction_final_time = vessel.prediction().t_max();
+  return vessel.has_flight_plan()
+             ? std::max(vessel.flight_plan().actual_final_time(),
+                        prediction_final_time)
+             : prediction_final_time;
+}
+
 }  // namespace
 
 Planetarium* __cdecl principia__PlanetariumCreate(
@@ -273,13 +286,8 @@ principia__PlanetariumPlotCelestialTrajectoryForPredictionOrFlightPlan(
   if (plugin->renderer().HasTargetVessel()) {
     return m.Return(new TypedIterator<RP2Lines<Length, Camera>>({}));
   } else {
-    auto const& vessel = *plugin->GetVessel(vessel_guid);
-    Instant const prediction_final_time = vessel.prediction().t_max();
     Instant const final_time =
-        vessel.has_flight_plan()
-            ? std::max(vessel.flight_plan().actual_final_time(),
-                       prediction_final_time)
-            : prediction_final_time;
+        FinalTimeOfPredictionOrFlightPlan(*plugin->GetVessel(vessel_guid));
     auto const& celestial_trajectory =
         plugin->GetCelestial(celestial_index).trajectory();
     auto const rp2_lines =
@@ -292,5 +300,69 @@ principia__PlanetariumPlotCelestialTrajectoryForPredictionOrFlightPlan(
   }
 }
 
+// Returns an iterator over the rendered trajectories of the celestials whose
+// character in |plotted_celestials| is '1', by increasing index; the character
+// at position i corresponds to the celestial of index i, and the celestials
+// beyond the end of the string are not plotted.  For each plotted celestial,
+// the iterator has the past trajectory, as returned by
+// |PlanetariumPlotCelestialTrajectoryForPsychohistory|, followed, if
+// |vessel_guid| is not null, by the future trajectory, as returned by
+// |PlanetariumPlotCelestialTrajectoryForPredictionOrFlightPlan|.  The
+// trajectories are plotted in parallel.
+Iterator* __cdecl principia__PlanetariumPlotCelestialTrajectories(
+    Planetarium const* const planetarium,
+    Plugin const* const plugin,
+    char const* const plotted_celestials,
+    char const* const vessel_guid,
+    double const max_history_length) {
+  journal::Method<journal::PlanetariumPlotCelestialTrajectories> m(
+      {planetarium, plugin, plotted_celestials, vessel_guid,
+       max_history_length});
+  CHECK_NOTNULL(plugin);
+  CHECK_NOTNULL(planetarium);
+  CHECK_NOTNULL(plotted_celestials);
+
+  Instant const now = plugin->CurrentTime();
+  std::optional<Instant> final_time;
+  if (vessel_guid != nullptr) {
+    final_time =
+        FinalTimeOfPredictionOrFlightPlan(*plugin->GetVessel(vessel_guid));
+  }
+  std::vector<Planetarium::PlottingRequest> requests;
+  for (int celestial_index = 0;
+       plotted_celestials[celestial_index] != '\0';
+       ++celestial_index) {
+    if (plotted_celestials[celestial_index] != '1') {
+      continue;
+    }
+    auto const& celestial_trajectory =
+        plugin->GetCelestial(celestial_index).trajectory();
+    requests.push_back(
+        {&celestial_trajectory,
+         /*first_time=*/std::max(now - max_history_length * Second,
+                                 celestial_trajectory.t_min()),
+         /*last_time=*/now,
+         /*reverse=*/true});
+    if (final_time.has_value()) {
+      requests.push_back({&celestial_trajectory,
+                          /*first_time=*/now,
+                          /*last_time=*/*final_time,
+                          /*reverse=*/false});
+    }
+  }
+
+  // Do not plot the trajectories when there is a target vessel as it is
+  // misleading.
+  std::vector<RP2Lines<Length, Camera>> rp2_lines_list;
+  if (plugin->renderer().HasTargetVessel()) {
+    rp2_lines_list.resize(requests.size());
+  } else {
+    rp2_lines_list = planetarium->PlotMethod2(requests, now);
+  }
+  return m.Return(
+      new TypedIterator<std::vector<RP2Lines<Length, Camera>>>(
+          std::move(rp2_lines_list)));
+}
+
 }  // namespace interface
 }  // namespace principia
@@ -37,6 +37,12 @@ class TypedIterator : public Iterator {
       std::function<Interchange(typename Container::value_type const&)> const&
           convert) const;
 
+  // Applies |action| to the elements from the one denoted by this iterator to
+  // the end of the container.  Does not move this iterator.
+  void ForEach(
+      std::function<void(typename Container::value_type const&)> const& action)
+      const;
+
   bool AtEnd() const override;
   void Increment() override;
   void Reset() override;
@@ -61,6 +67,12 @@ class TypedIterator<DiscreteTrajectory<World>> : public Iterator {
       std::function<Interchange(
           DiscreteTrajectory<World>::Iterator const&)> const& convert) const;
 
+  // Applies |action| to the points from the one denoted by this iterator to the
+  // end of the trajectory.  Does not move this iterator.
+  void ForEach(
+      std::function<void(DiscreteTrajectory<World>::Iterator const&)> const&
+          action) const;
+
   bool AtEnd() const override;
   void Increment() override;
   void Reset() override;
@@ -22,6 +22,15 @@ Interchange TypedIterator<Container>::Get(
   return convert(*iterator_);
 }
 
+template<typename Container>
+void TypedIterator<Container>::ForEach(
+    std::function<void(typename Container::value_type const&)> const& action)
+    const {
+  for (auto it = iterator_; it != container_.end(); ++it) {
+    action(*it);
+  }
+}
+
 template<typename Container>
 bool TypedIterator<Container>::AtEnd() const {
   return iterator_ == container_.end();
@@ -59,6 +68,14 @@ Interchange TypedIterator<DiscreteTrajectory<World>>::Get(
   return convert(iterator_);
 }
 
+inline void TypedIterator<DiscreteTrajectory<World>>::ForEach(
+    std::function<void(DiscreteTrajectory<World>::Iterator const&)> const&
+        action) const {
+  for (auto it = iterator_; it != trajectory_->end(); ++it) {
+    action(it);
+  }
+}
+
 inline bool TypedIterator<DiscreteTrajectory<World>>::AtEnd() const {
   return iterator_ == trajectory_->end();
 }
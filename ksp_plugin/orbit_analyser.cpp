@@ -14,7 +14,6 @@ namespace ksp_plugin {
 namespace internal_orbit_analyser {
 
 using base::dynamic_cast_not_null;
-using base::MakeStoppableThread;
 using geometry::Frame;
 using geometry::NonRotating;
 using physics::BodyCentredNonRotatingDynamicFrame;
@@ -31,22 +30,33 @@ OrbitAnalyser::OrbitAnalyser(
       analysed_trajectory_parameters_(
           std::move(analysed_trajectory_parameters)) {}
 
+OrbitAnalyser::~OrbitAnalyser() {
+  PredictionScheduler::Default().Cancel(this);
+}
+
 void OrbitAnalyser::Restart() {
-  analyser_ = MakeStoppableThread([this] { RepeatedlyAnalyseOrbit(); });
+  PredictionScheduler::Default().Cancel(this);
 }
 
-void OrbitAnalyser::RequestAnalysis(Parameters const& parameters) {
-  if (!analyser_.joinable()) {
-    analyser_ = MakeStoppableThread([this] { RepeatedlyAnalyseOrbit(); });
-  }
+void OrbitAnalyser::RequestAnalysis(
+    Parameters const& parameters,
+    PredictionScheduler::Priority const priority) {
   Ephemeris<Barycentric>::Guard guard(ephemeris_);
   if (ephemeris_->t_min() > parameters.first_time) {
     // Too much has been forgotten; we cannot perform this analysis.
     return;
   }
   last_parameters_ = parameters;
-  absl::MutexLock l(&lock_);
-  guarded_parameters_ = {std::move(guard), parameters};
+  {
+    absl::MutexLock l(&lock_);
+    guarded_parameters_ = {std::move(guard), parameters};
+  }
+  PredictionScheduler::Default().Schedule(
+      this, priority, [this]() { AnalyseOrbit(); });
+}
+
+void OrbitAnalyser::SetPriority(PredictionScheduler::Priority const priority) {
+  PredictionScheduler::Default().SetPriority(this, priority);
 }
 
 std::optional<OrbitAnalyser::Parameters> const& OrbitAnalyser::last_parameters()
@@ -70,118 +80,108 @@ double OrbitAnalyser::progress_of_next_analysis() const {
   return progress_of_next_analysis_;
 }
 
-Status OrbitAnalyser::RepeatedlyAnalyseOrbit() {
-  for (;;) {
-    // No point in going faster than 50 Hz.
-    std::chrono::steady_clock::time_point const wakeup_time =
-        std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
-
-    RETURN_IF_STOPPED;
-
-    std::optional<GuardedParameters> guarded_parameters;
-    {
-      absl::MutexLock l(&lock_);
-      if (!guarded_parameters_.has_value()) {
-        // No parameters, let's wait for them to appear.
-        continue;
-      }
-      std::swap(guarded_parameters, guarded_parameters_);
+Status OrbitAnalyser::AnalyseOrbit() {
+  std::optional<GuardedParameters> guarded_parameters;
+  {
+    absl::MutexLock l(&lock_);
+    if (!guarded_parameters_.has_value()) {
+      // The parameters were picked by a previous task.
+      return Status::OK;
     }
+    std::swap(guarded_parameters, guarded_parameters_);
+  }
 
-    auto const& parameters = guarded_parameters->parameters;
-
-    Analysis analysis{parameters.first_time};
-    DiscreteTrajectory<Barycentric> trajectory;
-    trajectory.Append(parameters.first_time,
-                      parameters.first_degrees_of_freedom);
-    std::vector<not_null<DiscreteTrajectory<Barycentric>*>> trajectories = {
-        &trajectory};
-    auto instance = ephemeris_->NewInstance(
-        trajectories,
-        Ephemeris<Barycentric>::NoIntrinsicAccelerations,
-        analysed_trajectory_parameters_);
-    for (Instant t =
-             parameters.first_time + parameters.mission_duration / 0x1p10;
-         trajectory.back().time <
-         parameters.first_time + parameters.mission_duration;
-         t += parameters.mission_duration / 0x1p10) {
-      if (!ephemeris_->FlowWithFixedStep(t, *instance).ok()) {
-        // TODO(egg): Report that the integration failed.
-        break;
-      }
-      progress_of_next_analysis_ =
-          (trajectory.back().time - parameters.first_time) /
-          parameters.mission_duration;
-      RETURN_IF_STOPPED;
+  auto const& parameters = guarded_parameters->parameters;
+
+  Analysis analysis{parameters.first_time};
+  DiscreteTrajectory<Barycentric> trajectory;
+  trajectory.Append(parameters.first_time,
+                    parameters.first_degrees_of_freedom);
+  std::vector<not_null<DiscreteTrajectory<Barycentric>*>> trajectories = {
+      &trajectory};
+  auto instance = ephemeris_->NewInstance(
+      trajectories,
+      Ephemeris<Barycentric>::NoIntrinsicAccelerations,
+      analysed_trajectory_parameters_);
+  for (Instant t =
+           parameters.first_time + parameters.mission_duration / 0x1p10;
+       trajectory.back().time <
+       parameters.first_time + parameters.mission_duration;
+       t += parameters.mission_duration / 0x1p10) {
+    if (!ephemeris_->FlowWithFixedStep(t, *instance).ok()) {
+      // TODO(egg): Report that the integration failed.
+      break;
     }
-    analysis.mission_duration_ =
-        trajectory.back().time - parameters.first_time;
+    progress_of_next_analysis_ =
+        (trajectory.back().time - parameters.first_time) /
+        parameters.mission_duration;
+    RETURN_IF_STOPPED;
+  }
+  analysis.mission_duration_ = trajectory.back().time - parameters.first_time;
 
-    // TODO(egg): |next_analysis_percentage_| only reflects the progress of the
-    // integration, but the analysis itself can take a while; this results in
-    // the progress bar being stuck at 100% while the elements and nodes are
-    // being computed.
+  // TODO(egg): |next_analysis_percentage_| only reflects the progress of the
+  // integration, but the analysis itself can take a while; this results in
+  // the progress bar being stuck at 100% while the elements and nodes are
+  // being computed.
 
-    RotatingBody<Barycentric> const* primary = nullptr;
-    auto smallest_osculating_period = Infinity<Time>;
-    for (auto const body : ephemeris_->bodies()) {
-      RETURN_IF_STOPPED;
-      auto const initial_osculating_elements =
-          KeplerOrbit<Barycentric>{
-              *body,
-              MasslessBody{},
-              parameters.first_degrees_of_freedom -
-                  ephemeris_->trajectory(body)->EvaluateDegreesOfFreedom(
-                      parameters.first_time),
-              parameters.first_time}.elements_at_epoch();
-      if (initial_osculating_elements.period.has_value() &&
-          initial_osculating_elements.period < smallest_osculating_period) {
-        smallest_osculating_period = *initial_osculating_elements.period;
-        primary = dynamic_cast_not_null<RotatingBody<Barycentric> const*>(body);
-      }
+  RotatingBody<Barycentric> const* primary = nullptr;
+  auto smallest_osculating_period = Infinity<Time>;
+  for (auto const body : ephemeris_->bodies()) {
+    RETURN_IF_STOPPED;
+    auto const initial_osculating_elements =
+        KeplerOrbit<Barycentric>{
+            *body,
+            MasslessBody{},
+            parameters.first_degrees_of_freedom -
+                ephemeris_->trajectory(body)->EvaluateDegreesOfFreedom(
+                    parameters.first_time),
+            parameters.first_time}.elements_at_epoch();
+    if (initial_osculating_elements.period.has_value() &&
+        initial_osculating_elements.period < smallest_osculating_period) {
+      smallest_osculating_period = *initial_osculating_elements.period;
+      primary = dynamic_cast_not_null<RotatingBody<Barycentric> const*>(body);
     }
-    if (primary != nullptr) {
-      using PrimaryCentred = Frame<enum class PrimaryCentredTag, NonRotating>;
-      DiscreteTrajectory<PrimaryCentred> primary_centred_trajectory;
-      BodyCentredNonRotatingDynamicFrame<Barycentric, PrimaryCentred>
-          body_centred(ephemeris_, primary);
-      for (auto const& [time, degrees_of_freedom] : trajectory) {
-        RETURN_IF_STOPPED;
-        primary_centred_trajectory.Append(
-            time, body_centred.ToThisFrameAtTime(time)(degrees_of_freedom));
-      }
-      analysis.primary_ = primary;
-      auto elements = OrbitalElements::ForTrajectory(
-          primary_centred_trajectory, *primary, MasslessBody{});
-      // We do not RETURN_IF_ERROR as ForTrajectory can return non-CANCELLED
-      // statuses.
+  }
+  if (primary != nullptr) {
+    using PrimaryCentred = Frame<enum class PrimaryCentredTag, NonRotating>;
+    DiscreteTrajectory<PrimaryCentred> primary_centred_trajectory;
+    BodyCentredNonRotatingDynamicFrame<Barycentric, PrimaryCentred>
+        body_centred(ephemeris_, primary);
+    for (auto const& [time, degrees_of_freedom] : trajectory) {
       RETURN_IF_STOPPED;
-      if (elements.ok()) {
-        analysis.elements_ = std::move(elements).ValueOrDie();
-        // TODO(egg): max_abs_Cᴛₒ should probably depend on the number of
-        // revolutions.
-        analysis.closest_recurrence_ = OrbitRecurrence::ClosestRecurrence(
-            analysis.elements_->nodal_period(),
-            analysis.elements_->nodal_precession(),
-            *primary,
-            /*max_abs_Cᴛₒ=*/100);
-        auto ground_track =
-            OrbitGroundTrack::ForTrajectory(primary_centred_trajectory,
-                                            *primary,
-                                            /*mean_sun=*/std::nullopt);
-        RETURN_IF_ERROR(ground_track);
-        analysis.ground_track_ = std::move(ground_track).ValueOrDie();
-        analysis.ResetRecurrence();
-      }
+      primary_centred_trajectory.Append(
+          time, body_centred.ToThisFrameAtTime(time)(degrees_of_freedom));
     }
-
-    {
-      absl::MutexLock l(&lock_);
-      next_analysis_ = std::move(analysis);
+    analysis.primary_ = primary;
+    auto elements = OrbitalElements::ForTrajectory(
+        primary_centred_trajectory, *primary, MasslessBody{});
+    // We do not RETURN_IF_ERROR as ForTrajectory can return non-CANCELLED
+    // statuses.
+    RETURN_IF_STOPPED;
+    if (elements.ok()) {
+      analysis.elements_ = std::move(elements).ValueOrDie();
+      // TODO(egg): max_abs_Cᴛₒ should probably depend on the number of
+      // revolutions.
+      analysis.closest_recurrence_ = OrbitRecurrence::ClosestRecurrence(
+          analysis.elements_->nodal_period(),
+          analysis.elements_->nodal_precession(),
+          *primary,
+          /*max_abs_Cᴛₒ=*/100);
+      auto ground_track =
+          OrbitGroundTrack::ForTrajectory(primary_centred_trajectory,
+                                          *primary,
+                                          /*mean_sun=*/std::nullopt);
+      RETURN_IF_ERROR(ground_track);
+      analysis.ground_track_ = std::move(ground_track).ValueOrDie();
+      analysis.ResetRecurrence();
     }
+  }
 
-    std::this_thread::sleep_until(wakeup_time);
+  {
+    absl::MutexLock l(&lock_);
+    next_analysis_ = std::move(analysis);
   }
+  return Status::OK;
 }
 
 Instant const& OrbitAnalyser::Analysis::first_time() const {
@@ -2,16 +2,15 @@
 
 #include <atomic>
 #include <optional>
-#include <thread>
 
 #include "absl/synchronization/mutex.h"
 #include "astronomy/orbit_ground_track.hpp"
 #include "astronomy/orbit_recurrence.hpp"
 #include "astronomy/orbital_elements.hpp"
-#include "base/jthread.hpp"
 #include "base/not_null.hpp"
 #include "geometry/named_quantities.hpp"
 #include "ksp_plugin/frames.hpp"
+#include "ksp_plugin/prediction_scheduler.hpp"
 #include "physics/degrees_of_freedom.hpp"
 #include "physics/ephemeris.hpp"
 #include "physics/rotating_body.hpp"
@@ -24,7 +23,6 @@ namespace internal_orbit_analyser {
 using astronomy::OrbitalElements;
 using astronomy::OrbitGroundTrack;
 using astronomy::OrbitRecurrence;
-using base::jthread;
 using base::not_null;
 using base::Status;
 using geometry::Instant;
@@ -95,13 +93,21 @@ class OrbitAnalyser {
                 Ephemeris<Barycentric>::FixedStepParameters
                     analysed_trajectory_parameters);
 
+  // Cancels any computation in progress.
+  ~OrbitAnalyser();
+
   // Cancel any computation in progress, causing the next call to
   // |RequestAnalysis| to be processed as fast as possible.
   void Restart();
 
   // Sets the parameters that will be used for the computation of the next
-  // analysis.
-  void RequestAnalysis(Parameters const& parameters);
+  // analysis, which is run by the |PredictionScheduler| with the given
+  // |priority|.
+  void RequestAnalysis(Parameters const& parameters,
+                       PredictionScheduler::Priority priority);
+
+  // Changes the priority of the analysis requested but not yet started, if any.
+  void SetPriority(PredictionScheduler::Priority priority);
 
   // The last value passed to |RequestAnalysis|.
   std::optional<Parameters> const& last_parameters() const;
@@ -123,7 +129,9 @@ class OrbitAnalyser {
     Parameters parameters;
   };
 
-  Status RepeatedlyAnalyseOrbit();
+  // Run by the |PredictionScheduler| to compute an analysis for the latest
+  // |guarded_parameters_|, if any.
+  Status AnalyseOrbit();
 
   not_null<Ephemeris<Barycentric>*> const ephemeris_;
   Ephemeris<Barycentric>::FixedStepParameters const
@@ -134,15 +142,14 @@ class OrbitAnalyser {
   std::optional<Analysis> analysis_;
 
   mutable absl::Mutex lock_;
-  jthread analyser_;
-  // |parameters_| is set by the main thread; it is read and cleared by the
-  // |analyser_| thread.
+  // |parameters_| is set by the main thread; it is read and cleared by
+  // |AnalyseOrbit|.
   std::optional<GuardedParameters> guarded_parameters_ GUARDED_BY(lock_);
-  // |next_analysis_| is set by the |analyser_| thread; it is read and cleared
-  // by the main thread.
+  // |next_analysis_| is set by |AnalyseOrbit|; it is read and cleared by the
+  // main thread.
   std::optional<Analysis> next_analysis_ GUARDED_BY(lock_);
-  // |progress_of_next_analysis_| is set by the |analyser_| thread; it tracks
-  // progress in computing |next_analysis_|.
+  // |progress_of_next_analysis_| is set by |AnalyseOrbit|; it tracks progress
+  // in computing |next_analysis_|.
   std::atomic<double> progress_of_next_analysis_ = 0;
 };
 
@@ -3,10 +3,13 @@
 
 #include <algorithm>
 #include <functional>
+#include <iterator>
 #include <list>
 #include <map>
 #include <memory>
+#include <optional>
 #include <utility>
+#include <vector>
 
 #include "base/map_util.hpp"
 #include "geometry/identity.hpp"
@@ -104,6 +107,14 @@ PileUp::PileUp(
 
 PileUp::~PileUp() {
   LOG(INFO) << "Destroying pile up at " << this;
+  PileUpBatch* batch;
+  {
+    absl::MutexLock l(lock_.get());
+    batch = batch_;
+  }
+  if (batch != nullptr) {
+    batch->Remove(this);
+  }
   if (deletion_callback_ != nullptr) {
     deletion_callback_();
   }
@@ -123,9 +134,23 @@ void PileUp::SetPartApparentRigidMotion(
 }
 
 Status PileUp::DeformAndAdvanceTime(Instant const& t) {
+  // If the |history_| is going to be advanced individually, this pile-up
+  // leaves its batch.  This must be done without holding the lock, see the
+  // lock order of |PileUpBatch|.
+  PileUpBatch* batch = nullptr;
+  {
+    absl::MutexLock l(lock_.get());
+    if (!history_advanced_by_batch_) {
+      batch = batch_;
+    }
+  }
+  if (batch != nullptr) {
+    batch->Remove(this);
+  }
   absl::MutexLock l(lock_.get());
   Status status;
-  if (psychohistory_->back().time < t) {
+  if (psychohistory_->back().time < t ||
+      history_last_before_batch_.has_value()) {
     DeformPileUpIfNeeded(t);
     status = AdvanceTime(t);
     NudgeParts();
@@ -535,18 +560,25 @@ Status PileUp::AdvanceTime(Instant const& t) {
   CHECK_NOTNULL(psychohistory_);
 
   Status status;
-  auto const history_last = --history_->end();
+  // If a batch advanced the |history_|, the points that it appended must be
+  // appended to the parts too.
+  auto const history_last =
+      history_last_before_batch_.value_or(--history_->end());
+  history_last_before_batch_.reset();
+  bool const history_advanced_by_batch = history_advanced_by_batch_;
+  history_advanced_by_batch_ = false;
   if (intrinsic_force_ == Vector<Force, Barycentric>{}) {
     // Remove the fork.
     history_->DeleteFork(psychohistory_);
-    if (fixed_instance_ == nullptr) {
-      fixed_instance_ = ephemeris_->NewInstance(
-          {history_.get()},
-          Ephemeris<Barycentric>::NoIntrinsicAccelerations,
-          fixed_step_parameters_);
+    if (!history_advanced_by_batch && history_->back().time < t) {
+      if (fixed_instance_ == nullptr) {
+        fixed_instance_ = ephemeris_->NewInstance(
+            {history_.get()},
+            Ephemeris<Barycentric>::NoIntrinsicAccelerations,
+            fixed_step_parameters_);
+      }
+      status = ephemeris_->FlowWithFixedStep(t, *fixed_instance_);
     }
-    CHECK_LT(history_->back().time, t);
-    status = ephemeris_->FlowWithFixedStep(t, *fixed_instance_);
     psychohistory_ = history_->NewForkAtLast();
     if (history_->back().time < t) {
       // Do not clear the |fixed_instance_| here, we will use it for the next
@@ -648,6 +680,233 @@ void PileUp::AppendToPart(DiscreteTrajectory<Barycentric>::Iterator it) const {
   }
 }
 
+PileUpBatch::PileUpBatch(
+    Ephemeris<Barycentric>::FixedStepParameters parameters,
+    not_null<Ephemeris<Barycentric>*> const ephemeris)
+    : parameters_(std::move(parameters)),
+      ephemeris_(ephemeris) {}
+
+PileUpBatch::~PileUpBatch() {
+  absl::MutexLock l(&lock_);
+  Reset();
+}
+
+std::vector<not_null<PileUp*>> PileUpBatch::Select(
+    std::list<PileUp*> const& pile_ups,
+    Instant const& t) {
+  absl::MutexLock l(&lock_);
+  selected_.clear();
+  for (PileUp* const pile_up : pile_ups) {
+    absl::MutexLock l(pile_up->lock_.get());
+    // A pile-up that is going to be deformed is not selected, as its
+    // deformation is computed at the end of its psychohistory, which the batch
+    // would move.
+    if (pile_up->intrinsic_force_ == Vector<Force, Barycentric>{} &&
+        pile_up->apparent_part_rigid_motion_.empty() &&
+        &pile_up->fixed_step_parameters_.integrator() ==
+            &parameters_.integrator() &&
+        pile_up->fixed_step_parameters_.step() == parameters_.step() &&
+        pile_up->psychohistory_->back().time < t) {
+      selected_.push_back(pile_up);
+    }
+  }
+  // The members that were not selected may be advanced concurrently with
+  // |AdvanceHistories|, so they must be detached now.
+  auto const not_selected = [this](not_null<PileUp*> const pile_up) {
+    return std::find(selected_.begin(), selected_.end(), pile_up) ==
+           selected_.end();
+  };
+  std::vector<not_null<PileUp*>> leaving;
+  std::copy_if(members_.begin(),
+               members_.end(),
+               std::back_inserter(leaving),
+               not_selected);
+  if (!leaving.empty()) {
+    Detach(leaving);
+  }
+  return selected_;
+}
+
+void PileUpBatch::AdvanceHistories(Instant const& t) {
+  absl::MutexLock l(&lock_);
+  std::vector<not_null<PileUp*>> newcomers;
+  for (not_null<PileUp*> const pile_up : selected_) {
+    absl::MutexLock l(pile_up->lock_.get());
+    pile_up->history_->DeleteFork(pile_up->psychohistory_);
+    pile_up->history_last_before_batch_ = --pile_up->history_->end();
+    if (pile_up->batch_ != this) {
+      newcomers.push_back(pile_up);
+    }
+  }
+
+  // At this point the |members_| are all selected, so they are not being
+  // advanced concurrently, and their histories are aligned.
+  if (!newcomers.empty()) {
+    AddNewcomers(newcomers, t);
+  }
+
+  if (instance_ != nullptr) {
+    Status const status = ephemeris_->FlowWithFixedStep(t, *instance_);
+    if (status.ok()) {
+      for (not_null<PileUp*> const pile_up : members_) {
+        absl::MutexLock l(pile_up->lock_.get());
+        pile_up->history_advanced_by_batch_ = true;
+      }
+    } else {
+      LOG(WARNING) << "Batch integration of " << members_.size()
+                   << " pile-ups failed: " << status.ToString();
+      Reset();
+    }
+  }
+
+  for (not_null<PileUp*> const pile_up : selected_) {
+    absl::MutexLock l(pile_up->lock_.get());
+    pile_up->psychohistory_ = pile_up->history_->NewForkAtLast();
+  }
+  selected_.clear();
+}
+
+void PileUpBatch::Remove(not_null<PileUp*> const pile_up) {
+  absl::MutexLock l(&lock_);
+  selected_.erase(std::remove(selected_.begin(), selected_.end(), pile_up),
+                  selected_.end());
+  if (std::find(members_.begin(), members_.end(), pile_up) != members_.end()) {
+    Detach({pile_up});
+  }
+}
+
+void PileUpBatch::AddNewcomers(
+    std::vector<not_null<PileUp*>> const& newcomers,
+    Instant const& t) {
+  Instant alignment_time = newcomers.front()->history_->back().time;
+  for (not_null<PileUp*> const pile_up : newcomers) {
+    alignment_time = std::max(alignment_time, pile_up->history_->back().time);
+  }
+  if (!members_.empty()) {
+    // The members are advanced by whole steps until they reach the newcomers,
+    // so that their histories keep being integrated with a fixed step.  If
+    // that would go beyond |t|, the newcomers join at a later time.
+    auto const& history = members_.front()->history_;
+    while (history->back().time < alignment_time) {
+      Instant const members_time = history->back().time;
+      Status const status = ephemeris_->FlowWithFixedStep(
+          std::min(t, members_time + 1.5 * parameters_.step()), *instance_);
+      if (!status.ok()) {
+        LOG(WARNING) << "Batch integration of " << members_.size()
+                     << " pile-ups failed: " << status.ToString();
+        Reset();
+        return;
+      }
+      if (history->back().time == members_time) {
+        return;
+      }
+    }
+    alignment_time = history->back().time;
+  }
+
+  std::vector<not_null<PileUp*>> joining;
+  for (not_null<PileUp*> const pile_up : newcomers) {
+    absl::MutexLock l(pile_up->lock_.get());
+    auto const& history = pile_up->history_;
+    // A newcomer that is integrated by its own instance at the alignment time
+    // keeps it, as it may be in sync with the |instance_|.  The others are
+    // flowed to the alignment time and get a new instance there.  Those that
+    // fail to reach it are left out of the batch.
+    if (pile_up->fixed_instance_ == nullptr ||
+        history->back().time != alignment_time) {
+      if (history->back().time < alignment_time) {
+        Status const status = ephemeris_->FlowWithAdaptiveStep(
+            history.get(),
+            Ephemeris<Barycentric>::NoIntrinsicAcceleration,
+            alignment_time,
+            pile_up->adaptive_step_parameters_,
+            Ephemeris<Barycentric>::unlimited_max_ephemeris_steps);
+        if (!status.ok()) {
+          continue;
+        }
+      }
+      if (history->back().time != alignment_time) {
+        continue;
+      }
+      pile_up->fixed_instance_ = ephemeris_->NewInstance(
+          {history.get()},
+          Ephemeris<Barycentric>::NoIntrinsicAccelerations,
+          parameters_);
+    }
+
+    if (members_.empty()) {
+      instance_ = std::move(pile_up->fixed_instance_);
+      pile_up->batch_ = this;
+      members_.push_back(pile_up);
+    } else {
+      // Whether the newcomer is in sync with the members is checked on an
+      // instance for two trajectories, so that the |instance_| is recombined
+      // only once for all the newcomers.  A newcomer that is not in sync, e.g.,
+      // because its integrator is still starting up, is advanced individually
+      // by |PileUp::DeformAndAdvanceTime| and joins at a later time.
+      if (ephemeris_->RecombineInstances(
+              {members_.front()->history_.get(), history.get()},
+              {{instance_.get(), 0}, {pile_up->fixed_instance_.get(), 0}}) !=
+          nullptr) {
+        joining.push_back(pile_up);
+      }
+    }
+  }
+
+  if (!joining.empty()) {
+    std::vector<not_null<DiscreteTrajectory<Barycentric>*>> histories;
+    std::vector<Ephemeris<Barycentric>::InstanceState> states;
+    for (int i = 0; i < members_.size(); ++i) {
+      histories.push_back(members_[i]->history_.get());
+      states.emplace_back(instance_.get(), i);
+    }
+    for (not_null<PileUp*> const pile_up : joining) {
+      histories.push_back(pile_up->history_.get());
+      states.emplace_back(pile_up->fixed_instance_.get(), 0);
+    }
+    instance_ = ephemeris_->RecombineInstances(histories, states);
+    CHECK(instance_ != nullptr);
+    for (not_null<PileUp*> const pile_up : joining) {
+      absl::MutexLock l(pile_up->lock_.get());
+      pile_up->fixed_instance_ = nullptr;
+      pile_up->batch_ = this;
+      members_.push_back(pile_up);
+    }
+  }
+}
+
+void PileUpBatch::Detach(std::vector<not_null<PileUp*>> const& leaving) {
+  std::vector<not_null<PileUp*>> staying;
+  std::vector<not_null<DiscreteTrajectory<Barycentric>*>> histories;
+  std::vector<Ephemeris<Barycentric>::InstanceState> states;
+  for (int i = 0; i < members_.size(); ++i) {
+    not_null<PileUp*> const pile_up = members_[i];
+    if (std::find(leaving.begin(), leaving.end(), pile_up) == leaving.end()) {
+      staying.push_back(pile_up);
+      histories.push_back(pile_up->history_.get());
+      states.emplace_back(instance_.get(), i);
+    } else {
+      absl::MutexLock l(pile_up->lock_.get());
+      pile_up->fixed_instance_ = ephemeris_->RecombineInstances(
+          {pile_up->history_.get()}, {{instance_.get(), i}});
+      pile_up->batch_ = nullptr;
+    }
+  }
+  instance_ = staying.empty()
+                  ? nullptr
+                  : ephemeris_->RecombineInstances(histories, states);
+  members_ = std::move(staying);
+}
+
+void PileUpBatch::Reset() {
+  for (not_null<PileUp*> const pile_up : members_) {
+    absl::MutexLock l(pile_up->lock_.get());
+    pile_up->batch_ = nullptr;
+  }
+  members_.clear();
+  instance_ = nullptr;
+}
+
 PileUpFuture::PileUpFuture(not_null<PileUp const*> const pile_up,
                            std::future<Status> future)
     : pile_up(pile_up),
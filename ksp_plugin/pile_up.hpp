@@ -8,8 +8,10 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/synchronization/mutex.h"
+#include "base/macros.hpp"
 #include "base/not_null.hpp"
 #include "base/status.hpp"
 #include "geometry/frame.hpp"
@@ -86,6 +88,8 @@ using PileUpPrincipalAxes = Frame<serialization::Frame::PluginTag,
                                   Handedness::Right,
                                   serialization::Frame::PILE_UP_PRINCIPAL_AXES>;
 
+class PileUpBatch;
+
 // A |PileUp| handles a connected component of the graph of |Parts| under
 // physical contact.  It advances the history and psychohistory of its component
 // |Parts|, modeling them as a massless body at their centre of mass.
@@ -115,9 +119,10 @@ class PileUp {
       RigidMotion<RigidPart, Apparent> const& rigid_motion);
 
   // Deforms the pile-up, advances the time, and nudges the parts, in sequence.
-  // Does nothing if the psychohistory is already advanced beyond |t|.  Several
-  // executions of this method may happen concurrently on multiple threads, but
-  // not concurrently with any other method of this class.
+  // Does nothing if the psychohistory is already advanced beyond |t| and the
+  // history was not advanced by a |PileUpBatch|.  Several executions of this
+  // method may happen concurrently on multiple threads, but not concurrently
+  // with any other method of this class.
   Status DeformAndAdvanceTime(Instant const& t);
 
   // Recomputes the state of motion of the pile-up based on that of its parts.
@@ -228,6 +233,18 @@ class PileUp {
       Ephemeris<Barycentric>::NewtonianMotionEquation>::Instance>
       fixed_instance_;
 
+  // The batch whose instance integrates the |history_| of this pile-up, if
+  // any.  While this pile-up is in a batch, its |fixed_instance_| is null.
+  // Guarded by |lock_|.
+  PileUpBatch* batch_ = nullptr;
+  // Set by |PileUpBatch::AdvanceHistories|: the last point of the |history_|
+  // before the batch advanced it, and whether it was advanced to the last step
+  // before the current time.  The points after |history_last_before_batch_|
+  // still have to be appended to the parts.  Guarded by |lock_|.
+  std::optional<DiscreteTrajectory<Barycentric>::Iterator>
+      history_last_before_batch_;
+  bool history_advanced_by_batch_ = false;
+
   PartTo<RigidMotion<RigidPart, NonRotatingPileUp>> actual_part_rigid_motion_;
   PartTo<RigidMotion<RigidPart, Apparent>> apparent_part_rigid_motion_;
 
@@ -238,9 +255,76 @@ class PileUp {
   // Called in the destructor.
   std::function<void()> deletion_callback_;
 
+  friend class PileUpBatch;
+
   friend class TestablePileUp;
 };
 
+// Integrates together the histories of the pile-ups that have no intrinsic
+// force.  The pile-ups share a single fixed-step instance, so that the
+// celestials are evaluated once per step for all of them instead of once per
+// step for each of them.  The integrator is not restarted when the set of
+// pile-ups changes: a pile-up that leaves the batch gets its own instance with
+// its part of the state of the shared instance, and a pile-up joins the batch
+// once its history is aligned with those of the members and its own instance
+// is in sync with the shared instance.
+// Lock order: the |lock_| of the batch is acquired before the |lock_| of a
+// pile-up, so a pile-up leaves its batch before locking itself.
+class PileUpBatch {
+ public:
+  PileUpBatch(Ephemeris<Barycentric>::FixedStepParameters parameters,
+              not_null<Ephemeris<Barycentric>*> ephemeris);
+
+  ~PileUpBatch();
+
+  // Selects among |pile_ups| the ones that |AdvanceHistories| will advance:
+  // those that have no intrinsic force, that use the fixed-step parameters of
+  // this object, that are not going to be deformed, and whose psychohistory
+  // ends before |t|.  Returns the selected pile-ups.  The selected pile-ups
+  // must not be advanced until |AdvanceHistories| returns, and must then be
+  // advanced by |PileUp::DeformAndAdvanceTime|.
+  std::vector<not_null<PileUp*>> Select(std::list<PileUp*> const& pile_ups,
+                                        Instant const& t) EXCLUDES(lock_);
+
+  // Advances the histories of the selected pile-ups to the last step before
+  // |t|.  If the integration fails, the pile-ups advance their histories
+  // individually in |PileUp::DeformAndAdvanceTime|, so that the failure is
+  // reported for the pile-up that caused it.
+  void AdvanceHistories(Instant const& t) EXCLUDES(lock_);
+
+ private:
+  // Forgets |pile_up|, which is being destroyed or advanced individually.
+  void Remove(not_null<PileUp*> pile_up) EXCLUDES(lock_);
+
+  // Aligns the histories of the |newcomers| with those of the |members_|,
+  // without going beyond |t|, and adds to the |members_| the newcomers whose
+  // instances are in sync with the |instance_|.
+  void AddNewcomers(std::vector<not_null<PileUp*>> const& newcomers,
+                    Instant const& t) REQUIRES(lock_);
+
+  // Removes the |leaving| pile-ups from the |members_| and splits the state of
+  // the |instance_| between them and the remaining members.
+  void Detach(std::vector<not_null<PileUp*>> const& leaving) REQUIRES(lock_);
+
+  // Detaches the |members_| and destroys the |instance_|.
+  void Reset() REQUIRES(lock_);
+
+  Ephemeris<Barycentric>::FixedStepParameters const parameters_;
+  not_null<Ephemeris<Barycentric>*> const ephemeris_;
+
+  absl::Mutex lock_;
+  std::vector<not_null<PileUp*>> selected_ GUARDED_BY(lock_);
+  // The pile-ups whose histories are integrated by |instance_|, in the order of
+  // its trajectories.  The |instance_| is null if and only if there are no
+  // members.
+  std::vector<not_null<PileUp*>> members_ GUARDED_BY(lock_);
+  std::unique_ptr<typename Integrator<
+      Ephemeris<Barycentric>::NewtonianMotionEquation>::Instance>
+      instance_ GUARDED_BY(lock_);
+
+  friend class PileUp;
+};
+
 // A convenient data object to track a pile-up and the result of integrating it.
 struct PileUpFuture {
   PileUpFuture(not_null<PileUp const*> pile_up, std::future<Status> future);
@@ -251,6 +335,7 @@ struct PileUpFuture {
 }  // namespace internal_pile_up
 
 using internal_pile_up::PileUp;
+using internal_pile_up::PileUpBatch;
 using internal_pile_up::PileUpFuture;
 
 }  // namespace ksp_plugin
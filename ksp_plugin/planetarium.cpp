@@ -2,11 +2,17 @@
 #include "ksp_plugin/planetarium.hpp"
 
 #include <algorithm>
+#include <cstdint>
+#include <future>
+#include <map>
 #include <optional>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include "base/thread_pool.hpp"
 #include "geometry/point.hpp"
+#include "geometry/r3_element.hpp"
 #include "physics/massive_body.hpp"
 #include "quantities/elementary_functions.hpp"
 
@@ -14,11 +20,14 @@ namespace principia {
 namespace ksp_plugin {
 namespace internal_planetarium {
 
+using base::ThreadPool;
 using geometry::Position;
+using geometry::R3Element;
 using geometry::RP2Line;
 using geometry::Sign;
 using geometry::Velocity;
 using physics::MassiveBody;
+using quantities::Infinity;
 using quantities::Pow;
 using quantities::Sin;
 using quantities::Sqrt;
@@ -26,9 +35,65 @@ using quantities::Tan;
 using quantities::Time;
 
 namespace {
+
 constexpr int max_plot_method_2_steps = 10'000;
+
+// The pool on which |PlotMethod2| plots trajectories in parallel.  It is
+// destroyed at exit, when no plotting is in progress.
+ThreadPool<void>& PlottingThreadPool() {
+  static ThreadPool<void> pool(
+      std::max(1u, std::thread::hardware_concurrency()));
+  return pool;
+}
+
+// The samples of a |PlottingCache| are discarded if the camera moved by more
+// than this fraction of its smallest distance to them.
+constexpr double max_relative_camera_motion = 0.1;
+
+// The number of segments bounded by each leaf of a pyramid.
+constexpr std::int64_t samples_per_leaf = 8;
+
+// Returns a sphere that contains both |sphere1| and |sphere2|.
+Sphere<Navigation> BoundingSphere(Sphere<Navigation> const& sphere1,
+                                  Sphere<Navigation> const& sphere2) {
+  Displacement<Navigation> const centre1_to_centre2 =
+      sphere2.centre() - sphere1.centre();
+  Length const distance = centre1_to_centre2.Norm();
+  if (distance + sphere2.radius() <= sphere1.radius()) {
+    return sphere1;
+  }
+  if (distance + sphere1.radius() <= sphere2.radius()) {
+    return sphere2;
+  }
+  Length const radius =
+      0.5 * (distance + sphere1.radius() + sphere2.radius());
+  return Sphere<Navigation>(
+      sphere1.centre() +
+          (radius - sphere1.radius()) / distance * centre1_to_centre2,
+      radius);
+}
+
 }  // namespace
 
+void PlottingCache::EvictUnusedEntries() {
+  absl::MutexLock l(&lock_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.used) {
+      it->second.used = false;
+      ++it;
+    } else {
+      it = entries_.erase(it);
+    }
+  }
+}
+
+not_null<PlottingCache::Entry*> PlottingCache::GetEntry(Key const& key) {
+  absl::MutexLock l(&lock_);
+  Entry& entry = entries_[key];
+  entry.used = true;
+  return &entry;
+}
+
 Planetarium::Parameters::Parameters(double const sphere_radius_multiplier,
                                     Angle const& angular_resolution,
                                     Angle const& field_of_view)
@@ -41,11 +106,13 @@ Planetarium::Planetarium(
     Parameters const& parameters,
     Perspective<Navigation, Camera> perspective,
     not_null<Ephemeris<Barycentric> const*> const ephemeris,
-    not_null<NavigationFrame const*> const plotting_frame)
+    not_null<NavigationFrame const*> const plotting_frame,
+    PlottingCache* const plotting_cache)
     : parameters_(parameters),
       perspective_(std::move(perspective)),
       ephemeris_(ephemeris),
-      plotting_frame_(plotting_frame) {}
+      plotting_frame_(plotting_frame),
+      plotting_cache_(plotting_cache) {}
 
 RP2Lines<Length, Camera> Planetarium::PlotMethod0(
     DiscreteTrajectory<Barycentric>::Iterator const& begin,
@@ -156,26 +223,106 @@ RP2Lines<Length, Camera> Planetarium::PlotMethod2(
     Instant const& last_time,
     Instant const& now,
     bool const reverse) const {
-  RP2Lines<Length, Camera> lines;
+  return PlotTrajectory(trajectory,
+                        first_time,
+                        last_time,
+                        ComputePlottableSpheres(now),
+                        reverse);
+}
+
+std::vector<RP2Lines<Length, Camera>> Planetarium::PlotMethod2(
+    std::vector<PlottingRequest> const& requests,
+    Instant const& now) const {
   auto const plottable_spheres = ComputePlottableSpheres(now);
+
+  // The requests for the same trajectory are processed in sequence by the same
+  // task, as they may share an entry of the |plotting_cache_|.
+  std::map<Trajectory<Barycentric> const*, std::vector<std::size_t>>
+      requests_by_trajectory;
+  for (std::size_t i = 0; i < requests.size(); ++i) {
+    requests_by_trajectory[requests[i].trajectory].push_back(i);
+  }
+
+  std::vector<RP2Lines<Length, Camera>> lines(requests.size());
+  std::vector<std::future<void>> futures;
+  for (auto const& pair : requests_by_trajectory) {
+    std::vector<std::size_t> const& indices = pair.second;
+    futures.push_back(PlottingThreadPool().Add(
+        [this, &indices, &lines, &plottable_spheres, &requests]() {
+          for (std::size_t const i : indices) {
+            auto const& request = requests[i];
+            lines[i] = PlotTrajectory(*request.trajectory,
+                                      request.first_time,
+                                      request.last_time,
+                                      plottable_spheres,
+                                      request.reverse);
+          }
+        }));
+  }
+  for (auto& future : futures) {
+    future.wait();
+  }
+  return lines;
+}
+
+RP2Lines<Length, Camera> Planetarium::PlotTrajectory(
+    Trajectory<Barycentric> const& trajectory,
+    Instant const& first_time,
+    Instant const& last_time,
+    std::vector<Sphere<Navigation>> const& plottable_spheres,
+    bool const reverse) const {
+  if (last_time <= first_time) {
+    return {};
+  }
+
+  if (plotting_cache_ == nullptr) {
+    Sample const initial_sample =
+        ComputeSample(trajectory, reverse ? last_time : first_time);
+    std::vector<Sample> samples = ComputeSamples(trajectory,
+                                                 initial_sample,
+                                                 reverse ? first_time
+                                                         : last_time,
+                                                 max_plot_method_2_steps);
+    samples.insert(samples.begin(), initial_sample);
+    if (reverse) {
+      std::reverse(samples.begin(), samples.end());
+    }
+    Pyramid pyramid;
+    ExtendPyramid(samples, pyramid);
+    return ProjectPolylines(SelectSamples(samples, pyramid, reverse),
+                            plottable_spheres);
+  }
+
+  auto const entry = plotting_cache_->GetEntry({&trajectory, reverse});
+  UpdateSamples(trajectory, first_time, last_time, reverse, *entry);
+  ExtendPyramid(entry->samples, entry->pyramid);
+  return ProjectPolylines(
+      SelectSamples(entry->samples, entry->pyramid, reverse),
+      plottable_spheres);
+}
+
+Planetarium::Sample Planetarium::ComputeSample(
+    Trajectory<Barycentric> const& trajectory,
+    Instant const& t) const {
+  DegreesOfFreedom<Navigation> const degrees_of_freedom =
+      plotting_frame_->ToThisFrameAtTime(t)(
+          trajectory.EvaluateDegreesOfFreedom(t));
+  return {t, degrees_of_freedom.position(), degrees_of_freedom.velocity()};
+}
+
+std::vector<Planetarium::Sample> Planetarium::ComputeSamples(
+    Trajectory<Barycentric> const& trajectory,
+    Sample const& initial_sample,
+    Instant const& final_time,
+    int const max_steps) const {
+  std::vector<Sample> samples;
   double const tan²_angular_resolution =
       Pow<2>(parameters_.tan_angular_resolution_);
-  auto const final_time = reverse ? first_time : last_time;
-  auto previous_time = reverse ? last_time : first_time;
-
-  Sign const direction = reverse ? Sign::Negative() : Sign::Positive();
-  if (direction * (final_time - previous_time) <= Time{}) {
-    return lines;
-  }
-  RigidMotion<Barycentric, Navigation> to_plotting_frame_at_t =
-      plotting_frame_->ToThisFrameAtTime(previous_time);
-  DegreesOfFreedom<Navigation> const initial_degrees_of_freedom =
-      to_plotting_frame_at_t(
-          trajectory.EvaluateDegreesOfFreedom(previous_time));
-  Position<Navigation> previous_position =
-      initial_degrees_of_freedom.position();
-  Velocity<Navigation> previous_velocity =
-      initial_degrees_of_freedom.velocity();
+  Sign const direction = final_time < initial_sample.time ? Sign::Negative()
+                                                          : Sign::Positive();
+  Instant previous_time = initial_sample.time;
+  Position<Navigation> previous_position = initial_sample.position;
+  Velocity<Navigation> previous_velocity = initial_sample.velocity;
   Time Δt = final_time - previous_time;
 
   Instant t;
@@ -183,22 +330,21 @@ RP2Lines<Length, Camera> Planetarium::PlotMethod2(
   std::optional<DegreesOfFreedom<Barycentric>>
       degrees_of_freedom_in_barycentric;
   Position<Navigation> position;
+  std::optional<RigidMotion<Barycentric, Navigation>> to_plotting_frame_at_t;
 
-  std::optional<Position<Navigation>> last_endpoint;
-
-  int steps_accepted = 0;
-
-  goto estimate_tan²_error;
-
-  while (steps_accepted < max_plot_method_2_steps &&
+  bool first_step = true;
+  while (static_cast<int>(samples.size()) < max_steps &&
          direction * (previous_time - final_time) < Time{}) {
     do {
-      // One square root because we have squared errors, another one because the
-      // errors are quadratic in time (in other words, two square roots because
-      // the squared errors are quartic in time).
-      // A safety factor prevents catastrophic retries.
-      Δt *= 0.9 * Sqrt(Sqrt(tan²_angular_resolution / estimated_tan²_error));
-    estimate_tan²_error:
+      if (first_step) {
+        first_step = false;
+      } else {
+        // One square root because we have squared errors, another one because
+        // the errors are quadratic in time (in other words, two square roots
+        // because the squared errors are quartic in time).
+        // A safety factor prevents catastrophic retries.
+        Δt *= 0.9 * Sqrt(Sqrt(tan²_angular_resolution / estimated_tan²_error));
+      }
       t = previous_time + Δt;
       if (direction * (t - final_time) > Time{}) {
         t = final_time;
@@ -209,7 +355,7 @@ RP2Lines<Length, Camera> Planetarium::PlotMethod2(
       to_plotting_frame_at_t = plotting_frame_->ToThisFrameAtTime(t);
       degrees_of_freedom_in_barycentric =
           trajectory.EvaluateDegreesOfFreedom(t);
-      position = to_plotting_frame_at_t.rigid_transformation()(
+      position = to_plotting_frame_at_t->rigid_transformation()(
                      degrees_of_freedom_in_barycentric->position());
 
       // The quadratic term of the error between the linear interpolation and
@@ -220,34 +366,301 @@ RP2Lines<Length, Camera> Planetarium::PlotMethod2(
           perspective_.Tan²AngularDistance(extrapolated_position, position) /
           16;
     } while (estimated_tan²_error > tan²_angular_resolution);
-    ++steps_accepted;
-
-    // TODO(egg): also limit to field of view.
-    auto const segment_behind_focal_plane =
-        perspective_.SegmentBehindFocalPlane(
-            Segment<Navigation>(previous_position, position));
 
     previous_time = t;
     previous_position = position;
     previous_velocity =
-        to_plotting_frame_at_t(*degrees_of_freedom_in_barycentric).velocity();
+        (*to_plotting_frame_at_t)(*degrees_of_freedom_in_barycentric)
+            .velocity();
+    samples.push_back({previous_time, previous_position, previous_velocity});
+  }
+  return samples;
+}
+
+void Planetarium::UpdateSamples(Trajectory<Barycentric> const& trajectory,
+                                Instant const& first_time,
+                                Instant const& last_time,
+                                bool const reverse,
+                                PlottingCache::Entry& entry) const {
+  auto& samples = entry.samples;
+  auto& pyramid = entry.pyramid;
+  auto const is_up_to_date = [this, &trajectory](Sample const& sample) {
+    return ComputeSample(trajectory, sample.time).position == sample.position;
+  };
+
+  if (!samples.empty() &&
+      (perspective_.camera() - entry.camera).Norm() >
+          max_relative_camera_motion * entry.min_distance) {
+    samples.clear();
+  }
+
+  // Forget the samples that are not in the plotted interval.  The last sample
+  // is always recomputed because the end of the trajectory may have changed,
+  // and so that the last segment grows with the trajectory.
+  while (!samples.empty() && samples.front().time < first_time) {
+    samples.pop_front();
+    ++pyramid.first;
+  }
+  while (!samples.empty() && samples.back().time > last_time) {
+    samples.pop_back();
+    pyramid = Pyramid();
+  }
+  if (!samples.empty()) {
+    samples.pop_back();
+  }
 
-    if (!segment_behind_focal_plane) {
+  // If the trajectory or the plotting frame changed in the interval of the
+  // remaining samples, start afresh.
+  if (samples.size() < 2 ||
+      !is_up_to_date(samples.front()) ||
+      !is_up_to_date(samples[samples.size() / 2]) ||
+      !is_up_to_date(samples.back())) {
+    samples.clear();
+  }
+
+  auto const update_min_distance = [this, &entry](Sample const& sample) {
+    entry.min_distance = std::min(
+        entry.min_distance, (sample.position - perspective_.camera()).Norm());
+  };
+
+  if (samples.empty()) {
+    pyramid = Pyramid();
+    entry.camera = perspective_.camera();
+    entry.min_distance = Infinity<Length>;
+    Sample const initial_sample =
+        ComputeSample(trajectory, reverse ? last_time : first_time);
+    samples.push_back(initial_sample);
+    for (auto const& sample :
+             ComputeSamples(trajectory,
+                            initial_sample,
+                            reverse ? first_time : last_time,
+                            max_plot_method_2_steps)) {
+      if (reverse) {
+        samples.push_front(sample);
+      } else {
+        samples.push_back(sample);
+      }
+    }
+    for (auto const& sample : samples) {
+      update_min_distance(sample);
+    }
+    return;
+  }
+
+  if (first_time < samples.front().time) {
+    pyramid = Pyramid();
+    for (auto const& sample : ComputeSamples(trajectory,
+                                             samples.front(),
+                                             first_time,
+                                             max_plot_method_2_steps)) {
+      update_min_distance(sample);
+      samples.push_front(sample);
+    }
+  }
+  if (samples.back().time < last_time) {
+    for (auto const& sample : ComputeSamples(trajectory,
+                                             samples.back(),
+                                             last_time,
+                                             max_plot_method_2_steps)) {
+      update_min_distance(sample);
+      samples.push_back(sample);
+    }
+  }
+}
+
+template<typename Samples>
+void Planetarium::ExtendPyramid(Samples const& samples, Pyramid& pyramid) {
+  std::int64_t end = pyramid.first + samples.size();
+  // Start afresh if most of the pyramid bounds samples that were removed.
+  if (2 * pyramid.first > end) {
+    pyramid = Pyramid();
+    end = samples.size();
+  }
+  if (end - pyramid.first < 2) {
+    pyramid = Pyramid();
+    return;
+  }
+
+  // The leaves are recomputed from the one that ends with the last sample
+  // previously bounded, as that sample may have changed.
+  std::int64_t first_changed =
+      pyramid.end < 2 ? 0 : (pyramid.end - 2) / samples_per_leaf;
+  auto& levels = pyramid.levels;
+  if (levels.empty()) {
+    levels.emplace_back();
+  }
+
+  // The leaves are centred on the bounding boxes of their samples.  The
+  // samples that were removed are not bounded.
+  auto& leaves = levels.front();
+  // The spheres are not assignable, so they cannot be erased in bulk.
+  while (static_cast<std::int64_t>(leaves.size()) > first_changed) {
+    leaves.pop_back();
+  }
+  for (std::int64_t begin = first_changed * samples_per_leaf;
+       begin < end - 1;
+       begin += samples_per_leaf) {
+    std::int64_t const leaf_begin =
+        std::max(begin, pyramid.first) - pyramid.first;
+    std::int64_t const leaf_end =
+        std::max(std::min(begin + samples_per_leaf, end - 1), pyramid.first) -
+        pyramid.first;
+    R3Element<Length> min =
+        (samples[leaf_begin].position - Navigation::origin).coordinates();
+    R3Element<Length> max = min;
+    for (std::int64_t i = leaf_begin + 1; i <= leaf_end; ++i) {
+      R3Element<Length> const coordinates =
+          (samples[i].position - Navigation::origin).coordinates();
+      min.x = std::min(min.x, coordinates.x);
+      min.y = std::min(min.y, coordinates.y);
+      min.z = std::min(min.z, coordinates.z);
+      max.x = std::max(max.x, coordinates.x);
+      max.y = std::max(max.y, coordinates.y);
+      max.z = std::max(max.z, coordinates.z);
+    }
+    Position<Navigation> const centre =
+        Navigation::origin + Displacement<Navigation>(0.5 * (min + max));
+    Length radius;
+    for (std::int64_t i = leaf_begin; i <= leaf_end; ++i) {
+      radius = std::max(radius, (samples[i].position - centre).Norm());
+    }
+    leaves.emplace_back(centre, radius);
+  }
+
+  // A parent is recomputed if one of its children was.
+  std::size_t level = 1;
+  for (; levels[level - 1].size() > 1; ++level) {
+    first_changed /= 2;
+    if (level == levels.size()) {
+      levels.emplace_back();
+    }
+    auto const& children = levels[level - 1];
+    auto& parents = levels[level];
+    while (static_cast<std::int64_t>(parents.size()) > first_changed) {
+      parents.pop_back();
+    }
+    for (std::size_t i = 2 * first_changed; i < children.size(); i += 2) {
+      if (i + 1 < children.size()) {
+        parents.push_back(BoundingSphere(children[i], children[i + 1]));
+      } else {
+        parents.push_back(children[i]);
+      }
+    }
+  }
+  levels.resize(level);
+  pyramid.end = end;
+}
+
+template<typename Samples>
+std::vector<std::vector<Position<Navigation>>> Planetarium::SelectSamples(
+    Samples const& samples,
+    Pyramid const& pyramid,
+    bool const reverse) const {
+  std::vector<std::vector<Position<Navigation>>> polylines;
+  if (pyramid.levels.empty()) {
+    return polylines;
+  }
+
+  // Depth-first traversal of the pyramid, by increasing time.  The stack
+  // contains pairs (level, index).
+  std::vector<std::pair<std::int64_t, std::int64_t>> stack;
+  stack.emplace_back(pyramid.levels.size() - 1, 0);
+  // The index of the last sample appended to |polylines|.
+  std::int64_t last_index = -1;
+  while (!stack.empty()) {
+    auto const [level, index] = stack.back();
+    stack.pop_back();
+    auto const& node = pyramid.levels[level][index];
+    // The numbers of the extremities of the node, and their indices in
+    // |samples|.  The node may start with samples that were removed.
+    std::int64_t const samples_per_node = samples_per_leaf << level;
+    std::int64_t const first_number = index * samples_per_node;
+    std::int64_t const last_number =
+        std::min(first_number + samples_per_node, pyramid.end - 1);
+    if (last_number <= pyramid.first) {
+      continue;
+    }
+    std::int64_t const begin =
+        std::max(first_number, pyramid.first) - pyramid.first;
+    std::int64_t const end = last_number - pyramid.first;
+
+    // Nothing in this node can be seen.  The next node, if any, will start a
+    // new polyline.
+    if (perspective_.IsOutOfView(node, parameters_.tan_field_of_view_)) {
       continue;
     }
 
-    auto const visible_segments = perspective_.VisibleSegments(
-                                      *segment_behind_focal_plane,
-                                      plottable_spheres);
+    // If the node is seen under an angle smaller than the angular resolution,
+    // the segment between its extremities is a good enough approximation of
+    // the samples that it contains.
+    bool const is_coarse_enough =
+        perspective_.SphereSin²HalfAngle(node) <
+        parameters_.sin²_angular_resolution_ / 4;
+    if (level > 0 && !is_coarse_enough) {
+      auto const& children = pyramid.levels[level - 1];
+      if (2 * index + 1 < static_cast<std::int64_t>(children.size())) {
+        stack.emplace_back(level - 1, 2 * index + 1);
+      }
+      stack.emplace_back(level - 1, 2 * index);
+      continue;
+    }
+
+    if (last_index != begin) {
+      polylines.emplace_back().push_back(samples[begin].position);
+    }
+    auto& polyline = polylines.back();
+    if (is_coarse_enough) {
+      polyline.push_back(samples[end].position);
+    } else {
+      for (std::int64_t i = begin + 1; i <= end; ++i) {
+        polyline.push_back(samples[i].position);
+      }
+    }
+    last_index = end;
+  }
+
+  if (reverse) {
+    std::reverse(polylines.begin(), polylines.end());
+    for (auto& polyline : polylines) {
+      std::reverse(polyline.begin(), polyline.end());
+    }
+  }
+  return polylines;
+}
+
+RP2Lines<Length, Camera> Planetarium::ProjectPolylines(
+    std::vector<std::vector<Position<Navigation>>> const& polylines,
+    std::vector<Sphere<Navigation>> const& plottable_spheres) const {
+  // Chain the consecutive visible segments into lines and project all their
+  // vertices at once.
+  std::vector<Position<Navigation>> vertices;
+  std::vector<std::int64_t> line_begins;
+  std::optional<Position<Navigation>> last_endpoint;
+  for (auto const& polyline : polylines) {
+    auto const visible_segments =
+        perspective_.VisibleSegments(polyline,
+                                     plottable_spheres,
+                                     parameters_.tan_field_of_view_);
     for (auto const& segment : visible_segments) {
       if (last_endpoint != segment.first) {
-        lines.emplace_back();
-        lines.back().push_back(perspective_(segment.first));
+        line_begins.push_back(vertices.size());
+        vertices.push_back(segment.first);
       }
-      lines.back().push_back(perspective_(segment.second));
+      vertices.push_back(segment.second);
       last_endpoint = segment.second;
     }
   }
+  auto const projections = perspective_(vertices);
+
+  std::int64_t const number_of_lines = line_begins.size();
+  RP2Lines<Length, Camera> lines;
+  lines.reserve(number_of_lines);
+  for (std::int64_t l = 0; l < number_of_lines; ++l) {
+    auto const line_end = l + 1 < number_of_lines
+                              ? projections.begin() + line_begins[l + 1]
+                              : projections.end();
+    lines.emplace_back(projections.begin() + line_begins[l], line_end);
+  }
   return lines;
 }
 
@@ -280,50 +693,24 @@ Segments<Navigation> Planetarium::ComputePlottableSegments(
     const std::vector<Sphere<Navigation>>& plottable_spheres,
     DiscreteTrajectory<Barycentric>::Iterator const& begin,
     DiscreteTrajectory<Barycentric>::Iterator const& end) const {
-  Segments<Navigation> all_segments;
   if (begin == end) {
-    return all_segments;
-  }
-  auto it1 = begin;
-  Instant t1 = it1->time;
-  RigidMotion<Barycentric, Navigation> rigid_motion_at_t1 =
-      plotting_frame_->ToThisFrameAtTime(t1);
-  Position<Navigation> p1 =
-      rigid_motion_at_t1(it1->degrees_of_freedom).position();
-
-  auto it2 = it1;
-  while (++it2 != end) {
-    // Processing one segment of the trajectory.
-    Instant const t2 = it2->time;
-
-    // Transform the degrees of freedom to the plotting frame.
-    RigidMotion<Barycentric, Navigation> const rigid_motion_at_t2 =
-        plotting_frame_->ToThisFrameAtTime(t2);
-    Position<Navigation> const p2 =
-        rigid_motion_at_t2(it2->degrees_of_freedom).position();
-
-    // Find the part of the segment that is behind the focal plane.  We don't
-    // care about things that are in front of the focal plane.
-    const Segment<Navigation> segment = {p1, p2};
-    auto const segment_behind_focal_plane =
-        perspective_.SegmentBehindFocalPlane(segment);
-    if (segment_behind_focal_plane) {
-      // Find the part(s) of the segment that are not hidden by spheres.  These
-      // are the ones we want to plot.
-      auto segments = perspective_.VisibleSegments(*segment_behind_focal_plane,
-                                                   plottable_spheres);
-      std::move(segments.begin(),
-                segments.end(),
-                std::back_inserter(all_segments));
-    }
+    return {};
+  }
 
-    it1 = it2;
-    t1 = t2;
-    rigid_motion_at_t1 = rigid_motion_at_t2;
-    p1 = p2;
+  // Transform the positions to the plotting frame.
+  std::vector<Position<Navigation>> positions;
+  for (auto it = begin; it != end; ++it) {
+    RigidMotion<Barycentric, Navigation> const rigid_motion =
+        plotting_frame_->ToThisFrameAtTime(it->time);
+    positions.push_back(rigid_motion(it->degrees_of_freedom).position());
   }
 
-  return all_segments;
+  // Find the parts of the segments that are behind the focal plane, in the
+  // field of view, and not hidden by spheres.  These are the ones we want to
+  // plot.
+  return perspective_.VisibleSegments(positions,
+                                      plottable_spheres,
+                                      parameters_.tan_field_of_view_);
 }
 
 }  // namespace internal_planetarium
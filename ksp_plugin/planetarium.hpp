@@ -1,8 +1,13 @@
 ﻿
 #pragma once
 
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <utility>
 #include <vector>
 
+#include "absl/synchronization/mutex.h"
 #include "base/not_null.hpp"
 #include "geometry/named_quantities.hpp"
 #include "geometry/orthogonal_map.hpp"
@@ -25,11 +30,13 @@ using geometry::Displacement;
 using geometry::Instant;
 using geometry::OrthogonalMap;
 using geometry::Perspective;
+using geometry::Position;
 using geometry::RP2Lines;
 using geometry::RP2Point;
 using geometry::Segment;
 using geometry::Segments;
 using geometry::Sphere;
+using geometry::Velocity;
 using physics::DegreesOfFreedom;
 using physics::DiscreteTrajectory;
 using physics::Ephemeris;
@@ -38,6 +45,69 @@ using physics::Trajectory;
 using quantities::Angle;
 using quantities::Length;
 
+// The points of the trajectories sampled by |Planetarium::PlotMethod2| in the
+// plotting frame, together with their level-of-detail pyramids.  A cache may be
+// shared by the successive planetariums used to plot the same trajectories,
+// e.g., in successive frames: they only resample the parts of the trajectories
+// that were appended or forgotten, and reproject the rest.  The samples of a
+// trajectory are discarded if the camera moves by a significant fraction of its
+// distance to the trajectory, or if the trajectory or the plotting frame
+// changed.  This class may be used concurrently for distinct trajectories.
+class PlottingCache {
+ public:
+  // Removes the entries that were not used since the last call to this
+  // function.  Must not be called while a planetarium is plotting.
+  void EvictUnusedEntries() EXCLUDES(lock_);
+
+ private:
+  struct Sample {
+    Instant time;
+    Position<Navigation> position;
+    Velocity<Navigation> velocity;
+  };
+
+  // A level-of-detail pyramid over samples ordered by increasing time.  The
+  // samples are numbered from the first one when the pyramid was started, so
+  // that removing samples at the beginning does not invalidate it.
+  // |levels[0][i]| bounds the samples with numbers in [i * b, (i + 1) * b],
+  // where b is the number of samples per leaf, and |levels[k + 1][i]| bounds
+  // |levels[k][2 * i]| and |levels[k][2 * i + 1]|.  The last level has a
+  // single node.  The pyramid has no levels if there are fewer than two
+  // samples.
+  struct Pyramid {
+    std::vector<std::vector<Sphere<Navigation>>> levels;
+    // The number of the first sample.  The nodes may also bound samples that
+    // were removed since they were computed.
+    std::int64_t first = 0;
+    // One past the number of the last sample bounded by the pyramid.
+    std::int64_t end = 0;
+  };
+
+  struct Entry {
+    // By increasing time.
+    std::deque<Sample> samples;
+    // The pyramid of the |samples|, extended when samples are appended.
+    Pyramid pyramid;
+    // The position of the camera when the samples were computed, and the
+    // smallest distance between that camera and the samples.
+    Position<Navigation> camera;
+    Length min_distance;
+    bool used = false;
+  };
+
+  // A trajectory and the direction in which it is plotted.
+  using Key = std::pair<Trajectory<Barycentric> const*, bool>;
+
+  // Returns the entry for |key|, creating it if needed, and marks it as used.
+  // The entry is stable until the next call to |EvictUnusedEntries|.
+  not_null<Entry*> GetEntry(Key const& key) EXCLUDES(lock_);
+
+  absl::Mutex lock_;
+  std::map<Key, Entry> entries_ GUARDED_BY(lock_);
+
+  friend class Planetarium;
+};
+
 // A planetarium is an ephemeris together with a perspective.  In this setting
 // it is possible to draw trajectories in the projective plane.
 class Planetarium {
@@ -62,10 +132,13 @@ class Planetarium {
 
   // TODO(phl): All this Navigation is weird.  Should it be named Plotting?
   // In particular Navigation vs. NavigationFrame is a mess.
+  // If |plotting_cache| is not null, |PlotMethod2| reuses the samples that it
+  // holds and updates it.
   Planetarium(Parameters const& parameters,
               Perspective<Navigation, Camera> perspective,
               not_null<Ephemeris<Barycentric> const*> ephemeris,
-              not_null<NavigationFrame const*> plotting_frame);
+              not_null<NavigationFrame const*> plotting_frame,
+              PlottingCache* plotting_cache = nullptr);
 
   // A no-op method that just returns all the points in the trajectory defined
   // by |begin| and |end|.
@@ -100,14 +173,90 @@ class Planetarium {
       Instant const& now,
       bool reverse) const;
 
+  // The part of a trajectory to plot with |PlotMethod2|.
+  struct PlottingRequest {
+    not_null<Trajectory<Barycentric> const*> trajectory;
+    Instant first_time;
+    Instant last_time;
+    bool reverse;
+  };
+
+  // Plots the given trajectories with |PlotMethod2| in parallel.  The results
+  // are in the order of the |requests| and are the same as those of calling
+  // |PlotMethod2| on each request in sequence.
+  std::vector<RP2Lines<Length, Camera>> PlotMethod2(
+      std::vector<PlottingRequest> const& requests,
+      Instant const& now) const;
+
  private:
+  using Pyramid = PlottingCache::Pyramid;
+  using Sample = PlottingCache::Sample;
+
+  // Returns the sample of |trajectory| at time |t|.
+  Sample ComputeSample(Trajectory<Barycentric> const& trajectory,
+                       Instant const& t) const;
+
+  // Samples |trajectory| from |initial_sample| (excluded) to |final_time|,
+  // which may precede it, using an adaptive step size to keep the error between
+  // the straight segments and the actual spline below and close to the angular
+  // resolution.  The samples are returned in the order in which they were
+  // computed.  At most |max_steps| samples are computed.
+  std::vector<Sample> ComputeSamples(Trajectory<Barycentric> const& trajectory,
+                                     Sample const& initial_sample,
+                                     Instant const& final_time,
+                                     int max_steps) const;
+
+  // Brings the samples of |entry| up to date for the part of |trajectory|
+  // between |first_time| and |last_time|.
+  void UpdateSamples(Trajectory<Barycentric> const& trajectory,
+                     Instant const& first_time,
+                     Instant const& last_time,
+                     bool reverse,
+                     PlottingCache::Entry& entry) const;
+
+  // Same as |PlotMethod2|, with the spheres returned by
+  // |ComputePlottableSpheres|.  The cost of the projection is proportional to
+  // the complexity of the plot on the screen rather than to the length of the
+  // trajectory: the parts of the trajectory that cannot be visible are skipped,
+  // and those that are seen under a small angle are plotted using the coarsest
+  // level of the pyramid that meets the angular resolution.
+  RP2Lines<Length, Camera> PlotTrajectory(
+      Trajectory<Barycentric> const& trajectory,
+      Instant const& first_time,
+      Instant const& last_time,
+      std::vector<Sphere<Navigation>> const& plottable_spheres,
+      bool reverse) const;
+
+  // Updates the |pyramid| to bound the |samples|, which are by increasing time.
+  // The |samples| must be those for which the |pyramid| was computed, except
+  // that samples may have been removed at the beginning, as recorded by
+  // |pyramid.first|, the last one may have changed, and new ones may have been
+  // appended.  Only the nodes affected by the changes at the end are computed.
+  template<typename Samples>
+  static void ExtendPyramid(Samples const& samples, Pyramid& pyramid);
+
+  // Returns polylines, in plotting order, that approximate the |samples|, which
+  // are by increasing time, to the angular resolution.  The parts of the
+  // trajectory that are out of view are omitted.
+  template<typename Samples>
+  std::vector<std::vector<Position<Navigation>>> SelectSamples(
+      Samples const& samples,
+      Pyramid const& pyramid,
+      bool reverse) const;
+
+  // Projects the segments of the |polylines|, taking into account the field of
+  // view and the hiding by the |plottable_spheres|.
+  RP2Lines<Length, Camera> ProjectPolylines(
+      std::vector<std::vector<Position<Navigation>>> const& polylines,
+      std::vector<Sphere<Navigation>> const& plottable_spheres) const;
+
   // Computes the coordinates of the spheres that represent the |ephemeris_|
   // bodies.  These coordinates are in the |plotting_frame_| at time |now|.
   std::vector<Sphere<Navigation>> ComputePlottableSpheres(
       Instant const& now) const;
 
   // Computes the segments of the trajectory defined by |begin| and |end| that
-  // are not hidden by the |plottable_spheres|.
+  // are in the field of view and not hidden by the |plottable_spheres|.
   Segments<Navigation> ComputePlottableSegments(
       const std::vector<Sphere<Navigation>>& plottable_spheres,
       DiscreteTrajectory<Barycentric>::Iterator const& begin,
@@ -117,11 +266,13 @@ class Planetarium {
   Perspective<Navigation, Camera> const perspective_;
   not_null<Ephemeris<Barycentric> const*> const ephemeris_;
   not_null<NavigationFrame const*> const plotting_frame_;
+  PlottingCache* const plotting_cache_;
 };
 
 }  // namespace internal_planetarium
 
 using internal_planetarium::Planetarium;
+using internal_planetarium::PlottingCache;
 
 }  // namespace ksp_plugin
 }  // namespace principia
@@ -2,6 +2,7 @@
 #include "ksp_plugin/plugin.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <filesystem>
 #include <fstream>
@@ -21,6 +22,7 @@
 #include "astronomy/stabilize_ksp.hpp"
 #include "astronomy/time_scales.hpp"
 #include "base/file.hpp"
+#include "base/flags.hpp"
 #include "base/hexadecimal.hpp"
 #include "base/map_util.hpp"
 #include "base/not_null.hpp"
@@ -41,6 +43,7 @@
 #include "ksp_plugin/integrators.hpp"
 #include "ksp_plugin/part.hpp"
 #include "ksp_plugin/part_subsets.hpp"
+#include "ksp_plugin/prediction_scheduler.hpp"
 #include "physics/apsides.hpp"
 #include "physics/barycentric_rotating_dynamic_frame_body.hpp"
 #include "physics/body_centred_body_direction_dynamic_frame.hpp"
@@ -68,6 +71,7 @@ using base::check_not_null;
 using base::dynamic_cast_not_null;
 using base::Error;
 using base::FindOrDie;
+using base::Flags;
 using base::Fingerprint2011;
 using base::HexadecimalEncoder;
 using base::make_not_null_unique;
@@ -107,11 +111,23 @@ using quantities::Force;
 using quantities::Infinity;
 using quantities::Length;
 using quantities::MomentOfInertia;
+using quantities::si::Day;
 using quantities::si::Milli;
 using quantities::si::Minute;
 using quantities::si::Radian;
 using ::operator<<;
 
+// The time during which the asynchronous computations of the vessels that are
+// neither active nor targeted may be started in each frame.
+constexpr auto background_prediction_budget = std::chrono::milliseconds(20);
+
+// The ephemeris is prolonged in the background this many frames ahead of the
+// current time, so that |AdvanceTime| and the integration of the pile-ups
+// rarely have to wait for it.  The lookahead is capped to avoid integrating the
+// solar system far into the future after a large time jump.
+constexpr int ephemeris_lookahead_frames = 2;
+constexpr Time max_ephemeris_lookahead = 1 * Day;
+
 Plugin::Plugin(std::string const& game_epoch,
                std::string const& solar_system_epoch,
                Angle const& planetarium_rotation)
@@ -764,19 +780,51 @@ void Plugin::AdvanceTime(Instant const& t, Angle const& planetarium_rotation) {
     vessel->ClearAllIntrinsicForcesAndTorques();
   }
 
+  Time const Δt = t - current_time_;
   current_time_ = t;
   planetarium_rotation_ = planetarium_rotation;
   ephemeris_->Prolong(current_time_);
+  if (!Flags::IsPresent("pipelined_prolongation", "off")) {
+    ephemeris_->RequestProlongation(
+        current_time_ +
+        ephemeris_lookahead_frames * std::min(Δt, max_ephemeris_lookahead));
+  }
   UpdatePlanetariumRotation();
   loaded_vessels_.clear();
+  PredictionScheduler::Default().SetFrameDeadline(
+      std::chrono::steady_clock::now() + background_prediction_budget);
 }
 
 void Plugin::CatchUpLaggingVessels(VesselSet& collided_vessels) {
   CHECK(!initializing_);
 
-  // Start all the integrations in parallel.
+  // The histories of the pile-ups that have no intrinsic force are integrated
+  // together, and their parts are advanced once that integration is done.
+  std::set<not_null<PileUp*>> batched_pile_ups;
+  std::optional<std::future<Status>> batch_future;
+  if (!Flags::IsPresent("pile_up_batch", "off")) {
+    if (pile_up_batch_ == nullptr) {
+      pile_up_batch_ =
+          std::make_unique<PileUpBatch>(history_parameters_, ephemeris_.get());
+    }
+    for (not_null<PileUp*> const pile_up :
+         pile_up_batch_->Select(pile_ups_, current_time_)) {
+      batched_pile_ups.insert(pile_up);
+    }
+    if (!batched_pile_ups.empty()) {
+      batch_future = vessel_thread_pool_.Add([this]() {
+        pile_up_batch_->AdvanceHistories(current_time_);
+        return Status::OK;
+      });
+    }
+  }
+
+  // Start all the other integrations in parallel.
   std::vector<PileUpFuture> pile_up_futures;
   for (auto* const pile_up : pile_ups_) {
+    if (Contains(batched_pile_ups, pile_up)) {
+      continue;
+    }
     pile_up_futures.emplace_back(
         pile_up,
         vessel_thread_pool_.Add([this, pile_up]() {
@@ -785,6 +833,16 @@ void Plugin::CatchUpLaggingVessels(VesselSet& collided_vessels) {
           return pile_up->DeformAndAdvanceTime(current_time_);
         }));
   }
+  if (batch_future.has_value()) {
+    batch_future->wait();
+    for (not_null<PileUp*> const pile_up : batched_pile_ups) {
+      pile_up_futures.emplace_back(
+          pile_up,
+          vessel_thread_pool_.Add([this, pile_up]() {
+            return pile_up->DeformAndAdvanceTime(current_time_);
+          }));
+    }
+  }
 
   // Wait for the integrations to finish and figure out which vessels collided
   // with a celestial.
@@ -915,8 +973,11 @@ void Plugin::UpdatePrediction(GUID const& vessel_guid) const {
   // If there is a target vessel, ensure that the prediction of |vessel| is not
   // longer than that of the target vessel.  This is necessary to build the
   // targetting frame.
+  vessel.set_prediction_priority(PredictionScheduler::Priority::ActiveVessel);
   if (renderer_->HasTargetVessel()) {
     target_vessel = &renderer_->GetTargetVessel();
+    target_vessel->set_prediction_priority(
+        PredictionScheduler::Priority::TargetVessel);
     target_vessel->RefreshPrediction();
     vessel.RefreshPrediction(target_vessel->prediction().back().time);
   } else {
@@ -924,7 +985,9 @@ void Plugin::UpdatePrediction(GUID const& vessel_guid) const {
   }
   for (auto const& [guid, v] : vessels_) {
     if (v.get() != &vessel && v.get() != target_vessel) {
-      v->StopPrognosticator();
+      v->set_prediction_priority(
+          is_loaded(v.get()) ? PredictionScheduler::Priority::VesselInView
+                             : PredictionScheduler::Priority::Other);
     }
   }
 }
@@ -1078,10 +1141,19 @@ not_null<std::unique_ptr<Planetarium>> Plugin::NewPlanetarium(
     Planetarium::Parameters const& parameters,
     Perspective<Navigation, Camera> const& perspective)
     const {
+  // The target frame changes with the prediction of the target vessel, so its
+  // samples may not be reused.
+  PlottingCache* plotting_cache = nullptr;
+  if (!renderer_->HasTargetVessel() &&
+      !Flags::IsPresent("plotting_cache", "off")) {
+    plotting_cache_.EvictUnusedEntries();
+    plotting_cache = &plotting_cache_;
+  }
   return make_not_null_unique<Planetarium>(parameters,
                                            perspective,
                                            ephemeris_.get(),
-                                           renderer_->GetPlottingFrame());
+                                           renderer_->GetPlottingFrame(),
+                                           plotting_cache);
 }
 
 not_null<std::unique_ptr<NavigationFrame>>
@@ -1370,7 +1442,7 @@ void Plugin::WriteToMessage(
   }
 }
 
-not_null<std::unique_ptr<Plugin>> Plugin::ReadFromMessage(
+StatusOr<not_null<std::unique_ptr<Plugin>>> Plugin::ReadFromMessage(
     serialization::Plugin const& message) {
   LOG(INFO) << __FUNCTION__;
 
@@ -1391,8 +1463,10 @@ not_null<std::unique_ptr<Plugin>> Plugin::ReadFromMessage(
 
   // The ephemeris constructed here is *not* prolonged and needs to be
   // explicitly prolonged to cover all the instants that we care about.
-  plugin->ephemeris_ =
+  auto ephemeris =
       Ephemeris<Barycentric>::ReadFromMessage(message.ephemeris());
+  RETURN_IF_ERROR(ephemeris);
+  plugin->ephemeris_ = std::move(ephemeris).ValueOrDie();
   plugin->ephemeris_->Prolong(plugin->game_epoch_);
   plugin->ephemeris_->Prolong(plugin->current_time_);
 
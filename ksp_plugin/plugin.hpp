@@ -14,6 +14,7 @@
 
 #include "base/monostable.hpp"
 #include "base/status.hpp"
+#include "base/status_or.hpp"
 #include "base/thread_pool.hpp"
 #include "geometry/affine_map.hpp"
 #include "geometry/grassmann.hpp"
@@ -49,6 +50,7 @@ namespace internal_plugin {
 
 using base::not_null;
 using base::Status;
+using base::StatusOr;
 using base::Subset;
 using base::ThreadPool;
 using geometry::AffineMap;
@@ -439,7 +441,9 @@ class Plugin {
 
   // Must be called after initialization.
   virtual void WriteToMessage(not_null<serialization::Plugin*> message) const;
-  static not_null<std::unique_ptr<Plugin>> ReadFromMessage(
+  // Fails if the ephemeris cannot be read, e.g., because its polynomials are in
+  // a block store that is unavailable.
+  static StatusOr<not_null<std::unique_ptr<Plugin>>> ReadFromMessage(
       serialization::Plugin const& message);
 
  private:
@@ -530,6 +534,8 @@ class Plugin {
 
   // Not null after initialization.
   std::unique_ptr<Renderer> renderer_;
+  // Shared by the successive planetariums returned by |NewPlanetarium|.
+  mutable PlottingCache plotting_cache_;
 
   RotatingBody<Barycentric> const* main_body_ = nullptr;
   AngularVelocity<Barycentric> angular_velocity_of_world_;
@@ -538,6 +544,9 @@ class Plugin {
   // and the pile-up will remove itself once no part owns it.  The elements are
   // not |not_null<>| because we temporarily need to insert null pointers.
   std::list<PileUp*> pile_ups_;
+  // Integrates together the histories of the pile-ups that have no intrinsic
+  // force.  Created lazily by |CatchUpLaggingVessels|.
+  std::unique_ptr<PileUpBatch> pile_up_batch_;
 
   // The vessels that are currently loaded, i.e. in the physics bubble.
   VesselSet loaded_vessels_;
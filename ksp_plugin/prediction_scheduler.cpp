@@ -0,0 +1,174 @@
+#include "ksp_plugin/prediction_scheduler.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+#include "absl/time/clock.h"
+#include "base/map_util.hpp"
+#include "glog/logging.h"
+
+namespace principia {
+namespace ksp_plugin {
+namespace internal_prediction_scheduler {
+
+using base::Contains;
+using base::MakeStoppableThread;
+using base::StopTokenScope;
+using base::stop_token;
+
+PredictionScheduler::PredictionScheduler(
+    std::int64_t const number_of_workers) {
+  CHECK_LT(0, number_of_workers);
+  for (std::int64_t i = 0; i < number_of_workers; ++i) {
+    workers_.push_back(MakeStoppableThread([this]() { ExecuteTasks(); }));
+  }
+}
+
+PredictionScheduler::~PredictionScheduler() {
+  {
+    absl::MutexLock l(&lock_);
+    shutdown_ = true;
+    pending_tasks_.clear();
+    for (auto& [_, source] : running_tasks_) {
+      source.request_stop();
+    }
+  }
+  // The destructors of the |workers_| join them.
+  workers_.clear();
+}
+
+void PredictionScheduler::Schedule(Key const key,
+                                   Priority const priority,
+                                   std::function<void()> task) {
+  absl::MutexLock l(&lock_);
+  pending_tasks_.insert_or_assign(
+      key, Task{priority, next_sequence_number_++, std::move(task)});
+}
+
+void PredictionScheduler::Cancel(Key const key) {
+  absl::MutexLock l(&lock_);
+  pending_tasks_.erase(key);
+  auto const it = running_tasks_.find(key);
+  if (it != running_tasks_.end()) {
+    it->second.request_stop();
+    auto const task_completed = [this, key]() {
+      return !Contains(running_tasks_, key);
+    };
+    lock_.Await(absl::Condition(&task_completed));
+  }
+}
+
+void PredictionScheduler::SetPriority(Key const key,
+                                      Priority const priority) {
+  absl::MutexLock l(&lock_);
+  auto const it = pending_tasks_.find(key);
+  if (it != pending_tasks_.end()) {
+    it->second.priority = priority;
+  }
+}
+
+void PredictionScheduler::SetFrameDeadline(
+    std::chrono::steady_clock::time_point const deadline) {
+  // The deadline is converted to an |absl::Time| so that the workers may wait
+  // until it.
+  absl::Time const absl_deadline =
+      absl::Now() +
+      absl::FromChrono(deadline - std::chrono::steady_clock::now());
+  absl::MutexLock l(&lock_);
+  frame_deadline_ = absl_deadline;
+}
+
+std::int64_t PredictionScheduler::number_of_tasks() const {
+  absl::ReaderMutexLock l(&lock_);
+  return pending_tasks_.size() + running_tasks_.size();
+}
+
+PredictionScheduler& PredictionScheduler::Default() {
+  static PredictionScheduler scheduler(
+      std::max(2u, std::thread::hardware_concurrency() / 2));
+  return scheduler;
+}
+
+void PredictionScheduler::ExecuteTasks() {
+  for (;;) {
+    Key key;
+    std::function<void()> function;
+    stop_token token;
+
+    {
+      absl::MutexLock l(&lock_);
+      auto const it = AwaitNextTask();
+      if (it == pending_tasks_.end()) {
+        return;
+      }
+      key = it->first;
+      function = std::move(it->second.function);
+      pending_tasks_.erase(it);
+      token = running_tasks_[key].get_token();
+    }
+
+    // Execute the task without holding the |lock_| as it might take some time.
+    {
+      StopTokenScope scope(token);
+      function();
+    }
+
+    absl::MutexLock l(&lock_);
+    running_tasks_.erase(key);
+  }
+}
+
+std::map<PredictionScheduler::Key, PredictionScheduler::Task>::iterator
+PredictionScheduler::AwaitNextTask() {
+  // The condition must only depend on the state protected by |lock_|, so it
+  // doesn't read the clock.  Instead, the wait is bounded by the frame
+  // deadline, and restarted when it passes or when it changes.
+  for (;;) {
+    std::optional<absl::Time> const frame_deadline = frame_deadline_;
+    bool const past_frame_deadline =
+        frame_deadline.has_value() && absl::Now() > *frame_deadline;
+    auto const has_task_or_shutdown =
+        [this, &frame_deadline, past_frame_deadline]() {
+          return shutdown_ || frame_deadline_ != frame_deadline ||
+                 NextTask(past_frame_deadline) != pending_tasks_.end();
+        };
+    if (frame_deadline.has_value() && !past_frame_deadline) {
+      lock_.AwaitWithDeadline(absl::Condition(&has_task_or_shutdown),
+                              *frame_deadline);
+    } else {
+      lock_.Await(absl::Condition(&has_task_or_shutdown));
+    }
+    if (shutdown_) {
+      return pending_tasks_.end();
+    }
+    if (frame_deadline_ == frame_deadline) {
+      auto const it = NextTask(past_frame_deadline);
+      if (it != pending_tasks_.end()) {
+        return it;
+      }
+    }
+  }
+}
+
+std::map<PredictionScheduler::Key, PredictionScheduler::Task>::iterator
+PredictionScheduler::NextTask(bool const past_frame_deadline) {
+  auto next = pending_tasks_.end();
+  for (auto it = pending_tasks_.begin(); it != pending_tasks_.end(); ++it) {
+    auto const& [key, task] = *it;
+    if (Contains(running_tasks_, key) ||
+        (past_frame_deadline && task.priority > Priority::TargetVessel)) {
+      continue;
+    }
+    if (next == pending_tasks_.end() ||
+        std::pair(task.priority, task.sequence_number) <
+            std::pair(next->second.priority, next->second.sequence_number)) {
+      next = it;
+    }
+  }
+  return next;
+}
+
+}  // namespace internal_prediction_scheduler
+}  // namespace ksp_plugin
+}  // namespace principia
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "base/jthread.hpp"
+#include "base/macros.hpp"
+
+namespace principia {
+namespace ksp_plugin {
+namespace internal_prediction_scheduler {
+
+using base::jthread;
+using base::stop_source;
+
+// Runs the asynchronous computations of all the vessels (predictions, orbit
+// analyses, speculative flight plan segments) on a fixed set of worker threads.
+// Each task is run on behalf of a key, typically the address of the object that
+// owns the computation.  A key has at most one pending task: scheduling a task
+// replaces the one that is pending, so that requests are coalesced if the
+// workers cannot keep up.  The tasks of a key never run concurrently.  The
+// pending tasks are started by decreasing priority, and in the order in which
+// they were scheduled for equal priorities.  This class is thread-safe.
+class PredictionScheduler {
+ public:
+  // The priorities, from highest to lowest.
+  enum class Priority {
+    ActiveVessel,
+    TargetVessel,
+    VesselInView,
+    Other,
+  };
+
+  using Key = void const*;
+
+  explicit PredictionScheduler(std::int64_t number_of_workers);
+
+  // Requests the running tasks to stop and waits for them to complete.  The
+  // pending tasks are dropped.
+  ~PredictionScheduler();
+
+  // Schedules |task| to be run on behalf of |key|, replacing the task pending
+  // for |key|, if any.  If a task is running for |key|, |task| will be started
+  // after it completes.  The task may use |RETURN_IF_STOPPED| to react to
+  // |Cancel|.
+  void Schedule(Key key, Priority priority, std::function<void()> task)
+      EXCLUDES(lock_);
+
+  // Drops the task pending for |key|, if any, requests the task running for
+  // |key|, if any, to stop, and waits for it to complete.  Must not be called
+  // by a task.
+  void Cancel(Key key) EXCLUDES(lock_);
+
+  // Changes the priority of the task pending for |key|, if any.
+  void SetPriority(Key key, Priority priority) EXCLUDES(lock_);
+
+  // The tasks whose priority is lower than |TargetVessel| are not started after
+  // |deadline|, until the next call to this function.  This bounds the time
+  // spent in each frame on the computations that are not displayed.  If this
+  // function is never called, there is no such restriction.
+  void SetFrameDeadline(std::chrono::steady_clock::time_point deadline)
+      EXCLUDES(lock_);
+
+  // The number of tasks pending or running.
+  std::int64_t number_of_tasks() const EXCLUDES(lock_);
+
+  // The scheduler shared by all the vessels.  It is destroyed at exit.
+  static PredictionScheduler& Default();
+
+ private:
+  struct Task {
+    Priority priority;
+    std::int64_t sequence_number;
+    std::function<void()> function;
+  };
+
+  // The loop executed by each worker to start the pending tasks.
+  void ExecuteTasks() EXCLUDES(lock_);
+
+  // Waits until a task may be started and returns it, or returns
+  // |pending_tasks_.end()| if this class is shutting down.
+  std::map<Key, Task>::iterator AwaitNextTask() REQUIRES(lock_);
+
+  // Returns the pending task to start next, or |pending_tasks_.end()| if no
+  // task may be started.  Only the tasks whose priority is at least
+  // |TargetVessel| may be started if |past_frame_deadline| is true.
+  std::map<Key, Task>::iterator NextTask(bool past_frame_deadline)
+      REQUIRES(lock_);
+
+  mutable absl::Mutex lock_;
+  bool shutdown_ GUARDED_BY(lock_) = false;
+  std::int64_t next_sequence_number_ GUARDED_BY(lock_) = 0;
+  std::optional<absl::Time> frame_deadline_ GUARDED_BY(lock_);
+  std::map<Key, Task> pending_tasks_ GUARDED_BY(lock_);
+  // The stop sources of the running tasks.
+  std::map<Key, stop_source> running_tasks_ GUARDED_BY(lock_);
+
+  std::vector<jthread> workers_;
+};
+
+}  // namespace internal_prediction_scheduler
+
+using internal_prediction_scheduler::PredictionScheduler;
+
+}  // namespace ksp_plugin
+}  // namespace principia
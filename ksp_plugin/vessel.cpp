@@ -23,7 +23,6 @@ using base::Contains;
 using base::Error;
 using base::FindOrDie;
 using base::make_not_null_unique;
-using base::MakeStoppableThread;
 using geometry::BarycentreCalculator;
 using geometry::Position;
 using quantities::IsFinite;
@@ -34,19 +33,23 @@ using quantities::si::Metre;
 constexpr std::int64_t max_dense_intervals = 10'000;
 constexpr Length downsampling_tolerance = 10 * Metre;
 
+bool operator!=(
+    Ephemeris<Barycentric>::AdaptiveStepParameters const& left,
+    Ephemeris<Barycentric>::AdaptiveStepParameters const& right) {
+  return &left.integrator() != &right.integrator() ||
+         left.max_steps() != right.max_steps() ||
+         left.length_integration_tolerance() !=
+             right.length_integration_tolerance() ||
+         left.speed_integration_tolerance() !=
+             right.speed_integration_tolerance();
+}
+
 bool operator!=(Vessel::PrognosticatorParameters const& left,
                 Vessel::PrognosticatorParameters const& right) {
   return left.first_time != right.first_time ||
          left.first_degrees_of_freedom != right.first_degrees_of_freedom ||
-         &left.adaptive_step_parameters.integrator() !=
-             &right.adaptive_step_parameters.integrator() ||
-         left.adaptive_step_parameters.max_steps() !=
-             right.adaptive_step_parameters.max_steps() ||
-         left.adaptive_step_parameters.length_integration_tolerance() !=
-             right.adaptive_step_parameters.length_integration_tolerance() ||
-         left.adaptive_step_parameters.speed_integration_tolerance() !=
-             right.adaptive_step_parameters.speed_integration_tolerance() ||
-         left.shutdown != right.shutdown;
+         left.adaptive_step_parameters != right.adaptive_step_parameters ||
+         left.extended_prediction_steps != right.extended_prediction_steps;
 }
 
 Vessel::Vessel(GUID guid,
@@ -69,20 +72,8 @@ Vessel::Vessel(GUID guid,
 
 Vessel::~Vessel() {
   LOG(INFO) << "Destroying vessel " << ShortDebugString();
-  // Ask the prognosticator to shut down.  This may take a while.  Make sure
-  // that we handle the case where |PrepareHistory| was not called.
-  if (prognosticator_.joinable()) {
-    {
-      absl::MutexLock l(&prognosticator_lock_);
-      prognosticator_parameters_ =
-          PrognosticatorParameters{Ephemeris<Barycentric>::Guard(ephemeris_),
-                                   psychohistory_->back().time,
-                                   psychohistory_->back().degrees_of_freedom,
-                                   prediction_adaptive_step_parameters_,
-                                   /*shutdown=*/true};
-    }
-    prognosticator_.join();
-  }
+  // Stop the prognostication.  This may take a while.
+  StopPrognosticator();
 }
 
 GUID const& Vessel::guid() const {
@@ -215,8 +206,14 @@ void Vessel::set_prediction_adaptive_step_parameters(
   prediction_adaptive_step_parameters_ = prediction_adaptive_step_parameters;
   absl::MutexLock l(&prognosticator_lock_);
   if (prognosticator_parameters_) {
-    prognosticator_parameters_->adaptive_step_parameters =
-        prediction_adaptive_step_parameters;
+    if (prognosticator_parameters_->extended_prediction_steps.has_value()) {
+      // The extension of a prediction must use the parameters with which the
+      // prediction was computed.
+      prognosticator_parameters_.reset();
+    } else {
+      prognosticator_parameters_->adaptive_step_parameters =
+          prediction_adaptive_step_parameters;
+    }
   }
 }
 
@@ -263,11 +260,12 @@ void Vessel::AdvanceTime() {
                            *psychohistory_);
   {
     absl::MutexLock l(&prognosticator_lock_);
-    if (prognostication_ == nullptr) {
-      AttachPrediction(std::move(prediction));
-    } else {
-      AttachPrediction(std::move(prognostication_));
+    if (!prognostication_.has_value() ||
+        prognostication_->extends_prediction) {
+      AttachPrediction(std::move(prediction),
+                       extensible_prediction_parameters_);
     }
+    AttachPrognostication();
   }
 
   for (auto const& [_, part] : parts_) {
@@ -343,49 +341,24 @@ Status Vessel::RebaseFlightPlan(Mass const& initial_mass) {
 }
 
 void Vessel::RefreshPrediction() {
-  absl::MutexLock l(&prognosticator_lock_);
-  // The guard below ensures that the ephemeris will not be "forgotten before"
-  // the end of the psychohistory between now and the time when the
-  // prognosticator finishes the integration.  This ensures that the ephemeris'
-  // |t_min| is never after the time that |FlowWithAdaptiveStep| tries to
-  // integrate.
-  // The guard will be destroyed either when the next set of parameters is
-  // created or when the prognostication has been computed.
-  // Note that we know that both |EventuallyForgetBefore| and
-  // |RefreshPrediction| are called on the main thread, therefore the ephemeris
-  // currently covers the last time of the psychohistory.  Were this to change,
-  // this code might have to change.
-  prognosticator_parameters_ =
-      PrognosticatorParameters{Ephemeris<Barycentric>::Guard(ephemeris_),
-                               psychohistory_->back().time,
-                               psychohistory_->back().degrees_of_freedom,
-                               prediction_adaptive_step_parameters_,
-                               /*shutdown=*/false};
-  if (synchronous_) {
-    std::unique_ptr<DiscreteTrajectory<Barycentric>> prognostication;
-    std::optional<PrognosticatorParameters> prognosticator_parameters;
-    std::swap(prognosticator_parameters, prognosticator_parameters_);
-    Status const status =
-        FlowPrognostication(std::move(*prognosticator_parameters),
-                            prognostication);
-    SwapPrognostication(prognostication, status);
-  } else {
-    StartPrognosticatorIfNeeded();
-  }
-  if (prognostication_ != nullptr) {
-    AttachPrediction(std::move(prognostication_));
-  }
+  UpdatePrediction(/*last_time=*/std::nullopt);
 }
 
 void Vessel::RefreshPrediction(Instant const& time) {
-  RefreshPrediction();
-  prediction_->ForgetAfter(time);
+  UpdatePrediction(time);
 }
 
 void Vessel::StopPrognosticator() {
-  if (prognosticator_.joinable()) {
-    prognosticator_.request_stop();
-    prognosticator_.join();
+  PredictionScheduler::Default().Cancel(this);
+}
+
+void Vessel::set_prediction_priority(
+    PredictionScheduler::Priority const priority) {
+  prediction_priority_ = priority;
+  // The pending computations are reordered as well.
+  PredictionScheduler::Default().SetPriority(this, priority);
+  if (orbit_analyser_.has_value()) {
+    orbit_analyser_->SetPriority(priority);
   }
 }
 
@@ -529,7 +502,8 @@ void Vessel::RefreshOrbitAnalysis(Time const& mission_duration) {
   orbit_analyser_->RequestAnalysis(
       {.first_time = psychohistory_->back().time,
        .first_degrees_of_freedom = psychohistory_->back().degrees_of_freedom,
-       .mission_duration = mission_duration});
+       .mission_duration = mission_duration},
+      prediction_priority_);
   orbit_analyser_->RefreshAnalysis();
 }
 
@@ -563,86 +537,160 @@ Vessel::Vessel()
       ephemeris_(testing_utilities::make_not_null<Ephemeris<Barycentric>*>()),
       history_(make_not_null_unique<DiscreteTrajectory<Barycentric>>()) {}
 
-void Vessel::StartPrognosticatorIfNeeded() {
-  prognosticator_lock_.AssertHeld();
-  if (!prognosticator_.joinable()) {
-    prognosticator_ = MakeStoppableThread(
-        std::bind(&Vessel::RepeatedlyFlowPrognostication, this));
-  }
-}
-
-Status Vessel::RepeatedlyFlowPrognostication() {
-  for (;;) {
-    // No point in going faster than 50 Hz.
-    std::chrono::steady_clock::time_point const wakeup_time =
-        std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
-
-    RETURN_IF_STOPPED;
-
-    std::optional<PrognosticatorParameters> prognosticator_parameters;
-    {
-      absl::MutexLock l(&prognosticator_lock_);
-      if (!prognosticator_parameters_) {
-        // No parameters, let's wait for them to appear.
-        continue;
-      }
-      std::swap(prognosticator_parameters, prognosticator_parameters_);
-    }
-
-    if (prognosticator_parameters->shutdown) {
-      break;
+void Vessel::UpdatePrediction(std::optional<Instant> const& last_time) {
+  absl::MutexLock l(&prognosticator_lock_);
+  AttachPrognostication();
+  // The guard below ensures that the ephemeris will not be "forgotten before"
+  // the end of the psychohistory between now and the time when the
+  // prognosticator finishes the integration.  This ensures that the ephemeris'
+  // |t_min| is never after the time that |FlowWithAdaptiveStep| tries to
+  // integrate.
+  // The guard will be destroyed either when the next set of parameters is
+  // created or when the prognostication has been computed.
+  // Note that we know that both |EventuallyForgetBefore| and
+  // |RefreshPrediction| are called on the main thread, therefore the ephemeris
+  // currently covers the last time of the psychohistory.  Were this to change,
+  // this code might have to change.
+  // A prediction that is truncated to |last_time| is never extended, as its
+  // last point is not where the integration stopped.
+  if (!last_time.has_value() &&
+      extensible_prediction_parameters_.has_value() &&
+      !(*extensible_prediction_parameters_ !=
+            prediction_adaptive_step_parameters_)) {
+    // The vessel is still on its prediction, typically because it is coasting:
+    // only integrate from the end of the prediction.  The steps already present
+    // in the prediction count against |max_steps|, so that extending it
+    // doesn't make it grow without bound.
+    std::int64_t const prediction_steps = prediction_->Size() - 1;
+    if (prediction_steps < prediction_adaptive_step_parameters_.max_steps()) {
+      prognosticator_parameters_ =
+          PrognosticatorParameters{Ephemeris<Barycentric>::Guard(ephemeris_),
+                                   prediction_->back().time,
+                                   prediction_->back().degrees_of_freedom,
+                                   prediction_adaptive_step_parameters_,
+                                   prediction_steps};
+    } else {
+      prognosticator_parameters_.reset();
     }
-
-    std::unique_ptr<DiscreteTrajectory<Barycentric>> prognostication;
-    Status const status =
-        FlowPrognostication(std::move(*prognosticator_parameters),
-                            prognostication);
-    RETURN_IF_STOPPED;
-    {
-      absl::MutexLock l(&prognosticator_lock_);
+  } else {
+    prognosticator_parameters_ =
+        PrognosticatorParameters{Ephemeris<Barycentric>::Guard(ephemeris_),
+                                 psychohistory_->back().time,
+                                 psychohistory_->back().degrees_of_freedom,
+                                 prediction_adaptive_step_parameters_,
+                                 /*extended_prediction_steps=*/std::nullopt};
+  }
+  if (prognosticator_parameters_.has_value()) {
+    if (synchronous_) {
+      std::optional<Prognostication> prognostication;
+      std::optional<PrognosticatorParameters> prognosticator_parameters;
+      std::swap(prognosticator_parameters, prognosticator_parameters_);
+      Status const status =
+          FlowPrognostication(std::move(*prognosticator_parameters),
+                              prognostication);
       SwapPrognostication(prognostication, status);
+      AttachPrognostication();
+    } else {
+      PredictionScheduler::Default().Schedule(
+          this,
+          prediction_priority_,
+          [this]() { FlowScheduledPrognostication(); });
     }
+  }
+  if (last_time.has_value()) {
+    prediction_->ForgetAfter(*last_time);
+    extensible_prediction_parameters_.reset();
+  }
+}
 
-    std::this_thread::sleep_until(wakeup_time);
+void Vessel::FlowScheduledPrognostication() {
+  std::optional<PrognosticatorParameters> prognosticator_parameters;
+  {
+    absl::MutexLock l(&prognosticator_lock_);
+    if (!prognosticator_parameters_) {
+      // The parameters were picked by a previous task.
+      return;
+    }
+    std::swap(prognosticator_parameters, prognosticator_parameters_);
   }
-  return Status::OK;
+
+  std::optional<Prognostication> prognostication;
+  Status const status =
+      FlowPrognostication(std::move(*prognosticator_parameters),
+                          prognostication);
+  absl::MutexLock l(&prognosticator_lock_);
+  SwapPrognostication(prognostication, status);
 }
 
 Status Vessel::FlowPrognostication(
     PrognosticatorParameters prognosticator_parameters,
-    std::unique_ptr<DiscreteTrajectory<Barycentric>>& prognostication) {
+    std::optional<Prognostication>& prognostication) {
   // The guard contained in |prognosticator_parameters| ensures that the |t_min|
   // of the ephemeris doesn't move in this function.
-  prognostication = std::make_unique<DiscreteTrajectory<Barycentric>>();
-  prognostication->Append(
-      prognosticator_parameters.first_time,
-      prognosticator_parameters.first_degrees_of_freedom);
+  auto const& adaptive_step_parameters =
+      prognosticator_parameters.adaptive_step_parameters;
+  std::int64_t const extended_prediction_steps =
+      prognosticator_parameters.extended_prediction_steps.value_or(0);
+  not_null<std::unique_ptr<DiscreteTrajectory<Barycentric>>> trajectory =
+      make_not_null_unique<DiscreteTrajectory<Barycentric>>();
+  trajectory->Append(prognosticator_parameters.first_time,
+                     prognosticator_parameters.first_degrees_of_freedom);
+
+  // The steps of the extended prediction, if any, count against |max_steps|.
+  auto const remaining_steps_parameters =
+      [&adaptive_step_parameters, extended_prediction_steps, &trajectory]()
+      -> std::optional<Ephemeris<Barycentric>::AdaptiveStepParameters> {
+    std::int64_t const remaining_steps = adaptive_step_parameters.max_steps() -
+                                         extended_prediction_steps -
+                                         (trajectory->Size() - 1);
+    if (remaining_steps <= 0) {
+      return std::nullopt;
+    }
+    auto parameters = adaptive_step_parameters;
+    parameters.set_max_steps(remaining_steps);
+    return parameters;
+  };
+
   Status status;
-  status = ephemeris_->FlowWithAdaptiveStep(
-      prognostication.get(),
-      Ephemeris<Barycentric>::NoIntrinsicAcceleration,
-      ephemeris_->t_max(),
-      prognosticator_parameters.adaptive_step_parameters,
-      FlightPlan::max_ephemeris_steps_per_frame);
-  bool const reached_t_max = status.ok();
+  bool reached_t_max = true;
+  if (trajectory->back().time < ephemeris_->t_max()) {
+    auto const parameters = remaining_steps_parameters();
+    if (parameters.has_value()) {
+      status = ephemeris_->FlowWithAdaptiveStep(
+          trajectory.get(),
+          Ephemeris<Barycentric>::NoIntrinsicAcceleration,
+          ephemeris_->t_max(),
+          *parameters,
+          FlightPlan::max_ephemeris_steps_per_frame);
+    }
+    reached_t_max = parameters.has_value() && status.ok();
+  }
   if (reached_t_max) {
-    // This will prolong the ephemeris by |max_ephemeris_steps_per_frame|.
-    status = ephemeris_->FlowWithAdaptiveStep(
-        prognostication.get(),
-        Ephemeris<Barycentric>::NoIntrinsicAcceleration,
-        InfiniteFuture,
-        prognosticator_parameters.adaptive_step_parameters,
-        FlightPlan::max_ephemeris_steps_per_frame);
+    if (auto const parameters = remaining_steps_parameters()) {
+      // This will prolong the ephemeris by |max_ephemeris_steps_per_frame|.
+      status = ephemeris_->FlowWithAdaptiveStep(
+          trajectory.get(),
+          Ephemeris<Barycentric>::NoIntrinsicAcceleration,
+          InfiniteFuture,
+          *parameters,
+          FlightPlan::max_ephemeris_steps_per_frame);
+    }
   }
   LOG_IF_EVERY_N(INFO, !status.ok(), 50)
       << "Prognostication from " << prognosticator_parameters.first_time
-      << " finished at " << prognostication->back().time << " with "
+      << " finished at " << trajectory->back().time << " with "
       << status.ToString() << " for " << ShortDebugString();
+
+  prognostication = Prognostication{
+      std::move(trajectory),
+      adaptive_step_parameters,
+      /*extends_prediction=*/
+      prognosticator_parameters.extended_prediction_steps.has_value()};
   return status;
 }
 
 void Vessel::SwapPrognostication(
-    std::unique_ptr<DiscreteTrajectory<Barycentric>>& prognostication,
+    std::optional<Prognostication>& prognostication,
     Status const& status) {
   prognosticator_lock_.AssertHeld();
   if (status.error() != Error::CANCELLED) {
@@ -650,6 +698,29 @@ void Vessel::SwapPrognostication(
   }
 }
 
+void Vessel::AttachPrognostication() {
+  prognosticator_lock_.AssertHeld();
+  if (!prognostication_.has_value()) {
+    return;
+  }
+  auto& [trajectory, adaptive_step_parameters, extends_prediction] =
+      *prognostication_;
+  if (!extends_prediction) {
+    AttachPrediction(std::move(trajectory), adaptive_step_parameters);
+  } else if (extensible_prediction_parameters_.has_value() &&
+             !(*extensible_prediction_parameters_ !=
+                   adaptive_step_parameters) &&
+             prediction_->back().time == trajectory->front().time) {
+    // The extension starts at the last point of the prediction, only copy the
+    // new points.
+    auto it = trajectory->begin();
+    for (++it; it != trajectory->end(); ++it) {
+      prediction_->Append(it->time, it->degrees_of_freedom);
+    }
+  }
+  prognostication_.reset();
+}
+
 void Vessel::AppendToVesselTrajectory(
     TrajectoryIterator const part_trajectory_begin,
     TrajectoryIterator const part_trajectory_end,
@@ -707,8 +778,34 @@ void Vessel::AppendToVesselTrajectory(
 }
 
 void Vessel::AttachPrediction(
-    not_null<std::unique_ptr<DiscreteTrajectory<Barycentric>>> trajectory) {
-  trajectory->ForgetBefore(psychohistory_->back().time);
+    not_null<std::unique_ptr<DiscreteTrajectory<Barycentric>>> trajectory,
+    std::optional<Ephemeris<Barycentric>::AdaptiveStepParameters> const&
+        adaptive_step_parameters) {
+  // The trajectory may be extended if it passes within the integration
+  // tolerances of the end of the psychohistory.  Don't interpolate if that time
+  // is a point of the trajectory, as is typically the case at its beginning.
+  auto const psychohistory_last = psychohistory_->back();
+  extensible_prediction_parameters_.reset();
+  if (adaptive_step_parameters.has_value() &&
+      !trajectory->Empty() &&
+      trajectory->t_min() <= psychohistory_last.time &&
+      psychohistory_last.time < trajectory->t_max()) {
+    auto const it = trajectory->LowerBound(psychohistory_last.time);
+    DegreesOfFreedom<Barycentric> const degrees_of_freedom =
+        it->time == psychohistory_last.time
+            ? it->degrees_of_freedom
+            : trajectory->EvaluateDegreesOfFreedom(psychohistory_last.time);
+    if ((degrees_of_freedom.position() -
+         psychohistory_last.degrees_of_freedom.position()).Norm() <=
+            adaptive_step_parameters->length_integration_tolerance() &&
+        (degrees_of_freedom.velocity() -
+         psychohistory_last.degrees_of_freedom.velocity()).Norm() <=
+            adaptive_step_parameters->speed_integration_tolerance()) {
+      extensible_prediction_parameters_ = adaptive_step_parameters;
+    }
+  }
+
+  trajectory->ForgetBefore(psychohistory_last.time);
   if (trajectory->Empty()) {
     prediction_ = psychohistory_->NewForkAtLast();
   } else {
@@ -9,13 +9,13 @@
 #include <vector>
 
 #include "absl/synchronization/mutex.h"
-#include "base/jthread.hpp"
 #include "base/status.hpp"
 #include "ksp_plugin/celestial.hpp"
 #include "ksp_plugin/flight_plan.hpp"
 #include "ksp_plugin/orbit_analyser.hpp"
 #include "ksp_plugin/part.hpp"
 #include "ksp_plugin/pile_up.hpp"
+#include "ksp_plugin/prediction_scheduler.hpp"
 #include "physics/discrete_trajectory.hpp"
 #include "physics/ephemeris.hpp"
 #include "physics/massless_body.hpp"
@@ -171,8 +171,13 @@ class Vessel {
   // have a last time at or before |time|.
   virtual void RefreshPrediction(Instant const& time);
 
+  // Cancels the computation of the prognostication, if any.
   void StopPrognosticator();
 
+  // The priority of the asynchronous computations (prognostication, orbit
+  // analysis) for this vessel.  Also applies to the pending computations.
+  void set_prediction_priority(PredictionScheduler::Priority priority);
+
   // Returns "vessel_name (GUID)".
   std::string ShortDebugString() const;
 
@@ -209,32 +214,52 @@ class Vessel {
     Instant first_time;
     DegreesOfFreedom<Barycentric> first_degrees_of_freedom;
     Ephemeris<Barycentric>::AdaptiveStepParameters adaptive_step_parameters;
-    bool shutdown = false;
+    // If the prognostication extends the |prediction_| from its last point,
+    // the number of steps already in the |prediction_|; if it starts afresh at
+    // the end of the |psychohistory_|, nullopt.
+    std::optional<std::int64_t> extended_prediction_steps;
   };
   friend bool operator!=(PrognosticatorParameters const& left,
                          PrognosticatorParameters const& right);
 
+  // The result of |FlowPrognostication|, published to the main thread.
+  struct Prognostication {
+    not_null<std::unique_ptr<DiscreteTrajectory<Barycentric>>> trajectory;
+    // The parameters of the integration, including the steps of the
+    // extended prediction, if any.
+    Ephemeris<Barycentric>::AdaptiveStepParameters adaptive_step_parameters;
+    // True if the |trajectory| extends the |prediction_| from its last point.
+    bool extends_prediction;
+  };
+
   using TrajectoryIterator =
       DiscreteTrajectory<Barycentric>::Iterator (Part::*)();
 
-  // Starts the |prognosticator_| if it is not started already.  The
-  // |prognosticator_parameters_| must have been set.
-  void StartPrognosticatorIfNeeded() REQUIRES(prognosticator_lock_);
+  // Attaches the latest prognostication, if any, and requests a new one, which
+  // extends the |prediction_| if possible.  If |last_time| is given, the
+  // |prediction_| is then truncated to it.
+  void UpdatePrediction(std::optional<Instant> const& last_time)
+      EXCLUDES(prognosticator_lock_);
 
-  // Run by the |prognosticator_| thread to periodically recompute the
-  // prognostication.
-  Status RepeatedlyFlowPrognostication();
+  // Run by the |PredictionScheduler| to compute the prognostication for the
+  // latest |prognosticator_parameters_|, if any.
+  void FlowScheduledPrognostication() EXCLUDES(prognosticator_lock_);
 
   // Runs the integrator to compute the |prognostication_| based on the given
   // parameters.
   Status FlowPrognostication(
       PrognosticatorParameters prognosticator_parameters,
-      std::unique_ptr<DiscreteTrajectory<Barycentric>>& prognostication);
+      std::optional<Prognostication>& prognostication);
 
   // Publishes the prognostication if the computation was not cancelled.
-  void SwapPrognostication(
-      std::unique_ptr<DiscreteTrajectory<Barycentric>>& prognostication,
-      Status const& status);
+  void SwapPrognostication(std::optional<Prognostication>& prognostication,
+                           Status const& status)
+      REQUIRES(prognosticator_lock_);
+
+  // Uses the published |prognostication_|, if any, to replace or extend the
+  // |prediction_|.  An extension is dropped if the |prediction_| has changed
+  // since it was requested.
+  void AttachPrognostication() REQUIRES(prognosticator_lock_);
 
   // Appends to |trajectory| the centre of mass of the trajectories of the parts
   // denoted by |part_trajectory_begin| and |part_trajectory_end|.  Only the
@@ -244,9 +269,14 @@ class Vessel {
                                 DiscreteTrajectory<Barycentric>& trajectory);
 
   // Attaches the given |trajectory| to the end of the |psychohistory_| to
-  // become the new |prediction_|.
+  // become the new |prediction_|.  |adaptive_step_parameters| are those that
+  // were used to compute it, if known; if they are, and if the |trajectory|
+  // passes within their tolerances of the end of the |psychohistory_|, the
+  // |prediction_| may later be extended instead of being recomputed.
   void AttachPrediction(
-      not_null<std::unique_ptr<DiscreteTrajectory<Barycentric>>> trajectory);
+      not_null<std::unique_ptr<DiscreteTrajectory<Barycentric>>> trajectory,
+      std::optional<Ephemeris<Barycentric>::AdaptiveStepParameters> const&
+          adaptive_step_parameters);
 
   GUID const guid_;
   std::string name_;
@@ -263,12 +293,13 @@ class Vessel {
 
   mutable absl::Mutex prognosticator_lock_;
   // This member only contains a value if |RefreshPrediction| has been called
-  // but the parameters have not been picked by the |prognosticator_|.  It never
-  // contains a moved-from value, and is only read using |std::swap| to ensure
-  // that reading it clears it.
+  // but the parameters have not been picked by the scheduled prognostication.
+  // It never contains a moved-from value, and is only read using |std::swap|
+  // to ensure that reading it clears it.
   std::optional<PrognosticatorParameters> prognosticator_parameters_
       GUARDED_BY(prognosticator_lock_);
-  base::jthread prognosticator_;
+  PredictionScheduler::Priority prediction_priority_ =
+      PredictionScheduler::Priority::Other;
 
   // See the comments in pile_up.hpp for an explanation of the terminology.
   not_null<std::unique_ptr<DiscreteTrajectory<Barycentric>>> history_;
@@ -276,10 +307,16 @@ class Vessel {
 
   // The |prediction_| is forked off the end of the |psychohistory_|.
   DiscreteTrajectory<Barycentric>* prediction_ = nullptr;
+  // The parameters with which the |prediction_| was computed, if it may be
+  // extended from its last point instead of being recomputed, typically
+  // because the vessel is coasting.
+  std::optional<Ephemeris<Barycentric>::AdaptiveStepParameters>
+      extensible_prediction_parameters_;
 
   // The |prognostication_| is a root trajectory that's computed asynchronously
-  // and may or may not be used as a prediction;
-  std::unique_ptr<DiscreteTrajectory<Barycentric>> prognostication_
+  // and may or may not be used as a prediction or to extend it.  Only the new
+  // points of an extension are copied to the |prediction_|.
+  std::optional<Prognostication> prognostication_
       GUARDED_BY(prognosticator_lock_);
 
   std::unique_ptr<FlightPlan> flight_plan_;
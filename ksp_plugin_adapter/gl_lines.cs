@@ -82,52 +82,52 @@ public enum Style {
                                   Style style) {
     UnityEngine.GL.Color(colour);
 
-    // First evaluate the total size of the lines.
+    // Obtain all the points of the lines in a single call, growing the buffer
+    // if it is too small.
+    int buffer_size = rp2_lines_iterator.IteratorFillRP2LinesXY(
+        rp2_points_, rp2_points_.Length);
+    if (buffer_size > rp2_points_.Length) {
+      rp2_points_ = new XY[buffer_size];
+      rp2_lines_iterator.IteratorFillRP2LinesXY(rp2_points_,
+                                                rp2_points_.Length);
+    }
+
+    // Evaluate the total size of the lines, excluding the separators.
     int size = 0;
-    for (;
-         !rp2_lines_iterator.IteratorAtEnd();
-         rp2_lines_iterator.IteratorIncrement()) {
-      using (DisposableIterator rp2_line_iterator =
-                rp2_lines_iterator.IteratorGetRP2LinesIterator()) {
-        size += rp2_line_iterator.IteratorSize();
+    for (int i = 0; i < buffer_size; ++i) {
+      if (!double.IsNaN(rp2_points_[i].x)) {
+        ++size;
       }
     }
 
-    // Reset the iterator and do the actual plotting.
-    rp2_lines_iterator.IteratorReset();
     int index = 0;
-    for (;
-         !rp2_lines_iterator.IteratorAtEnd();
-         rp2_lines_iterator.IteratorIncrement()) {
-      using (DisposableIterator rp2_line_iterator =
-                rp2_lines_iterator.IteratorGetRP2LinesIterator()) {
-        XY? previous_rp2_point = null;
-        for (;
-             !rp2_line_iterator.IteratorAtEnd();
-             rp2_line_iterator.IteratorIncrement()) {
-          XY current_rp2_point = ToScreen(
-              rp2_line_iterator.IteratorGetRP2LineXY());
-          if (previous_rp2_point.HasValue) {
-            if (style == Style.Faded) {
-              var faded_colour = colour;
-              // Fade from the opacity of |colour| (when index = 0) down to 1/4
-              // of that opacity.
-              faded_colour.a *= 1 - (float)(4 * index) / (float)(5 * size);
-              UnityEngine.GL.Color(faded_colour);
-            }
-            if (style != Style.Dashed || index % 2 == 1) {
-              UnityEngine.GL.Vertex3((float)previous_rp2_point.Value.x,
-                                      (float)previous_rp2_point.Value.y,
-                                      0);
-              UnityEngine.GL.Vertex3((float)current_rp2_point.x,
-                                      (float)current_rp2_point.y,
-                                      0);
-            }
-          }
-          previous_rp2_point = current_rp2_point;
-          ++index;
+    XY? previous_rp2_point = null;
+    for (int i = 0; i < buffer_size; ++i) {
+      if (double.IsNaN(rp2_points_[i].x)) {
+        // Start a new line.
+        previous_rp2_point = null;
+        continue;
+      }
+      XY current_rp2_point = ToScreen(rp2_points_[i]);
+      if (previous_rp2_point.HasValue) {
+        if (style == Style.Faded) {
+          var faded_colour = colour;
+          // Fade from the opacity of |colour| (when index = 0) down to 1/4 of
+          // that opacity.
+          faded_colour.a *= 1 - (float)(4 * index) / (float)(5 * size);
+          UnityEngine.GL.Color(faded_colour);
+        }
+        if (style != Style.Dashed || index % 2 == 1) {
+          UnityEngine.GL.Vertex3((float)previous_rp2_point.Value.x,
+                                 (float)previous_rp2_point.Value.y,
+                                 0);
+          UnityEngine.GL.Vertex3((float)current_rp2_point.x,
+                                 (float)current_rp2_point.y,
+                                 0);
         }
       }
+      previous_rp2_point = current_rp2_point;
+      ++index;
     }
   }
 
@@ -144,6 +144,9 @@ public enum Style {
                       0.5 * camera.pixelHeight};
    }
 
+  // The buffer that receives the points of the lines, reused across calls.
+  private static XY[] rp2_points_ = new XY[1024];
+
   private static UnityEngine.Material line_material_;
   private static UnityEngine.Material line_material {
     get {
@@ -71,6 +71,11 @@ internal static partial class Interface {
              CallingConvention = CallingConvention.Cdecl)]
   internal static extern void ActivateRecorder(bool activate);
 
+  [DllImport(dllName           : dll_path,
+             EntryPoint        = "principia__DumpLatencies",
+             CallingConvention = CallingConvention.Cdecl)]
+  internal static extern void DumpLatencies();
+
   [DllImport(dllName           : dll_path,
              EntryPoint        = "principia__InitGoogleLogging",
              CallingConvention = CallingConvention.Cdecl)]
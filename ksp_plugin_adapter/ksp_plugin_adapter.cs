@@ -81,6 +81,10 @@ private enum UnityLayers {
   private string serialization_compression_ = "";
   [KSPField(isPersistant = true)]
   private string serialization_encoding_ = "hexadecimal";
+  // The serialization that was loaded if the plugin could not be read from it,
+  // e.g., because its block store is missing.  It is saved unchanged so that
+  // the state is not lost.
+  private string[] unreadable_serializations_;
 
   // Whether the plotting frame must be set to something convenient at the next
   // opportunity.
@@ -732,6 +736,10 @@ class PartCentredForceHolder {
         }
         node.AddValue(principia_serialized_plugin_, serialization);
       }
+    } else if (unreadable_serializations_ != null) {
+      foreach (string serialization in unreadable_serializations_) {
+        node.AddValue(principia_serialized_plugin_, serialization);
+      }
     }
   }
 
@@ -743,6 +751,7 @@ class PartCentredForceHolder {
     if (node.HasValue(principia_serialized_plugin_)) {
       Cleanup();
       RemoveBuggyTidalLocking();
+      unreadable_serializations_ = null;
 
       IntPtr deserializer = IntPtr.Zero;
       string[] serializations = node.GetValues(principia_serialized_plugin_);
@@ -759,6 +768,12 @@ class PartCentredForceHolder {
                                   ref plugin_,
                                   serialization_compression_,
                                   serialization_encoding_);
+      if (!PluginRunning()) {
+        Log.Error("Unable to read the Principia state, see the log for " +
+                  "details; it will be saved unchanged");
+        unreadable_serializations_ = serializations;
+        return;
+      }
       if (serialization_compression_ == "") {
         serialization_compression_ = "gipfeli";
       }
@@ -2168,7 +2183,13 @@ class PartCentredForceHolder {
 
   private void PlotCelestialTrajectories(DisposablePlanetarium planetarium,
                                          string main_vessel_guid) {
+    // The hidden celestials and those fixed in the plotting frame are not
+    // plotted.
+    var plotted_celestials = new List<CelestialBody>();
+    var colours = new List<UnityEngine.Color>();
+    var plotted = new char[FlightGlobals.Bodies.Count];
     foreach (CelestialBody celestial in FlightGlobals.Bodies) {
+      plotted[celestial.flightGlobalsIndex] = '0';
       if (plotting_frame_selector_.FixedBodies().Contains(celestial)) {
         continue;
       }
@@ -2190,24 +2211,38 @@ class PartCentredForceHolder {
       if (colour.a == 0) {
         continue;
       }
-      using (DisposableIterator rp2_lines_iterator =
-                planetarium.PlanetariumPlotCelestialTrajectoryForPsychohistory(
-                    plugin_,
-                    celestial.flightGlobalsIndex,
-                    main_vessel_guid,
-                    main_window_.history_length)) {
-        GLLines.PlotRP2Lines(rp2_lines_iterator,
-                              colour,
-                              GLLines.Style.Faded);
-      }
-      if (main_vessel_guid != null) {
+      plotted[celestial.flightGlobalsIndex] = '1';
+      plotted_celestials.Add(celestial);
+      colours.Add(colour);
+    }
+    if (plotted_celestials.Count == 0) {
+      return;
+    }
+    // The trajectories of the plotted celestials are plotted together.  For
+    // each of them, by increasing index, the iterator has the past trajectory
+    // and, if there is a main vessel, the future trajectory.
+    using (DisposableIterator rp2_lines_list_iterator =
+              planetarium.PlanetariumPlotCelestialTrajectories(
+                  plugin_,
+                  new string(plotted),
+                  main_vessel_guid,
+                  main_window_.history_length)) {
+      for (int i = 0; i < plotted_celestials.Count; ++i) {
         using (DisposableIterator rp2_lines_iterator =
-            planetarium.
-                PlanetariumPlotCelestialTrajectoryForPredictionOrFlightPlan(
-                    plugin_,
-                    celestial.flightGlobalsIndex,
-                    main_vessel_guid)) {
-          GLLines.PlotRP2Lines(rp2_lines_iterator, colour, GLLines.Style.Solid);
+                  rp2_lines_list_iterator.IteratorGetRP2LinesListIterator()) {
+          GLLines.PlotRP2Lines(rp2_lines_iterator,
+                               colours[i],
+                               GLLines.Style.Faded);
+        }
+        rp2_lines_list_iterator.IteratorIncrement();
+        if (main_vessel_guid != null) {
+          using (DisposableIterator rp2_lines_iterator =
+                    rp2_lines_list_iterator.IteratorGetRP2LinesListIterator()) {
+            GLLines.PlotRP2Lines(rp2_lines_iterator,
+                                 colours[i],
+                                 GLLines.Style.Solid);
+          }
+          rp2_lines_list_iterator.IteratorIncrement();
         }
       }
     }
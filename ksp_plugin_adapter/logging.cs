@@ -16,6 +16,10 @@ internal static class Log {
     Interface.ActivateRecorder(activate);
   }
 
+  internal static void DumpLatencies() {
+    Interface.DumpLatencies();
+  }
+
   internal static void SetBufferedLogging(int max_severity) {
     Interface.SetBufferedLogging(max_severity);
   }
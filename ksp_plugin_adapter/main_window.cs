@@ -359,6 +359,10 @@ internal class MainWindow : VesselSupervisedWindowRenderer {
           "Journaling is " + (journaling_ ? "ON" : "OFF"),
           style : Style.Info(Style.RightAligned(UnityEngine.GUI.skin.label)));
     }
+    if (UnityEngine.GUILayout.Button(
+            text : "Write the latencies of the interface calls")) {
+      Log.DumpLatencies();
+    }
     if (journaling_ && !must_record_journal_) {
       // We can deactivate a recorder at any time, but in order for replaying to
       // work, we should only activate one before creating a plugin.
@@ -1,9 +1,12 @@
 ﻿
 #include "ksp_plugin/flight_plan.hpp"
 
+#include <algorithm>
 #include <limits>
+#include <list>
 #include <vector>
 
+#include "absl/synchronization/mutex.h"
 #include "astronomy/epoch.hpp"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -172,6 +175,41 @@ class FlightPlanTest : public testing::Test {
     return burn;
   }
 
+  // Waits until the speculations of |flight_plan_| are done, and returns the
+  // last segment of the cached segments that start with a manœuvre having the
+  // Δv of |burn|, or null if there are none.
+  DiscreteTrajectory<Barycentric> const* WaitForCachedLastSegment(
+      NavigationManœuvre::Burn const& burn) {
+    absl::MutexLock l(&flight_plan_->lock_);
+    flight_plan_->lock_.Await(absl::Condition(
+        +[](std::list<FlightPlan::CachedSegments>* const cached_segments) {
+          return std::all_of(
+              cached_segments->begin(),
+              cached_segments->end(),
+              [](FlightPlan::CachedSegments const& cached) {
+                return cached.state == FlightPlan::CachedSegments::State::Done;
+              });
+        },
+        &flight_plan_->cached_segments_));
+    for (auto const& cached : flight_plan_->cached_segments_) {
+      if (cached.burn != nullptr &&
+          cached.manœuvres.front().burn().intensity.Δv == burn.intensity.Δv) {
+        return cached.segments.back();
+      }
+    }
+    return nullptr;
+  }
+
+  // The number of cached segments of |flight_plan_| that failed to compute.
+  int FailedCachedSegments() {
+    absl::MutexLock l(&flight_plan_->lock_);
+    return std::count_if(flight_plan_->cached_segments_.begin(),
+                         flight_plan_->cached_segments_.end(),
+                         [](FlightPlan::CachedSegments const& cached) {
+                           return cached.burn == nullptr;
+                         });
+  }
+
   Instant const t0_;
   std::unique_ptr<TestNavigationFrame> navigation_frame_;
   std::unique_ptr<Ephemeris<Barycentric>> ephemeris_;
@@ -423,6 +461,56 @@ TEST_F(FlightPlanTest, Replace) {
   EXPECT_LT(t0_ + 1.7 * Second, flight_plan_->desired_final_time());
 }
 
+TEST_F(FlightPlanTest, SegmentReuse) {
+  flight_plan_->SetDesiredFinalTime(t0_ + 42 * Second);
+  // The last segment of the flight plan, and its last point.
+  auto const last_segment =
+      [this]() -> DiscreteTrajectory<Barycentric> const* {
+        DiscreteTrajectory<Barycentric>::Iterator begin;
+        DiscreteTrajectory<Barycentric>::Iterator end;
+        flight_plan_->GetAllSegments(begin, end);
+        --end;
+        return end.trajectory();
+      };
+  auto const last_point = [&last_segment]() {
+    return last_segment()->back().degrees_of_freedom;
+  };
+  auto const make_burn = [this](double const Δv_ratio) {
+    auto burn = MakeFirstBurn();
+    *burn.intensity.Δv *= Δv_ratio;
+    return burn;
+  };
+
+  EXPECT_OK(flight_plan_->Insert(make_burn(1), 0));
+  auto const* const first_last_segment = last_segment();
+  EXPECT_OK(flight_plan_->Replace(make_burn(10), 0));
+  EXPECT_NE(first_last_segment, last_segment());
+
+  // Coming back to the first burn reuses its segments.
+  EXPECT_OK(flight_plan_->Replace(make_burn(1), 0));
+  EXPECT_EQ(first_last_segment, last_segment());
+
+  // Coming back to the first burn cancelled the speculation on a Δv of
+  // 19 m/s, which is not kept in the cache.  It started a speculation on a Δv
+  // of -8 m/s, whose segments are computed in the background and are the ones
+  // attached to the flight plan if that burn is chosen.
+  DiscreteTrajectory<Barycentric> const* const speculative_last_segment =
+      WaitForCachedLastSegment(make_burn(-8));
+  ASSERT_NE(nullptr, speculative_last_segment);
+  EXPECT_EQ(0, FailedCachedSegments());
+  EXPECT_EQ(1, flight_plan_->progress_of_speculations());
+  EXPECT_OK(flight_plan_->Replace(make_burn(-8), 0));
+  EXPECT_EQ(speculative_last_segment, last_segment());
+  EXPECT_EQ(3, flight_plan_->number_of_segments());
+
+  // These segments are the same as those of a computation from scratch.
+  DegreesOfFreedom<Barycentric> const speculative_last_point = last_point();
+  EXPECT_OK(flight_plan_->SetAdaptiveStepParameters(
+      flight_plan_->adaptive_step_parameters(),
+      flight_plan_->generalized_adaptive_step_parameters()));
+  EXPECT_EQ(speculative_last_point, last_point());
+}
+
 TEST_F(FlightPlanTest, Segments) {
   flight_plan_->SetDesiredFinalTime(t0_ + 42 * Second);
   EXPECT_OK(flight_plan_->Insert(MakeFirstBurn(), 0));
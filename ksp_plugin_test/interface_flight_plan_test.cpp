@@ -389,6 +389,12 @@ TEST_F(InterfaceFlightPlanTest, FlightPlan) {
   principia__IteratorIncrement(iterator);
   EXPECT_EQ(XYZ({0, 2, 4}),
             principia__IteratorGetDiscreteTrajectoryXYZ(iterator));
+  principia__IteratorReset(iterator);
+  XYZ xyz[2];
+  EXPECT_EQ(3,
+            principia__IteratorFillDiscreteTrajectoryXYZ(iterator, xyz, 2));
+  EXPECT_EQ(XYZ({0, 0, 0}), xyz[0]);
+  EXPECT_EQ(XYZ({0, 1, 2}), xyz[1]);
 
   interface_burn.thrust_in_kilonewtons = 10;
   EXPECT_CALL(*plugin_,
@@ -1,18 +1,23 @@
 
 #include "ksp_plugin/interface.hpp"
 
+#include <cmath>
+
 #include "geometry/affine_map.hpp"
 #include "geometry/named_quantities.hpp"
 #include "geometry/orthogonal_map.hpp"
 #include "geometry/permutation.hpp"
 #include "geometry/rotation.hpp"
+#include "geometry/rp2_point.hpp"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "ksp_plugin/frames.hpp"
+#include "ksp_plugin/iterators.hpp"
 #include "ksp_plugin_test/mock_planetarium.hpp"
 #include "ksp_plugin_test/mock_plugin.hpp"
 #include "ksp_plugin_test/mock_renderer.hpp"
 #include "quantities/quantities.hpp"
+#include "quantities/si.hpp"
 #include "testing_utilities/actions.hpp"
 
 namespace principia {
@@ -25,12 +30,16 @@ using geometry::OrthogonalMap;
 using geometry::Permutation;
 using geometry::RigidTransformation;
 using geometry::Rotation;
+using geometry::RP2Lines;
+using geometry::RP2Point;
 using ksp_plugin::Camera;
 using ksp_plugin::Navigation;
 using ksp_plugin::MockPlanetarium;
 using ksp_plugin::MockPlugin;
 using ksp_plugin::MockRenderer;
+using ksp_plugin::TypedIterator;
 using quantities::Length;
+using quantities::si::Metre;
 using testing_utilities::FillUniquePtr;
 using ::testing::IsNull;
 using ::testing::Return;
@@ -78,5 +87,35 @@ TEST_F(InterfacePlanetariumTest, ConstructionDestruction) {
   EXPECT_THAT(planetarium, IsNull());
 }
 
+TEST_F(InterfacePlanetariumTest, IteratorFillRP2LinesXY) {
+  using Point = RP2Point<Length, Camera>;
+  Iterator* iterator = new TypedIterator<RP2Lines<Length, Camera>>(
+      {{Point(1 * Metre, 2 * Metre, 1), Point(3 * Metre, 4 * Metre, 1)},
+       {Point(5 * Metre, 6 * Metre, 1)}});
+
+  // The buffer is too small: the size is returned and the buffer is filled as
+  // much as possible.
+  XY xy[4];
+  EXPECT_EQ(4, principia__IteratorFillRP2LinesXY(iterator, xy, 2));
+  EXPECT_EQ(XY({1, 2}), xy[0]);
+  EXPECT_EQ(XY({3, 4}), xy[1]);
+
+  // The lines are separated by a NaN point.
+  EXPECT_EQ(4, principia__IteratorFillRP2LinesXY(iterator, xy, 4));
+  EXPECT_EQ(XY({1, 2}), xy[0]);
+  EXPECT_EQ(XY({3, 4}), xy[1]);
+  EXPECT_TRUE(std::isnan(xy[2].x));
+  EXPECT_TRUE(std::isnan(xy[2].y));
+  EXPECT_EQ(XY({5, 6}), xy[3]);
+
+  // Only the lines from the current one are exported.
+  principia__IteratorIncrement(iterator);
+  EXPECT_EQ(1, principia__IteratorFillRP2LinesXY(iterator, xy, 4));
+  EXPECT_EQ(XY({5, 6}), xy[0]);
+
+  principia__IteratorDelete(&iterator);
+  EXPECT_THAT(iterator, IsNull());
+}
+
 }  // namespace interface
 }  // namespace principia
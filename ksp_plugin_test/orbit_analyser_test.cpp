@@ -96,7 +96,8 @@ TEST_F(OrbitAnalyserTest, TOPEXPoséidon) {
       {.first_time = arc.begin()->time,
        .first_degrees_of_freedom = itrs_.FromThisFrameAtTime(arc.begin()->time)(
            arc.begin()->degrees_of_freedom),
-       .mission_duration = 3 * Hour});
+       .mission_duration = 3 * Hour},
+      PredictionScheduler::Priority::ActiveVessel);
   while (analyser.progress_of_next_analysis() != 1) {
     absl::SleepFor(absl::Milliseconds(10));
   }
@@ -2,6 +2,7 @@
 #include "ksp_plugin/pile_up.hpp"
 
 #include <limits>
+#include <list>
 #include <map>
 #include <string>
 #include <vector>
@@ -63,6 +64,7 @@ using quantities::Time;
 using quantities::si::Kilogram;
 using quantities::si::Metre;
 using quantities::si::Micro;
+using quantities::si::Milli;
 using quantities::si::Newton;
 using quantities::si::Radian;
 using quantities::si::Second;
@@ -75,6 +77,7 @@ using ::testing::DoAll;
 using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::IsEmpty;
+using ::testing::Lt;
 using ::testing::Matcher;
 using ::testing::MockFunction;
 using ::testing::Return;
@@ -98,6 +101,11 @@ class TestablePileUp : public PileUp {
     return intrinsic_force_;
   }
 
+  bool batched() const {
+    absl::MutexLock l(lock_.get());
+    return batch_ != nullptr;
+  }
+
   not_null<DiscreteTrajectory<Barycentric>*> psychohistory() const {
     return psychohistory_;
   }
@@ -646,6 +654,234 @@ TEST_F(PileUpTest, MidStepIntrinsicForce) {
       AlmostEquals(old_velocity + 0.5 * fixed_step * a, 1));
 }
 
+TEST_F(PileUpTest, Batch) {
+  // A nearly empty ephemeris, as above.
+  std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
+  bodies.emplace_back(make_not_null_unique<MassiveBody>(1 * Kilogram));
+  std::vector<DegreesOfFreedom<Barycentric>> initial_state{
+      DegreesOfFreedom<Barycentric>{
+          Barycentric::origin +
+              Displacement<Barycentric>(
+                  {std::pow(2, 100) * Metre, 0 * Metre, 0 * Metre}),
+          Barycentric::unmoving}};
+  Ephemeris<Barycentric> ephemeris{
+      std::move(bodies),
+      initial_state,
+      /*initial_time=*/astronomy::J2000,
+      /*accuracy_parameters=*/{/*fitting_tolerance=*/1 * Metre,
+                               /*geopotential_tolerance=*/0x1p-24},
+      Ephemeris<Barycentric>::FixedStepParameters{
+          SymplecticRungeKuttaNyströmIntegrator<BlanesMoan2002SRKN6B,
+                                                Position<Barycentric>>(),
+          1 * Second}};
+  ASSERT_THAT(DefaultHistoryParameters().step(), Eq(10 * Second));
+
+  // The pile-ups are created at different times, so their histories are not
+  // initially aligned.
+  EXPECT_CALL(deletion_callback_, Call()).Times(2);
+  TestablePileUp pile_up1({&p1_}, astronomy::J2000,
+                          DefaultPsychohistoryParameters(),
+                          DefaultHistoryParameters(),
+                          &ephemeris,
+                          deletion_callback_.AsStdFunction());
+  TestablePileUp pile_up2({&p2_}, astronomy::J2000 + 3 * Second,
+                          DefaultPsychohistoryParameters(),
+                          DefaultHistoryParameters(),
+                          &ephemeris,
+                          deletion_callback_.AsStdFunction());
+  std::list<PileUp*> const pile_ups{&pile_up1, &pile_up2};
+  PileUpBatch batch(DefaultHistoryParameters(), &ephemeris);
+
+  auto const advance_time = [&batch, &pile_ups](Instant const& t) {
+    auto const selected = batch.Select(pile_ups, t);
+    batch.AdvanceHistories(t);
+    for (PileUp* const pile_up : pile_ups) {
+      EXPECT_TRUE(pile_up->DeformAndAdvanceTime(t).ok());
+    }
+    return selected.size();
+  };
+  auto const last_history_time = [](Part& part) {
+    return (--part.history_end())->time;
+  };
+  auto const last_psychohistory_point = [](Part& part) {
+    return *--part.psychohistory_end();
+  };
+
+  // The first pile-up is aligned on the second one, then both are integrated
+  // together.
+  EXPECT_THAT(advance_time(astronomy::J2000 + 25 * Second), Eq(2));
+  EXPECT_THAT(last_history_time(p1_), Eq(astronomy::J2000 + 23 * Second));
+  EXPECT_THAT(last_history_time(p2_), Eq(astronomy::J2000 + 23 * Second));
+  EXPECT_THAT(last_psychohistory_point(p1_).time,
+              Eq(astronomy::J2000 + 25 * Second));
+  EXPECT_THAT(last_psychohistory_point(p1_).degrees_of_freedom,
+              Componentwise(AlmostEquals(p1_dof_.position() +
+                                             25 * Second * p1_dof_.velocity(),
+                                         0, 20),
+                            AlmostEquals(p1_dof_.velocity(), 0, 20)));
+  EXPECT_THAT(last_psychohistory_point(p2_).degrees_of_freedom,
+              Componentwise(AlmostEquals(p2_dof_.position() +
+                                             22 * Second * p2_dof_.velocity(),
+                                         0, 20),
+                            AlmostEquals(p2_dof_.velocity(), 0, 20)));
+
+  EXPECT_THAT(advance_time(astronomy::J2000 + 47 * Second), Eq(2));
+  EXPECT_THAT(last_history_time(p1_), Eq(astronomy::J2000 + 43 * Second));
+  EXPECT_THAT(last_history_time(p2_), Eq(astronomy::J2000 + 43 * Second));
+
+  // A pile-up with an intrinsic force leaves the batch and is integrated
+  // individually.
+  p1_.apply_intrinsic_force(p1_.mass() * Vector<Acceleration, Barycentric>(
+                                             {1 * Metre / Pow<2>(Second),
+                                              0 * Metre / Pow<2>(Second),
+                                              0 * Metre / Pow<2>(Second)}));
+  pile_up1.RecomputeFromParts();
+  EXPECT_THAT(advance_time(astronomy::J2000 + 70 * Second), Eq(1));
+  EXPECT_THAT(last_history_time(p1_), Eq(astronomy::J2000 + 70 * Second));
+  EXPECT_THAT(last_history_time(p2_), Eq(astronomy::J2000 + 63 * Second));
+  EXPECT_THAT(last_psychohistory_point(p2_).time,
+              Eq(astronomy::J2000 + 70 * Second));
+
+  // When the force stops, the pile-up joins the batch again: the member is
+  // advanced by one fixed step, and the newcomer is aligned on it.
+  p1_.clear_intrinsic_force();
+  pile_up1.RecomputeFromParts();
+  EXPECT_THAT(advance_time(astronomy::J2000 + 85 * Second), Eq(2));
+  EXPECT_THAT(last_history_time(p1_), Eq(astronomy::J2000 + 83 * Second));
+  EXPECT_THAT(last_history_time(p2_), Eq(astronomy::J2000 + 83 * Second));
+
+  // A pile-up that is going to be deformed is not selected.
+  pile_up2.SetPartApparentRigidMotion(
+      &p2_,
+      RigidMotion<RigidPart, Apparent>::MakeNonRotatingMotion(
+          DegreesOfFreedom<Apparent>(Apparent::origin, Apparent::unmoving)));
+  EXPECT_THAT(advance_time(astronomy::J2000 + 95 * Second), Eq(1));
+  EXPECT_THAT(last_history_time(p1_), Eq(astronomy::J2000 + 93 * Second));
+}
+
+// Checks that the histories integrated by a batch agree with those integrated
+// individually, even when pile-ups join and leave the batch.
+TEST_F(PileUpTest, BatchMatchesIndividualIntegration) {
+  // A central body, and pile-ups in orbit around it.
+  std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
+  bodies.emplace_back(make_not_null_unique<MassiveBody>(6e24 * Kilogram));
+  Ephemeris<Barycentric> ephemeris{
+      std::move(bodies),
+      {DegreesOfFreedom<Barycentric>{Barycentric::origin,
+                                     Barycentric::unmoving}},
+      /*initial_time=*/astronomy::J2000,
+      /*accuracy_parameters=*/{/*fitting_tolerance=*/1 * Metre,
+                               /*geopotential_tolerance=*/0x1p-24},
+      Ephemeris<Barycentric>::FixedStepParameters{
+          SymplecticRungeKuttaNyströmIntegrator<BlanesMoan2002SRKN6B,
+                                                Position<Barycentric>>(),
+          10 * Second}};
+
+  // Each pile-up of the batch has a twin that is integrated individually.  The
+  // third pair is created later, at a time that is not on the grid of the
+  // batch.
+  std::vector<Instant> const creation_times{astronomy::J2000,
+                                            astronomy::J2000,
+                                            astronomy::J2000 + 53 * Second};
+  std::vector<std::unique_ptr<Part>> parts;
+  std::vector<std::unique_ptr<TestablePileUp>> batched_pile_ups;
+  std::vector<std::unique_ptr<TestablePileUp>> individual_pile_ups;
+  auto const add_pile_up =
+      [this, &ephemeris, &parts](
+          int const i,
+          std::vector<std::unique_ptr<TestablePileUp>>& pile_ups,
+          Instant const& t) {
+    DegreesOfFreedom<Barycentric> const degrees_of_freedom(
+        Barycentric::origin +
+            Displacement<Barycentric>(
+                {(7e6 + 1e4 * i) * Metre, 0 * Metre, 1e5 * i * Metre}),
+        Velocity<Barycentric>({0 * Metre / Second,
+                               7.5e3 * Metre / Second,
+                               10 * i * Metre / Second}));
+    parts.push_back(std::make_unique<Part>(
+        1000 + parts.size(),
+        "p",
+        mass1_,
+        EccentricPart::origin,
+        inertia_tensor1_,
+        RigidMotion<EccentricPart, Barycentric>::MakeNonRotatingMotion(
+            degrees_of_freedom),
+        /*deletion_callback=*/nullptr));
+    pile_ups.push_back(std::make_unique<TestablePileUp>(
+        std::list<not_null<Part*>>{parts.back().get()},
+        t,
+        DefaultPsychohistoryParameters(),
+        DefaultHistoryParameters(),
+        &ephemeris,
+        /*deletion_callback=*/nullptr));
+  };
+
+  PileUpBatch batch(DefaultHistoryParameters(), &ephemeris);
+  std::list<PileUp*> pile_ups;
+  for (Instant t = astronomy::J2000 + 7 * Second;
+       t < astronomy::J2000 + 400 * Second;
+       t += 7 * Second) {
+    for (int i = 0; i < creation_times.size(); ++i) {
+      if (batched_pile_ups.size() == i && creation_times[i] <= t) {
+        add_pile_up(i, batched_pile_ups, creation_times[i]);
+        add_pile_up(i, individual_pile_ups, creation_times[i]);
+        pile_ups.push_back(batched_pile_ups.back().get());
+      }
+    }
+    // The second pile-up is deformed once, so it leaves the batch and joins it
+    // again at the next step.
+    if (t == astronomy::J2000 + 140 * Second) {
+      for (auto* const pile_up : {batched_pile_ups[1].get(),
+                                  individual_pile_ups[1].get()}) {
+        Part& part = *pile_up->parts().front();
+        pile_up->SetPartApparentRigidMotion(
+            &part,
+            RigidMotion<RigidPart, Apparent>::MakeNonRotatingMotion(
+                DegreesOfFreedom<Apparent>(Apparent::origin,
+                                           Apparent::unmoving)));
+      }
+    }
+    batch.Select(pile_ups, t);
+    batch.AdvanceHistories(t);
+    for (auto const& pile_up : batched_pile_ups) {
+      EXPECT_TRUE(pile_up->DeformAndAdvanceTime(t).ok());
+    }
+    for (auto const& pile_up : individual_pile_ups) {
+      EXPECT_TRUE(pile_up->DeformAndAdvanceTime(t).ok());
+    }
+  }
+
+  for (auto const& pile_up : batched_pile_ups) {
+    EXPECT_TRUE(pile_up->batched());
+  }
+  for (int i = 0; i < batched_pile_ups.size(); ++i) {
+    Part const& batched_part = *parts[2 * i];
+    Part const& individual_part = *parts[2 * i + 1];
+    auto const batched_point = *--batched_part.psychohistory_end();
+    auto const individual_point = *--individual_part.psychohistory_end();
+    EXPECT_EQ(batched_point.time, individual_point.time);
+    if (i < 2) {
+      // The integrator was not restarted when the pile-ups joined or left the
+      // batch, so the integrations are identical.
+      EXPECT_THAT(batched_point.degrees_of_freedom,
+                  Componentwise(AlmostEquals(
+                                    individual_point.degrees_of_freedom
+                                        .position(), 0),
+                                AlmostEquals(
+                                    individual_point.degrees_of_freedom
+                                        .velocity(), 0)));
+    } else {
+      // The third pile-up was aligned on the batch.
+      EXPECT_THAT((batched_point.degrees_of_freedom.position() -
+                   individual_point.degrees_of_freedom.position()).Norm(),
+                  Lt(1 * Milli(Metre)));
+      EXPECT_THAT((batched_point.degrees_of_freedom.velocity() -
+                   individual_point.degrees_of_freedom.velocity()).Norm(),
+                  Lt(1 * Micro(Metre) / Second));
+    }
+  }
+}
+
 TEST_F(PileUpTest, Serialization) {
   MockEphemeris<Barycentric> ephemeris;
   p1_.apply_intrinsic_force(
@@ -70,7 +70,9 @@ using testing_utilities::ReadFromBinaryFile;
 using testing_utilities::VanishesBefore;
 using ::testing::_;
 using ::testing::AllOf;
+using ::testing::DoAll;
 using ::testing::Ge;
+using ::testing::InvokeWithoutArgs;
 using ::testing::Le;
 using ::testing::Return;
 using ::testing::ReturnRef;
@@ -251,6 +253,221 @@ TEST_F(PlanetariumTest, PlotMethod2) {
   }
 }
 
+TEST_F(PlanetariumTest, PlotMethod2Cache) {
+  auto const discrete_trajectory =
+      NewCircularTrajectory(/*period=*/100'000 * Second,
+                            /*step=*/1 * Second,
+                            /*last=*/25'000 * Second);
+
+  // Count the evaluations of the plotting frame.
+  int evaluations = 0;
+  EXPECT_CALL(plotting_frame_, ToThisFrameAtTime(_))
+      .WillRepeatedly(DoAll(InvokeWithoutArgs([&evaluations]() {
+                              ++evaluations;
+                            }),
+                            Return(RigidMotion<Barycentric, Navigation>(
+                                RigidTransformation<Barycentric, Navigation>::
+                                    Identity(),
+                                Barycentric::nonrotating,
+                                Barycentric::unmoving))));
+
+  Planetarium::Parameters parameters(
+      /*sphere_radius_multiplier=*/1,
+      /*angular_resolution=*/0.4 * ArcMinute,
+      /*field_of_view=*/90 * Degree);
+  PlottingCache plotting_cache;
+  auto const plot = [this,
+                     &discrete_trajectory,
+                     &parameters,
+                     &plotting_cache](Instant const& last_time) {
+    Planetarium planetarium(parameters,
+                            perspective_,
+                            &ephemeris_,
+                            &plotting_frame_,
+                            &plotting_cache);
+    return planetarium.PlotMethod2(discrete_trajectory->begin(),
+                                   discrete_trajectory->LowerBound(last_time),
+                                   t0_ + 10 * Second,
+                                   /*reverse=*/false);
+  };
+
+  plot(t0_ + 20'000 * Second);
+  int const first_evaluations = evaluations;
+
+  // Extending the plotted part of the trajectory only samples the new part.
+  evaluations = 0;
+  auto const rp2_lines = plot(t0_ + 25'000 * Second);
+  EXPECT_THAT(evaluations, Le(first_evaluations / 2));
+  EXPECT_THAT(rp2_lines, SizeIs(1));
+  EXPECT_THAT(rp2_lines[0], SizeIs(AllOf(Ge(40), Le(50))));
+  for (auto const& rp2_point : rp2_lines[0]) {
+    EXPECT_THAT(rp2_point.x(),
+                AllOf(Ge(0 * Metre),
+                      Le((5.0 / Sqrt(3.0)) * Metre)));
+    EXPECT_THAT(rp2_point.y(), VanishesBefore(1 * Metre, 0, 14));
+  }
+
+  // Plotting the same part again only validates the samples and recomputes the
+  // last one.
+  evaluations = 0;
+  EXPECT_THAT(plot(t0_ + 25'000 * Second)[0], SizeIs(rp2_lines[0].size()));
+  EXPECT_THAT(evaluations, Le(10));
+
+  // The samples are discarded if the trajectory changed.
+  auto const other_trajectory =
+      NewCircularTrajectory(/*period=*/50'000 * Second,
+                            /*step=*/1 * Second,
+                            /*last=*/25'000 * Second);
+  discrete_trajectory->ForgetAfter(t0_);
+  for (auto const& [time, degrees_of_freedom] : *other_trajectory) {
+    if (time > t0_) {
+      discrete_trajectory->Append(time, degrees_of_freedom);
+    }
+  }
+  evaluations = 0;
+  plot(t0_ + 25'000 * Second);
+  EXPECT_THAT(evaluations, Ge(first_evaluations));
+}
+
+TEST_F(PlanetariumTest, PlotMethod2LevelOfDetail) {
+  auto const discrete_trajectory =
+      NewCircularTrajectory(/*period=*/100'000 * Second,
+                            /*step=*/1 * Second,
+                            /*last=*/25'000 * Second);
+
+  PlottingCache plotting_cache;
+  auto const plot = [this, &discrete_trajectory, &plotting_cache](
+                        Angle const& angular_resolution) {
+    Planetarium::Parameters parameters(
+        /*sphere_radius_multiplier=*/1,
+        angular_resolution,
+        /*field_of_view=*/90 * Degree);
+    Planetarium planetarium(parameters,
+                            perspective_,
+                            &ephemeris_,
+                            &plotting_frame_,
+                            &plotting_cache);
+    return planetarium.PlotMethod2(discrete_trajectory->begin(),
+                                   discrete_trajectory->end(),
+                                   t0_ + 10 * Second,
+                                   /*reverse=*/false);
+  };
+
+  auto const fine_rp2_lines = plot(0.004 * ArcMinute);
+  ASSERT_THAT(fine_rp2_lines, SizeIs(1));
+  EXPECT_THAT(fine_rp2_lines[0], SizeIs(Ge(400)));
+
+  // The samples computed for the fine resolution are reused, but they are
+  // plotted using the coarser levels of the pyramid.
+  auto const coarse_rp2_lines = plot(5 * Degree);
+  ASSERT_THAT(coarse_rp2_lines, SizeIs(1));
+  EXPECT_THAT(coarse_rp2_lines[0],
+              SizeIs(AllOf(Ge(5), Le(fine_rp2_lines[0].size() / 4))));
+  EXPECT_EQ(fine_rp2_lines[0].front(), coarse_rp2_lines[0].front());
+  EXPECT_EQ(fine_rp2_lines[0].back(), coarse_rp2_lines[0].back());
+  for (auto const& rp2_point : coarse_rp2_lines[0]) {
+    EXPECT_THAT(rp2_point.x(),
+                AllOf(Ge(0 * Metre),
+                      Le((5.0 / Sqrt(3.0)) * Metre)));
+    EXPECT_THAT(rp2_point.y(), VanishesBefore(1 * Metre, 0, 14));
+  }
+}
+
+TEST_F(PlanetariumTest, PlotMethod2SlidingInterval) {
+  auto const discrete_trajectory =
+      NewCircularTrajectory(/*period=*/100'000 * Second,
+                            /*step=*/1 * Second,
+                            /*last=*/25'000 * Second);
+
+  Planetarium::Parameters parameters(
+      /*sphere_radius_multiplier=*/1,
+      /*angular_resolution=*/0.4 * ArcMinute,
+      /*field_of_view=*/90 * Degree);
+  PlottingCache plotting_cache;
+  auto const plot = [this, &discrete_trajectory, &parameters](
+                        PlottingCache* const plotting_cache,
+                        Instant const& first_time,
+                        Instant const& last_time) {
+    Planetarium planetarium(parameters,
+                            perspective_,
+                            &ephemeris_,
+                            &plotting_frame_,
+                            plotting_cache);
+    return planetarium.PlotMethod2(discrete_trajectory->LowerBound(first_time),
+                                   discrete_trajectory->LowerBound(last_time),
+                                   t0_ + 10 * Second,
+                                   /*reverse=*/false);
+  };
+
+  // Both ends of the plotted interval move forward, as in successive frames.
+  // The pyramid is extended and its beginning is ignored, and the result is
+  // close to that of plotting without a cache.
+  for (Time t; t <= 10'000 * Second; t += 500 * Second) {
+    auto const rp2_lines = plot(&plotting_cache,
+                                t0_ + t,
+                                t0_ + t + 15'000 * Second);
+    auto const uncached_rp2_lines =
+        plot(/*plotting_cache=*/nullptr, t0_ + t, t0_ + t + 15'000 * Second);
+    ASSERT_THAT(rp2_lines, SizeIs(1)) << t;
+    ASSERT_THAT(uncached_rp2_lines, SizeIs(1)) << t;
+    EXPECT_THAT(rp2_lines[0],
+                SizeIs(AllOf(Ge(uncached_rp2_lines[0].size() / 2),
+                             Le(2 * uncached_rp2_lines[0].size())))) << t;
+    EXPECT_EQ(uncached_rp2_lines[0].back(), rp2_lines[0].back()) << t;
+    for (auto const& rp2_point : rp2_lines[0]) {
+      EXPECT_THAT(rp2_point.x(),
+                  AllOf(Ge(0 * Metre),
+                        Le((5.0 / Sqrt(3.0)) * Metre)));
+      EXPECT_THAT(rp2_point.y(), VanishesBefore(1 * Metre, 0, 14));
+    }
+  }
+}
+
+TEST_F(PlanetariumTest, PlotMethod2Parallel) {
+  auto const trajectory1 =
+      NewCircularTrajectory(/*period=*/100'000 * Second,
+                            /*step=*/1 * Second,
+                            /*last=*/25'000 * Second);
+  auto const trajectory2 =
+      NewCircularTrajectory(/*period=*/10'000 * Second,
+                            /*step=*/1 * Second,
+                            /*last=*/5'000 * Second);
+
+  Planetarium::Parameters parameters(
+      /*sphere_radius_multiplier=*/1,
+      /*angular_resolution=*/0.4 * ArcMinute,
+      /*field_of_view=*/90 * Degree);
+  PlottingCache plotting_cache;
+  Planetarium planetarium(parameters,
+                          perspective_,
+                          &ephemeris_,
+                          &plotting_frame_,
+                          &plotting_cache);
+  Planetarium sequential_planetarium(
+      parameters, perspective_, &ephemeris_, &plotting_frame_);
+  std::vector<Planetarium::PlottingRequest> const requests = {
+      {trajectory1.get(), t0_, t0_ + 20'000 * Second, /*reverse=*/true},
+      {trajectory2.get(), t0_, t0_ + 5'000 * Second, /*reverse=*/false},
+      {trajectory1.get(), t0_, t0_ + 25'000 * Second, /*reverse=*/true},
+      {trajectory1.get(), t0_, t0_ + 25'000 * Second, /*reverse=*/false}};
+  auto const rp2_lines_list = planetarium.PlotMethod2(requests,
+                                                      t0_ + 10 * Second);
+  ASSERT_THAT(rp2_lines_list, SizeIs(requests.size()));
+  // Without a cache, the results are those of sequential plotting.
+  auto const uncached_rp2_lines_list =
+      sequential_planetarium.PlotMethod2(requests, t0_ + 10 * Second);
+  for (std::size_t i = 0; i < requests.size(); ++i) {
+    auto const& request = requests[i];
+    EXPECT_EQ(sequential_planetarium.PlotMethod2(*request.trajectory,
+                                                 request.first_time,
+                                                 request.last_time,
+                                                 t0_ + 10 * Second,
+                                                 request.reverse),
+              uncached_rp2_lines_list[i]) << i;
+    EXPECT_THAT(rp2_lines_list[i], SizeIs(1)) << i;
+  }
+}
+
 #if !defined(_DEBUG)
 TEST_F(PlanetariumTest, RealSolarSystem) {
   auto discrete_trajectory = DiscreteTrajectory<Barycentric>::ReadFromMessage(
@@ -262,7 +479,8 @@ TEST_F(PlanetariumTest, RealSolarSystem) {
   auto ephemeris = Ephemeris<Barycentric>::ReadFromMessage(
       ParseFromBytes<serialization::Ephemeris>(
           ReadFromBinaryFile(SOLUTION_DIR / "ksp_plugin_test" /
-                             "planetarium_ephemeris.proto.bin")));
+                             "planetarium_ephemeris.proto.bin")))
+      .ValueOrDie();
 
   auto plotting_frame = NavigationFrame::ReadFromMessage(
       ParseFromBytes<serialization::DynamicFrame>(
@@ -64,7 +64,8 @@ std::map<GUID, not_null<Vessel const*>> TestablePlugin::vessels() const {
 
 not_null<std::unique_ptr<TestablePlugin>> TestablePlugin::ReadFromMessage(
   serialization::Plugin const& message) {
-  std::unique_ptr<Plugin> plugin = Plugin::ReadFromMessage(message);
+  std::unique_ptr<Plugin> plugin =
+      Plugin::ReadFromMessage(message).ValueOrDie();
   return std::unique_ptr<TestablePlugin>(
       static_cast<TestablePlugin*>(plugin.release()));
 }
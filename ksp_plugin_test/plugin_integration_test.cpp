@@ -160,7 +160,7 @@ TEST_F(PluginIntegrationTest, AdvanceTimeWithCelestialsOnly) {
       Lt(0.01));
   serialization::Plugin plugin_message;
   plugin_->WriteToMessage(&plugin_message);
-  plugin_ = Plugin::ReadFromMessage(plugin_message);
+  plugin_ = Plugin::ReadFromMessage(plugin_message).ValueOrDie();
   // Having saved and loaded, we compute a new segment again, this probably
   // exercises apocalypse-type bugs.
   for (; t < initial_time + 20 * 45 * Minute; t += δt) {
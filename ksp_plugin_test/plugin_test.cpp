@@ -435,7 +435,7 @@ TEST_F(PluginTest, Serialization) {
 
   serialization::Plugin message;
   plugin->WriteToMessage(&message);
-  plugin = Plugin::ReadFromMessage(message);
+  plugin = Plugin::ReadFromMessage(message).ValueOrDie();
   serialization::Plugin second_message;
   plugin->WriteToMessage(&second_message);
   EXPECT_THAT(message, EqualsProto(second_message));
@@ -0,0 +1,165 @@
+#include "ksp_plugin/prediction_scheduler.hpp"
+
+#include <chrono>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace principia {
+namespace ksp_plugin {
+namespace internal_prediction_scheduler {
+
+using base::this_stoppable_thread;
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+class PredictionSchedulerTest : public ::testing::Test {
+ protected:
+  using Priority = PredictionScheduler::Priority;
+
+  // Keys for the tasks.
+  int const a_ = 0;
+  int const b_ = 0;
+  int const c_ = 0;
+  int const d_ = 0;
+
+  // Returns a task that records its execution in |executed_|.
+  std::function<void()> Record(char const name) {
+    return [this, name]() {
+      absl::MutexLock l(&lock_);
+      executed_.push_back(name);
+    };
+  }
+
+  // Schedules for |key| a task that blocks the worker until |release_| is
+  // notified.
+  void Block(PredictionScheduler& scheduler, void const* const key) {
+    absl::Notification started;
+    scheduler.Schedule(key, Priority::ActiveVessel, [this, &started]() {
+      started.Notify();
+      release_.WaitForNotification();
+    });
+    started.WaitForNotification();
+  }
+
+  void WaitForCompletion(PredictionScheduler const& scheduler) {
+    while (scheduler.number_of_tasks() > 0) {
+      absl::SleepFor(absl::Milliseconds(1));
+    }
+  }
+
+  absl::Notification release_;
+  absl::Mutex lock_;
+  std::vector<char> executed_ GUARDED_BY(lock_);
+};
+
+TEST_F(PredictionSchedulerTest, Priorities) {
+  PredictionScheduler scheduler(/*number_of_workers=*/1);
+  Block(scheduler, &a_);
+  scheduler.Schedule(&b_, Priority::Other, Record('b'));
+  scheduler.Schedule(&c_, Priority::VesselInView, Record('c'));
+  scheduler.Schedule(&d_, Priority::Other, Record('d'));
+  scheduler.Schedule(&a_, Priority::TargetVessel, Record('a'));
+  release_.Notify();
+  WaitForCompletion(scheduler);
+  absl::MutexLock l(&lock_);
+  EXPECT_THAT(executed_, ElementsAre('a', 'c', 'b', 'd'));
+}
+
+TEST_F(PredictionSchedulerTest, Coalescing) {
+  PredictionScheduler scheduler(/*number_of_workers=*/1);
+  Block(scheduler, &a_);
+  // The second task for |b_| replaces the first one.
+  scheduler.Schedule(&a_, Priority::ActiveVessel, Record('a'));
+  scheduler.Schedule(&b_, Priority::Other, Record('b'));
+  scheduler.Schedule(&b_, Priority::Other, Record('B'));
+  EXPECT_THAT(scheduler.number_of_tasks(), Eq(3));
+  release_.Notify();
+  WaitForCompletion(scheduler);
+  absl::MutexLock l(&lock_);
+  EXPECT_THAT(executed_, ElementsAre('a', 'B'));
+}
+
+TEST_F(PredictionSchedulerTest, NoConcurrentTasksForAKey) {
+  PredictionScheduler scheduler(/*number_of_workers=*/2);
+  Block(scheduler, &a_);
+  scheduler.Schedule(&a_, Priority::ActiveVessel, Record('a'));
+  scheduler.Schedule(&b_, Priority::Other, Record('b'));
+  // The task for |b_| is run by the idle worker, but the one for |a_| waits
+  // for the blocking task.
+  while (scheduler.number_of_tasks() > 2) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  {
+    absl::MutexLock l(&lock_);
+    EXPECT_THAT(executed_, ElementsAre('b'));
+  }
+  release_.Notify();
+  WaitForCompletion(scheduler);
+  absl::MutexLock l(&lock_);
+  EXPECT_THAT(executed_, ElementsAre('b', 'a'));
+}
+
+TEST_F(PredictionSchedulerTest, Cancel) {
+  PredictionScheduler scheduler(/*number_of_workers=*/1);
+  absl::Notification started;
+  bool observed_stop = false;
+  scheduler.Schedule(
+      &a_, Priority::ActiveVessel, [&started, &observed_stop]() {
+        started.Notify();
+        while (!this_stoppable_thread::get_stop_token().stop_requested()) {
+          absl::SleepFor(absl::Milliseconds(1));
+        }
+        observed_stop = true;
+      });
+  started.WaitForNotification();
+  scheduler.Schedule(&a_, Priority::ActiveVessel, Record('a'));
+  scheduler.Cancel(&a_);
+  EXPECT_TRUE(observed_stop);
+  EXPECT_THAT(scheduler.number_of_tasks(), Eq(0));
+  absl::MutexLock l(&lock_);
+  EXPECT_THAT(executed_, ElementsAre());
+}
+
+TEST_F(PredictionSchedulerTest, SetPriority) {
+  PredictionScheduler scheduler(/*number_of_workers=*/1);
+  Block(scheduler, &a_);
+  scheduler.Schedule(&b_, Priority::Other, Record('b'));
+  scheduler.Schedule(&c_, Priority::VesselInView, Record('c'));
+  scheduler.SetPriority(&b_, Priority::ActiveVessel);
+  // No task is pending for |d_|.
+  scheduler.SetPriority(&d_, Priority::ActiveVessel);
+  release_.Notify();
+  WaitForCompletion(scheduler);
+  absl::MutexLock l(&lock_);
+  EXPECT_THAT(executed_, ElementsAre('b', 'c'));
+}
+
+TEST_F(PredictionSchedulerTest, FrameDeadline) {
+  PredictionScheduler scheduler(/*number_of_workers=*/1);
+  scheduler.SetFrameDeadline(std::chrono::steady_clock::now());
+  absl::SleepFor(absl::Milliseconds(1));
+  scheduler.Schedule(&a_, Priority::Other, Record('a'));
+  scheduler.Schedule(&b_, Priority::TargetVessel, Record('b'));
+  while (scheduler.number_of_tasks() > 1) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  {
+    absl::MutexLock l(&lock_);
+    EXPECT_THAT(executed_, ElementsAre('b'));
+  }
+  scheduler.SetFrameDeadline(std::chrono::steady_clock::now() +
+                             std::chrono::hours(1));
+  WaitForCompletion(scheduler);
+  absl::MutexLock l(&lock_);
+  EXPECT_THAT(executed_, ElementsAre('b', 'a'));
+}
+
+}  // namespace internal_prediction_scheduler
+}  // namespace ksp_plugin
+}  // namespace principia
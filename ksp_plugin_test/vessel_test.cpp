@@ -389,6 +389,76 @@ TEST_F(VesselTest, PredictBeyondTheInfinite) {
                                        50.0 * Metre / Second}), 0)));
 }
 
+TEST_F(VesselTest, PredictionReuse) {
+  DegreesOfFreedom<Barycentric> const degrees_of_freedom(
+      Barycentric::origin +
+          Displacement<Barycentric>(
+              {14.0 / 3.0 * Metre, 5.0 * Metre, 4.0 * Metre}),
+      Velocity<Barycentric>({140.0 / 3.0 * Metre / Second,
+                             50.0 * Metre / Second,
+                             40.0 * Metre / Second}));
+  EXPECT_CALL(ephemeris_, t_min_locked())
+      .WillRepeatedly(Return(astronomy::J2000));
+  EXPECT_CALL(ephemeris_, t_max())
+      .WillRepeatedly(Return(astronomy::J2000 + 1 * Second));
+  EXPECT_CALL(
+      ephemeris_,
+      FlowWithAdaptiveStep(_, _, astronomy::InfiniteFuture, _, _))
+      .WillRepeatedly(Return(Status::OK));
+  // Since the vessel doesn't move, the prognostication is only integrated up
+  // to |t_max| once, and later refreshes reuse it.
+  EXPECT_CALL(
+      ephemeris_,
+      FlowWithAdaptiveStep(_, _, astronomy::J2000 + 1 * Second, _, _))
+      .WillOnce(DoAll(AppendToDiscreteTrajectory(
+                          astronomy::J2000 + 1 * Second, degrees_of_freedom),
+                      Return(Status::OK)));
+
+  vessel_.PrepareHistory(astronomy::J2000);
+  for (int i = 0; i < 5; ++i) {
+    vessel_.RefreshPrediction();
+    using namespace std::chrono_literals;
+    std::this_thread::sleep_for(100ms);
+  }
+  EXPECT_EQ(2, vessel_.prediction().Size());
+  EXPECT_EQ(astronomy::J2000 + 1 * Second, vessel_.prediction().back().time);
+
+  // Changing the integration parameters forces a recomputation.
+  EXPECT_CALL(
+      ephemeris_,
+      FlowWithAdaptiveStep(_, _, astronomy::J2000 + 1 * Second, _, _))
+      .WillOnce(DoAll(AppendToDiscreteTrajectory(
+                          astronomy::J2000 + 1 * Second, degrees_of_freedom),
+                      Return(Status::OK)));
+  auto parameters = DefaultPredictionParameters();
+  parameters.set_length_integration_tolerance(2 * Metre);
+  vessel_.set_prediction_adaptive_step_parameters(parameters);
+  for (int i = 0; i < 5; ++i) {
+    vessel_.RefreshPrediction();
+    using namespace std::chrono_literals;
+    std::this_thread::sleep_for(100ms);
+  }
+  EXPECT_EQ(2, vessel_.prediction().Size());
+
+  // When the ephemeris is prolonged, the prediction is extended from its last
+  // point instead of being recomputed.
+  EXPECT_CALL(ephemeris_, t_max())
+      .WillRepeatedly(Return(astronomy::J2000 + 2 * Second));
+  EXPECT_CALL(
+      ephemeris_,
+      FlowWithAdaptiveStep(_, _, astronomy::J2000 + 2 * Second, _, _))
+      .WillOnce(DoAll(AppendToDiscreteTrajectory(
+                          astronomy::J2000 + 2 * Second, degrees_of_freedom),
+                      Return(Status::OK)));
+  for (int i = 0; i < 5; ++i) {
+    vessel_.RefreshPrediction();
+    using namespace std::chrono_literals;
+    std::this_thread::sleep_for(100ms);
+  }
+  EXPECT_EQ(3, vessel_.prediction().Size());
+  EXPECT_EQ(astronomy::J2000 + 2 * Second, vessel_.prediction().back().time);
+}
+
 TEST_F(VesselTest, FlightPlan) {
   EXPECT_CALL(ephemeris_, t_max())
       .WillRepeatedly(Return(astronomy::J2000 + 2 * Second));
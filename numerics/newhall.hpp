@@ -56,8 +56,21 @@ NewhallApproximationInMonomialBasis(int degree,
                                     Instant const& t_max,
                                     Vector& error_estimate);
 
+// Returns the |error_estimate| that the preceding functions would compute for
+// the given |degree|, without computing the approximation.  This only uses one
+// row of the Newhall matrix, so it is much cheaper than an approximation and
+// makes it possible to select the degree before approximating.
+template<typename Vector>
+Vector NewhallApproximationErrorEstimate(
+    int degree,
+    std::vector<Vector> const& q,
+    std::vector<Variation<Vector>> const& v,
+    Instant const& t_min,
+    Instant const& t_max);
+
 }  // namespace internal_newhall
 
+using internal_newhall::NewhallApproximationErrorEstimate;
 using internal_newhall::NewhallApproximationInЧебышёвBasis;
 using internal_newhall::NewhallApproximationInMonomialBasis;
 
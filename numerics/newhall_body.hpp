@@ -23,6 +23,15 @@ using quantities::Time;
 // Only supports 8 divisions for now.
 constexpr int divisions = 8;
 
+// Returns the positions and velocities in the order expected by Newhall's
+// matrices, with the velocities scaled to the interval [-1, 1].
+template<typename Vector>
+FixedVector<Vector, 2 * divisions + 2> NewhallQV(
+    std::vector<Vector> const& q,
+    std::vector<Variation<Vector>> const& v,
+    Instant const& t_min,
+    Instant const& t_max);
+
 template<typename Vector, int degree,
          template<typename, typename, int> class Evaluator>
 PolynomialInMonomialBasis<Vector, Instant, degree, Evaluator> Dehomogeneize(
@@ -50,6 +59,29 @@ struct Dehomogeneizer<Vector, DehomogeneizedCoefficients, degree, degree> {
       DehomogeneizedCoefficients& dehomogeneized_coefficients);
 };
 
+template<typename Vector>
+FixedVector<Vector, 2 * divisions + 2> NewhallQV(
+    std::vector<Vector> const& q,
+    std::vector<Variation<Vector>> const& v,
+    Instant const& t_min,
+    Instant const& t_max) {
+  CHECK_EQ(divisions + 1, q.size());
+  CHECK_EQ(divisions + 1, v.size());
+
+  Time const duration_over_two = 0.5 * (t_max - t_min);
+
+  // Tricky.  The order in Newhall's matrices is such that the entries for the
+  // largest time occur first.
+  FixedVector<Vector, 2 * divisions + 2> qv;
+  for (int i = 0, j = 2 * divisions;
+       i < divisions + 1 && j >= 0;
+       ++i, j -= 2) {
+    qv[j] = q[i];
+    qv[j + 1] = v[i] * duration_over_two;
+  }
+  return qv;
+}
+
 template<typename Vector, int degree,
          template<typename, typename, int> class Evaluator>
 PolynomialInMonomialBasis<Vector, Instant, degree, Evaluator> Dehomogeneize(
@@ -148,20 +180,7 @@ NewhallApproximationInЧебышёвBasis(int degree,
                                    Instant const& t_min,
                                    Instant const& t_max,
                                    Vector& error_estimate) {
-  CHECK_EQ(divisions + 1, q.size());
-  CHECK_EQ(divisions + 1, v.size());
-
-  Time const duration_over_two = 0.5 * (t_max - t_min);
-
-  // Tricky.  The order in Newhall's matrices is such that the entries for the
-  // largest time occur first.
-  FixedVector<Vector, 2 * divisions + 2> qv;
-  for (int i = 0, j = 2 * divisions;
-       i < divisions + 1 && j >= 0;
-       ++i, j -= 2) {
-    qv[j] = q[i];
-    qv[j + 1] = v[i] * duration_over_two;
-  }
+  auto const qv = NewhallQV(q, v, t_min, t_max);
 
   std::vector<Vector> coefficients;
   coefficients.reserve(degree);
@@ -200,21 +219,9 @@ NewhallApproximationInMonomialBasis(std::vector<Vector> const& q,
                                     Instant const& t_min,
                                     Instant const& t_max,
                                     Vector& error_estimate) {
-  CHECK_EQ(divisions + 1, q.size());
-  CHECK_EQ(divisions + 1, v.size());
-
+  auto const qv = NewhallQV(q, v, t_min, t_max);
   Time const duration_over_two = 0.5 * (t_max - t_min);
 
-  // Tricky.  The order in Newhall's matrices is such that the entries for the
-  // largest time occur first.
-  FixedVector<Vector, 2 * divisions + 2> qv;
-  for (int i = 0, j = 2 * divisions;
-       i < divisions + 1 && j >= 0;
-       ++i, j -= 2) {
-    qv[j] = q[i];
-    qv[j + 1] = v[i] * duration_over_two;
-  }
-
   Instant const t_mid = Barycentre<Instant, double>({t_min, t_max}, {1, 1});
   return Dehomogeneize<Vector, degree, Evaluator>(
              NewhallAppromixator<Vector, degree, Evaluator>::
@@ -264,6 +271,43 @@ NewhallApproximationInMonomialBasis(int degree,
 
 #undef PRINCIPIA_NEWHALL_APPROXIMATION_IN_MONOMIAL_BASIS_CASE
 
+#define PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(degree)           \
+  case (degree):                                                              \
+    return newhall_c_matrix_чебышёв_degree_##degree##_divisions_8_w04.row<    \
+               (degree)>() * qv
+
+template<typename Vector>
+Vector NewhallApproximationErrorEstimate(
+    int const degree,
+    std::vector<Vector> const& q,
+    std::vector<Variation<Vector>> const& v,
+    Instant const& t_min,
+    Instant const& t_max) {
+  auto const qv = NewhallQV(q, v, t_min, t_max);
+  switch (degree) {
+    PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(3);
+    PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(4);
+    PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(5);
+    PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(6);
+    PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(7);
+    PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(8);
+    PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(9);
+    PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(10);
+    PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(11);
+    PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(12);
+    PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(13);
+    PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(14);
+    PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(15);
+    PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(16);
+    PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE(17);
+    default:
+      LOG(FATAL) << "Unexpected degree " << degree;
+      break;
+  }
+}
+
+#undef PRINCIPIA_NEWHALL_APPROXIMATION_ERROR_ESTIMATE_CASE
+
 }  // namespace internal_newhall
 }  // namespace numerics
 }  // namespace principia
@@ -769,5 +769,31 @@ TEST_F(NewhallTest, NonConstantDegree) {
                               length_function_1_(t_min_)), IsNear(9e-13_⑴));
 }
 
+TEST_F(NewhallTest, ErrorEstimate) {
+  std::vector<Length> lengths;
+  std::vector<Speed> speeds;
+  for (Instant t = t_min_; t <= t_max_; t += 0.5 * Second) {
+    lengths.push_back(length_function_1_(t));
+    speeds.push_back(speed_function_1_(t));
+  }
+
+  // The error estimate is exactly the one computed by the approximations.
+  for (int degree = 3; degree <= 17; ++degree) {
+    Length monomial_error_estimate;
+    NewhallApproximationInMonomialBasis<Length, EstrinEvaluator>(
+        degree,
+        lengths, speeds, t_min_, t_max_, monomial_error_estimate);
+    Length чебышёв_error_estimate;
+    NewhallApproximationInЧебышёвBasis(
+        degree,
+        lengths, speeds, t_min_, t_max_, чебышёв_error_estimate);
+    Length const error_estimate = NewhallApproximationErrorEstimate(
+        degree,
+        lengths, speeds, t_min_, t_max_);
+    EXPECT_EQ(monomial_error_estimate, error_estimate) << degree;
+    EXPECT_EQ(чебышёв_error_estimate, error_estimate) << degree;
+  }
+}
+
 }  // namespace numerics
 }  // namespace principia
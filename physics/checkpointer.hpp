@@ -3,10 +3,12 @@
 
 #include <functional>
 #include <map>
+#include <memory>
 
 #include "absl/synchronization/mutex.h"
 #include "base/not_null.hpp"
 #include "geometry/named_quantities.hpp"
+#include "google/protobuf/arena.h"
 #include "quantities/quantities.hpp"
 
 namespace principia {
@@ -81,10 +83,17 @@ class Checkpointer {
   void CreateUnconditionallyLocked(Instant const& t)
       EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Each checkpoint is allocated on its own arena, so that the many small
+  // messages that it is made of are allocated and freed in bulk.
+  struct Checkpoint {
+    std::unique_ptr<google::protobuf::Arena> arena;
+    not_null<Message*> message;
+  };
+
   mutable absl::Mutex lock_;
   Reader const reader_;
   Writer const writer_;
-  std::map<Instant, Message> checkpoints_;
+  std::map<Instant, Checkpoint> checkpoints_;
 };
 
 }  // namespace internal_checkpointer
@@ -3,10 +3,27 @@
 
 #include "physics/checkpointer.hpp"
 
+#include <type_traits>
+
+#include "google/protobuf/message_lite.h"
+
 namespace principia {
 namespace physics {
 namespace internal_checkpointer {
 
+using google::protobuf::Arena;
+
+// Protocol buffers must be created on an arena using |CreateMessage| so that
+// their submessages also live on the arena.
+template<typename Message>
+not_null<Message*> CreateOnArena(not_null<Arena*> const arena) {
+  if constexpr (std::is_base_of_v<google::protobuf::MessageLite, Message>) {
+    return Arena::CreateMessage<Message>(arena);
+  } else {
+    return Arena::Create<Message>(arena);
+  }
+}
+
 template<typename Message>
 Checkpointer<Message>::Checkpointer(Reader reader, Writer writer)
     : reader_(std::move(reader)),
@@ -48,7 +65,7 @@ Instant Checkpointer<Message>::WriteToMessage(
     static Instant infinite_future = Instant() + quantities::Infinity<Time>;
     return infinite_future;
   } else {
-    message->MergeFrom(checkpoints_.cbegin()->second);
+    message->MergeFrom(*checkpoints_.cbegin()->second.message);
     return checkpoints_.cbegin()->first;
   }
 }
@@ -66,8 +83,11 @@ void Checkpointer<Message>::ReadFromMessage(Instant const& t,
 template<typename Message>
 void Checkpointer<Message>::CreateUnconditionallyLocked(Instant const& t) {
   lock_.AssertHeld();
-  auto const it = checkpoints_.emplace_hint(checkpoints_.end(), t, Message());
-  writer_(&it->second);
+  auto arena = std::make_unique<Arena>();
+  not_null<Message*> const message = CreateOnArena<Message>(arena.get());
+  auto const it = checkpoints_.emplace_hint(
+      checkpoints_.end(), t, Checkpoint{std::move(arena), message});
+  writer_(it->second.message);
 }
 
 }  // namespace internal_checkpointer
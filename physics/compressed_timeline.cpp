@@ -0,0 +1,18 @@
+#include "physics/compressed_timeline.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace principia {
+namespace physics {
+namespace internal_compressed_timeline {
+
+ThreadPool<void>& CodecPool() {
+  static ThreadPool<void>* const pool =
+      new ThreadPool<void>(std::max(1u, std::thread::hardware_concurrency()));
+  return *pool;
+}
+
+}  // namespace internal_compressed_timeline
+}  // namespace physics
+}  // namespace principia
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "base/macros.hpp"
+#include "base/not_null.hpp"
+#include "base/thread_pool.hpp"
+#include "geometry/named_quantities.hpp"
+#include "physics/degrees_of_freedom.hpp"
+#include "quantities/quantities.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_compressed_timeline {
+
+using base::not_null;
+using base::ThreadPool;
+using geometry::Instant;
+using quantities::Length;
+
+// The pool used by the |CompressedTimeline|s of all frames to compress and
+// decompress chunks in parallel.  Never destroyed.
+ThreadPool<void>& CodecPool();
+
+// A sequence of points ordered by time, stored as blocks compressed with ZFP.
+// The times are exact, the positions are approximated to the tolerance given
+// when the block is appended, and the velocities to a commensurate tolerance.
+// This is used for the cold part of the timeline of a |DiscreteTrajectory|,
+// which is rarely accessed: the blocks are decompressed on demand, and the
+// last few decompressed blocks are cached.  A block is designated by an index
+// which is not invalidated by |Append| or |ForgetBefore|.
+template<typename Frame>
+class CompressedTimeline {
+ public:
+  using value_type = std::pair<Instant const, DegreesOfFreedom<Frame>>;
+  using Block = std::vector<value_type>;
+
+  CompressedTimeline() = default;
+  CompressedTimeline(CompressedTimeline const&) = delete;
+  CompressedTimeline(CompressedTimeline&&) = delete;
+  CompressedTimeline& operator=(CompressedTimeline const&) = delete;
+  CompressedTimeline& operator=(CompressedTimeline&&) = delete;
+
+  // Appends a block made of the points in [begin, end[, which must be nonempty
+  // and after the points already in this object.  The values of |Iterator|
+  // must have members |first| and |second| of type |Instant| and
+  // |DegreesOfFreedom<Frame>| respectively.
+  template<typename Iterator>
+  void Append(Iterator begin, Iterator end, Length const& tolerance);
+
+  // Appends a block made of |size| points compressed by |CompressPoints| in
+  // |zfp|, the last of which is at |last_time|.  The points are not
+  // decompressed until they are accessed.
+  void AppendCompressed(std::string_view zfp,
+                        std::int64_t size,
+                        Instant const& last_time);
+
+  // Removes all the points (strictly) before |time|.
+  void ForgetBefore(Instant const& time);
+
+  // Removes the blocks at or after |block|.
+  void ForgetBlocksFrom(std::int64_t block);
+
+  bool empty() const;
+  // The number of points that have not been forgotten.
+  std::int64_t size() const;
+  // The time of the last point.  This object must not be empty.
+  Instant const& t_max() const;
+
+  // The indices of the first block and past the last block.
+  std::int64_t begin_block() const;
+  std::int64_t end_block() const;
+
+  // Returns the first block whose last point is at or after |time|, or
+  // |end_block()| if there is none.
+  std::int64_t FindBlock(Instant const& time) const;
+
+  // The index in |Decompress(block)| of the first point of |block| that has
+  // not been forgotten.
+  std::int64_t first_index(std::int64_t block) const;
+
+  // The time of the last point of |block|.
+  Instant const& last_time(std::int64_t block) const;
+
+  // Returns the points of |block|, including those that have been forgotten.
+  // The result remains usable for as long as it is held, even if the block is
+  // removed from this object.  Thread-safe.
+  std::shared_ptr<Block const> Decompress(std::int64_t block) const
+      EXCLUDES(lock_);
+
+  // The number of bytes used by the compressed representation.
+  std::int64_t compressed_size() const;
+
+  // Appends to |zfp| the compressed representation of the points in
+  // [begin, end[, with the same constraints as for |Append|.  This is the
+  // format of the serialized timeline of a |DiscreteTrajectory|.
+  template<typename Iterator>
+  static void CompressPoints(Iterator begin,
+                             Iterator end,
+                             Length const& tolerance,
+                             not_null<std::string*> zfp);
+
+  // Reads |size| points from the start of |zfp|, which is updated to reflect
+  // the data that was consumed.
+  static Block DecompressPoints(std::int64_t size, std::string_view& zfp);
+
+  // Compresses the points in [begin, end[ as consecutive chunks of at most
+  // |points_per_chunk| points in the format of |CompressPoints|, and calls
+  // |write_chunk| with the number of points and the compressed representation
+  // of each chunk, in order.  The chunks are compressed in parallel, a bounded
+  // number at a time, so the memory used doesn't depend on the number of
+  // points.  A single chunk is compressed on the calling thread.  The points
+  // must not be modified during the call.
+  template<typename Iterator>
+  static void CompressChunks(
+      Iterator begin,
+      Iterator end,
+      std::int64_t points_per_chunk,
+      Length const& tolerance,
+      std::function<void(std::int64_t size, std::string const& zfp)> const&
+          write_chunk);
+
+  // Decompresses in parallel the chunks given by their number of points and
+  // their compressed representation, and calls |read_chunk| with the points of
+  // each chunk, in order.  At most a bounded number of chunks are decompressed
+  // at a time.  A single chunk is decompressed on the calling thread.
+  static void DecompressChunks(
+      std::vector<std::pair<std::int64_t, std::string_view>> const& chunks,
+      std::function<void(Block const& points)> const& read_chunk);
+
+  // Appends to |zfp| the compressed representation of the points of |block|
+  // that have not been forgotten, in the format of |CompressPoints|, and
+  // returns their number.  If no point of |block| has been forgotten, the
+  // compressed data are copied without being decompressed, in which case
+  // |tolerance| must be the one that was passed to |Append|.
+  std::int64_t WriteBlock(std::int64_t block,
+                          Length const& tolerance,
+                          not_null<std::string*> zfp) const;
+
+ private:
+  struct CompressedBlock {
+    Instant last_time;
+    std::int64_t size;
+    std::int64_t first_index;
+    std::string zfp;
+  };
+
+  CompressedBlock const& block(std::int64_t block) const;
+
+  // The number of chunks that are compressed or decompressed at a time, per
+  // thread of the |CodecPool|.
+  static constexpr int chunks_in_flight_per_thread = 2;
+
+  // The number of decompressed blocks retained by |cache_|.
+  static constexpr int max_cached_blocks = 2;
+
+  std::deque<CompressedBlock> blocks_;
+  // The index of |blocks_.front()|.
+  std::int64_t begin_block_ = 0;
+  std::int64_t size_ = 0;
+
+  mutable absl::Mutex lock_;
+  // The most recently decompressed blocks, most recent first.
+  mutable std::list<std::pair<std::int64_t, std::shared_ptr<Block const>>>
+      cache_ GUARDED_BY(lock_);
+};
+
+}  // namespace internal_compressed_timeline
+
+using internal_compressed_timeline::CompressedTimeline;
+
+}  // namespace physics
+}  // namespace principia
+
+#include "physics/compressed_timeline_body.hpp"
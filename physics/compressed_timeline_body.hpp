@@ -0,0 +1,406 @@
+#pragma once
+
+#include "physics/compressed_timeline.hpp"
+
+#include <algorithm>
+#include <future>
+#include <optional>
+#include <thread>
+
+#include "base/zfp_compressor.hpp"
+#include "geometry/grassmann.hpp"
+#include "glog/logging.h"
+#include "quantities/named_quantities.hpp"
+#include "quantities/si.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_compressed_timeline {
+
+using base::ZfpCompressor;
+using geometry::Displacement;
+using geometry::Position;
+using geometry::Velocity;
+using quantities::Time;
+using quantities::si::Metre;
+using quantities::si::Second;
+
+template<typename Frame>
+template<typename Iterator>
+void CompressedTimeline<Frame>::Append(Iterator const begin,
+                                       Iterator const end,
+                                       Length const& tolerance) {
+  CHECK(begin != end);
+  CHECK(blocks_.empty() || blocks_.back().last_time < begin->first)
+      << "Append out of order at " << begin->first << ", last time is "
+      << blocks_.back().last_time;
+  std::int64_t const size = std::distance(begin, end);
+  auto& block = blocks_.emplace_back();
+  block.size = size;
+  block.first_index = 0;
+  CompressPoints(begin, end, tolerance, &block.zfp);
+  block.zfp.shrink_to_fit();
+  Iterator last = end;
+  --last;
+  block.last_time = last->first;
+  size_ += size;
+}
+
+template<typename Frame>
+void CompressedTimeline<Frame>::AppendCompressed(std::string_view const zfp,
+                                                 std::int64_t const size,
+                                                 Instant const& last_time) {
+  CHECK_LT(0, size);
+  CHECK(blocks_.empty() || blocks_.back().last_time < last_time)
+      << "Append out of order at " << last_time << ", last time is "
+      << blocks_.back().last_time;
+  auto& block = blocks_.emplace_back();
+  block.size = size;
+  block.first_index = 0;
+  block.zfp = zfp;
+  block.last_time = last_time;
+  size_ += size;
+}
+
+template<typename Frame>
+void CompressedTimeline<Frame>::ForgetBefore(Instant const& time) {
+  while (!blocks_.empty() && blocks_.front().last_time < time) {
+    auto const& front = blocks_.front();
+    size_ -= front.size - front.first_index;
+    blocks_.pop_front();
+    ++begin_block_;
+  }
+  if (!blocks_.empty()) {
+    // The points of the first block are not all forgotten: find the first one
+    // to keep.
+    auto& front = blocks_.front();
+    auto const points = Decompress(begin_block_);
+    auto const it = std::lower_bound(
+        points->begin() + front.first_index,
+        points->end(),
+        time,
+        [](value_type const& point, Instant const& time) {
+          return point.first < time;
+        });
+    std::int64_t const first_index = it - points->begin();
+    size_ -= first_index - front.first_index;
+    front.first_index = first_index;
+  }
+  absl::MutexLock l(&lock_);
+  cache_.remove_if([this](auto const& cached) {
+    return cached.first < begin_block_;
+  });
+}
+
+template<typename Frame>
+void CompressedTimeline<Frame>::ForgetBlocksFrom(std::int64_t const block) {
+  CHECK_LE(begin_block_, block);
+  while (end_block() > block) {
+    auto const& back = blocks_.back();
+    size_ -= back.size - back.first_index;
+    blocks_.pop_back();
+  }
+  absl::MutexLock l(&lock_);
+  cache_.remove_if([block](auto const& cached) {
+    return cached.first >= block;
+  });
+}
+
+template<typename Frame>
+bool CompressedTimeline<Frame>::empty() const {
+  return blocks_.empty();
+}
+
+template<typename Frame>
+std::int64_t CompressedTimeline<Frame>::size() const {
+  return size_;
+}
+
+template<typename Frame>
+Instant const& CompressedTimeline<Frame>::t_max() const {
+  CHECK(!blocks_.empty());
+  return blocks_.back().last_time;
+}
+
+template<typename Frame>
+std::int64_t CompressedTimeline<Frame>::begin_block() const {
+  return begin_block_;
+}
+
+template<typename Frame>
+std::int64_t CompressedTimeline<Frame>::end_block() const {
+  return begin_block_ + blocks_.size();
+}
+
+template<typename Frame>
+std::int64_t CompressedTimeline<Frame>::FindBlock(Instant const& time) const {
+  auto const it = std::partition_point(
+      blocks_.begin(),
+      blocks_.end(),
+      [&time](CompressedBlock const& block) {
+        return block.last_time < time;
+      });
+  return begin_block_ + (it - blocks_.begin());
+}
+
+template<typename Frame>
+std::int64_t CompressedTimeline<Frame>::first_index(
+    std::int64_t const block) const {
+  return this->block(block).first_index;
+}
+
+template<typename Frame>
+Instant const& CompressedTimeline<Frame>::last_time(
+    std::int64_t const block) const {
+  return this->block(block).last_time;
+}
+
+template<typename Frame>
+std::shared_ptr<typename CompressedTimeline<Frame>::Block const>
+CompressedTimeline<Frame>::Decompress(std::int64_t const block) const {
+  auto const& compressed_block = this->block(block);
+  {
+    absl::MutexLock l(&lock_);
+    for (auto it = cache_.begin(); it != cache_.end(); ++it) {
+      if (it->first == block) {
+        cache_.splice(cache_.begin(), cache_, it);
+        return cache_.front().second;
+      }
+    }
+  }
+
+  // Decompress outside of the lock, another thread might do the same work but
+  // that's harmless.
+  std::string_view zfp = compressed_block.zfp;
+  auto points = std::make_shared<Block const>(
+      DecompressPoints(compressed_block.size, zfp));
+
+  absl::MutexLock l(&lock_);
+  cache_.emplace_front(block, points);
+  if (cache_.size() > max_cached_blocks) {
+    cache_.pop_back();
+  }
+  return points;
+}
+
+template<typename Frame>
+std::int64_t CompressedTimeline<Frame>::compressed_size() const {
+  std::int64_t result = 0;
+  for (auto const& block : blocks_) {
+    result += block.zfp.size();
+  }
+  return result;
+}
+
+template<typename Frame>
+template<typename Iterator>
+void CompressedTimeline<Frame>::CompressPoints(
+    Iterator const begin,
+    Iterator const end,
+    Length const& tolerance,
+    not_null<std::string*> const zfp) {
+  // The timeline data is made dimensionless and stored in separate arrays per
+  // coordinate.  We expect strong correlations within a coordinate over time,
+  // but not between coordinates.
+  std::vector<double> t;
+  std::vector<double> qx;
+  std::vector<double> qy;
+  std::vector<double> qz;
+  std::vector<double> px;
+  std::vector<double> py;
+  std::vector<double> pz;
+  std::optional<Instant> previous_instant;
+  Time max_Δt;
+  for (Iterator it = begin; it != end; ++it) {
+    auto const& [instant, degrees_of_freedom] = *it;
+    auto const q = degrees_of_freedom.position() - Frame::origin;
+    auto const p = degrees_of_freedom.velocity();
+    t.push_back((instant - Instant{}) / Second);
+    qx.push_back(q.coordinates().x / Metre);
+    qy.push_back(q.coordinates().y / Metre);
+    qz.push_back(q.coordinates().z / Metre);
+    px.push_back(p.coordinates().x / (Metre / Second));
+    py.push_back(p.coordinates().y / (Metre / Second));
+    pz.push_back(p.coordinates().z / (Metre / Second));
+    if (previous_instant.has_value()) {
+      max_Δt = std::max(max_Δt, instant - *previous_instant);
+    }
+    previous_instant = instant;
+  }
+
+  // Times are exact.
+  ZfpCompressor time_compressor(0);
+  // Lengths are approximated to the given tolerance.
+  ZfpCompressor length_compressor(tolerance / Metre);
+  // Speeds are approximated based on the length tolerance and the maximum
+  // step in the timeline.
+  ZfpCompressor const speed_compressor((tolerance / max_Δt) /
+                                       (Metre / Second));
+
+  time_compressor.WriteToMessageMultidimensional<2>(t, zfp);
+  length_compressor.WriteToMessageMultidimensional<2>(qx, zfp);
+  length_compressor.WriteToMessageMultidimensional<2>(qy, zfp);
+  length_compressor.WriteToMessageMultidimensional<2>(qz, zfp);
+  speed_compressor.WriteToMessageMultidimensional<2>(px, zfp);
+  speed_compressor.WriteToMessageMultidimensional<2>(py, zfp);
+  speed_compressor.WriteToMessageMultidimensional<2>(pz, zfp);
+}
+
+template<typename Frame>
+typename CompressedTimeline<Frame>::Block
+CompressedTimeline<Frame>::DecompressPoints(std::int64_t const size,
+                                            std::string_view& zfp) {
+  std::vector<double> t(size);
+  std::vector<double> qx(size);
+  std::vector<double> qy(size);
+  std::vector<double> qz(size);
+  std::vector<double> px(size);
+  std::vector<double> py(size);
+  std::vector<double> pz(size);
+
+  ZfpCompressor decompressor;
+  decompressor.ReadFromMessageMultidimensional<2>(t, zfp);
+  decompressor.ReadFromMessageMultidimensional<2>(qx, zfp);
+  decompressor.ReadFromMessageMultidimensional<2>(qy, zfp);
+  decompressor.ReadFromMessageMultidimensional<2>(qz, zfp);
+  decompressor.ReadFromMessageMultidimensional<2>(px, zfp);
+  decompressor.ReadFromMessageMultidimensional<2>(py, zfp);
+  decompressor.ReadFromMessageMultidimensional<2>(pz, zfp);
+
+  Block points;
+  points.reserve(size);
+  for (std::int64_t i = 0; i < size; ++i) {
+    Position<Frame> const q =
+        Frame::origin +
+        Displacement<Frame>({qx[i] * Metre, qy[i] * Metre, qz[i] * Metre});
+    Velocity<Frame> const p({px[i] * (Metre / Second),
+                             py[i] * (Metre / Second),
+                             pz[i] * (Metre / Second)});
+    points.emplace_back(Instant() + t[i] * Second,
+                        DegreesOfFreedom<Frame>(q, p));
+  }
+  return points;
+}
+
+template<typename Frame>
+template<typename Iterator>
+void CompressedTimeline<Frame>::CompressChunks(
+    Iterator const begin,
+    Iterator const end,
+    std::int64_t const points_per_chunk,
+    Length const& tolerance,
+    std::function<void(std::int64_t size, std::string const& zfp)> const&
+        write_chunk) {
+  CHECK_LT(0, points_per_chunk);
+  struct Chunk {
+    std::int64_t size;
+    std::string zfp;
+    std::future<void> compressed;
+  };
+  std::size_t const max_chunks_in_flight =
+      chunks_in_flight_per_thread * std::thread::hardware_concurrency() + 1;
+  std::deque<Chunk> chunks;
+  auto const write_first_chunk = [&chunks, &write_chunk]() {
+    auto& chunk = chunks.front();
+    chunk.compressed.wait();
+    write_chunk(chunk.size, chunk.zfp);
+    chunks.pop_front();
+  };
+
+  Iterator chunk_begin = begin;
+  while (chunk_begin != end) {
+    Iterator chunk_end = chunk_begin;
+    std::int64_t size = 0;
+    for (; chunk_end != end && size < points_per_chunk; ++chunk_end) {
+      ++size;
+    }
+    // A single chunk is not worth a trip through the pool.
+    if (chunk_begin == begin && chunk_end == end) {
+      std::string zfp;
+      CompressPoints(begin, end, tolerance, &zfp);
+      write_chunk(size, zfp);
+      return;
+    }
+    if (chunks.size() == max_chunks_in_flight) {
+      write_first_chunk();
+    }
+    // The elements of a deque are not invalidated by insertions at its ends.
+    auto& chunk = chunks.emplace_back();
+    chunk.size = size;
+    chunk.compressed = CodecPool().Add(
+        [chunk_begin, chunk_end, tolerance, zfp = &chunk.zfp]() {
+          CompressPoints(chunk_begin, chunk_end, tolerance, zfp);
+        });
+    chunk_begin = chunk_end;
+  }
+  while (!chunks.empty()) {
+    write_first_chunk();
+  }
+}
+
+template<typename Frame>
+void CompressedTimeline<Frame>::DecompressChunks(
+    std::vector<std::pair<std::int64_t, std::string_view>> const& chunks,
+    std::function<void(Block const& points)> const& read_chunk) {
+  if (chunks.size() == 1) {
+    std::string_view zfp = chunks.front().second;
+    read_chunk(DecompressPoints(chunks.front().first, zfp));
+    return;
+  }
+
+  std::size_t const max_chunks_in_flight =
+      chunks_in_flight_per_thread * std::thread::hardware_concurrency() + 1;
+  std::deque<std::future<void>> decompressed;
+  // The points of the chunks that are being decompressed.
+  std::deque<Block> blocks;
+  auto const read_first_chunk = [&blocks, &decompressed, &read_chunk]() {
+    decompressed.front().wait();
+    read_chunk(blocks.front());
+    decompressed.pop_front();
+    blocks.pop_front();
+  };
+
+  for (auto const& [size, zfp] : chunks) {
+    if (blocks.size() == max_chunks_in_flight) {
+      read_first_chunk();
+    }
+    decompressed.push_back(CodecPool().Add(
+        [size = size, zfp = zfp, points = &blocks.emplace_back()]() {
+          std::string_view chunk_zfp = zfp;
+          *points = DecompressPoints(size, chunk_zfp);
+        }));
+  }
+  while (!blocks.empty()) {
+    read_first_chunk();
+  }
+}
+
+template<typename Frame>
+std::int64_t CompressedTimeline<Frame>::WriteBlock(
+    std::int64_t const block,
+    Length const& tolerance,
+    not_null<std::string*> const zfp) const {
+  auto const& compressed_block = this->block(block);
+  if (compressed_block.first_index == 0) {
+    zfp->append(compressed_block.zfp);
+  } else {
+    auto const points = Decompress(block);
+    CompressPoints(points->begin() + compressed_block.first_index,
+                   points->end(),
+                   tolerance,
+                   zfp);
+  }
+  return compressed_block.size - compressed_block.first_index;
+}
+
+template<typename Frame>
+typename CompressedTimeline<Frame>::CompressedBlock const&
+CompressedTimeline<Frame>::block(std::int64_t const block) const {
+  CHECK_LE(begin_block_, block);
+  CHECK_LT(block, end_block());
+  return blocks_[block - begin_block_];
+}
+
+}  // namespace internal_compressed_timeline
+}  // namespace physics
+}  // namespace principia
@@ -0,0 +1,228 @@
+#include "physics/compressed_timeline.hpp"
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "geometry/frame.hpp"
+#include "geometry/named_quantities.hpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "quantities/quantities.hpp"
+#include "quantities/si.hpp"
+#include "testing_utilities/matchers.hpp"
+#include "testing_utilities/numerics_matchers.hpp"
+
+namespace principia {
+namespace physics {
+namespace internal_compressed_timeline {
+
+using geometry::Displacement;
+using geometry::Frame;
+using geometry::Handedness;
+using geometry::Inertial;
+using geometry::Velocity;
+using quantities::Sin;
+using quantities::si::Metre;
+using quantities::si::Milli;
+using quantities::si::Radian;
+using quantities::si::Second;
+using testing_utilities::AbsoluteErrorFrom;
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Lt;
+
+class CompressedTimelineTest : public ::testing::Test {
+ protected:
+  using World = Frame<serialization::Frame::TestTag,
+                      Inertial,
+                      Handedness::Right,
+                      serialization::Frame::TEST>;
+
+  // Appends to |points_| the given number of points on a sine curve.
+  void AppendPoints(int const count) {
+    for (int i = 0; i < count; ++i) {
+      Instant const t = t0_ + points_.size() * Second;
+      double const x = Sin((t - t0_) / Second * Radian / 10);
+      points_.emplace(
+          t,
+          DegreesOfFreedom<World>(
+              World::origin +
+                  Displacement<World>({x * Metre, 0 * Metre, 0 * Metre}),
+              Velocity<World>({0 * Metre / Second,
+                               x * Metre / Second,
+                               0 * Metre / Second})));
+    }
+  }
+
+  Instant const t0_;
+  std::map<Instant, DegreesOfFreedom<World>> points_;
+};
+
+TEST_F(CompressedTimelineTest, AppendAndDecompress) {
+  CompressedTimeline<World> timeline;
+  EXPECT_TRUE(timeline.empty());
+  AppendPoints(10);
+  timeline.Append(points_.begin(), points_.end(), 1 * Milli(Metre));
+  auto const second_block_begin = points_.rbegin()->first;
+  AppendPoints(7);
+  timeline.Append(points_.upper_bound(second_block_begin),
+                  points_.end(),
+                  1 * Milli(Metre));
+
+  EXPECT_FALSE(timeline.empty());
+  EXPECT_THAT(timeline.size(), Eq(17));
+  EXPECT_THAT(timeline.begin_block(), Eq(0));
+  EXPECT_THAT(timeline.end_block(), Eq(2));
+  EXPECT_THAT(timeline.t_max(), Eq(t0_ + 16 * Second));
+  EXPECT_THAT(timeline.FindBlock(t0_), Eq(0));
+  EXPECT_THAT(timeline.FindBlock(t0_ + 9 * Second), Eq(0));
+  EXPECT_THAT(timeline.FindBlock(t0_ + 9.5 * Second), Eq(1));
+  EXPECT_THAT(timeline.FindBlock(t0_ + 17 * Second), Eq(2));
+
+  auto it = points_.begin();
+  for (std::int64_t block = timeline.begin_block();
+       block < timeline.end_block();
+       ++block) {
+    auto const decompressed = timeline.Decompress(block);
+    EXPECT_THAT(timeline.Decompress(block), Eq(decompressed));
+    for (auto const& [time, degrees_of_freedom] : *decompressed) {
+      EXPECT_THAT(time, Eq(it->first));
+      EXPECT_THAT(degrees_of_freedom.position(),
+                  AbsoluteErrorFrom(it->second.position(),
+                                    Lt(1 * Milli(Metre))));
+      ++it;
+    }
+  }
+  EXPECT_TRUE(it == points_.end());
+}
+
+TEST_F(CompressedTimelineTest, Forget) {
+  CompressedTimeline<World> timeline;
+  for (int i = 0; i < 3; ++i) {
+    auto const size = points_.size();
+    AppendPoints(8);
+    timeline.Append(std::next(points_.begin(), size),
+                    points_.end(),
+                    1 * Milli(Metre));
+  }
+  EXPECT_THAT(timeline.size(), Eq(24));
+
+  timeline.ForgetBefore(t0_ + 10.5 * Second);
+  EXPECT_THAT(timeline.size(), Eq(13));
+  EXPECT_THAT(timeline.begin_block(), Eq(1));
+  EXPECT_THAT(timeline.first_index(1), Eq(3));
+  EXPECT_THAT((*timeline.Decompress(1))[3].first, Eq(t0_ + 11 * Second));
+
+  auto const last_block = timeline.Decompress(2);
+  timeline.ForgetBlocksFrom(2);
+  EXPECT_THAT(timeline.size(), Eq(5));
+  EXPECT_THAT(timeline.end_block(), Eq(2));
+  EXPECT_THAT(timeline.t_max(), Eq(t0_ + 15 * Second));
+  // The decompressed block is still usable.
+  EXPECT_THAT(last_block->back().first, Eq(t0_ + 23 * Second));
+
+  timeline.ForgetBefore(t0_ + 16 * Second);
+  EXPECT_TRUE(timeline.empty());
+  EXPECT_THAT(timeline.size(), Eq(0));
+}
+
+TEST_F(CompressedTimelineTest, AppendCompressed) {
+  AppendPoints(10);
+  std::string zfp;
+  CompressedTimeline<World>::CompressPoints(
+      points_.begin(), points_.end(), 1 * Milli(Metre), &zfp);
+
+  CompressedTimeline<World> timeline;
+  timeline.AppendCompressed(zfp, points_.size(), points_.rbegin()->first);
+  EXPECT_THAT(timeline.size(), Eq(10));
+  EXPECT_THAT(timeline.t_max(), Eq(t0_ + 9 * Second));
+  EXPECT_THAT(timeline.last_time(0), Eq(t0_ + 9 * Second));
+
+  // The block is written back without being recompressed.
+  std::string written_zfp;
+  EXPECT_THAT(timeline.WriteBlock(0, 1 * Milli(Metre), &written_zfp), Eq(10));
+  EXPECT_THAT(written_zfp, Eq(zfp));
+
+  std::string_view zfp_view = zfp;
+  EXPECT_THAT(*timeline.Decompress(0),
+              Eq(CompressedTimeline<World>::DecompressPoints(10, zfp_view)));
+}
+
+TEST_F(CompressedTimelineTest, Chunks) {
+  AppendPoints(100);
+  std::vector<std::int64_t> sizes;
+  std::string zfp;
+  CompressedTimeline<World>::CompressChunks(
+      points_.begin(),
+      points_.end(),
+      /*points_per_chunk=*/30,
+      1 * Milli(Metre),
+      [&sizes, &zfp](std::int64_t const size, std::string const& chunk_zfp) {
+        sizes.push_back(size);
+        zfp.append(chunk_zfp);
+      });
+  EXPECT_THAT(sizes, ElementsAre(30, 30, 30, 10));
+
+  std::vector<std::pair<std::int64_t, std::string_view>> chunks;
+  std::string_view zfp_view = zfp;
+  for (std::int64_t const size : sizes) {
+    std::string_view chunk_zfp = zfp_view;
+    CompressedTimeline<World>::DecompressPoints(size, zfp_view);
+    chunks.emplace_back(size, chunk_zfp.substr(0, chunk_zfp.size() -
+                                                      zfp_view.size()));
+  }
+  auto it = points_.begin();
+  CompressedTimeline<World>::DecompressChunks(
+      chunks,
+      [&it](CompressedTimeline<World>::Block const& points) {
+        for (auto const& [time, degrees_of_freedom] : points) {
+          EXPECT_THAT(time, Eq(it->first));
+          EXPECT_THAT(degrees_of_freedom.position(),
+                      AbsoluteErrorFrom(it->second.position(),
+                                        Lt(1 * Milli(Metre))));
+          ++it;
+        }
+      });
+  EXPECT_TRUE(it == points_.end());
+}
+
+TEST_F(CompressedTimelineTest, SingleChunk) {
+  std::vector<std::int64_t> sizes;
+  std::string zfp;
+  auto const write_chunk = [&sizes, &zfp](std::int64_t const size,
+                                          std::string const& chunk_zfp) {
+    sizes.push_back(size);
+    zfp.append(chunk_zfp);
+  };
+
+  // No chunk for no points.
+  CompressedTimeline<World>::CompressChunks(points_.begin(),
+                                            points_.end(),
+                                            /*points_per_chunk=*/30,
+                                            1 * Milli(Metre),
+                                            write_chunk);
+  EXPECT_TRUE(sizes.empty());
+
+  AppendPoints(30);
+  CompressedTimeline<World>::CompressChunks(points_.begin(),
+                                            points_.end(),
+                                            /*points_per_chunk=*/30,
+                                            1 * Milli(Metre),
+                                            write_chunk);
+  EXPECT_THAT(sizes, ElementsAre(30));
+
+  std::int64_t size = 0;
+  CompressedTimeline<World>::DecompressChunks(
+      {{30, zfp}},
+      [&size](CompressedTimeline<World>::Block const& points) {
+        size += points.size();
+      });
+  EXPECT_THAT(size, Eq(30));
+}
+
+}  // namespace internal_compressed_timeline
+}  // namespace physics
+}  // namespace principia
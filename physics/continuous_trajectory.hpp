@@ -2,13 +2,20 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
 #include <optional>
 #include <utility>
 #include <vector>
 
 #include "absl/synchronization/mutex.h"
+#include "base/block_store.hpp"
 #include "base/not_null.hpp"
 #include "base/status.hpp"
+#include "base/status_or.hpp"
+#include "base/thread_pool.hpp"
 #include "geometry/named_quantities.hpp"
 #include "numerics/piecewise_poisson_series.hpp"
 #include "numerics/polynomial.hpp"
@@ -23,8 +30,11 @@ namespace principia {
 namespace physics {
 namespace internal_continuous_trajectory {
 
+using base::BlockStore;
 using base::not_null;
 using base::Status;
+using base::StatusOr;
+using base::ThreadPool;
 using geometry::Displacement;
 using geometry::Instant;
 using geometry::Position;
@@ -58,6 +68,9 @@ class ContinuousTrajectory : public Trajectory<Frame> {
   ContinuousTrajectory& operator=(ContinuousTrajectory const&) = delete;
   ContinuousTrajectory& operator=(ContinuousTrajectory&&) = delete;
 
+  // Waits for the pending fits, if any.
+  ~ContinuousTrajectory() override;
+
   // Returns true iff this trajectory cannot be evaluated for any time.
   bool empty() const EXCLUDES(lock_);
 
@@ -76,6 +89,21 @@ class ContinuousTrajectory : public Trajectory<Frame> {
   // Removes all data for times strictly less than |time|.
   void ForgetBefore(Instant const& time) EXCLUDES(lock_);
 
+  // If |pool| is not null, the polynomials are subsequently fitted on |pool|
+  // instead of in |Append|, in the order in which the points were appended.
+  // The fits of a given trajectory are sequential, so they yield the same
+  // polynomials as synchronous fitting, but the fits of distinct trajectories
+  // sharing a pool proceed in parallel.  |t_max| only increases when a fit
+  // completes.  Errors of asynchronous fits are returned by the next call to
+  // |Append| or |WaitForFits|.  |pool| must outlive this object.
+  void SetFittingPool(ThreadPool<void>* pool) EXCLUDES(lock_);
+
+  // Waits until the polynomials for all the points appended so far (except for
+  // the ones that do not yet make a complete polynomial) have been fitted.
+  // Returns the first error of an asynchronous fit not yet returned by
+  // |Append| or |WaitForFits|.
+  Status WaitForFits() EXCLUDES(lock_);
+
   // Implementation of the interface |Trajectory|.
 
   // |t_max| may be less than the last time passed to Append.  For an empty
@@ -108,20 +136,25 @@ class ContinuousTrajectory : public Trajectory<Frame> {
 
   void WriteToMessage(not_null<serialization::ContinuousTrajectory*> message)
       const EXCLUDES(lock_);
+  // Fails with |FAILED_PRECONDITION| if the message refers to blocks of
+  // polynomials and the flag |block_store| is not set, or with the error of
+  // the |BlockStore| if a block cannot be read.
   template<typename F = Frame,
            typename = std::enable_if_t<base::is_serializable_v<F>>>
-  static not_null<std::unique_ptr<ContinuousTrajectory>> ReadFromMessage(
-      serialization::ContinuousTrajectory const& message);
+  static StatusOr<not_null<std::unique_ptr<ContinuousTrajectory>>>
+  ReadFromMessage(serialization::ContinuousTrajectory const& message);
 
   // Checkpointing support.  The checkpointer is exposed to make it possible for
   // Ephemeris to create synchronized checkpoints of its state and that of its
-  // trajectories.
+  // trajectories.  Creating a checkpoint waits for the pending fits.
   Checkpointer<serialization::ContinuousTrajectory>& checkpointer();
   void WriteToCheckpoint(
-      not_null<serialization::ContinuousTrajectory*> message);
+      not_null<serialization::ContinuousTrajectory*> message)
+      EXCLUDES(lock_) EXCLUDES(fitting_lock_);
   template<typename F = Frame,
            typename = std::enable_if_t<base::is_serializable_v<F>>>
-  bool ReadFromCheckpoint(serialization::ContinuousTrajectory const& message);
+  bool ReadFromCheckpoint(serialization::ContinuousTrajectory const& message)
+      EXCLUDES(lock_) EXCLUDES(fitting_lock_);
 
  protected:
   // For mocking.
@@ -145,6 +178,14 @@ class ContinuousTrajectory : public Trajectory<Frame> {
   };
   using InstantPolynomialPairs = std::vector<InstantPolynomialPair>;
 
+  // The data needed to fit a polynomial over [t_min, t_max] asynchronously.
+  struct PendingFit {
+    Instant t_min;
+    Instant t_max;
+    std::vector<Displacement<Frame>> q;
+    std::vector<Velocity<Frame>> v;
+  };
+
   Instant t_min_locked() const REQUIRES_SHARED(lock_);
   Instant t_max_locked() const REQUIRES_SHARED(lock_);
 
@@ -158,14 +199,31 @@ class ContinuousTrajectory : public Trajectory<Frame> {
       Instant const& t_max,
       Displacement<Frame>& error_estimate) const;
 
-  // Computes the best Newhall approximation based on the desired tolerance.
-  // Adjust the |degree_| and other member variables to stay within the
-  // tolerance while minimizing the computational cost and avoiding numerical
-  // instabilities.
+  // Same as above, but only returns the error estimate.
+  virtual Displacement<Frame> NewhallApproximationErrorEstimate(
+      int degree,
+      std::vector<Displacement<Frame>> const& q,
+      std::vector<Velocity<Frame>> const& v,
+      Instant const& t_min,
+      Instant const& t_max) const;
+
+  // Computes the best Newhall approximation over [t_min, t_max] based on the
+  // desired tolerance, and stores it in |polynomial|.  Adjust the |degree_| and
+  // other member variables to stay within the tolerance while minimizing the
+  // computational cost and avoiding numerical instabilities.
   Status ComputeBestNewhallApproximation(
-      Instant const& time,
+      Instant const& t_min,
+      Instant const& t_max,
       std::vector<Displacement<Frame>> const& q,
-      std::vector<Velocity<Frame>> const& v) REQUIRES(lock_);
+      std::vector<Velocity<Frame>> const& v,
+      std::unique_ptr<Polynomial<Displacement<Frame>, Instant>>& polynomial)
+      REQUIRES(fitting_lock_);
+
+  // Runs on |fitting_pool_| until |pending_fits_| is empty.
+  void FitPendingPolynomials() EXCLUDES(lock_);
+
+  // Blocks until |pending_fits_| is empty and no fit is in progress.
+  void WaitForFitsLocked() REQUIRES(lock_);
 
   // Returns an iterator to the polynomial applicable for the given |time|, or
   // |begin()| if |time| is before the first polynomial or |end()| if |time| is
@@ -173,22 +231,50 @@ class ContinuousTrajectory : public Trajectory<Frame> {
   typename InstantPolynomialPairs::const_iterator
   FindPolynomialForInstant(Instant const& time) const REQUIRES_SHARED(lock_);
 
+  // Returns true if the blocks written to a |BlockStore| end with the
+  // polynomial whose |t_max| is given.  The boundaries of the blocks only
+  // depend on their contents, so that the blocks are not affected by
+  // |ForgetBefore| or by the polynomials appended later.
+  static bool IsEndOfBlock(Instant const& t_max);
+
+  // Writes the polynomials in [begin, end[ as a block to |block_store|, unless
+  // it's already there, and returns its fingerprint.
+  std::uint64_t WriteBlock(
+      typename InstantPolynomialPairs::const_iterator begin,
+      typename InstantPolynomialPairs::const_iterator end,
+      BlockStore const& block_store) const
+      REQUIRES_SHARED(lock_) EXCLUDES(block_fingerprints_lock_);
+
   // Construction parameters;
   Time const step_;
   Length const tolerance_;
   Checkpointer<serialization::ContinuousTrajectory> checkpointer_;
 
+  // The checkpointer calls |WriteToCheckpoint| and |ReadFromCheckpoint| with
+  // its lock held, so that lock is taken before |lock_|.
   mutable absl::Mutex lock_;
 
+  // Protects the state of the fitting, which is only accessed by one thread at
+  // a time but not necessarily under |lock_|.  When both locks are taken,
+  // |lock_| is taken first.
+  absl::Mutex fitting_lock_;
+
   // Initially set to the construction parameters, and then adjusted when we
   // choose the degree.
-  Length adjusted_tolerance_ GUARDED_BY(lock_);
-  bool is_unstable_ GUARDED_BY(lock_);
+  Length adjusted_tolerance_ GUARDED_BY(fitting_lock_);
+  bool is_unstable_ GUARDED_BY(fitting_lock_);
 
   // The degree of the approximation and its age in number of Newhall
   // approximations.
-  int degree_ GUARDED_BY(lock_);
-  int degree_age_ GUARDED_BY(lock_);
+  int degree_ GUARDED_BY(fitting_lock_);
+  int degree_age_ GUARDED_BY(fitting_lock_);
+
+  // Asynchronous fitting support.  |fitting_| is true while a call to
+  // |FitPendingPolynomials| is queued or running.
+  ThreadPool<void>* fitting_pool_ GUARDED_BY(lock_) = nullptr;
+  std::deque<PendingFit> pending_fits_ GUARDED_BY(lock_);
+  bool fitting_ GUARDED_BY(lock_) = false;
+  Status fitting_status_ GUARDED_BY(lock_);
 
   // The polynomials are in increasing time order.
   InstantPolynomialPairs polynomials_ GUARDED_BY(lock_);
@@ -211,12 +297,22 @@ class ContinuousTrajectory : public Trajectory<Frame> {
   // The time at which this trajectory starts.  Set for a nonempty trajectory.
   std::optional<Instant> first_time_ GUARDED_BY(lock_);
 
-  // The points that have not yet been incorporated in a polynomial.  Nonempty
-  // for a nonempty trajectory.
-  // |last_points_.begin()->first == polynomials_.back().t_max|
+  // The points that have not yet been incorporated in a polynomial or in a
+  // pending fit.  Nonempty for a nonempty trajectory.  When there are no
+  // pending fits, |last_points_.begin()->first == polynomials_.back().t_max|.
   std::vector<std::pair<Instant, DegreesOfFreedom<Frame>>> last_points_
       GUARDED_BY(lock_);
 
+  // The average number of polynomials in a block written to a |BlockStore|.
+  static constexpr std::uint64_t polynomials_per_block = 64;
+
+  // The fingerprints of the blocks written to or read from a |BlockStore|,
+  // indexed by the |t_max| of their first and last polynomials.  This avoids
+  // serializing the blocks again when the trajectory is written.
+  mutable absl::Mutex block_fingerprints_lock_;
+  mutable std::map<std::pair<Instant, Instant>, std::uint64_t>
+      block_fingerprints_ GUARDED_BY(block_fingerprints_lock_);
+
   friend class TestableContinuousTrajectory<Frame>;
 };
 
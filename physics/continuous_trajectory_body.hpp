@@ -4,6 +4,8 @@
 #include "physics/continuous_trajectory.hpp"
 
 #include <algorithm>
+#include <cstring>
+#include <iterator>
 #include <limits>
 #include <optional>
 #include <sstream>
@@ -11,6 +13,7 @@
 #include <vector>
 
 #include "astronomy/epoch.hpp"
+#include "base/fingerprint2011.hpp"
 #include "geometry/interval.hpp"
 #include "glog/stl_logging.h"
 #include "numerics/newhall.hpp"
@@ -23,7 +26,9 @@ namespace physics {
 namespace internal_continuous_trajectory {
 
 using base::dynamic_cast_not_null;
+using base::check_not_null;
 using base::Error;
+using base::Fingerprint2011;
 using base::make_not_null_unique;
 using geometry::Interval;
 using numerics::EstrinEvaluator;
@@ -73,6 +78,12 @@ ContinuousTrajectory<Frame>::ContinuousTrajectory(Time const& step,
   CHECK_LT(0 * Metre, tolerance_);
 }
 
+template<typename Frame>
+ContinuousTrajectory<Frame>::~ContinuousTrajectory() {
+  absl::MutexLock l(&lock_);
+  WaitForFitsLocked();
+}
+
 template<typename Frame>
 bool ContinuousTrajectory<Frame>::empty() const {
   absl::ReaderMutexLock l(&lock_);
@@ -115,26 +126,60 @@ Status ContinuousTrajectory<Frame>::Append(
   Status status;
   CHECK_LE(last_points_.size(), divisions);
   if (last_points_.size() == divisions) {
-    // These vectors are thread-local to avoid deallocation/reallocation each
-    // time we go through this code path.
-    thread_local std::vector<Displacement<Frame>> q(divisions + 1);
-    thread_local std::vector<Velocity<Frame>> v(divisions + 1);
-    q.clear();
-    v.clear();
-
-    for (auto const& [_, degrees_of_freedom] : last_points_) {
+    Instant const t_min = last_points_.cbegin()->first;
+    if (fitting_pool_ == nullptr) {
+      // These vectors are thread-local to avoid deallocation/reallocation each
+      // time we go through this code path.
+      thread_local std::vector<Displacement<Frame>> q(divisions + 1);
+      thread_local std::vector<Velocity<Frame>> v(divisions + 1);
+      q.clear();
+      v.clear();
+
+      for (auto const& [_, degrees_of_freedom] : last_points_) {
+        q.push_back(degrees_of_freedom.position() - Frame::origin);
+        v.push_back(degrees_of_freedom.velocity());
+      }
       q.push_back(degrees_of_freedom.position() - Frame::origin);
       v.push_back(degrees_of_freedom.velocity());
-    }
-    q.push_back(degrees_of_freedom.position() - Frame::origin);
-    v.push_back(degrees_of_freedom.velocity());
 
-    status = ComputeBestNewhallApproximation(time, q, v);
+      std::unique_ptr<Polynomial<Displacement<Frame>, Instant>> polynomial;
+      {
+        absl::MutexLock l(&fitting_lock_);
+        status = ComputeBestNewhallApproximation(t_min, time, q, v, polynomial);
+      }
+      polynomials_.emplace_back(time, check_not_null(std::move(polynomial)));
+    } else {
+      // Copy the data of the fit and leave the work to the pool.  At most one
+      // call to |FitPendingPolynomials| is in flight for this trajectory, so
+      // the polynomials are appended in order.
+      auto& fit = pending_fits_.emplace_back();
+      fit.t_min = t_min;
+      fit.t_max = time;
+      fit.q.reserve(divisions + 1);
+      fit.v.reserve(divisions + 1);
+      for (auto const& [_, degrees_of_freedom] : last_points_) {
+        fit.q.push_back(degrees_of_freedom.position() - Frame::origin);
+        fit.v.push_back(degrees_of_freedom.velocity());
+      }
+      fit.q.push_back(degrees_of_freedom.position() - Frame::origin);
+      fit.v.push_back(degrees_of_freedom.velocity());
+      if (!fitting_) {
+        fitting_ = true;
+        fitting_pool_->Add([this]() { FitPendingPolynomials(); });
+      }
+    }
 
     // Wipe-out the points that have just been incorporated in a polynomial.
     last_points_.clear();
   }
 
+  // Report the errors of the asynchronous fits that completed since the last
+  // call.  If this call already fails, they are reported by the next one.
+  if (status.ok() && !fitting_status_.ok()) {
+    status = fitting_status_;
+    fitting_status_ = Status::OK;
+  }
+
   // Note that we only insert the new point in the map *after* computing the
   // approximation, because clearing the map is much more efficient than erasing
   // every element but one.
@@ -145,28 +190,47 @@ Status ContinuousTrajectory<Frame>::Append(
 
 template<typename Frame>
 void ContinuousTrajectory<Frame>::ForgetBefore(Instant const& time) {
-  absl::MutexLock l(&lock_);
-  if (time < t_min_locked()) {
-    // TODO(phl): test for this case, it yielded a check failure in
-    // |FindPolynomialForInstant|.
-    return;
-  }
+  {
+    absl::MutexLock l(&lock_);
+    WaitForFitsLocked();
+    if (time < t_min_locked()) {
+      // TODO(phl): test for this case, it yielded a check failure in
+      // |FindPolynomialForInstant|.
+      return;
+    }
 
-  polynomials_.erase(polynomials_.begin(), FindPolynomialForInstant(time));
+    polynomials_.erase(polynomials_.begin(), FindPolynomialForInstant(time));
 
-  // If there are no |polynomials_| left, clear everything.  Otherwise, update
-  // the first time.
-  if (polynomials_.empty()) {
-    first_time_ = std::nullopt;
-    last_points_.clear();
-    last_accessed_polynomial_ = 0;
-  } else {
-    first_time_ = time;
-    last_accessed_polynomial_ = polynomials_.size() - 1;
+    // If there are no |polynomials_| left, clear everything.  Otherwise,
+    // update the first time.
+    if (polynomials_.empty()) {
+      first_time_ = std::nullopt;
+      last_points_.clear();
+      last_accessed_polynomial_ = 0;
+    } else {
+      first_time_ = time;
+      last_accessed_polynomial_ = polynomials_.size() - 1;
+    }
   }
   checkpointer_.ForgetBefore(time);
 }
 
+template<typename Frame>
+void ContinuousTrajectory<Frame>::SetFittingPool(ThreadPool<void>* const pool) {
+  absl::MutexLock l(&lock_);
+  WaitForFitsLocked();
+  fitting_pool_ = pool;
+}
+
+template<typename Frame>
+Status ContinuousTrajectory<Frame>::WaitForFits() {
+  absl::MutexLock l(&lock_);
+  WaitForFitsLocked();
+  Status const status = fitting_status_;
+  fitting_status_ = Status::OK;
+  return status;
+}
+
 template<typename Frame>
 Instant ContinuousTrajectory<Frame>::t_min() const {
   absl::ReaderMutexLock l(&lock_);
@@ -344,22 +408,37 @@ ContinuousTrajectory<Frame>::ToPiecewisePoissonSeries(
 template<typename Frame>
 void ContinuousTrajectory<Frame>::WriteToMessage(
       not_null<serialization::ContinuousTrajectory*> const message) const {
-  absl::ReaderMutexLock l(&lock_);
   Instant const checkpoint_time =  checkpointer_.WriteToMessage(message);
+  absl::ReaderMutexLock l(&lock_);
   checkpoint_time.WriteToMessage(message->mutable_checkpoint_time());
   step_.WriteToMessage(message->mutable_step());
   tolerance_.WriteToMessage(message->mutable_tolerance());
-  for (auto const& pair : polynomials_) {
-    Instant const& t_max = pair.t_max;
-    auto const& polynomial = pair.polynomial;
-    if (t_max <= checkpoint_time) {
-      auto* const pair = message->add_instant_polynomial_pair();
-      t_max.WriteToMessage(pair->mutable_t_max());
-      polynomial->WriteToMessage(pair->mutable_polynomial());
-    } else {
-      break;
+  auto const end = std::find_if(
+      polynomials_.begin(),
+      polynomials_.end(),
+      [&checkpoint_time](InstantPolynomialPair const& pair) {
+        return pair.t_max > checkpoint_time;
+      });
+  auto begin = polynomials_.begin();
+
+  // If there is a block store, the complete blocks of polynomials go there and
+  // only the last, incomplete one is written to the message.
+  if (std::optional<BlockStore> const block_store = BlockStore::FromFlags();
+      block_store.has_value()) {
+    for (auto it = begin; it != end;) {
+      bool const is_end_of_block = IsEndOfBlock(it->t_max);
+      ++it;
+      if (is_end_of_block) {
+        message->add_block_of_polynomials(WriteBlock(begin, it, *block_store));
+        begin = it;
+      }
     }
   }
+  for (auto it = begin; it != end; ++it) {
+    auto* const pair = message->add_instant_polynomial_pair();
+    it->t_max.WriteToMessage(pair->mutable_t_max());
+    it->polynomial->WriteToMessage(pair->mutable_polynomial());
+  }
   if (first_time_) {
     first_time_->WriteToMessage(message->mutable_first_time());
   }
@@ -367,7 +446,7 @@ void ContinuousTrajectory<Frame>::WriteToMessage(
 
 template<typename Frame>
 template<typename, typename>
-not_null<std::unique_ptr<ContinuousTrajectory<Frame>>>
+StatusOr<not_null<std::unique_ptr<ContinuousTrajectory<Frame>>>>
 ContinuousTrajectory<Frame>::ReadFromMessage(
       serialization::ContinuousTrajectory const& message) {
   bool const is_pre_cohen = message.series_size() > 0;
@@ -401,11 +480,46 @@ ContinuousTrajectory<Frame>::ReadFromMessage(
               error_estimate));
     }
   } else {
+    auto& polynomials = continuous_trajectory->polynomials_;
+    auto const read_pair =
+        [&polynomials](
+            serialization::ContinuousTrajectory::InstantPolynomialPair const&
+                pair) {
+          polynomials.emplace_back(
+              Instant::ReadFromMessage(pair.t_max()),
+              Polynomial<Displacement<Frame>, Instant>::
+                  template ReadFromMessage<EstrinEvaluator>(
+                      pair.polynomial()));
+        };
+    if (message.block_of_polynomials_size() > 0) {
+      std::optional<BlockStore> const block_store = BlockStore::FromFlags();
+      if (!block_store.has_value()) {
+        return Status(Error::FAILED_PRECONDITION,
+                      "The block_store flag must be set to read this save");
+      }
+      for (std::uint64_t const fingerprint : message.block_of_polynomials()) {
+        auto const bytes = block_store->Get(fingerprint);
+        RETURN_IF_ERROR(bytes);
+        serialization::ContinuousTrajectory::BlockOfPolynomials block;
+        if (!block.ParseFromString(bytes.ValueOrDie()) ||
+            block.instant_polynomial_pair_size() == 0) {
+          return Status(Error::DATA_LOSS,
+                        "Unparseable block " + std::to_string(fingerprint));
+        }
+        for (auto const& pair : block.instant_polynomial_pair()) {
+          read_pair(pair);
+        }
+        absl::MutexLock l(&continuous_trajectory->block_fingerprints_lock_);
+        continuous_trajectory->block_fingerprints_.emplace(
+            std::pair(
+                Instant::ReadFromMessage(
+                    block.instant_polynomial_pair(0).t_max()),
+                polynomials.back().t_max),
+            fingerprint);
+      }
+    }
     for (auto const& pair : message.instant_polynomial_pair()) {
-      continuous_trajectory->polynomials_.emplace_back(
-          Instant::ReadFromMessage(pair.t_max()),
-          Polynomial<Displacement<Frame>, Instant>::template ReadFromMessage<
-              EstrinEvaluator>(pair.polynomial()));
+      read_pair(pair);
     }
   }
   if (message.has_first_time()) {
@@ -435,6 +549,11 @@ ContinuousTrajectory<Frame>::checkpointer() {
 template<typename Frame>
 void ContinuousTrajectory<Frame>::WriteToCheckpoint(
     not_null<serialization::ContinuousTrajectory*> const message) {
+  absl::MutexLock l(&lock_);
+  // The checkpoint must reflect all the points appended so far.  The errors of
+  // the fits are reported by the next call to |Append| or |WaitForFits|.
+  WaitForFitsLocked();
+  absl::MutexLock l2(&fitting_lock_);
   adjusted_tolerance_.WriteToMessage(message->mutable_adjusted_tolerance());
   message->set_is_unstable(is_unstable_);
   message->set_degree(degree_);
@@ -458,6 +577,8 @@ bool ContinuousTrajectory<Frame>::ReadFromCheckpoint(
                               message.has_degree() &&
                               message.has_degree_age();
   if (has_checkpoint) {
+    absl::MutexLock l(&lock_);
+    absl::MutexLock l2(&fitting_lock_);
     adjusted_tolerance_ = Length::ReadFromMessage(message.adjusted_tolerance());
     is_unstable_ = message.is_unstable();
     degree_ = message.degree();
@@ -475,6 +596,41 @@ template<typename Frame>
 ContinuousTrajectory<Frame>::ContinuousTrajectory()
     : checkpointer_(/*reader=*/nullptr, /*writer=*/nullptr) {}
 
+template<typename Frame>
+bool ContinuousTrajectory<Frame>::IsEndOfBlock(Instant const& t_max) {
+  double const t = (t_max - Instant()) / Second;
+  char bytes[sizeof(t)];
+  std::memcpy(bytes, &t, sizeof(t));
+  return Fingerprint2011(bytes, sizeof(bytes)) % polynomials_per_block == 0;
+}
+
+template<typename Frame>
+std::uint64_t ContinuousTrajectory<Frame>::WriteBlock(
+    typename InstantPolynomialPairs::const_iterator const begin,
+    typename InstantPolynomialPairs::const_iterator const end,
+    BlockStore const& block_store) const {
+  std::pair<Instant, Instant> const key(begin->t_max, std::prev(end)->t_max);
+  {
+    absl::MutexLock l(&block_fingerprints_lock_);
+    auto const it = block_fingerprints_.find(key);
+    if (it != block_fingerprints_.end() && block_store.Contains(it->second)) {
+      return it->second;
+    }
+  }
+
+  serialization::ContinuousTrajectory::BlockOfPolynomials block;
+  for (auto it = begin; it != end; ++it) {
+    auto* const pair = block.add_instant_polynomial_pair();
+    it->t_max.WriteToMessage(pair->mutable_t_max());
+    it->polynomial->WriteToMessage(pair->mutable_polynomial());
+  }
+  std::uint64_t const fingerprint = block_store.Put(block.SerializeAsString());
+
+  absl::MutexLock l(&block_fingerprints_lock_);
+  block_fingerprints_.insert_or_assign(key, fingerprint);
+  return fingerprint;
+}
+
 template<typename Frame>
 ContinuousTrajectory<Frame>::InstantPolynomialPair::InstantPolynomialPair(
     Instant const t_max,
@@ -521,12 +677,27 @@ ContinuousTrajectory<Frame>::NewhallApproximationInMonomialBasis(
                                                   error_estimate);
 }
 
+template<typename Frame>
+Displacement<Frame>
+ContinuousTrajectory<Frame>::NewhallApproximationErrorEstimate(
+    int degree,
+    std::vector<Displacement<Frame>> const& q,
+    std::vector<Velocity<Frame>> const& v,
+    Instant const& t_min,
+    Instant const& t_max) const {
+  return numerics::NewhallApproximationErrorEstimate(degree,
+                                                     q, v,
+                                                     t_min, t_max);
+}
+
 template<typename Frame>
 Status ContinuousTrajectory<Frame>::ComputeBestNewhallApproximation(
-    Instant const& time,
+    Instant const& t_min,
+    Instant const& t_max,
     std::vector<Displacement<Frame>> const& q,
-    std::vector<Velocity<Frame>> const& v) {
-  lock_.AssertHeld();
+    std::vector<Velocity<Frame>> const& v,
+    std::unique_ptr<Polynomial<Displacement<Frame>, Instant>>& polynomial) {
+  fitting_lock_.AssertHeld();
   Length const previous_adjusted_tolerance = adjusted_tolerance_;
 
   // If the degree is too old, restart from the lowest degree.  This ensures
@@ -540,18 +711,13 @@ Status ContinuousTrajectory<Frame>::ComputeBestNewhallApproximation(
     degree_age_ = 0;
   }
 
-  // Compute the approximation with the current degree.
-  Displacement<Frame> displacement_error_estimate;
-  polynomials_.emplace_back(time,
-                            NewhallApproximationInMonomialBasis(
-                                degree_,
-                                q, v,
-                                last_points_.cbegin()->first, time,
-                                displacement_error_estimate));
-
-  // Estimate the error.  For initializing |previous_error_estimate|, any value
-  // greater than |error_estimate| will do.
-  Length error_estimate = displacement_error_estimate.Norm();
+  // The degree is selected based on the error estimates, which are cheap to
+  // compute, and the approximation is only computed once at the end.
+
+  // Estimate the error with the current degree.  For initializing
+  // |previous_error_estimate|, any value greater than |error_estimate| will do.
+  Length error_estimate =
+      NewhallApproximationErrorEstimate(degree_, q, v, t_min, t_max).Norm();
   Length previous_error_estimate = error_estimate + error_estimate;
 
   // If we are in the zone of numerical instabilities and we exceeded the
@@ -579,15 +745,19 @@ Status ContinuousTrajectory<Frame>::ComputeBestNewhallApproximation(
     ++degree_;
     VLOG(1) << "Increasing degree for " << this << " to " <<degree_
             << " because error estimate was " << error_estimate;
-    polynomials_.back().polynomial = NewhallApproximationInMonomialBasis(
-                                         degree_,
-                                         q, v,
-                                         last_points_.cbegin()->first, time,
-                                         displacement_error_estimate);
     previous_error_estimate = error_estimate;
-    error_estimate = displacement_error_estimate.Norm();
+    error_estimate =
+        NewhallApproximationErrorEstimate(degree_, q, v, t_min, t_max).Norm();
   }
 
+  // The approximation uses the last degree that we tried, even if we revert to
+  // a lower degree below for the next approximation.
+  Displacement<Frame> displacement_error_estimate;
+  polynomial = NewhallApproximationInMonomialBasis(degree_,
+                                                   q, v,
+                                                   t_min, t_max,
+                                                   displacement_error_estimate);
+
   // If we have entered the zone of numerical instability, go back to the
   // point where the error was decreasing and nudge the tolerance since we
   // won't be able to reliably do better than that.
@@ -616,7 +786,7 @@ Status ContinuousTrajectory<Frame>::ComputeBestNewhallApproximation(
     message << "Error trying to fit a smooth polynomial to the trajectory. "
             << "The approximation error jumped from "
             << previous_adjusted_tolerance << " to " << adjusted_tolerance_
-            << " at time " << time << ". The last position is " << q.back()
+            << " at time " << t_max << ". The last position is " << q.back()
             << " and the last velocity is " << v.back()
             << ". An apocalypse occurred and two celestials probably "
             << "collided because your solar system is unstable.";
@@ -624,6 +794,47 @@ Status ContinuousTrajectory<Frame>::ComputeBestNewhallApproximation(
   }
 }
 
+template<typename Frame>
+void ContinuousTrajectory<Frame>::FitPendingPolynomials() {
+  for (;;) {
+    PendingFit fit;
+    {
+      absl::MutexLock l(&lock_);
+      if (pending_fits_.empty()) {
+        fitting_ = false;
+        return;
+      }
+      fit = std::move(pending_fits_.front());
+      pending_fits_.pop_front();
+    }
+
+    // The fit proper runs without holding |lock_| so that the trajectory may
+    // be evaluated and appended to concurrently.
+    std::unique_ptr<Polynomial<Displacement<Frame>, Instant>> polynomial;
+    Status status;
+    {
+      absl::MutexLock l(&fitting_lock_);
+      status = ComputeBestNewhallApproximation(
+          fit.t_min, fit.t_max, fit.q, fit.v, polynomial);
+    }
+
+    absl::MutexLock l(&lock_);
+    polynomials_.emplace_back(fit.t_max, check_not_null(std::move(polynomial)));
+    if (fitting_status_.ok()) {
+      fitting_status_ = status;
+    }
+  }
+}
+
+template<typename Frame>
+void ContinuousTrajectory<Frame>::WaitForFitsLocked() {
+  lock_.AssertHeld();
+  auto const fits_done = [this]() {
+    return !fitting_ && pending_fits_.empty();
+  };
+  lock_.Await(absl::Condition(&fits_done));
+}
+
 template<typename Frame>
 typename ContinuousTrajectory<Frame>::InstantPolynomialPairs::const_iterator
 ContinuousTrajectory<Frame>::FindPolynomialForInstant(
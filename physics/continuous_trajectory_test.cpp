@@ -3,10 +3,13 @@
 
 #include <algorithm>
 #include <deque>
+#include <filesystem>
 #include <functional>
 #include <limits>
 #include <vector>
 
+#include "base/flags.hpp"
+#include "base/thread_pool.hpp"
 #include "geometry/frame.hpp"
 #include "geometry/named_quantities.hpp"
 #include "gtest/gtest.h"
@@ -30,6 +33,8 @@ namespace principia {
 namespace physics {
 namespace internal_continuous_trajectory {
 
+using base::Flags;
+using base::ThreadPool;
 using geometry::Displacement;
 using geometry::Frame;
 using geometry::Handedness;
@@ -65,7 +70,9 @@ class TestableContinuousTrajectory : public ContinuousTrajectory<Frame> {
  public:
   using ContinuousTrajectory<Frame>::ContinuousTrajectory;
 
-  // Mock the Newhall factory.
+  // Mock the Newhall factory.  The degree is selected based on the error
+  // estimates, which are mocked, and the approximation is then computed once
+  // with the selected degree, which is recorded.
   not_null<std::unique_ptr<Polynomial<Displacement<Frame>, Instant>>>
   NewhallApproximationInMonomialBasis(
       int degree,
@@ -75,16 +82,23 @@ class TestableContinuousTrajectory : public ContinuousTrajectory<Frame> {
       Instant const& t_max,
       Displacement<Frame>& error_estimate) const override;
 
-  MOCK_CONST_METHOD7_T(
-      FillNewhallApproximationInMonomialBasis,
+  Displacement<Frame> NewhallApproximationErrorEstimate(
+      int degree,
+      std::vector<Displacement<Frame>> const& q,
+      std::vector<Velocity<Frame>> const& v,
+      Instant const& t_min,
+      Instant const& t_max) const override;
+
+  MOCK_CONST_METHOD6_T(
+      FillNewhallApproximationErrorEstimate,
       void(int degree,
            std::vector<Displacement<Frame>> const& q,
            std::vector<Velocity<Frame>> const& v,
            Instant const& t_min,
            Instant const& t_max,
-           Displacement<Frame>& error_estimate,
-           not_null<std::unique_ptr<Polynomial<Displacement<Frame>, Instant>>>&
-               polynomial));
+           Displacement<Frame>& error_estimate));
+
+  MOCK_CONST_METHOD1_T(RecordNewhallApproximationDegree, void(int degree));
 
   Status LockAndComputeBestNewhallApproximation(
       Instant const& time,
@@ -111,14 +125,24 @@ TestableContinuousTrajectory<Frame>::NewhallApproximationInMonomialBasis(
                 Displacement<Frame>, Instant, /*degree=*/1, HornerEvaluator>;
   typename P::Coefficients const coefficients = {Displacement<Frame>(),
                                                  Velocity<Frame>()};
-  not_null<std::unique_ptr<Polynomial<Displacement<Frame>, Instant>>>
-      polynomial = make_not_null_unique<P>(coefficients, Instant());
-  FillNewhallApproximationInMonomialBasis(degree,
-                                          q, v,
-                                          t_min, t_max,
-                                          error_estimate,
-                                          polynomial);
-  return polynomial;
+  RecordNewhallApproximationDegree(degree);
+  return make_not_null_unique<P>(coefficients, Instant());
+}
+
+template<typename Frame>
+Displacement<Frame>
+TestableContinuousTrajectory<Frame>::NewhallApproximationErrorEstimate(
+    int degree,
+    std::vector<Displacement<Frame>> const& q,
+    std::vector<Velocity<Frame>> const& v,
+    Instant const& t_min,
+    Instant const& t_max) const {
+  Displacement<Frame> error_estimate;
+  FillNewhallApproximationErrorEstimate(degree,
+                                        q, v,
+                                        t_min, t_max,
+                                        error_estimate);
+  return error_estimate;
 }
 
 template<typename Frame>
@@ -128,7 +152,10 @@ TestableContinuousTrajectory<Frame>::LockAndComputeBestNewhallApproximation(
     std::vector<Displacement<Frame>> const& q,
     std::vector<Velocity<Frame>> const& v) {
   absl::MutexLock l(&this->lock_);
-  return this->ComputeBestNewhallApproximation(time, q, v);
+  absl::MutexLock fitting_lock(&this->fitting_lock_);
+  std::unique_ptr<Polynomial<Displacement<Frame>, Instant>> polynomial;
+  return this->ComputeBestNewhallApproximation(
+      this->last_points_.cbegin()->first, time, q, v, polynomial);
 }
 
 template<typename Frame>
@@ -196,21 +223,22 @@ TEST_F(ContinuousTrajectoryTest, BestNewhallApproximation) {
   {
     Sequence s;
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(3, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(3, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({3 * Metre, 4 * Metre, 5 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(4, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(4, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({2 * Metre, 1 * Metre, 2 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(5, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(5, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({0.1 * Metre, 2 * Metre, 0 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(6, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(6, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({0.5 * Metre, 0.5 * Metre, 0.1 * Metre})));
+    EXPECT_CALL(*trajectory, RecordNewhallApproximationDegree(6));
     t += step;
     trajectory->LockAndComputeBestNewhallApproximation(t, q, v);
     EXPECT_EQ(6, trajectory->degree());
@@ -224,21 +252,23 @@ TEST_F(ContinuousTrajectoryTest, BestNewhallApproximation) {
   {
     Sequence s;
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(3, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(3, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({3 * Metre, 4 * Metre, 5 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(4, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(4, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({2 * Metre, 1 * Metre, 2 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(5, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(5, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({0.1 * Metre, 2 * Metre, 0 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(6, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(6, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({1 * Metre, 3 * Metre, 1 * Metre})));
+    // The approximation uses the last degree tried, not the reverted one.
+    EXPECT_CALL(*trajectory, RecordNewhallApproximationDegree(6));
     t += step;
     trajectory->LockAndComputeBestNewhallApproximation(t, q, v);
     EXPECT_EQ(5, trajectory->degree());
@@ -250,9 +280,10 @@ TEST_F(ContinuousTrajectoryTest, BestNewhallApproximation) {
   {
     Sequence s;
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(5, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(5, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({0.1 * Metre, 1.5 * Metre, 0 * Metre})));
+    EXPECT_CALL(*trajectory, RecordNewhallApproximationDegree(5));
     t += step;
     trajectory->LockAndComputeBestNewhallApproximation(t, q, v);
     EXPECT_EQ(5, trajectory->degree());
@@ -264,31 +295,33 @@ TEST_F(ContinuousTrajectoryTest, BestNewhallApproximation) {
   {
     Sequence s;
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(5, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(5, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({0.1 * Metre, 2 * Metre, 0.5 * Metre})))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({1 * Metre, 2 * Metre, 1 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(3, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(3, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({3 * Metre, 4 * Metre, 5 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(4, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(4, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({2 * Metre, 1 * Metre, 2 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(6, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(6, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({1 * Metre, 1.5 * Metre, 1 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(7, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(7, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({1 * Metre, 1.2 * Metre, 1 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(8, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(8, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({1 * Metre, 1.3 * Metre, 1 * Metre})));
+    // The approximation uses the last degree tried, not the reverted one.
+    EXPECT_CALL(*trajectory, RecordNewhallApproximationDegree(8));
     t += step;
     trajectory->LockAndComputeBestNewhallApproximation(t, q, v);
     EXPECT_EQ(7, trajectory->degree());
@@ -300,17 +333,18 @@ TEST_F(ContinuousTrajectoryTest, BestNewhallApproximation) {
   {
     Sequence s;
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(7, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(7, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({1 * Metre, 1.3 * Metre, 1 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(3, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(3, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({3 * Metre, 4 * Metre, 5 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(4, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(4, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({0.1 * Metre, 0.5 * Metre, 0.2 * Metre})));
+    EXPECT_CALL(*trajectory, RecordNewhallApproximationDegree(4));
     t += step;
     trajectory->LockAndComputeBestNewhallApproximation(t, q, v);
     EXPECT_EQ(4, trajectory->degree());
@@ -325,21 +359,22 @@ TEST_F(ContinuousTrajectoryTest, BestNewhallApproximation) {
   {
     Sequence s;
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(3, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(3, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({3 * Metre, 3 * Metre, 3 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(4, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(4, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({2 * Metre, 2 * Metre, 2 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(5, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(5, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({1 * Metre, 1 * Metre, 1 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(6, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(6, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({0.1 * Metre, 0.1 * Metre, 0.1 * Metre})));
+    EXPECT_CALL(*trajectory, RecordNewhallApproximationDegree(6));
     t += step;
     trajectory->LockAndComputeBestNewhallApproximation(t, q, v);
     EXPECT_EQ(6, trajectory->degree());
@@ -351,10 +386,11 @@ TEST_F(ContinuousTrajectoryTest, BestNewhallApproximation) {
   {
     Sequence s;
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(6, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(6, _, _, _, _, _))
         .Times(99)
         .WillRepeatedly(SetArgReferee<5>(
             Displacement<World>({0.1 * Metre, 0.1 * Metre, 0.1 * Metre})));
+    EXPECT_CALL(*trajectory, RecordNewhallApproximationDegree(6)).Times(99);
     for (int i = 0; i < 99; ++i) {
       t += step;
       trajectory->LockAndComputeBestNewhallApproximation(t, q, v);
@@ -368,17 +404,18 @@ TEST_F(ContinuousTrajectoryTest, BestNewhallApproximation) {
   {
     Sequence s;
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(3, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(3, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({3 * Metre, 3 * Metre, 3 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(4, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(4, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({2 * Metre, 2 * Metre, 2 * Metre})));
     EXPECT_CALL(*trajectory,
-                FillNewhallApproximationInMonomialBasis(5, _, _, _, _, _, _))
+                FillNewhallApproximationErrorEstimate(5, _, _, _, _, _))
         .WillOnce(SetArgReferee<5>(
             Displacement<World>({0.2 * Metre, 0.2 * Metre, 0.2 * Metre})));
+    EXPECT_CALL(*trajectory, RecordNewhallApproximationDegree(5));
     t += step;
     trajectory->LockAndComputeBestNewhallApproximation(t, q, v);
     EXPECT_EQ(5, trajectory->degree());
@@ -611,6 +648,114 @@ TEST_F(ContinuousTrajectoryTest, Continuity) {
   EXPECT_THAT(p1, AlmostEquals(p3, 0, 2));
 }
 
+TEST_F(ContinuousTrajectoryTest, AsynchronousFitting) {
+  int const number_of_steps = 1000;
+  Length const distance = 1 * Kilo(Metre);
+  Time const period = 100 * Second;
+  Time const step = 0.1 * Second;
+
+  auto position_function = [this, distance, period](Instant const t) {
+    Angle const angle = 2 * π * Radian * (t - t0_) / period;
+    return World::origin +
+        Displacement<World>({
+            distance * Cos(angle),
+            distance * Sin(angle),
+            0 * Metre});
+  };
+  auto velocity_function = [this, distance, period](Instant const t) {
+    AngularFrequency const ω = 2 * π * Radian / period;
+    Angle const angle = ω * (t - t0_);
+    return Velocity<World>({
+        -ω * distance * Sin(angle) / Radian,
+        ω * distance * Cos(angle) / Radian,
+        0 * Metre / Second});
+  };
+
+  ThreadPool<void> pool(/*pool_size=*/2);
+  ContinuousTrajectory<World> synchronous_trajectory(
+      step, /*tolerance=*/1 * Milli(Metre));
+  std::vector<std::unique_ptr<ContinuousTrajectory<World>>> trajectories;
+  for (int i = 0; i < 3; ++i) {
+    trajectories.push_back(std::make_unique<ContinuousTrajectory<World>>(
+        step, /*tolerance=*/1 * Milli(Metre)));
+    trajectories.back()->SetFittingPool(&pool);
+  }
+
+  FillTrajectory(number_of_steps,
+                 step,
+                 position_function,
+                 velocity_function,
+                 t0_,
+                 synchronous_trajectory);
+  for (auto const& trajectory : trajectories) {
+    FillTrajectory(number_of_steps,
+                   step,
+                   position_function,
+                   velocity_function,
+                   t0_,
+                   *trajectory);
+  }
+
+  // The fits are sequential for each trajectory, so they produce exactly the
+  // same polynomials as the synchronous ones.
+  for (auto const& trajectory : trajectories) {
+    EXPECT_OK(trajectory->WaitForFits());
+    EXPECT_EQ(synchronous_trajectory.t_min(), trajectory->t_min());
+    EXPECT_EQ(synchronous_trajectory.t_max(), trajectory->t_max());
+    EXPECT_EQ(synchronous_trajectory.average_degree(),
+              trajectory->average_degree());
+    for (Instant t = trajectory->t_min();
+         t <= trajectory->t_max();
+         t += step / 3) {
+      EXPECT_EQ(synchronous_trajectory.EvaluateDegreesOfFreedom(t),
+                trajectory->EvaluateDegreesOfFreedom(t));
+    }
+  }
+}
+
+TEST_F(ContinuousTrajectoryTest, CheckpointWithPendingFits) {
+  int const number_of_steps = 1000;
+  Time const step = 0.1 * Second;
+  auto position_function = [this](Instant const t) {
+    return World::origin +
+        Displacement<World>({(t - t0_) * 3 * Metre / Second,
+                             (t - t0_) * 5 * Metre / Second,
+                             (t - t0_) * (-2) * Metre / Second});
+  };
+  auto velocity_function = [](Instant const t) {
+    return Velocity<World>({3 * Metre / Second,
+                            5 * Metre / Second,
+                            -2 * Metre / Second});
+  };
+
+  ThreadPool<void> pool(/*pool_size=*/1);
+  ContinuousTrajectory<World> synchronous_trajectory(
+      step, /*tolerance=*/1 * Milli(Metre));
+  ContinuousTrajectory<World> asynchronous_trajectory(
+      step, /*tolerance=*/1 * Milli(Metre));
+  asynchronous_trajectory.SetFittingPool(&pool);
+  Instant const t_last = t0_ + number_of_steps * step;
+  for (auto* const trajectory :
+       {&synchronous_trajectory, &asynchronous_trajectory}) {
+    FillTrajectory(number_of_steps,
+                   step,
+                   position_function,
+                   velocity_function,
+                   t0_,
+                   *trajectory);
+    // The checkpoint of the asynchronous trajectory is created while fits may
+    // be pending.
+    trajectory->checkpointer().CreateUnconditionally(t_last);
+  }
+
+  serialization::ContinuousTrajectory synchronous_message;
+  synchronous_trajectory.WriteToMessage(&synchronous_message);
+  serialization::ContinuousTrajectory asynchronous_message;
+  asynchronous_trajectory.WriteToMessage(&asynchronous_message);
+  EXPECT_THAT(asynchronous_message, EqualsProto(synchronous_message));
+  EXPECT_OK(asynchronous_trajectory.WaitForFits());
+}
+
 TEST_F(ContinuousTrajectoryTest, Serialization) {
   int const number_of_steps = 20;
   int const number_of_substeps = 50;
@@ -657,7 +802,7 @@ TEST_F(ContinuousTrajectoryTest, Serialization) {
     EXPECT_TRUE(message.has_first_time());
 
     auto const trajectory_read =
-        ContinuousTrajectory<World>::ReadFromMessage(message);
+        ContinuousTrajectory<World>::ReadFromMessage(message).ValueOrDie();
     EXPECT_EQ(trajectory->t_min(), trajectory_read->t_min());
     EXPECT_EQ(trajectory->t_max(), trajectory_read->t_max());
     for (Instant time = trajectory->t_min();
@@ -690,7 +835,7 @@ TEST_F(ContinuousTrajectoryTest, Serialization) {
     EXPECT_EQ(4, message.last_point_size());
 
     auto const trajectory_read =
-        ContinuousTrajectory<World>::ReadFromMessage(message);
+        ContinuousTrajectory<World>::ReadFromMessage(message).ValueOrDie();
     EXPECT_EQ(trajectory->t_min(), trajectory_read->t_min());
     EXPECT_EQ(trajectory->t_max(), trajectory_read->t_max());
     for (Instant time = trajectory->t_min();
@@ -706,6 +851,100 @@ TEST_F(ContinuousTrajectoryTest, Serialization) {
   }
 }
 
+TEST_F(ContinuousTrajectoryTest, BlockStore) {
+  int const number_of_steps = 5000;
+  Time const step = 0.01 * Second;
+  Length const tolerance = 0.1 * Metre;
+
+  auto position_function =
+      [this](Instant const t) {
+        return World::origin +
+            Displacement<World>({(t - t0_) * 3 * Metre / Second,
+                                 (t - t0_) * 5 * Metre / Second,
+                                 (t - t0_) * (-2) * Metre / Second});
+      };
+  auto velocity_function =
+      [](Instant const t) {
+        return Velocity<World>({3 * Metre / Second,
+                                5 * Metre / Second,
+                                -2 * Metre / Second});
+      };
+
+  auto const trajectory = std::make_unique<ContinuousTrajectory<World>>(
+                              step, tolerance);
+  FillTrajectory(number_of_steps,
+                 step,
+                 position_function,
+                 velocity_function,
+                 t0_,
+                 *trajectory);
+  trajectory->checkpointer().CreateUnconditionally(trajectory->t_max());
+
+  std::filesystem::path const directory =
+      TEMP_DIR / "continuous_trajectory_test_blocks";
+  std::filesystem::remove_all(directory);
+  Flags::Set("block_store", directory.string());
+
+  // The complete blocks of polynomials go to the store, one file per block.
+  serialization::ContinuousTrajectory message;
+  trajectory->WriteToMessage(&message);
+  EXPECT_LT(1, message.block_of_polynomials_size());
+  EXPECT_EQ(message.block_of_polynomials_size(),
+            std::distance(std::filesystem::directory_iterator(directory),
+                          std::filesystem::directory_iterator()));
+
+  auto const trajectory_read =
+      ContinuousTrajectory<World>::ReadFromMessage(message).ValueOrDie();
+  EXPECT_EQ(trajectory->t_min(), trajectory_read->t_min());
+  EXPECT_EQ(trajectory->t_max(), trajectory_read->t_max());
+  for (Instant time = trajectory->t_min();
+       time <= trajectory->t_max();
+       time += step) {
+    EXPECT_EQ(trajectory->EvaluateDegreesOfFreedom(time),
+              trajectory_read->EvaluateDegreesOfFreedom(time));
+  }
+  serialization::ContinuousTrajectory second_message;
+  trajectory_read->WriteToMessage(&second_message);
+  EXPECT_THAT(message, EqualsProto(second_message));
+
+  // Forgetting the first polynomials only changes the first block.
+  trajectory->ForgetBefore(t0_ + number_of_steps / 2 * step);
+  serialization::ContinuousTrajectory forgotten_message;
+  trajectory->WriteToMessage(&forgotten_message);
+  int const forgotten_blocks = message.block_of_polynomials_size() -
+                               forgotten_message.block_of_polynomials_size();
+  EXPECT_LT(0, forgotten_blocks);
+  for (int i = 1; i < forgotten_message.block_of_polynomials_size(); ++i) {
+    EXPECT_EQ(message.block_of_polynomials(i + forgotten_blocks),
+              forgotten_message.block_of_polynomials(i));
+  }
+  EXPECT_EQ(message.instant_polynomial_pair_size(),
+            forgotten_message.instant_polynomial_pair_size());
+
+  // The blocks deleted from the store are written again by the next save,
+  // even though their fingerprints are known.
+  std::filesystem::remove_all(directory);
+  serialization::ContinuousTrajectory rewritten_message;
+  trajectory->WriteToMessage(&rewritten_message);
+  EXPECT_THAT(rewritten_message, EqualsProto(forgotten_message));
+  EXPECT_EQ(rewritten_message.block_of_polynomials_size(),
+            std::distance(std::filesystem::directory_iterator(directory),
+                          std::filesystem::directory_iterator()));
+
+  // Reading fails if a block is missing or if there is no store.
+  std::filesystem::remove(
+      std::filesystem::directory_iterator(directory)->path());
+  EXPECT_EQ(Error::NOT_FOUND,
+            ContinuousTrajectory<World>::ReadFromMessage(rewritten_message)
+                .status().error());
+  Flags::Clear();
+  EXPECT_EQ(Error::FAILED_PRECONDITION,
+            ContinuousTrajectory<World>::ReadFromMessage(rewritten_message)
+                .status().error());
+
+  std::filesystem::remove_all(directory);
+}
+
 TEST_F(ContinuousTrajectoryTest, PreCohenCompatibility) {
   Time const step = 0.01 * Second;
   Length const tolerance = 0.1 * Metre;
@@ -737,7 +976,7 @@ TEST_F(ContinuousTrajectoryTest, PreCohenCompatibility) {
   // that it has the form:
   //   -2 - 14 * t + 6 * t^2 + 16 * t^3.
   auto const trajectory_read =
-      ContinuousTrajectory<World>::ReadFromMessage(message);
+      ContinuousTrajectory<World>::ReadFromMessage(message).ValueOrDie();
   serialization::ContinuousTrajectory message2;
   trajectory_read->WriteToMessage(&message2);
   EXPECT_EQ(1, message2.instant_polynomial_pair_size());
@@ -815,7 +1054,7 @@ TEST_F(ContinuousTrajectoryTest, Checkpoint) {
   EXPECT_EQ(6, message.last_point_size());
 
   auto const trajectory_read =
-      ContinuousTrajectory<World>::ReadFromMessage(message);
+      ContinuousTrajectory<World>::ReadFromMessage(message).ValueOrDie();
   EXPECT_EQ(trajectory_read->t_min(), trajectory->t_min());
   EXPECT_EQ(trajectory_read->t_max(), checkpoint_time);
   for (Instant time = trajectory->t_min();
@@ -2,10 +2,13 @@
 #pragma once
 
 #include <functional>
+#include <iterator>
 #include <list>
 #include <map>
 #include <memory>
 #include <optional>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
 #include "base/not_constructible.hpp"
@@ -13,6 +16,7 @@
 #include "geometry/grassmann.hpp"
 #include "geometry/named_quantities.hpp"
 #include "numerics/hermite3.hpp"
+#include "physics/compressed_timeline.hpp"
 #include "physics/degrees_of_freedom.hpp"
 #include "physics/forkable.hpp"
 #include "physics/trajectory.hpp"
@@ -31,10 +35,89 @@ namespace internal_forkable {
 
 using base::not_constructible;
 
+// An iterator over the timeline of a |DiscreteTrajectory|, which is made of a
+// compressed cold part followed by a hot part held in a |std::map|.  An
+// iterator in the cold part keeps alive the decompressed block that it
+// designates.
+template<typename Frame>
+class DiscreteTrajectoryTimelineIterator {
+ public:
+  using ColdTimeline = CompressedTimeline<Frame>;
+  using HotTimeline = std::map<Instant, DegreesOfFreedom<Frame>>;
+
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = typename HotTimeline::value_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = value_type const*;
+  using reference = value_type const&;
+
+  DiscreteTrajectoryTimelineIterator() = default;
+  // An iterator in the hot part.
+  DiscreteTrajectoryTimelineIterator(
+      not_null<ColdTimeline const*> cold,
+      not_null<HotTimeline const*> hot,
+      typename HotTimeline::const_iterator hot_iterator);
+  // An iterator to the point at |index| in the given cold |block|.
+  DiscreteTrajectoryTimelineIterator(not_null<ColdTimeline const*> cold,
+                                     not_null<HotTimeline const*> hot,
+                                     std::int64_t block,
+                                     std::int64_t index);
+
+  reference operator*() const;
+  pointer operator->() const;
+
+  DiscreteTrajectoryTimelineIterator& operator++();
+  DiscreteTrajectoryTimelineIterator& operator--();
+
+  bool operator==(DiscreteTrajectoryTimelineIterator const& right) const;
+  bool operator!=(DiscreteTrajectoryTimelineIterator const& right) const;
+
+  // The decompressed block that holds the designated point if this iterator is
+  // in the cold part, null otherwise.
+  std::shared_ptr<typename ColdTimeline::Block const> const& points() const;
+
+ private:
+  ColdTimeline const* cold_ = nullptr;
+  HotTimeline const* hot_ = nullptr;
+  // The decompressed points of |block_| if this iterator is in the cold part,
+  // null otherwise.
+  std::shared_ptr<typename ColdTimeline::Block const> points_;
+  std::int64_t block_ = 0;
+  std::int64_t index_ = 0;
+  typename HotTimeline::const_iterator hot_iterator_;
+};
+
+// A point designated by an iterator in a |DiscreteTrajectory|.  Its members
+// refer to the storage of the point: either a node of the hot timeline, which
+// remains valid until the point is forgotten, or a decompressed block of the
+// cold timeline, which remains valid as long as this object or an iterator to
+// the block exists.  Thus, a reference bound to |it->degrees_of_freedom| may be
+// used as long as |it| designates the point, but one bound to
+// |trajectory.front().degrees_of_freedom| must not outlive the
+// full-expression.  Supports structured bindings.
+template<typename Frame>
+class DiscreteTrajectoryPoint {
+ public:
+  DiscreteTrajectoryPoint(
+      Instant const& time,
+      DegreesOfFreedom<Frame> const& degrees_of_freedom,
+      std::shared_ptr<typename CompressedTimeline<Frame>::Block const> block);
+
+  template<std::size_t i>
+  auto const& get() const;
+
+  Instant const& time;
+  DegreesOfFreedom<Frame> const& degrees_of_freedom;
+
+ private:
+  // The cold block that holds the point, null for a point of the hot timeline.
+  std::shared_ptr<typename CompressedTimeline<Frame>::Block const> block_;
+};
+
 template<typename Frame>
 struct DiscreteTrajectoryTraits : not_constructible {
   using Timeline = typename std::map<Instant, DegreesOfFreedom<Frame>>;
-  using TimelineConstIterator = typename Timeline::const_iterator;
+  using TimelineConstIterator = DiscreteTrajectoryTimelineIterator<Frame>;
 
   static Instant const& time(TimelineConstIterator it);
 };
@@ -45,10 +128,7 @@ class DiscreteTrajectoryIterator
                               DiscreteTrajectoryIterator<Frame>,
                               DiscreteTrajectoryTraits<Frame>> {
  public:
-  struct reference {
-    Instant const& time;
-    DegreesOfFreedom<Frame> const& degrees_of_freedom;
-  };
+  using reference = DiscreteTrajectoryPoint<Frame>;
 
   reference operator*() const;
   std::optional<reference> operator->() const;
@@ -137,6 +217,9 @@ class DiscreteTrajectory : public Forkable<DiscreteTrajectory<Frame>,
   // when |Append|ing, ensuring that |EvaluatePosition| returns a result within
   // |tolerance| of the missing points.  |max_dense_intervals| is the largest
   // number of points that can be added before removal is considered.
+  // The points that precede the dense part of the timeline are eventually
+  // moved to a compressed cold timeline, with positions approximated to
+  // |tolerance|.  They are decompressed when iterated upon.
   void SetDownsampling(std::int64_t max_dense_intervals,
                        Length const& tolerance);
 
@@ -193,20 +276,26 @@ class DiscreteTrajectory : public Forkable<DiscreteTrajectory<Frame>,
 
  private:
   using Timeline = typename DiscreteTrajectoryTraits<Frame>::Timeline;
+  using HotTimelineConstIterator = typename Timeline::const_iterator;
+
+  // The number of points in a block of the |cold_timeline_|.
+  static constexpr std::int64_t points_per_cold_block = 256;
+  // The number of points in a serialized block of the hot |timeline_|.
+  static constexpr std::int64_t points_per_serialized_block = 1024;
 
   class Downsampling {
    public:
     Downsampling(std::int64_t max_dense_intervals,
                  Length tolerance,
-                 TimelineConstIterator start_of_dense_timeline,
+                 HotTimelineConstIterator start_of_dense_timeline,
                  Timeline const& timeline);
 
-    TimelineConstIterator start_of_dense_timeline() const;
+    HotTimelineConstIterator start_of_dense_timeline() const;
     // |start_of_dense_timeline()->first|, for readability.
     Instant const& first_dense_time() const;
     // Keeps |dense_intervals_| consistent with the new
     // |start_of_dense_timeline_|.
-    void SetStartOfDenseTimeline(TimelineConstIterator value,
+    void SetStartOfDenseTimeline(HotTimelineConstIterator value,
                                  Timeline const& timeline);
 
     // Sets |dense_intervals_| to
@@ -239,7 +328,7 @@ class DiscreteTrajectory : public Forkable<DiscreteTrajectory<Frame>,
     // An iterator to the first point of the timeline which is not the left
     // endpoint of a downsampled interval.  Not |timeline_.end()| if the
     // timeline is nonempty.
-    TimelineConstIterator start_of_dense_timeline_;
+    HotTimelineConstIterator start_of_dense_timeline_;
     // |std::distance(start_of_dense_timeline, timeline_.cend()) - 1|.  Kept as
     // an optimization for |Append| as it can be maintained by incrementing,
     // whereas |std::distance| is linear in the value of the result.
@@ -255,6 +344,17 @@ class DiscreteTrajectory : public Forkable<DiscreteTrajectory<Frame>,
       serialization::DiscreteTrajectory const& message,
       std::vector<DiscreteTrajectory<Frame>**> const& forks);
 
+  // Moves the oldest points of the |timeline_| to the |cold_timeline_|, by
+  // blocks of |points_per_cold_block|, as long as they precede the dense part
+  // of the timeline.  This trajectory must be downsampling.
+  void CompressColdPoints();
+
+  // Returns an iterator to the |index|th point of the given cold |block|.
+  TimelineConstIterator MakeColdIterator(std::int64_t block,
+                                         std::int64_t index) const;
+  // Returns an iterator corresponding to an iterator in the |timeline_|.
+  TimelineConstIterator MakeHotIterator(HotTimelineConstIterator it) const;
+
   // Returns the Hermite interpolation for the left-open, right-closed
   // trajectory segment containing the given |time|, or, if |time| is |t_min()|,
   // returns a first-degree polynomial which should be evaluated only at
@@ -262,6 +362,10 @@ class DiscreteTrajectory : public Forkable<DiscreteTrajectory<Frame>,
   Hermite3<Instant, Position<Frame>> GetInterpolation(
       Instant const& time) const;
 
+  // The points that are older than the |timeline_|.  Only ever nonempty for a
+  // downsampled root, in which case |timeline_| is not empty either.
+  CompressedTimeline<Frame> cold_timeline_;
+  // The hot part of the timeline.
   Timeline timeline_;
 
   std::optional<Downsampling> downsampling_;
@@ -283,4 +387,20 @@ using internal_discrete_trajectory::DiscreteTrajectory;
 }  // namespace physics
 }  // namespace principia
 
+// The tuple protocol of |DiscreteTrajectoryPoint|, for structured bindings.
+template<typename Frame>
+struct std::tuple_size<
+    principia::physics::internal_forkable::DiscreteTrajectoryPoint<Frame>>
+    : std::integral_constant<std::size_t, 2> {};
+
+template<std::size_t i, typename Frame>
+struct std::tuple_element<
+    i,
+    principia::physics::internal_forkable::DiscreteTrajectoryPoint<Frame>> {
+  using type = std::conditional_t<
+      i == 0,
+      principia::geometry::Instant const&,
+      principia::physics::DegreesOfFreedom<Frame> const&>;
+};
+
 #include "physics/discrete_trajectory_body.hpp"
@@ -4,9 +4,12 @@
 #include "physics/discrete_trajectory.hpp"
 
 #include <algorithm>
+#include <iterator>
 #include <list>
 #include <map>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "astronomy/epoch.hpp"
@@ -25,6 +28,125 @@ namespace internal_forkable {
 
 using geometry::Instant;
 
+template<typename Frame>
+DiscreteTrajectoryTimelineIterator<Frame>::DiscreteTrajectoryTimelineIterator(
+    not_null<ColdTimeline const*> const cold,
+    not_null<HotTimeline const*> const hot,
+    typename HotTimeline::const_iterator const hot_iterator)
+    : cold_(cold),
+      hot_(hot),
+      hot_iterator_(hot_iterator) {}
+
+template<typename Frame>
+DiscreteTrajectoryTimelineIterator<Frame>::DiscreteTrajectoryTimelineIterator(
+    not_null<ColdTimeline const*> const cold,
+    not_null<HotTimeline const*> const hot,
+    std::int64_t const block,
+    std::int64_t const index)
+    : cold_(cold),
+      hot_(hot),
+      points_(cold->Decompress(block)),
+      block_(block),
+      index_(index) {}
+
+template<typename Frame>
+typename DiscreteTrajectoryTimelineIterator<Frame>::reference
+DiscreteTrajectoryTimelineIterator<Frame>::operator*() const {
+  return points_ == nullptr ? *hot_iterator_ : (*points_)[index_];
+}
+
+template<typename Frame>
+typename DiscreteTrajectoryTimelineIterator<Frame>::pointer
+DiscreteTrajectoryTimelineIterator<Frame>::operator->() const {
+  return &**this;
+}
+
+template<typename Frame>
+DiscreteTrajectoryTimelineIterator<Frame>&
+DiscreteTrajectoryTimelineIterator<Frame>::operator++() {
+  if (points_ == nullptr) {
+    ++hot_iterator_;
+  } else if (++index_ == points_->size()) {
+    // Move to the next block, or to the hot part.
+    if (++block_ == cold_->end_block()) {
+      points_.reset();
+      hot_iterator_ = hot_->begin();
+    } else {
+      points_ = cold_->Decompress(block_);
+      index_ = 0;
+    }
+  }
+  return *this;
+}
+
+template<typename Frame>
+DiscreteTrajectoryTimelineIterator<Frame>&
+DiscreteTrajectoryTimelineIterator<Frame>::operator--() {
+  if (points_ == nullptr) {
+    if (hot_iterator_ == hot_->begin() && !cold_->empty()) {
+      // Move to the last point of the cold part.
+      block_ = cold_->end_block() - 1;
+      points_ = cold_->Decompress(block_);
+      index_ = points_->size() - 1;
+    } else {
+      --hot_iterator_;
+    }
+  } else if (index_ == cold_->first_index(block_)) {
+    // Move to the previous block.
+    points_ = cold_->Decompress(--block_);
+    index_ = points_->size() - 1;
+  } else {
+    --index_;
+  }
+  return *this;
+}
+
+template<typename Frame>
+bool DiscreteTrajectoryTimelineIterator<Frame>::operator==(
+    DiscreteTrajectoryTimelineIterator const& right) const {
+  if (points_ == nullptr) {
+    return right.points_ == nullptr && hot_iterator_ == right.hot_iterator_;
+  } else {
+    return right.points_ != nullptr &&
+           block_ == right.block_ &&
+           index_ == right.index_;
+  }
+}
+
+template<typename Frame>
+bool DiscreteTrajectoryTimelineIterator<Frame>::operator!=(
+    DiscreteTrajectoryTimelineIterator const& right) const {
+  return !(*this == right);
+}
+
+template<typename Frame>
+std::shared_ptr<
+    typename DiscreteTrajectoryTimelineIterator<Frame>::ColdTimeline::Block
+        const> const&
+DiscreteTrajectoryTimelineIterator<Frame>::points() const {
+  return points_;
+}
+
+template<typename Frame>
+DiscreteTrajectoryPoint<Frame>::DiscreteTrajectoryPoint(
+    Instant const& time,
+    DegreesOfFreedom<Frame> const& degrees_of_freedom,
+    std::shared_ptr<typename CompressedTimeline<Frame>::Block const> block)
+    : time(time),
+      degrees_of_freedom(degrees_of_freedom),
+      block_(std::move(block)) {}
+
+template<typename Frame>
+template<std::size_t i>
+auto const& DiscreteTrajectoryPoint<Frame>::get() const {
+  if constexpr (i == 0) {
+    return time;
+  } else {
+    static_assert(i == 1);
+    return degrees_of_freedom;
+  }
+}
+
 template<typename Frame>
 Instant const& DiscreteTrajectoryTraits<Frame>::time(
     TimelineConstIterator const it) {
@@ -35,14 +157,14 @@ template<typename Frame>
 typename DiscreteTrajectoryIterator<Frame>::reference
 DiscreteTrajectoryIterator<Frame>::operator*() const {
   auto const& it = this->current();
-  return {it->first, it->second};
+  return reference(it->first, it->second, it.points());
 }
 
 template<typename Frame>
 std::optional<typename DiscreteTrajectoryIterator<Frame>::reference>
     DiscreteTrajectoryIterator<Frame>::operator->() const {
   auto const& it = this->current();
-  return std::make_optional<reference>({it->first, it->second});
+  return std::make_optional<reference>(it->first, it->second, it.points());
 }
 
 template<typename Frame>
@@ -66,17 +188,13 @@ using astronomy::InfinitePast;
 using base::Flags;
 using base::make_not_null_unique;
 using base::ZfpCompressor;
-using geometry::Displacement;
 using numerics::FitHermiteSpline;
-using quantities::Time;
-using quantities::si::Metre;
-using quantities::si::Second;
 
 template<typename Frame>
 not_null<DiscreteTrajectory<Frame>*>
 DiscreteTrajectory<Frame>::NewForkWithCopy(Instant const& time) {
   // May be at |timeline_end()| if |time| is the fork time of this object.
-  auto timeline_it = timeline_.find(time);
+  auto timeline_it = timeline_find(time);
   CHECK(timeline_it != timeline_end() ||
         (!this->is_root() && time == this->Fork()->time))
       << "NewForkWithCopy at nonexistent time " << time;
@@ -84,8 +202,10 @@ DiscreteTrajectory<Frame>::NewForkWithCopy(Instant const& time) {
   auto const fork = this->NewFork(timeline_it);
 
   // Copy the tail of the trajectory in the child object.
-  if (timeline_it != timeline_.end()) {
-    fork->timeline_.insert(++timeline_it, timeline_.end());
+  if (timeline_it != timeline_end()) {
+    for (++timeline_it; timeline_it != timeline_end(); ++timeline_it) {
+      fork->timeline_.emplace_hint(fork->timeline_.end(), *timeline_it);
+    }
   }
   return fork;
 }
@@ -94,7 +214,7 @@ template<typename Frame>
 not_null<DiscreteTrajectory<Frame>*>
 DiscreteTrajectory<Frame>::NewForkWithoutCopy(Instant const& time) {
   // May be at |timeline_end()| if |time| is the fork time of this object.
-  auto timeline_it = timeline_.find(time);
+  auto timeline_it = timeline_find(time);
   CHECK(timeline_it != timeline_end() ||
         (!this->is_root() && time == this->Fork()->time))
       << "NewForkWithoutCopy at nonexistent time " << time;
@@ -105,8 +225,8 @@ DiscreteTrajectory<Frame>::NewForkWithoutCopy(Instant const& time) {
 template<typename Frame>
 not_null<DiscreteTrajectory<Frame>*>
 DiscreteTrajectory<Frame>::NewForkAtLast() {
-  auto end = timeline_.end();
-  if (timeline_.empty()) {
+  auto end = timeline_end();
+  if (timeline_empty()) {
     return this->NewFork(end);
   } else {
     return this->NewFork(--end);
@@ -117,6 +237,7 @@ template<typename Frame>
 void DiscreteTrajectory<Frame>::AttachFork(
     not_null<std::unique_ptr<DiscreteTrajectory<Frame>>> fork) {
   CHECK(fork->is_root());
+  CHECK(fork->cold_timeline_.empty());
   CHECK(!this->Empty());
 
   auto& fork_timeline = fork->timeline_;
@@ -203,10 +324,10 @@ void DiscreteTrajectory<Frame>::Append(
       this->CheckNoForksBefore(this->back().time);
       downsampling_->increment_dense_intervals(timeline_);
       if (downsampling_->reached_max_dense_intervals()) {
-        std::vector<TimelineConstIterator> dense_iterators;
+        std::vector<HotTimelineConstIterator> dense_iterators;
         // This contains points, hence one more than intervals.
         dense_iterators.reserve(downsampling_->max_dense_intervals() + 1);
-        for (TimelineConstIterator it =
+        for (HotTimelineConstIterator it =
                  downsampling_->start_of_dense_timeline();
              it != timeline_.end();
              ++it) {
@@ -221,13 +342,15 @@ void DiscreteTrajectory<Frame>::Append(
         if (right_endpoints.empty()) {
           right_endpoints.push_back(dense_iterators.end() - 1);
         }
-        TimelineConstIterator left = downsampling_->start_of_dense_timeline();
+        HotTimelineConstIterator left =
+            downsampling_->start_of_dense_timeline();
         for (const auto& it_in_dense_iterators : right_endpoints) {
-          TimelineConstIterator const right = *it_in_dense_iterators;
+          HotTimelineConstIterator const right = *it_in_dense_iterators;
           timeline_.erase(++left, right);
           left = right;
         }
         downsampling_->SetStartOfDenseTimeline(left, timeline_);
+        CompressColdPoints();
       }
     }
   }
@@ -237,6 +360,42 @@ template<typename Frame>
 void DiscreteTrajectory<Frame>::ForgetAfter(Instant const& time) {
   this->DeleteAllForksAfter(time);
 
+  if (!cold_timeline_.empty() && time <= cold_timeline_.t_max()) {
+    // All the hot points are removed, and the cold points that are kept in
+    // the last block become the new hot timeline.  If there are none, use the
+    // previous block so as to keep the hot timeline nonempty.  This is also
+    // done if |time| is the last cold time, as the hot timeline would
+    // otherwise become empty.
+    timeline_.clear();
+    std::int64_t block = cold_timeline_.FindBlock(time);
+    auto points = cold_timeline_.Decompress(block);
+    auto first = points->begin() + cold_timeline_.first_index(block);
+    auto last = std::upper_bound(
+        first,
+        points->end(),
+        time,
+        [](Instant const& time, auto const& point) {
+          return time < point.first;
+        });
+    if (first == last && block > cold_timeline_.begin_block()) {
+      points = cold_timeline_.Decompress(--block);
+      first = points->begin() + cold_timeline_.first_index(block);
+      last = points->end();
+    }
+    timeline_.insert(first, last);
+    cold_timeline_.ForgetBlocksFrom(block);
+    // The forks in the blocks that were moved must now designate their hot
+    // copies.
+    this->UpdateChildrenPositions();
+    if (downsampling_.has_value()) {
+      // Further points will be appended to the last remaining point, so this
+      // is where the dense timeline will begin.
+      downsampling_->SetStartOfDenseTimeline(
+          timeline_.empty() ? timeline_.end() : --timeline_.end(),
+          timeline_);
+    }
+  }
+
   // Get an iterator denoting the first entry with time > |time|.  Remove that
   // entry and all the entries that follow it.  This preserves any entry with
   // time == |time|.
@@ -272,6 +431,8 @@ template<typename Frame>
 void DiscreteTrajectory<Frame>::ForgetBefore(Instant const& time) {
   this->CheckNoForksBefore(time);
 
+  cold_timeline_.ForgetBefore(time);
+
   // Get an iterator denoting the first entry with time >= |time|.  Remove all
   // the entries that precede it.  This preserves any entry with time == |time|.
   auto const first_kept_in_timeline = timeline_.lower_bound(time);
@@ -296,6 +457,19 @@ void DiscreteTrajectory<Frame>::SetDownsampling(
 template<typename Frame>
 void DiscreteTrajectory<Frame>::ClearDownsampling() {
   downsampling_.reset();
+  // The cold points are only meaningful with downsampling, move them back to
+  // the hot timeline.
+  if (!cold_timeline_.empty()) {
+    for (std::int64_t block = cold_timeline_.begin_block();
+         block < cold_timeline_.end_block();
+         ++block) {
+      auto const points = cold_timeline_.Decompress(block);
+      timeline_.insert(points->begin() + cold_timeline_.first_index(block),
+                       points->end());
+    }
+    cold_timeline_.ForgetBlocksFrom(cold_timeline_.begin_block());
+    this->UpdateChildrenPositions();
+  }
 }
 
 template<typename Frame>
@@ -373,42 +547,65 @@ DiscreteTrajectory<Frame>::that() const {
 template<typename Frame>
 typename DiscreteTrajectory<Frame>::TimelineConstIterator
 DiscreteTrajectory<Frame>::timeline_begin() const {
-  return timeline_.begin();
+  if (cold_timeline_.empty()) {
+    return MakeHotIterator(timeline_.begin());
+  } else {
+    std::int64_t const block = cold_timeline_.begin_block();
+    return MakeColdIterator(block, cold_timeline_.first_index(block));
+  }
 }
 
 template<typename Frame>
 typename DiscreteTrajectory<Frame>::TimelineConstIterator
 DiscreteTrajectory<Frame>::timeline_end() const {
-  return timeline_.end();
+  return MakeHotIterator(timeline_.end());
 }
 
 template<typename Frame>
 typename DiscreteTrajectory<Frame>::TimelineConstIterator
 DiscreteTrajectory<Frame>::timeline_find(Instant const& time) const {
-  return timeline_.find(time);
+  auto const it = timeline_lower_bound(time);
+  if (it == timeline_end() || it->first != time) {
+    return timeline_end();
+  } else {
+    return it;
+  }
 }
 
 template<typename Frame>
 typename DiscreteTrajectory<Frame>::TimelineConstIterator
 DiscreteTrajectory<Frame>::timeline_lower_bound(Instant const& time) const {
-  return timeline_.lower_bound(time);
+  if (cold_timeline_.empty() || time > cold_timeline_.t_max()) {
+    return MakeHotIterator(timeline_.lower_bound(time));
+  } else {
+    std::int64_t const block = cold_timeline_.FindBlock(time);
+    auto const points = cold_timeline_.Decompress(block);
+    auto const it = std::lower_bound(
+        points->begin() + cold_timeline_.first_index(block),
+        points->end(),
+        time,
+        [](auto const& point, Instant const& time) {
+          return point.first < time;
+        });
+    return MakeColdIterator(block, it - points->begin());
+  }
 }
 
 template<typename Frame>
 bool DiscreteTrajectory<Frame>::timeline_empty() const {
-  return timeline_.empty();
+  return cold_timeline_.empty() && timeline_.empty();
 }
 
 template<typename Frame>
 std::int64_t DiscreteTrajectory<Frame>::timeline_size() const {
-  return timeline_.size();
+  return cold_timeline_.size() + timeline_.size();
 }
 
 template<typename Frame>
 DiscreteTrajectory<Frame>::Downsampling::Downsampling(
     std::int64_t const max_dense_intervals,
     Length const tolerance,
-    TimelineConstIterator const start_of_dense_timeline,
+    HotTimelineConstIterator const start_of_dense_timeline,
     Timeline const& timeline)
     : max_dense_intervals_(max_dense_intervals),
       tolerance_(tolerance),
@@ -417,7 +614,7 @@ DiscreteTrajectory<Frame>::Downsampling::Downsampling(
 }
 
 template<typename Frame>
-typename DiscreteTrajectory<Frame>::TimelineConstIterator
+typename DiscreteTrajectory<Frame>::HotTimelineConstIterator
 DiscreteTrajectory<Frame>::Downsampling::start_of_dense_timeline() const {
   return start_of_dense_timeline_;
 }
@@ -430,7 +627,7 @@ Instant const& DiscreteTrajectory<Frame>::Downsampling::first_dense_time()
 
 template<typename Frame>
 void DiscreteTrajectory<Frame>::Downsampling::SetStartOfDenseTimeline(
-    TimelineConstIterator const value,
+    HotTimelineConstIterator const value,
     Timeline const& timeline) {
   start_of_dense_timeline_ = value;
   RecountDenseIntervals(timeline);
@@ -487,7 +684,7 @@ typename DiscreteTrajectory<Frame>::Downsampling
 DiscreteTrajectory<Frame>::Downsampling::ReadFromMessage(
     serialization::DiscreteTrajectory::Downsampling const& message,
     Timeline const& timeline) {
-  TimelineConstIterator start_of_dense_timeline;
+  HotTimelineConstIterator start_of_dense_timeline;
   if (message.has_start_of_dense_timeline()) {
     start_of_dense_timeline = timeline.find(
         Instant::ReadFromMessage(message.start_of_dense_timeline()));
@@ -508,7 +705,8 @@ void DiscreteTrajectory<Frame>::WriteSubTreeToMessage(
   Forkable<DiscreteTrajectory, Iterator, DiscreteTrajectoryTraits<Frame>>::
       WriteSubTreeToMessage(message, forks);
   if (Flags::IsPresent("zfp", "off")) {
-    for (auto const& [instant, degrees_of_freedom] : timeline_) {
+    for (auto it = timeline_begin(); it != timeline_end(); ++it) {
+      auto const& [instant, degrees_of_freedom] = *it;
       auto const instantaneous_degrees_of_freedom = message->add_timeline();
       instant.WriteToMessage(
           instantaneous_degrees_of_freedom->mutable_instant());
@@ -516,66 +714,53 @@ void DiscreteTrajectory<Frame>::WriteSubTreeToMessage(
           instantaneous_degrees_of_freedom->mutable_degrees_of_freedom());
     }
   } else {
-    int const timeline_size = timeline_.size();
     auto* const zfp = message->mutable_zfp();
-    zfp->set_timeline_size(timeline_size);
-
-    // The timeline data is made dimensionless and stored in separate arrays per
-    // coordinate.  We expect strong correlations within a coordinate over time,
-    // but not between coordinates.
-    std::vector<double> t;
-    std::vector<double> qx;
-    std::vector<double> qy;
-    std::vector<double> qz;
-    std::vector<double> px;
-    std::vector<double> py;
-    std::vector<double> pz;
-    t.reserve(timeline_size);
-    qx.reserve(timeline_size);
-    qy.reserve(timeline_size);
-    qz.reserve(timeline_size);
-    px.reserve(timeline_size);
-    py.reserve(timeline_size);
-    pz.reserve(timeline_size);
-    std::optional<Instant> previous_instant;
-    Time max_Δt;
-    std::string* const zfp_timeline = zfp->mutable_timeline();
-    for (auto const& [instant, degrees_of_freedom] : timeline_) {
-      auto const q = degrees_of_freedom.position() - Frame::origin;
-      auto const p = degrees_of_freedom.velocity();
-      t.push_back((instant - Instant{}) / Second);
-      qx.push_back(q.coordinates().x / Metre);
-      qy.push_back(q.coordinates().y / Metre);
-      qz.push_back(q.coordinates().z / Metre);
-      px.push_back(p.coordinates().x / (Metre / Second));
-      py.push_back(p.coordinates().y / (Metre / Second));
-      pz.push_back(p.coordinates().z / (Metre / Second));
-      if (previous_instant.has_value()) {
-        max_Δt = std::max(max_Δt, instant - *previous_instant);
-      }
-      previous_instant = instant;
-    }
+    zfp->set_timeline_size(timeline_size());
 
-    // Times are exact.
-    ZfpCompressor time_compressor(0);
     // Lengths are approximated to the downsampling tolerance if downsampling is
     // enabled, otherwise they are exact.
     Length const length_tolerance =
         downsampling_.has_value() ? downsampling_->tolerance() : Length();
-    ZfpCompressor length_compressor(length_tolerance / Metre);
-    // Speeds are approximated based on the length tolerance and the maximum
-    // step in the timeline.
-    ZfpCompressor const speed_compressor((length_tolerance / max_Δt) /
-                                         (Metre / Second));
-
     ZfpCompressor::WriteVersion(message);
-    time_compressor.WriteToMessageMultidimensional<2>(t, zfp_timeline);
-    length_compressor.WriteToMessageMultidimensional<2>(qx, zfp_timeline);
-    length_compressor.WriteToMessageMultidimensional<2>(qy, zfp_timeline);
-    length_compressor.WriteToMessageMultidimensional<2>(qz, zfp_timeline);
-    speed_compressor.WriteToMessageMultidimensional<2>(px, zfp_timeline);
-    speed_compressor.WriteToMessageMultidimensional<2>(py, zfp_timeline);
-    speed_compressor.WriteToMessageMultidimensional<2>(pz, zfp_timeline);
+    if (timeline_empty()) {
+      CompressedTimeline<Frame>::CompressPoints(timeline_begin(),
+                                                timeline_end(),
+                                                length_tolerance,
+                                                zfp->mutable_timeline());
+    } else {
+      // The blocks of the cold timeline are copied without being
+      // decompressed, so that only the points added since the last
+      // compaction have to be compressed.  The whole history is still
+      // written, so the cost of a save remains proportional to its size.
+      // The last time of each block is written so that it can be read
+      // without being decompressed.
+      std::string& zfp_timeline = *zfp->mutable_timeline();
+      for (std::int64_t block = cold_timeline_.begin_block();
+           block < cold_timeline_.end_block();
+           ++block) {
+        auto* const block_message = zfp->add_block();
+        std::int64_t const zfp_size = zfp_timeline.size();
+        block_message->set_size(
+            cold_timeline_.WriteBlock(block, length_tolerance, &zfp_timeline));
+        block_message->set_zfp_size(zfp_timeline.size() - zfp_size);
+        cold_timeline_.last_time(block).WriteToMessage(
+            block_message->mutable_last_time());
+      }
+      // The points of the hot timeline are compressed in parallel, block by
+      // block, so that no copy of the whole timeline is made.
+      CompressedTimeline<Frame>::CompressChunks(
+          timeline_.begin(),
+          timeline_.end(),
+          points_per_serialized_block,
+          length_tolerance,
+          [zfp, &zfp_timeline](std::int64_t const size,
+                               std::string const& block_zfp) {
+            auto* const block_message = zfp->add_block();
+            block_message->set_size(size);
+            block_message->set_zfp_size(block_zfp.size());
+            zfp_timeline.append(block_zfp);
+          });
+    }
   }
 
   if (downsampling_.has_value()) {
@@ -599,45 +784,104 @@ void DiscreteTrajectory<Frame>::FillSubTreeFromMessage(
     CHECK_EQ(ZFP_VERSION, message.zfp().library_version());
 
     int const timeline_size = message.zfp().timeline_size();
-    std::vector<double> t(timeline_size);
-    std::vector<double> qx(timeline_size);
-    std::vector<double> qy(timeline_size);
-    std::vector<double> qz(timeline_size);
-    std::vector<double> px(timeline_size);
-    std::vector<double> py(timeline_size);
-    std::vector<double> pz(timeline_size);
     std::string_view zfp_timeline(message.zfp().timeline().data(),
                                   message.zfp().timeline().size());
 
-    ZfpCompressor decompressor;
     ZfpCompressor::ReadVersion(message);
-    decompressor.ReadFromMessageMultidimensional<2>(t, zfp_timeline);
-    decompressor.ReadFromMessageMultidimensional<2>(qx, zfp_timeline);
-    decompressor.ReadFromMessageMultidimensional<2>(qy, zfp_timeline);
-    decompressor.ReadFromMessageMultidimensional<2>(qz, zfp_timeline);
-    decompressor.ReadFromMessageMultidimensional<2>(px, zfp_timeline);
-    decompressor.ReadFromMessageMultidimensional<2>(py, zfp_timeline);
-    decompressor.ReadFromMessageMultidimensional<2>(pz, zfp_timeline);
-
-    for (int i = 0; i < timeline_size; ++i) {
-      Position<Frame> const q =
-          Frame::origin +
-          Displacement<Frame>({qx[i] * Metre, qy[i] * Metre, qz[i] * Metre});
-      Velocity<Frame> const p({px[i] * (Metre / Second),
-                               py[i] * (Metre / Second),
-                               pz[i] * (Metre / Second)});
-      Append(Instant() + t[i] * Second, DegreesOfFreedom<Frame>(q, p));
+    bool const is_pre_gallai = message.zfp().block().empty() &&
+                               message.zfp().block_point_count().empty();
+    if (is_pre_gallai) {
+      for (auto const& [time, degrees_of_freedom] :
+           CompressedTimeline<Frame>::DecompressPoints(timeline_size,
+                                                       zfp_timeline)) {
+        Append(time, degrees_of_freedom);
+      }
+    } else if (message.zfp().block().empty()) {
+      // The blocks don't record their size in bytes, so they must be
+      // decompressed in sequence.
+      std::int64_t size = 0;
+      for (std::int64_t const point_count :
+           message.zfp().block_point_count()) {
+        for (auto const& [time, degrees_of_freedom] :
+             CompressedTimeline<Frame>::DecompressPoints(point_count,
+                                                         zfp_timeline)) {
+          Append(time, degrees_of_freedom);
+        }
+        size += point_count;
+      }
+      CHECK_EQ(timeline_size, size);
+    } else {
+      // The blocks of the hot timeline, which are decompressed in parallel.
+      std::vector<std::pair<std::int64_t, std::string_view>> hot_blocks;
+      std::int64_t size = 0;
+      for (auto const& block : message.zfp().block()) {
+        std::string_view block_zfp = zfp_timeline.substr(0, block.zfp_size());
+        zfp_timeline.remove_prefix(block.zfp_size());
+        if (block.has_last_time() && message.has_downsampling()) {
+          // The cold blocks are only decompressed when they are accessed, so
+          // the cost of reading a long history is proportional to the part of
+          // it that is used.
+          CHECK(timeline_.empty());
+          CHECK(hot_blocks.empty());
+          cold_timeline_.AppendCompressed(
+              block_zfp,
+              block.size(),
+              Instant::ReadFromMessage(block.last_time()));
+        } else {
+          hot_blocks.emplace_back(block.size(), block_zfp);
+        }
+        size += block.size();
+      }
+      CHECK_EQ(timeline_size, size);
+      CompressedTimeline<Frame>::DecompressChunks(
+          hot_blocks,
+          [this](typename CompressedTimeline<Frame>::Block const& points) {
+            for (auto const& [time, degrees_of_freedom] : points) {
+              Append(time, degrees_of_freedom);
+            }
+          });
     }
   }
   if (message.has_downsampling()) {
     CHECK(this->is_root());
     downsampling_.emplace(
         Downsampling::ReadFromMessage(message.downsampling(), timeline_));
+    CompressColdPoints();
   }
   Forkable<DiscreteTrajectory, Iterator, DiscreteTrajectoryTraits<Frame>>::
       FillSubTreeFromMessage(message, forks);
 }
 
+template<typename Frame>
+void DiscreteTrajectory<Frame>::CompressColdPoints() {
+  if (Flags::IsPresent("zfp", "off")) {
+    return;
+  }
+  std::int64_t cold_points = std::distance(
+      timeline_.cbegin(), downsampling_->start_of_dense_timeline());
+  while (cold_points >= points_per_cold_block) {
+    auto const begin = timeline_.begin();
+    auto const end = std::next(begin, points_per_cold_block);
+    cold_timeline_.Append(begin, end, downsampling_->tolerance());
+    timeline_.erase(begin, end);
+    cold_points -= points_per_cold_block;
+  }
+}
+
+template<typename Frame>
+typename DiscreteTrajectory<Frame>::TimelineConstIterator
+DiscreteTrajectory<Frame>::MakeColdIterator(std::int64_t const block,
+                                            std::int64_t const index) const {
+  return TimelineConstIterator(&cold_timeline_, &timeline_, block, index);
+}
+
+template<typename Frame>
+typename DiscreteTrajectory<Frame>::TimelineConstIterator
+DiscreteTrajectory<Frame>::MakeHotIterator(
+    HotTimelineConstIterator const it) const {
+  return TimelineConstIterator(&cold_timeline_, &timeline_, it);
+}
+
 template<typename Frame>
 Hermite3<Instant, Position<Frame>> DiscreteTrajectory<Frame>::GetInterpolation(
     Instant const& time) const {
@@ -59,6 +59,7 @@ using ::std::placeholders::_3;
 using ::testing::Contains;
 using ::testing::Each;
 using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
 using ::testing::Eq;
 using ::testing::Gt;
 using ::testing::Le;
@@ -133,6 +134,16 @@ class DiscreteTrajectoryTest : public testing::Test {
     return result;
   }
 
+  // The sizes of the compressed blocks of the timeline of |message|.
+  static std::vector<std::int64_t> BlockSizes(
+      serialization::DiscreteTrajectory const& message) {
+    std::vector<std::int64_t> result;
+    for (auto const& block : message.zfp().block()) {
+      result.push_back(block.size());
+    }
+    return result;
+  }
+
   Position<World> q1_, q2_, q3_, q4_;
   Velocity<World> p1_, p2_, p3_, p4_;
   DegreesOfFreedom<World> d1_, d2_, d3_, d4_;
@@ -983,6 +994,250 @@ TEST_F(DiscreteTrajectoryTest, DownsamplingForgetAfter) {
   EXPECT_THAT(errors, Each(Eq(0 * Metre)));
 }
 
+TEST_F(DiscreteTrajectoryTest, DownsamplingColdTimeline) {
+  DiscreteTrajectory<World> circle;
+  DiscreteTrajectory<World> downsampled_circle;
+  downsampled_circle.SetDownsampling(/*max_dense_intervals=*/50,
+                                     /*tolerance=*/1 * Milli(Metre));
+  AngularFrequency const ω = 3 * Radian / Second;
+  Length const r = 2 * Metre;
+  Speed const v = ω * r / Radian;
+  for (auto t = DoublePrecision<Instant>(t0_);
+       t.value <= t0_ + 200 * Second;
+       t.Increment(10 * Milli(Second))) {
+    DegreesOfFreedom<World> const dof =
+        {World::origin + Displacement<World>{{r * Cos(ω * (t.value - t0_)),
+                                              r * Sin(ω * (t.value - t0_)),
+                                              0 * Metre}},
+         Velocity<World>{{-v * Sin(ω * (t.value - t0_)),
+                          v * Cos(ω * (t.value - t0_)),
+                          0 * Metre / Second}}};
+    circle.Append(t.value, dof);
+    downsampled_circle.Append(t.value, dof);
+  }
+
+  // The oldest points have been compressed, but iteration goes through them
+  // in both directions.
+  EXPECT_THAT(downsampled_circle.Size(), Eq(933));
+  std::vector<Instant> times;
+  for (auto const& [time, _] : downsampled_circle) {
+    times.push_back(time);
+  }
+  EXPECT_THAT(times.size(), Eq(933));
+  EXPECT_TRUE(std::is_sorted(times.begin(), times.end()));
+  EXPECT_THAT(times.front(), Eq(t0_));
+  auto it = downsampled_circle.end();
+  for (auto time = times.rbegin(); time != times.rend(); ++time) {
+    --it;
+    EXPECT_THAT(it->time, Eq(*time));
+  }
+  EXPECT_THAT(downsampled_circle.Find(times[100])->time, Eq(times[100]));
+  EXPECT_THAT(downsampled_circle.LowerBound(times[300] - 1 * Milli(Second))
+                  ->time,
+              Eq(times[300]));
+
+  std::vector<Length> errors;
+  for (auto const& [time, degrees_of_freedom] : circle) {
+    errors.push_back((downsampled_circle.EvaluatePosition(time) -
+                      degrees_of_freedom.position()).Norm());
+  }
+  EXPECT_THAT(errors, Each(Lt(3 * Milli(Metre))));
+
+  // Serialization goes through the cold points, which are written block by
+  // block, and read without being recompressed.
+  serialization::DiscreteTrajectory message;
+  downsampled_circle.WriteToMessage(&message, /*forks=*/{});
+  EXPECT_THAT(BlockSizes(message), ElementsAre(256, 256, 256, 165));
+  auto const deserialized_circle =
+      DiscreteTrajectory<World>::ReadFromMessage(message, /*forks=*/{});
+  EXPECT_THAT(deserialized_circle->Size(), Eq(933));
+  for (auto it1 = downsampled_circle.begin(),
+            it2 = deserialized_circle->begin();
+       it1 != downsampled_circle.end();
+       ++it1, ++it2) {
+    EXPECT_EQ(it1->time, it2->time);
+    if (it1->time <= times[767]) {
+      EXPECT_EQ(it1->degrees_of_freedom, it2->degrees_of_freedom);
+    }
+  }
+
+  // The blocks written by early Gallai builds only recorded their number of
+  // points.
+  serialization::DiscreteTrajectory legacy_message = message;
+  legacy_message.mutable_zfp()->clear_block();
+  for (auto const& block : message.zfp().block()) {
+    legacy_message.mutable_zfp()->add_block_point_count(block.size());
+  }
+  auto const legacy_circle =
+      DiscreteTrajectory<World>::ReadFromMessage(legacy_message, /*forks=*/{});
+  EXPECT_THAT(legacy_circle->Size(), Eq(933));
+  for (auto it1 = deserialized_circle->begin(), it2 = legacy_circle->begin();
+       it1 != deserialized_circle->end();
+       ++it1, ++it2) {
+    EXPECT_EQ(it1->time, it2->time);
+  }
+
+  // Forgetting may cut through the cold points.
+  downsampled_circle.ForgetBefore(times[100]);
+  EXPECT_THAT(downsampled_circle.Size(), Eq(833));
+  EXPECT_THAT(downsampled_circle.front().time, Eq(times[100]));
+  message.Clear();
+  downsampled_circle.WriteToMessage(&message, /*forks=*/{});
+  EXPECT_THAT(BlockSizes(message), ElementsAre(156, 256, 256, 165));
+  EXPECT_THAT(DiscreteTrajectory<World>::ReadFromMessage(message, /*forks=*/{})
+                  ->front().time,
+              Eq(times[100]));
+  downsampled_circle.ForgetAfter(times[600]);
+  EXPECT_THAT(downsampled_circle.Size(), Eq(501));
+  EXPECT_THAT(downsampled_circle.back().time, Eq(times[600]));
+  downsampled_circle.ForgetAfter(times[300]);
+  EXPECT_THAT(downsampled_circle.Size(), Eq(201));
+  EXPECT_THAT(downsampled_circle.back().time, Eq(times[300]));
+  downsampled_circle.Append(times[300] + 10 * Milli(Second),
+                            circle.EvaluateDegreesOfFreedom(
+                                times[300] + 10 * Milli(Second)));
+  EXPECT_THAT(downsampled_circle.Size(), Eq(202));
+}
+
+TEST_F(DiscreteTrajectoryTest, ColdTimelineForgetAfterAndClear) {
+  DiscreteTrajectory<World> circle;
+  circle.SetDownsampling(/*max_dense_intervals=*/50,
+                         /*tolerance=*/1 * Milli(Metre));
+  AngularFrequency const ω = 3 * Radian / Second;
+  Length const r = 2 * Metre;
+  Speed const v = ω * r / Radian;
+  for (auto t = DoublePrecision<Instant>(t0_);
+       t.value <= t0_ + 200 * Second;
+       t.Increment(10 * Milli(Second))) {
+    circle.Append(
+        t.value,
+        {World::origin + Displacement<World>{{r * Cos(ω * (t.value - t0_)),
+                                              r * Sin(ω * (t.value - t0_)),
+                                              0 * Metre}},
+         Velocity<World>{{-v * Sin(ω * (t.value - t0_)),
+                          v * Cos(ω * (t.value - t0_)),
+                          0 * Metre / Second}}});
+  }
+  std::vector<Instant> times;
+  for (auto const& [time, _] : circle) {
+    times.push_back(time);
+  }
+
+  // The points returned by |front| and |back|, and the references to the
+  // members of the points designated by an iterator, remain valid after the
+  // blocks that they come from have been evicted from the cache.
+  auto const front = circle.front();
+  auto const it = circle.begin();
+  auto const& it_degrees_of_freedom = it->degrees_of_freedom;
+  auto const& [it_time, _] = *it;
+  for (auto const& [time, _] : circle) {}
+  EXPECT_THAT(front.time, Eq(times.front()));
+  EXPECT_THAT(circle.t_min(), Eq(times.front()));
+  EXPECT_THAT(it_time, Eq(times.front()));
+  EXPECT_THAT(it_degrees_of_freedom, Eq(front.degrees_of_freedom));
+
+  // Forgetting after the last cold point keeps it in the hot timeline.
+  circle.ForgetAfter(times[767]);
+  EXPECT_THAT(circle.Size(), Eq(768));
+  EXPECT_THAT(circle.back().time, Eq(times[767]));
+  EXPECT_THAT(circle.t_max(), Eq(times[767]));
+  circle.Append(times[767] + 10 * Milli(Second),
+                front.degrees_of_freedom);
+  EXPECT_THAT(circle.Size(), Eq(769));
+
+  // Clearing the downsampling moves the cold points back to the hot timeline.
+  circle.ClearDownsampling();
+  EXPECT_THAT(circle.Size(), Eq(769));
+  serialization::DiscreteTrajectory message;
+  circle.WriteToMessage(&message, /*forks=*/{});
+  EXPECT_THAT(BlockSizes(message), ElementsAre(769));
+  std::vector<Instant> cleared_times;
+  for (auto const& [time, _] : circle) {
+    cleared_times.push_back(time);
+  }
+  times.resize(768);
+  times.push_back(times[767] + 10 * Milli(Second));
+  EXPECT_THAT(cleared_times, ElementsAreArray(times));
+}
+
+TEST_F(DiscreteTrajectoryTest, ColdTimelineForkForgetAfter) {
+  DiscreteTrajectory<World> circle;
+  circle.SetDownsampling(/*max_dense_intervals=*/50,
+                         /*tolerance=*/1 * Milli(Metre));
+  AngularFrequency const ω = 3 * Radian / Second;
+  Length const r = 2 * Metre;
+  Speed const v = ω * r / Radian;
+  for (auto t = DoublePrecision<Instant>(t0_);
+       t.value <= t0_ + 200 * Second;
+       t.Increment(10 * Milli(Second))) {
+    circle.Append(
+        t.value,
+        {World::origin + Displacement<World>{{r * Cos(ω * (t.value - t0_)),
+                                              r * Sin(ω * (t.value - t0_)),
+                                              0 * Metre}},
+         Velocity<World>{{-v * Sin(ω * (t.value - t0_)),
+                          v * Cos(ω * (t.value - t0_)),
+                          0 * Metre / Second}}});
+  }
+  std::vector<Instant> times;
+  for (auto const& [time, _] : circle) {
+    times.push_back(time);
+  }
+
+  // Forks in the first and second cold blocks.  Forgetting in the second block
+  // moves it to the hot timeline, but the forks must still be found while
+  // iterating.
+  auto const fork1 = circle.NewForkWithCopy(times[100]);
+  auto const fork2 = circle.NewForkWithCopy(times[300]);
+  circle.ForgetAfter(times[400]);
+  EXPECT_THAT(circle.Size(), Eq(401));
+  std::int64_t const size = times.size();
+  for (auto const fork : {fork1, fork2}) {
+    EXPECT_THAT(fork->Size(), Eq(size));
+    std::vector<Instant> fork_times;
+    for (auto const& [time, _] : *fork) {
+      fork_times.push_back(time);
+    }
+    EXPECT_THAT(fork_times, ElementsAreArray(times));
+  }
+  EXPECT_THAT(fork1->Fork()->time, Eq(times[100]));
+  EXPECT_THAT(fork2->Fork()->time, Eq(times[300]));
+
+  // Same thing when clearing the downsampling, which moves the first block.
+  circle.ClearDownsampling();
+  EXPECT_THAT(fork1->Size(), Eq(size));
+  EXPECT_THAT(fork1->Fork()->time, Eq(times[100]));
+  EXPECT_THAT(fork2->Size(), Eq(size));
+}
+
+TEST_F(DiscreteTrajectoryTest, SerializationInBlocks) {
+  DiscreteTrajectory<World> line;
+  for (int i = 0; i < 2500; ++i) {
+    line.Append(t0_ + i * Second,
+                {World::origin + Displacement<World>({i * Metre,
+                                                      2 * i * Metre,
+                                                      3 * Metre}),
+                 Velocity<World>({1 * Metre / Second,
+                                  2 * Metre / Second,
+                                  i * Metre / Second})});
+  }
+
+  // The timeline is written in blocks that are compressed independently, and
+  // without downsampling the points are exact.
+  serialization::DiscreteTrajectory message;
+  line.WriteToMessage(&message, /*forks=*/{});
+  EXPECT_THAT(BlockSizes(message), ElementsAre(1024, 1024, 452));
+  auto const deserialized_line =
+      DiscreteTrajectory<World>::ReadFromMessage(message, /*forks=*/{});
+  EXPECT_THAT(deserialized_line->Size(), Eq(2500));
+  for (auto it1 = line.begin(), it2 = deserialized_line->begin();
+       it1 != line.end();
+       ++it1, ++it2) {
+    EXPECT_EQ(it1->time, it2->time);
+    EXPECT_EQ(it1->degrees_of_freedom, it2->degrees_of_freedom);
+  }
+}
+
 }  // namespace internal_discrete_trajectory
 }  // namespace physics
 }  // namespace principia
@@ -5,11 +5,16 @@
 #include <limits>
 #include <map>
 #include <memory>
+#include <optional>
+#include <utility>
 #include <vector>
 
 #include "absl/synchronization/mutex.h"
+#include "base/jthread.hpp"
 #include "base/not_null.hpp"
 #include "base/status.hpp"
+#include "base/status_or.hpp"
+#include "base/thread_pool.hpp"
 #include "geometry/grassmann.hpp"
 #include "geometry/named_quantities.hpp"
 #include "google/protobuf/repeated_field.h"
@@ -32,8 +37,12 @@ namespace physics {
 namespace internal_ephemeris {
 
 using base::Error;
+using base::jthread;
 using base::not_null;
 using base::Status;
+using base::StatusOr;
+using base::stop_token;
+using base::ThreadPool;
 using geometry::Instant;
 using geometry::Position;
 using geometry::Vector;
@@ -112,6 +121,11 @@ class Ephemeris {
   using GeneralizedNewtonianMotionEquation =
       ExplicitSecondOrderOrdinaryDifferentialEquation<Position<Frame>>;
 
+  // An instance and the index of one of the trajectories that it integrates.
+  using InstanceState = std::pair<
+      not_null<typename Integrator<NewtonianMotionEquation>::Instance const*>,
+      int>;
+
   using AdaptiveStepParameters =
       ODEAdaptiveStepParameters<NewtonianMotionEquation>;
   using GeneralizedAdaptiveStepParameters =
@@ -139,6 +153,7 @@ class Ephemeris {
         FixedStepSizeIntegrator<NewtonianMotionEquation> const& integrator,
         Time const& step);
 
+    FixedStepSizeIntegrator<NewtonianMotionEquation> const& integrator() const;
     Time const& step() const;
 
     void WriteToMessage(
@@ -193,6 +208,12 @@ class Ephemeris {
   // Prolongs the ephemeris up to at least |t|.  After the call, |t_max() >= t|.
   virtual void Prolong(Instant const& t) EXCLUDES(lock_);
 
+  // Requests that the ephemeris be prolonged up to at least |t| on a background
+  // thread, and returns immediately.  This makes it likely that the calls to
+  // |Prolong| for times before |t| return without integrating.
+  virtual void RequestProlongation(Instant const& t)
+      EXCLUDES(prolongation_lock_);
+
   // Creates an instance suitable for integrating the given |trajectories| with
   // their |intrinsic_accelerations| using a fixed-step integrator parameterized
   // by |parameters|.
@@ -203,6 +224,21 @@ class Ephemeris {
       IntrinsicAccelerations const& intrinsic_accelerations,
       FixedStepParameters const& parameters);
 
+  // Creates an instance suitable for integrating the given |trajectories|
+  // without intrinsic accelerations that continues the integrations of
+  // existing instances instead of restarting the integrator: the trajectory
+  // |trajectories[i]| is integrated from the state reached by the instance
+  // |*states[i].first| for its trajectory of index |states[i].second|.  Returns
+  // null if these instances are not at the same point of the same integration,
+  // e.g., if they are at different times or at different stages of the startup
+  // of a multistep integrator, or if their integrator doesn't support this
+  // operation.
+  virtual std::unique_ptr<
+      typename Integrator<NewtonianMotionEquation>::Instance>
+  RecombineInstances(
+      std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
+      std::vector<InstanceState> const& states);
+
   // Integrates, until exactly |t| (except for timeouts or singularities), the
   // |trajectory| followed by a massless body in the gravitational potential
   // described by |*this|.  If |t > t_max()|, calls |Prolong(t)| beforehand.
@@ -276,9 +312,10 @@ class Ephemeris {
 
   virtual void WriteToMessage(
       not_null<serialization::Ephemeris*> message) const EXCLUDES(lock_);
+  // Fails if one of the trajectories cannot be read.
   template<typename F = Frame,
            typename = std::enable_if_t<base::is_serializable_v<F>>>
-  static not_null<std::unique_ptr<Ephemeris>> ReadFromMessage(
+  static StatusOr<not_null<std::unique_ptr<Ephemeris>>> ReadFromMessage(
       serialization::Ephemeris const& message) EXCLUDES(lock_);
 
   // A |Guard| is an RAII object that protects a critical section against
@@ -324,6 +361,24 @@ class Ephemeris {
       typename NewtonianMotionEquation::SystemState const& state,
       std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories);
 
+  // Records an apocalypse if |status| (returned by the trajectory of
+  // |bodies_[index]|) is an error.
+  void RecordTrajectoryStatus(int index, Status const& status) REQUIRES(lock_);
+
+  // Waits until the trajectories have fitted all their pending polynomials,
+  // and records the errors.
+  void WaitForFits() REQUIRES(lock_);
+
+  // Makes the trajectories fit their polynomials on |fitting_pool_|.
+  void StartAsynchronousFitting();
+
+  // The loop executed by |prolonger_| to satisfy |RequestProlongation|.
+  void ProlongInBackground(stop_token const& st)
+      EXCLUDES(prolongation_lock_);
+
+  // Records in |prolonged_t_max_| that the ephemeris extends up to |t_max|.
+  void RecordProlongation(Instant const& t_max) EXCLUDES(prolongation_lock_);
+
   // Note the return by copy: the returned value is usable even if the
   // |instance_| is being integrated.
   Instant instance_time() const EXCLUDES(lock_);
@@ -410,6 +465,11 @@ class Ephemeris {
   // Only has entries for the oblate bodies, at the same indices as |bodies_|.
   std::vector<Geopotential<Frame>> geopotentials_;
 
+  // The pool on which the trajectories fit their polynomials while |Prolong|
+  // integrates the next steps.  Declared before the trajectories, which must
+  // not outlive it.
+  std::unique_ptr<ThreadPool<void>> fitting_pool_;
+
   // The indices in |bodies_| correspond to those in |trajectories_|.
   std::vector<not_null<ContinuousTrajectory<Frame>*>> trajectories_;
 
@@ -438,6 +498,25 @@ class Ephemeris {
 
   Status last_severe_integration_status_ GUARDED_BY(lock_);
 
+  // |prolonger_| integrates at most this number of steps each time it locks
+  // |lock_|, so that it doesn't block the callers of |Prolong| for long and
+  // that it reacts promptly to stop requests.
+  static constexpr std::int64_t background_prolongation_steps = 10;
+
+  // Lock order: |lock_| may be held when acquiring |prolongation_lock_|, but
+  // not the converse.
+  absl::Mutex prolongation_lock_;
+  std::optional<Instant> prolongation_target_ GUARDED_BY(prolongation_lock_);
+  // The value of |t_max()| as of the last call to |Prolong|, if any.  This is
+  // what |ProlongInBackground| waits on, as the condition of |Await| must only
+  // depend on state guarded by |prolongation_lock_|.
+  std::optional<Instant> prolonged_t_max_ GUARDED_BY(prolongation_lock_);
+  // Set when |prolonger_| is asked to stop.
+  bool prolongation_stopped_ GUARDED_BY(prolongation_lock_) = false;
+  // Started by the first call to |RequestProlongation|.  Declared last so that
+  // it is joined before the other members are destroyed.
+  jthread prolonger_;
+
   friend class Guard;
 };
 
@@ -8,6 +8,7 @@
 #include <limits>
 #include <optional>
 #include <set>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -36,6 +37,7 @@ using base::dynamic_cast_not_null;
 using base::Error;
 using base::FindOrDie;
 using base::make_not_null_unique;
+using base::stop_callback;
 using geometry::Barycentre;
 using geometry::Displacement;
 using geometry::InnerProduct;
@@ -202,6 +204,13 @@ Ephemeris<Frame>::FixedStepParameters::FixedStepParameters(
   CHECK_LT(Time(), step);
 }
 
+template<typename Frame>
+inline FixedStepSizeIntegrator<
+    typename Ephemeris<Frame>::NewtonianMotionEquation> const&
+Ephemeris<Frame>::FixedStepParameters::integrator() const {
+  return *integrator_;
+}
+
 template<typename Frame>
 inline Time const& Ephemeris<Frame>::FixedStepParameters::step() const {
   return step_;
@@ -298,6 +307,8 @@ Ephemeris<Frame>::Ephemeris(
     }
   }
 
+  StartAsynchronousFitting();
+
   absl::ReaderMutexLock l(&lock_);  // For locking checks.
   instance_ = fixed_step_parameters_.integrator_->NewInstance(
       problem,
@@ -371,8 +382,9 @@ bool Ephemeris<Frame>::EventuallyForgetBefore(Instant const& t) {
 
 template<typename Frame>
 void Ephemeris<Frame>::Prolong(Instant const& t) {
-  // Short-circuit without locking.
-  if (t <= t_max()) {
+  // Short-circuit without locking |lock_|.
+  if (Instant const t_max = this->t_max(); t <= t_max) {
+    RecordProlongation(t_max);
     return;
   }
 
@@ -389,11 +401,32 @@ void Ephemeris<Frame>::Prolong(Instant const& t) {
 
   // Perform the integration.  Note that we may have to iterate until |t_max()|
   // actually reaches |t| because the last series may not be fully determined
-  // after the first integration.
-  absl::MutexLock l(&lock_);
-  while (t_max() < t) {
-    instance_->Solve(t_final);
-    t_final += fixed_step_parameters_.step_;
+  // after the first integration.  The polynomials are fitted asynchronously
+  // while the integration proceeds, so we must wait for them before looking
+  // at |t_max()|.
+  Instant t_max;
+  {
+    absl::MutexLock l(&lock_);
+    while (this->t_max() < t) {
+      instance_->Solve(t_final);
+      WaitForFits();
+      t_final += fixed_step_parameters_.step_;
+    }
+    t_max = this->t_max();
+  }
+  RecordProlongation(t_max);
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::RequestProlongation(Instant const& t) {
+  absl::MutexLock l(&prolongation_lock_);
+  if (!prolongation_target_.has_value() || *prolongation_target_ < t) {
+    prolongation_target_ = t;
+  }
+  if (!prolonger_.joinable()) {
+    prolonger_ = jthread([this](stop_token const& st) {
+      ProlongInBackground(st);
+    });
   }
 }
 
@@ -451,6 +484,46 @@ Ephemeris<Frame>::NewInstance(
       problem, append_state, parameters.step_);
 }
 
+template<typename Frame>
+std::unique_ptr<typename Integrator<
+    typename Ephemeris<Frame>::NewtonianMotionEquation>::Instance>
+Ephemeris<Frame>::RecombineInstances(
+    std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
+    std::vector<InstanceState> const& states) {
+  using FixedStepInstance =
+      typename FixedStepSizeIntegrator<NewtonianMotionEquation>::Instance;
+  CHECK(!trajectories.empty());
+  CHECK_EQ(trajectories.size(), states.size());
+  std::vector<std::pair<not_null<FixedStepInstance const*>, int>>
+      fixed_step_states;
+  for (auto const& [instance, index] : states) {
+    auto const* const fixed_step_instance =
+        dynamic_cast<FixedStepInstance const*>(&*instance);
+    if (fixed_step_instance == nullptr) {
+      return nullptr;
+    }
+    fixed_step_states.emplace_back(fixed_step_instance, index);
+  }
+
+  NewtonianMotionEquation equation;
+  equation.compute_acceleration =
+      [this](Instant const& t,
+             std::vector<Position<Frame>> const& positions,
+             std::vector<Vector<Acceleration, Frame>>& accelerations) {
+    RETURN_IF_STOPPED;
+    Error const error =
+        ComputeMasslessBodiesGravitationalAccelerations(t,
+                                                        positions,
+                                                        accelerations);
+    return error == Error::OK ? Status::OK : CollisionDetected();
+  };
+  auto const append_state =
+      std::bind(&Ephemeris::AppendMasslessBodiesState, _1, trajectories);
+
+  return fixed_step_states.front().first->Recombine(
+      fixed_step_states, equation, append_state);
+}
+
 template<typename Frame>
 Status Ephemeris<Frame>::FlowWithAdaptiveStep(
     not_null<DiscreteTrajectory<Frame>*> const trajectory,
@@ -738,8 +811,8 @@ void Ephemeris<Frame>::WriteToMessage(
 
 template<typename Frame>
 template<typename, typename>
-not_null<std::unique_ptr<Ephemeris<Frame>>> Ephemeris<Frame>::ReadFromMessage(
-    serialization::Ephemeris const& message) {
+StatusOr<not_null<std::unique_ptr<Ephemeris<Frame>>>>
+Ephemeris<Frame>::ReadFromMessage(serialization::Ephemeris const& message) {
   bool const is_pre_ἐρατοσθένης = !message.has_accuracy_parameters();
   bool const is_pre_fatou = !message.has_checkpoint_time();
 
@@ -748,6 +821,17 @@ not_null<std::unique_ptr<Ephemeris<Frame>>> Ephemeris<Frame>::ReadFromMessage(
     bodies.push_back(MassiveBody::ReadFromMessage(body));
   }
 
+  // The trajectories are read first, so that nothing is started if one of them
+  // cannot be read.
+  std::vector<not_null<std::unique_ptr<ContinuousTrajectory<Frame>>>>
+      trajectories;
+  for (auto const& trajectory : message.trajectory()) {
+    auto deserialized_trajectory =
+        ContinuousTrajectory<Frame>::ReadFromMessage(trajectory);
+    RETURN_IF_ERROR(deserialized_trajectory);
+    trajectories.push_back(std::move(deserialized_trajectory).ValueOrDie());
+  }
+
   AccuracyParameters accuracy_parameters(
       pre_ἐρατοσθένης_default_ephemeris_fitting_tolerance,
       /*geopotential_tolerance=*/0);
@@ -773,16 +857,14 @@ not_null<std::unique_ptr<Ephemeris<Frame>>> Ephemeris<Frame>::ReadFromMessage(
   int index = 0;
   ephemeris->bodies_to_trajectories_.clear();
   ephemeris->trajectories_.clear();
-  for (auto const& trajectory : message.trajectory()) {
+  for (auto& deserialized_trajectory : trajectories) {
     not_null<MassiveBody const*> const body = ephemeris->bodies_[index].get();
-    not_null<std::unique_ptr<ContinuousTrajectory<Frame>>>
-        deserialized_trajectory =
-            ContinuousTrajectory<Frame>::ReadFromMessage(trajectory);
     ephemeris->trajectories_.push_back(deserialized_trajectory.get());
     ephemeris->bodies_to_trajectories_.emplace(
         body, std::move(deserialized_trajectory));
     ++index;
   }
+  ephemeris->StartAsynchronousFitting();
 
   Instant checkpoint_time;
   if (is_pre_fatou) {
@@ -802,7 +884,9 @@ template<typename Frame>
 Ephemeris<Frame>::Guard::Guard(
     not_null<Ephemeris<Frame> const*> const ephemeris)
     : ephemeris_(ephemeris) {
-  absl::MutexLock l(&ephemeris->lock_);
+  // A reader lock is sufficient to prevent |t_min| from changing until it is
+  // protected, and it lets guards be constructed concurrently.
+  absl::ReaderMutexLock l(&ephemeris->lock_);
   t_min_ = ephemeris->t_min_locked();
   ephemeris->protector_->Protect(t_min_);
 }
@@ -918,14 +1002,7 @@ void Ephemeris<Frame>::AppendMassiveBodiesState(
         DegreesOfFreedom<Frame>(state.positions[index].value,
                                 state.velocities[index].value));
 
-    // Handle the apocalypse.
-    if (!status.ok()) {
-      last_severe_integration_status_ =
-          Status(status.error(),
-                 "Error extending trajectory for " + bodies_[i]->name() + ". " +
-                     status.message());
-      LOG(ERROR) << "New Apocalypse: " << last_severe_integration_status_;
-    }
+    RecordTrajectoryStatus(i, status);
 
     ++index;
   }
@@ -933,6 +1010,41 @@ void Ephemeris<Frame>::AppendMassiveBodiesState(
   CreateCheckpointIfNeeded(time);
 }
 
+template<typename Frame>
+void Ephemeris<Frame>::RecordTrajectoryStatus(int const index,
+                                              Status const& status) {
+  // Handle the apocalypse.
+  if (!status.ok()) {
+    last_severe_integration_status_ =
+        Status(status.error(),
+               "Error extending trajectory for " + bodies_[index]->name() +
+                   ". " + status.message());
+    LOG(ERROR) << "New Apocalypse: " << last_severe_integration_status_;
+  }
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::WaitForFits() {
+  for (int i = 0; i < trajectories_.size(); ++i) {
+    RecordTrajectoryStatus(i, trajectories_[i]->WaitForFits());
+  }
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::StartAsynchronousFitting() {
+  // The fits of a trajectory are sequential, so there is no point in having
+  // more threads than trajectories.
+  std::int64_t const pool_size =
+      std::min<std::int64_t>(trajectories_.size(),
+                             std::thread::hardware_concurrency());
+  if (fitting_pool_ == nullptr && pool_size > 1) {
+    fitting_pool_ = std::make_unique<ThreadPool<void>>(pool_size);
+  }
+  for (auto const& trajectory : trajectories_) {
+    trajectory->SetFittingPool(fitting_pool_.get());
+  }
+}
+
 template<typename Frame>
 void Ephemeris<Frame>::AppendMasslessBodiesState(
     typename NewtonianMotionEquation::SystemState const& state,
@@ -947,6 +1059,44 @@ void Ephemeris<Frame>::AppendMasslessBodiesState(
   }
 }
 
+template<typename Frame>
+void Ephemeris<Frame>::ProlongInBackground(stop_token const& st) {
+  stop_callback const wake_up(st, [this]() {
+    absl::MutexLock l(&prolongation_lock_);
+    prolongation_stopped_ = true;
+  });
+  for (;;) {
+    Instant target;
+    {
+      absl::MutexLock l(&prolongation_lock_);
+      auto const stopped_or_behind_target = [this]() {
+        return prolongation_stopped_ || !prolonged_t_max_.has_value() ||
+               *prolongation_target_ > *prolonged_t_max_;
+      };
+      prolongation_lock_.Await(absl::Condition(&stopped_or_behind_target));
+      if (prolongation_stopped_) {
+        return;
+      }
+      target = *prolongation_target_;
+    }
+    // Note that the stop token of this thread is not the one checked by the
+    // integrator: |Prolong| must not be interrupted, as it loops until it
+    // reaches its target.  We prolong from |instance_time()| because |t_max()|
+    // is infinite if the ephemeris is empty.
+    Prolong(std::min(target,
+                     instance_time() + background_prolongation_steps *
+                                           fixed_step_parameters_.step_));
+  }
+}
+
+template<typename Frame>
+void Ephemeris<Frame>::RecordProlongation(Instant const& t_max) {
+  absl::MutexLock l(&prolongation_lock_);
+  if (!prolonged_t_max_.has_value() || *prolonged_t_max_ < t_max) {
+    prolonged_t_max_ = t_max;
+  }
+}
+
 template<typename Frame>
 Instant Ephemeris<Frame>::instance_time() const {
   absl::ReaderMutexLock l(&lock_);
@@ -8,6 +8,8 @@
 #include <string>
 #include <vector>
 
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "astronomy/frames.hpp"
 #include "base/macros.hpp"
 #include "geometry/barycentre_calculator.hpp"
@@ -204,6 +206,40 @@ TEST_P(EphemerisTest, ProlongSpecialCases) {
   EXPECT_EQ(t_max, ephemeris.t_max());
 }
 
+TEST_P(EphemerisTest, RequestProlongation) {
+  std::vector<not_null<std::unique_ptr<MassiveBody const>>> bodies;
+  std::vector<DegreesOfFreedom<ICRS>> initial_state;
+  Position<ICRS> centre_of_mass;
+  Time period;
+  SetUpEarthMoonSystem(bodies, initial_state, centre_of_mass, period);
+
+  Ephemeris<ICRS> ephemeris(
+      std::move(bodies),
+      initial_state,
+      t0_,
+      /*accuracy_parameters=*/{/*fitting_tolerance=*/5 * Milli(Metre),
+                               /*geopotential_tolerance=*/0x1p-24},
+      Ephemeris<ICRS>::FixedStepParameters(integrator(), period / 100));
+
+  ephemeris.RequestProlongation(t0_ + period);
+  ephemeris.RequestProlongation(t0_ + period / 2);
+  absl::Time const deadline = absl::Now() + absl::Seconds(60);
+  while (ephemeris.t_max() < t0_ + period && absl::Now() < deadline) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  ASSERT_LE(t0_ + period, ephemeris.t_max());
+  Instant const t_max = ephemeris.t_max();
+
+  // The foreground prolongation doesn't integrate and gives the same result.
+  ephemeris.Prolong(t0_ + period);
+  EXPECT_EQ(t_max, ephemeris.t_max());
+
+  // Prolonging beyond the request works even if the background thread is busy.
+  ephemeris.RequestProlongation(t0_ + 3 * period);
+  ephemeris.Prolong(t0_ + 2 * period);
+  EXPECT_LE(t0_ + 2 * period, ephemeris.t_max());
+}
+
 TEST_P(EphemerisTest, FlowWithAdaptiveStepSpecialCase) {
   Length const distance = 1e9 * Metre;
   Speed const velocity = 1e3 * Metre / Second;
@@ -677,7 +713,8 @@ TEST_P(EphemerisTest, Serialization) {
   serialization::Ephemeris message;
   ephemeris.WriteToMessage(&message);
 
-  auto const ephemeris_read = Ephemeris<ICRS>::ReadFromMessage(message);
+  auto const ephemeris_read =
+      Ephemeris<ICRS>::ReadFromMessage(message).ValueOrDie();
   // After deserialization, the client must prolong as needed.
   ephemeris_read->Prolong(ephemeris.t_max());
 
@@ -195,6 +195,11 @@ class Forkable {
   // This trajectory must be a root.
   void CheckNoForksBefore(Instant const& time);
 
+  // Recomputes the positions of the children in the timeline of this object.
+  // Must be called when the iterators to the fork points may have been
+  // invalidated, e.g., because points were moved within the timeline.
+  void UpdateChildrenPositions();
+
   // This trajectory need not be a root.  As forks are encountered during tree
   // traversal their pointer is nulled-out in |forks|.
   void WriteSubTreeToMessage(
@@ -450,6 +450,13 @@ CheckNoForksBefore(Instant const& time) {
                                  << " forks before " << time;
 }
 
+template<typename Tr4jectory, typename It3rator, typename Traits>
+void Forkable<Tr4jectory, It3rator, Traits>::UpdateChildrenPositions() {
+  for (auto const& [fork_time, child] : children_) {
+    child->position_in_parent_timeline_ = timeline_find(fork_time);
+  }
+}
+
 template<typename Tr4jectory, typename It3rator, typename Traits>
 void Forkable<Tr4jectory, It3rator, Traits>::WriteSubTreeToMessage(
     not_null<serialization::DiscreteTrajectory*> const message,
@@ -4,6 +4,7 @@
 #include <optional>
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include "physics/body.hpp"
 #include "physics/degrees_of_freedom.hpp"
@@ -106,6 +107,17 @@ class KeplerOrbit final {
   // The |DegreesOfFreedom| of the secondary minus those of the primary.
   RelativeDegreesOfFreedom<Frame> StateVectors(Instant const& t) const;
 
+  // Same as above, at each of the |times|.  This is much faster than calling
+  // the above function repeatedly, as Kepler's equation is solved for all the
+  // |times| at once and the orientation of the orbit is computed only once.
+  std::vector<RelativeDegreesOfFreedom<Frame>> StateVectors(
+      std::vector<Instant> const& times) const;
+
+  // The state vectors of each of the |orbits| at time |t|.
+  static std::vector<RelativeDegreesOfFreedom<Frame>> StateVectors(
+      std::vector<not_null<KeplerOrbit const*>> const& orbits,
+      Instant const& t);
+
   // All |optional|s are filled in the result.
   KeplerianElements<Frame> const& elements_at_epoch() const;
 
@@ -129,6 +141,15 @@ class KeplerOrbit final {
   // minimally specified.  Fills section III.
   static void CompleteAnomalies(KeplerianElements<Frame>& elements);
 
+  // The elliptic or hyperbolic mean anomaly at |t|, in radians.
+  double MeanAnomaly(Instant const& t) const;
+
+  // Appends to |state_vectors| the state vectors corresponding to each of the
+  // elliptic or hyperbolic |eccentric_anomalies|, in radians.
+  void AppendStateVectors(
+      std::vector<double> const& eccentric_anomalies,
+      std::vector<RelativeDegreesOfFreedom<Frame>>& state_vectors) const;
+
   GravitationalParameter const gravitational_parameter_;
   KeplerianElements<Frame> elements_at_epoch_;
   Instant const epoch_;
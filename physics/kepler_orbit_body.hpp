@@ -3,7 +3,10 @@
 
 #include "physics/kepler_orbit.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <string>
+#include <vector>
 
 #include "base/optional_serialization.hpp"
 #include "geometry/frame.hpp"
@@ -50,6 +53,85 @@ using quantities::Sqrt;
 using quantities::Time;
 using quantities::si::Radian;
 
+// Solves the elliptic Kepler equation M = E - e sin E for each of the
+// |mean_anomalies| (in radians) with the corresponding |eccentricities|, and
+// stores the results in |eccentric_anomalies|.  The mean anomalies are first
+// reduced to [-π, π].  The starter is that of Danby (1987), refined near the
+// parabolic limit with the cubic approximation E³ e / 6 = M; it is followed by
+// three iterations of Danby's quartically convergent method, which reach full
+// precision for all e < 1.  There are no data-dependent branches, so that the
+// loop may be vectorized.
+inline void SolveEllipticKeplerEquation(
+    std::vector<double> const& eccentricities,
+    std::vector<double> const& mean_anomalies,
+    std::vector<double>& eccentric_anomalies) {
+  constexpr int iterations = 3;
+  std::size_t const size = mean_anomalies.size();
+  CHECK_EQ(size, eccentricities.size());
+  eccentric_anomalies.resize(size);
+  double const* const e = eccentricities.data();
+  double const* const mean_anomaly = mean_anomalies.data();
+  double* const eccentric_anomaly = eccentric_anomalies.data();
+  for (std::size_t k = 0; k < size; ++k) {
+    double const M = mean_anomaly[k] -
+                     2 * π * std::nearbyint(mean_anomaly[k] / (2 * π));
+    double const abs_M = std::abs(M);
+    double E = std::copysign(
+        std::min(abs_M + 0.85 * e[k], std::cbrt(6 * abs_M / e[k])), M);
+    for (int i = 0; i < iterations; ++i) {
+      double const e_sin_E = e[k] * std::sin(E);
+      double const e_cos_E = e[k] * std::cos(E);
+      // The function and its first three derivatives.
+      double const f0 = E - e_sin_E - M;
+      double const f1 = 1 - e_cos_E;
+      double const f2 = e_sin_E;
+      double const f3 = e_cos_E;
+      double const δ1 = -f0 / f1;
+      double const δ2 = -f0 / (f1 + δ1 * f2 / 2);
+      double const δ3 = -f0 / (f1 + δ2 * f2 / 2 + δ2 * δ2 * f3 / 6);
+      E += δ3;
+    }
+    eccentric_anomaly[k] = E;
+  }
+}
+
+// Same as above for the hyperbolic Kepler equation M = e sinh H - H.  The
+// starter is that of Danby (1987), with the same refinement near the parabolic
+// limit.
+inline void SolveHyperbolicKeplerEquation(
+    std::vector<double> const& eccentricities,
+    std::vector<double> const& hyperbolic_mean_anomalies,
+    std::vector<double>& hyperbolic_eccentric_anomalies) {
+  constexpr int iterations = 4;
+  std::size_t const size = hyperbolic_mean_anomalies.size();
+  CHECK_EQ(size, eccentricities.size());
+  hyperbolic_eccentric_anomalies.resize(size);
+  double const* const e = eccentricities.data();
+  double const* const mean_anomaly = hyperbolic_mean_anomalies.data();
+  double* const eccentric_anomaly = hyperbolic_eccentric_anomalies.data();
+  for (std::size_t k = 0; k < size; ++k) {
+    double const M = mean_anomaly[k];
+    double const abs_M = std::abs(M);
+    double H = std::copysign(std::min(std::log(2 * abs_M / e[k] + 1.8),
+                                      std::cbrt(6 * abs_M / e[k])),
+                             M);
+    for (int i = 0; i < iterations; ++i) {
+      double const e_sinh_H = e[k] * std::sinh(H);
+      double const e_cosh_H = e[k] * std::cosh(H);
+      // The function and its first three derivatives.
+      double const f0 = e_sinh_H - H - M;
+      double const f1 = e_cosh_H - 1;
+      double const f2 = e_sinh_H;
+      double const f3 = e_cosh_H;
+      double const δ1 = -f0 / f1;
+      double const δ2 = -f0 / (f1 + δ1 * f2 / 2);
+      double const δ3 = -f0 / (f1 + δ2 * f2 / 2 + δ2 * δ2 * f3 / 6);
+      H += δ3;
+    }
+    eccentric_anomaly[k] = H;
+  }
+}
+
 template<typename Frame>
 void KeplerianElements<Frame>::WriteToMessage(
     not_null<serialization::KeplerianElements*> const message) const {
@@ -279,6 +361,74 @@ KeplerOrbit<Frame>::StateVectors(Instant const& t) const {
   return {displacement, velocity};
 }
 
+template<typename Frame>
+std::vector<RelativeDegreesOfFreedom<Frame>> KeplerOrbit<Frame>::StateVectors(
+    std::vector<Instant> const& times) const {
+  double const& e = *elements_at_epoch_.eccentricity;
+  std::vector<double> const eccentricities(times.size(), e);
+  std::vector<double> mean_anomalies;
+  mean_anomalies.reserve(times.size());
+  for (Instant const& t : times) {
+    mean_anomalies.push_back(MeanAnomaly(t));
+  }
+
+  std::vector<double> eccentric_anomalies;
+  if (e < 1) {
+    SolveEllipticKeplerEquation(
+        eccentricities, mean_anomalies, eccentric_anomalies);
+  } else {
+    SolveHyperbolicKeplerEquation(
+        eccentricities, mean_anomalies, eccentric_anomalies);
+  }
+
+  std::vector<RelativeDegreesOfFreedom<Frame>> state_vectors;
+  state_vectors.reserve(times.size());
+  AppendStateVectors(eccentric_anomalies, state_vectors);
+  return state_vectors;
+}
+
+template<typename Frame>
+std::vector<RelativeDegreesOfFreedom<Frame>> KeplerOrbit<Frame>::StateVectors(
+    std::vector<not_null<KeplerOrbit const*>> const& orbits,
+    Instant const& t) {
+  // Solve all the elliptic equations together and all the hyperbolic ones
+  // together.
+  std::vector<double> elliptic_eccentricities;
+  std::vector<double> elliptic_mean_anomalies;
+  std::vector<double> hyperbolic_eccentricities;
+  std::vector<double> hyperbolic_mean_anomalies;
+  for (auto const orbit : orbits) {
+    double const& e = *orbit->elements_at_epoch_.eccentricity;
+    if (e < 1) {
+      elliptic_eccentricities.push_back(e);
+      elliptic_mean_anomalies.push_back(orbit->MeanAnomaly(t));
+    } else {
+      hyperbolic_eccentricities.push_back(e);
+      hyperbolic_mean_anomalies.push_back(orbit->MeanAnomaly(t));
+    }
+  }
+  std::vector<double> elliptic_eccentric_anomalies;
+  std::vector<double> hyperbolic_eccentric_anomalies;
+  SolveEllipticKeplerEquation(elliptic_eccentricities,
+                              elliptic_mean_anomalies,
+                              elliptic_eccentric_anomalies);
+  SolveHyperbolicKeplerEquation(hyperbolic_eccentricities,
+                                hyperbolic_mean_anomalies,
+                                hyperbolic_eccentric_anomalies);
+
+  std::vector<RelativeDegreesOfFreedom<Frame>> state_vectors;
+  state_vectors.reserve(orbits.size());
+  std::vector<double> eccentric_anomaly(1);
+  auto elliptic_it = elliptic_eccentric_anomalies.cbegin();
+  auto hyperbolic_it = hyperbolic_eccentric_anomalies.cbegin();
+  for (auto const orbit : orbits) {
+    double const& e = *orbit->elements_at_epoch_.eccentricity;
+    eccentric_anomaly[0] = e < 1 ? *elliptic_it++ : *hyperbolic_it++;
+    orbit->AppendStateVectors(eccentric_anomaly, state_vectors);
+  }
+  return state_vectors;
+}
+
 template<typename Frame>
 KeplerianElements<Frame> const& KeplerOrbit<Frame>::elements_at_epoch() const {
   return elements_at_epoch_;
@@ -667,6 +817,88 @@ void KeplerOrbit<Frame>::CompleteAnomalies(KeplerianElements<Frame>& elements) {
   }
 }
 
+template<typename Frame>
+double KeplerOrbit<Frame>::MeanAnomaly(Instant const& t) const {
+  double const& e = *elements_at_epoch_.eccentricity;
+  if (e < 1) {
+    // Elliptic case.
+    return (*elements_at_epoch_.mean_anomaly +
+            *elements_at_epoch_.mean_motion * (t - epoch_)) / Radian;
+  } else if (e == 1) {
+    // Parabolic case.
+    LOG(FATAL) << "not yet implemented";
+    base::noreturn();
+  } else {
+    // Hyperbolic case.
+    return (*elements_at_epoch_.hyperbolic_mean_anomaly +
+            *elements_at_epoch_.hyperbolic_mean_motion * (t - epoch_)) /
+           Radian;
+  }
+}
+
+template<typename Frame>
+void KeplerOrbit<Frame>::AppendStateVectors(
+    std::vector<double> const& eccentric_anomalies,
+    std::vector<RelativeDegreesOfFreedom<Frame>>& state_vectors) const {
+  double const& e = *elements_at_epoch_.eccentricity;
+  Angle const& i = elements_at_epoch_.inclination;
+  Angle const& Ω = elements_at_epoch_.longitude_of_ascending_node;
+  Angle const& ω = *elements_at_epoch_.argument_of_periapsis;
+  using OrbitPlane = geometry::Frame<enum class OrbitPlaneTag>;
+  Rotation<OrbitPlane, Frame> const from_orbit_plane(
+      Ω, i, ω,
+      EulerAngles::ZXZ,
+      DefinesFrame<OrbitPlane>{});
+  // In the orbit plane the periapsis is on the x axis, and the motion is
+  // towards positive y at the periapsis.  The expressions below are written in
+  // terms of the periapsis distance and of the squared sine of half the
+  // eccentric anomaly to avoid cancellations for nearly parabolic orbits.
+  Length const& r_pe = *elements_at_epoch_.periapsis_distance;
+  if (e < 1) {
+    // Elliptic case.
+    Length const& a = *elements_at_epoch_.semimajor_axis;
+    Length const& b = *elements_at_epoch_.semiminor_axis;
+    AngularFrequency const& n = *elements_at_epoch_.mean_motion;
+    for (double const E : eccentric_anomalies) {
+      double const cos_E = std::cos(E);
+      double const sin_E = std::sin(E);
+      double const sin_half_E = std::sin(E / 2);
+      // 1 - cos E.
+      double const versine_E = 2 * sin_half_E * sin_half_E;
+      Length const r = r_pe + a * e * versine_E;
+      // The time derivative of the eccentric anomaly.
+      auto const Ė = n * a / (r * Radian);
+      Displacement<OrbitPlane> const displacement(
+          {r_pe - a * versine_E, b * sin_E, Length()});
+      Velocity<OrbitPlane> const velocity(
+          {-a * sin_E * Ė, b * cos_E * Ė, Speed()});
+      state_vectors.emplace_back(from_orbit_plane(displacement),
+                                 from_orbit_plane(velocity));
+    }
+  } else {
+    // Hyperbolic case.
+    Length const a = -*elements_at_epoch_.semimajor_axis;
+    Length const& b = *elements_at_epoch_.impact_parameter;
+    AngularFrequency const& n = *elements_at_epoch_.hyperbolic_mean_motion;
+    for (double const H : eccentric_anomalies) {
+      double const cosh_H = std::cosh(H);
+      double const sinh_H = std::sinh(H);
+      double const sinh_half_H = std::sinh(H / 2);
+      // cosh H - 1.
+      double const hyperbolic_versine_H = 2 * sinh_half_H * sinh_half_H;
+      Length const r = r_pe + a * e * hyperbolic_versine_H;
+      // The time derivative of the hyperbolic eccentric anomaly.
+      auto const Ḣ = n * a / (r * Radian);
+      Displacement<OrbitPlane> const displacement(
+          {r_pe - a * hyperbolic_versine_H, b * sinh_H, Length()});
+      Velocity<OrbitPlane> const velocity(
+          {-a * sinh_H * Ḣ, b * cosh_H * Ḣ, Speed()});
+      state_vectors.emplace_back(from_orbit_plane(displacement),
+                                 from_orbit_plane(velocity));
+    }
+  }
+}
+
 }  // namespace internal_kepler_orbit
 }  // namespace physics
 }  // namespace principia
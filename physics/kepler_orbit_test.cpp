@@ -10,6 +10,7 @@
 #include "physics/solar_system.hpp"
 #include "quantities/astronomy.hpp"
 #include "testing_utilities/almost_equals.hpp"
+#include "testing_utilities/numerics_matchers.hpp"
 
 namespace principia {
 namespace physics {
@@ -26,6 +27,7 @@ using quantities::si::Metre;
 using quantities::si::Milli;
 using quantities::si::Second;
 using testing_utilities::AlmostEquals;
+using testing_utilities::RelativeErrorFrom;
 using ::testing::AllOf;
 using ::testing::Eq;
 using ::testing::Gt;
@@ -482,6 +484,58 @@ TEST_F(KeplerOrbitTest, HyperbolicMeanAnomalyToTrueAnomaly) {
               AlmostEquals(*SimpleHyperbola().mean_anomaly, 0));
 }
 
+// Checks that the batch computations agree with the scalar one.  We don't test
+// nearly-parabolic orbits because the scalar computation is ill-conditioned
+// near the apoapsis.
+TEST_F(KeplerOrbitTest, BatchStateVectors) {
+  MasslessBody const massless{};
+  std::vector<Instant> times;
+  for (int i = -1000; i <= 1000; ++i) {
+    times.push_back(J2000 + i * 0.01 * JulianYear);
+  }
+  for (auto const& elements : {MoonElements(), SimpleHyperbola()}) {
+    KeplerianElements<ICRS> partial_elements;
+    partial_elements.eccentricity = elements.eccentricity;
+    partial_elements.semimajor_axis = elements.semimajor_axis;
+    partial_elements.inclination = elements.inclination;
+    partial_elements.longitude_of_ascending_node =
+        elements.longitude_of_ascending_node;
+    partial_elements.argument_of_periapsis = elements.argument_of_periapsis;
+    partial_elements.true_anomaly = elements.true_anomaly;
+    KeplerOrbit<ICRS> const orbit(body_, massless, partial_elements, J2000);
+
+    auto const batch = orbit.StateVectors(times);
+    ASSERT_EQ(times.size(), batch.size());
+    for (std::size_t i = 0; i < times.size(); ++i) {
+      auto const scalar = orbit.StateVectors(times[i]);
+      EXPECT_THAT(batch[i].displacement(),
+                  RelativeErrorFrom(scalar.displacement(), Lt(2e-11)))
+          << times[i];
+      EXPECT_THAT(batch[i].velocity(),
+                  RelativeErrorFrom(scalar.velocity(), Lt(2e-11)))
+          << times[i];
+    }
+  }
+
+  KeplerOrbit<ICRS> const ellipse(body_, massless, SimpleEllipse(), J2000);
+  KeplerOrbit<ICRS> const hyperbola(body_, massless, SimpleHyperbola(), J2000);
+  Instant const t = J2000 + 3 * JulianYear;
+  auto const batch = KeplerOrbit<ICRS>::StateVectors(
+      {&hyperbola, &ellipse, &hyperbola}, t);
+  ASSERT_EQ(3, batch.size());
+  EXPECT_THAT(batch[0].displacement(),
+              AlmostEquals(batch[2].displacement(), 0));
+  EXPECT_THAT(batch[0].displacement(),
+              RelativeErrorFrom(hyperbola.StateVectors(t).displacement(),
+                                Lt(1e-14)));
+  EXPECT_THAT(batch[1].displacement(),
+              RelativeErrorFrom(ellipse.StateVectors(t).displacement(),
+                                Lt(1e-14)));
+  EXPECT_THAT(batch[1].velocity(),
+              RelativeErrorFrom(ellipse.StateVectors(t).velocity(),
+                                Lt(1e-14)));
+}
+
 TEST_F(KeplerOrbitTest, OrientationFromLongitudeOfPeriapsis) {
   KeplerianElements<ICRS> elements;
   elements.eccentricity = 0;
@@ -21,6 +21,7 @@ class MockEphemeris : public Ephemeris<Frame> {
   using typename Ephemeris<Frame>::IntrinsicAcceleration;
   using typename Ephemeris<Frame>::IntrinsicAccelerations;
   using typename Ephemeris<Frame>::NewtonianMotionEquation;
+  using typename Ephemeris<Frame>::InstanceState;
 
   MockEphemeris()
       : Ephemeris<Frame>(
@@ -40,6 +41,7 @@ class MockEphemeris : public Ephemeris<Frame> {
 
   MOCK_METHOD1_T(EventuallyForgetBefore, bool(Instant const& t));
   MOCK_METHOD1_T(Prolong, void(Instant const& t));
+  MOCK_METHOD1_T(RequestProlongation, void(Instant const& t));
   MOCK_METHOD3_T(
       NewInstance,
       not_null<std::unique_ptr<
@@ -47,6 +49,11 @@ class MockEphemeris : public Ephemeris<Frame> {
           std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
           IntrinsicAccelerations const& intrinsic_accelerations,
           FixedStepParameters const& parameters));
+  MOCK_METHOD2_T(
+      RecombineInstances,
+      std::unique_ptr<typename Integrator<NewtonianMotionEquation>::Instance>(
+          std::vector<not_null<DiscreteTrajectory<Frame>*>> const& trajectories,
+          std::vector<InstanceState> const& states));
   MOCK_METHOD5_T(
       FlowWithAdaptiveStep,
       Status(not_null<DiscreteTrajectory<Frame>*> trajectory,
@@ -1,55 +1,151 @@
-
 #include "physics/protector.hpp"
 
-#include <optional>
+#include <algorithm>
+#include <limits>
+#include <thread>
 #include <vector>
 
+#include "quantities/si.hpp"
+
 namespace principia {
 namespace physics {
 namespace internal_protector {
 
+using quantities::Infinity;
+using quantities::Time;
+using quantities::si::Second;
+
+namespace {
+
+constexpr double free_slot = std::numeric_limits<double>::infinity();
+
+// Instants are represented exactly by their offset from the epoch.
+double ToSlotValue(Instant const& t) {
+  return (t - Instant()) / Second;
+}
+
+Instant FromSlotValue(double const value) {
+  return Instant() + value * Second;
+}
+
+}  // namespace
+
+Protector::Protector() {
+  for (auto& slot : slots_) {
+    slot.protection_start_time = free_slot;
+  }
+}
+
 bool Protector::RunWhenUnprotected(Instant const& t, Callback callback) {
   {
     absl::MutexLock l(&lock_);
-    if (!protection_start_times_.empty() &&
-        *protection_start_times_.begin() < t) {
+    // The increment must be visible before we look at the slots: either
+    // |Unprotect| sees it and takes the locked path, or we see the slot that
+    // it freed.
+    pending_callbacks_.fetch_add(1);
+    if (EarliestProtectionStartTime() < t) {
       callbacks_.emplace(t, std::move(callback));
       return false;
     }
+    pending_callbacks_.fetch_sub(1);
   }
   callback();
   return true;
 }
 
 void Protector::Protect(Instant const& t_min) {
+  double const value = ToSlotValue(t_min);
+  if (value < free_slot) {
+    int const home = HomeSlotIndex();
+    for (int i = 0; i < slot_count; ++i) {
+      auto& slot = slots_[(home + i) % slot_count];
+      double expected = free_slot;
+      if (slot.protection_start_time.load(std::memory_order_relaxed) ==
+              free_slot &&
+          slot.protection_start_time.compare_exchange_strong(expected,
+                                                             value)) {
+        return;
+      }
+    }
+  }
+
+  // All the slots are taken, or |t_min| cannot be represented in a slot.
   absl::MutexLock l(&lock_);
-  protection_start_times_.insert(t_min);
+  overflow_protection_start_times_.insert(t_min);
 }
 
 void Protector::Unprotect(Instant const& t_min) {
+  double const value = ToSlotValue(t_min);
+  bool released = false;
+  if (value < free_slot) {
+    int const home = HomeSlotIndex();
+    for (int i = 0; i < slot_count; ++i) {
+      auto& slot = slots_[(home + i) % slot_count];
+      double expected = value;
+      if (slot.protection_start_time.load(std::memory_order_relaxed) ==
+              value &&
+          slot.protection_start_time.compare_exchange_strong(expected,
+                                                             free_slot)) {
+        released = true;
+        break;
+      }
+    }
+  }
+  if (!released) {
+    absl::MutexLock l(&lock_);
+    auto const it = overflow_protection_start_times_.find(t_min);
+    CHECK(it != overflow_protection_start_times_.end());
+    overflow_protection_start_times_.erase(it);
+  }
+
+  // Fast path: no callback may be waiting for this range.
+  if (pending_callbacks_.load() == 0) {
+    return;
+  }
+  RunUnprotectedCallbacks();
+}
+
+int Protector::HomeSlotIndex() {
+  thread_local int const home_slot_index =
+      std::hash<std::thread::id>()(std::this_thread::get_id()) % slot_count;
+  return home_slot_index;
+}
+
+Instant Protector::EarliestProtectionStartTime() const {
+  double earliest = free_slot;
+  for (auto const& slot : slots_) {
+    earliest = std::min(earliest, slot.protection_start_time.load());
+  }
+  Instant result = earliest == free_slot ? Instant() + Infinity<Time>
+                                         : FromSlotValue(earliest);
+  if (!overflow_protection_start_times_.empty()) {
+    result = std::min(result, *overflow_protection_start_times_.begin());
+  }
+  return result;
+}
+
+void Protector::RunUnprotectedCallbacks() {
   std::vector<Callback> callbacks_to_run;
   {
     absl::MutexLock l(&lock_);
-    auto const it = protection_start_times_.find(t_min);
-    CHECK(it != protection_start_times_.end());
-    protection_start_times_.erase(it);
 
     // Find all the callbacks that are now unprotected and remove them from the
     // multimap.
-    std::optional<Instant> const first_guard_start_time =
-        protection_start_times_.empty()
-            ? std::nullopt
-            : std::make_optional(*protection_start_times_.begin());
+    Instant const earliest_protection_start_time =
+        EarliestProtectionStartTime();
     for (auto it = callbacks_.begin(); it != callbacks_.end();) {
       auto const& t = it->first;
       auto& callback = it->second;
-      if (!first_guard_start_time || t <= *first_guard_start_time) {
+      if (t <= earliest_protection_start_time) {
         callbacks_to_run.emplace_back(std::move(callback));
         it = callbacks_.erase(it);
       } else {
-        ++it;
+        // The callbacks are sorted by time, so the remaining ones are still
+        // protected.
+        break;
       }
     }
+    pending_callbacks_.fetch_sub(callbacks_to_run.size());
   }
 
   // Run the callbacks without holding the lock.
@@ -1,6 +1,8 @@
-﻿
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <set>
 #include <map>
@@ -21,26 +23,58 @@ using geometry::Instant;
 // would want to touch the time range ]-∞, t[ should do so through
 // RunWhenUnprotected, and the change will be delayed until ]-∞, t[ becomes
 // unprotected.  This class is thread-safe.
+// Protection and unprotection are lock-free as long as fewer than
+// |slot_count| ranges are protected at the same time and there are no delayed
+// callbacks; past that point they fall back to a slower locked path.
 class Protector {
  public:
   // A callback that may be run immediately or in a delayed manner when the
   // state of the protector permits it.
   using Callback = std::function<void()>;
 
+  Protector();
+
   // If the range ]-∞, t[ is unprotected, |callback| is run immediately and this
   // function returns true.  Otherwise |callback| is delayed and will be run as
   // soon as ]-∞, t[ becomes unprotected; returns false in this case.  The
   // callbacks are run without any lock held, in time order.
-  bool RunWhenUnprotected(Instant const& t, Callback callback);
+  bool RunWhenUnprotected(Instant const& t, Callback callback) EXCLUDES(lock_);
 
   // Protects and unprotects the time range [t_min, +∞[.
-  void Protect(Instant const& t_min);
-  void Unprotect(Instant const& t_min);
+  void Protect(Instant const& t_min) EXCLUDES(lock_);
+  void Unprotect(Instant const& t_min) EXCLUDES(lock_);
 
  private:
-  absl::Mutex lock_;
+  static constexpr int slot_count = 64;
+
+  // A slot holds the start of a protected range, expressed in seconds since
+  // the epoch, or +∞ if it is free.  Slots are aligned on cache lines to
+  // prevent false sharing between the threads that use them.
+  struct alignas(64) Slot {
+    std::atomic<double> protection_start_time;
+  };
+
+  // The index of the slot where the search for a slot starts for the current
+  // thread.  Different threads tend to use different slots.
+  static int HomeSlotIndex();
+
+  // Returns the earliest start of a protected range, or +∞ if nothing is
+  // protected.
+  Instant EarliestProtectionStartTime() const REQUIRES_SHARED(lock_);
+
+  // Runs the callbacks that are no longer protected.
+  void RunUnprotectedCallbacks() EXCLUDES(lock_);
+
+  std::array<Slot, slot_count> slots_;
+
+  // The number of callbacks that are delayed or about to be delayed.  Used by
+  // |Unprotect| to skip the locked path when there is nothing to run.
+  std::atomic<std::int64_t> pending_callbacks_ = 0;
+
+  mutable absl::Mutex lock_;
   std::multimap<Instant, Callback> callbacks_ GUARDED_BY(lock_);
-  std::multiset<Instant> protection_start_times_ GUARDED_BY(lock_);
+  // The protections that did not fit in |slots_|.
+  std::multiset<Instant> overflow_protection_start_times_ GUARDED_BY(lock_);
 };
 
 }  // namespace internal_protector
@@ -1,5 +1,10 @@
 #include "physics/protector.hpp"
 
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "quantities/si.hpp"
@@ -9,6 +14,7 @@ namespace physics {
 
 using geometry::Instant;
 using quantities::si::Second;
+using ::testing::Mock;
 using ::testing::MockFunction;
 
 class ProtectorTest : public ::testing::Test {
@@ -36,5 +42,99 @@ TEST_F(ProtectorTest, DelayedExecution) {
   protector_.Unprotect(Instant() + 10 * Second);
 }
 
+// More protections than there are lock-free slots.
+TEST_F(ProtectorTest, Overflow) {
+  for (int i = 0; i < 1000; ++i) {
+    protector_.Protect(Instant() + (i + 10) * Second);
+  }
+  EXPECT_CALL(callback_, Call()).Times(0);
+  CHECK(!protector_.RunWhenUnprotected(Instant() + 15 * Second,
+                                       callback_.AsStdFunction()));
+  for (int i = 999; i >= 6; --i) {
+    protector_.Unprotect(Instant() + (i + 10) * Second);
+  }
+  protector_.Unprotect(Instant() + 15 * Second);
+  for (int i = 4; i >= 1; --i) {
+    protector_.Unprotect(Instant() + (i + 10) * Second);
+  }
+  Mock::VerifyAndClearExpectations(&callback_);
+
+  // Removing the last protection before the requested time runs the callback.
+  EXPECT_CALL(callback_, Call()).Times(1);
+  protector_.Unprotect(Instant() + 10 * Second);
+}
+
+// Many threads protecting and unprotecting concurrently while others try to
+// forget.  Checks that all the callbacks are eventually run, and never while
+// their range is protected by a protection that was established before they
+// were requested.
+TEST_F(ProtectorTest, Stress) {
+  constexpr int number_of_threads = 16;
+  constexpr int iterations = 10'000;
+
+  // For each thread, the start of the range that it protects and a counter
+  // that is odd while the range is protected.
+  struct Protection {
+    std::atomic<int> start = 0;
+    std::atomic<std::int64_t> epoch = 0;
+  };
+  std::vector<Protection> protections(number_of_threads);
+  std::atomic<int> callbacks_requested = 0;
+  std::atomic<int> callbacks_run = 0;
+  std::atomic<bool> violated = false;
+
+  std::vector<std::thread> threads;
+  for (int j = 0; j < number_of_threads; ++j) {
+    threads.emplace_back([this,
+                          j,
+                          &protections,
+                          &callbacks_requested,
+                          &callbacks_run,
+                          &violated]() {
+      std::mt19937_64 random(j);
+      std::uniform_int_distribution<int> distribution(0, 100);
+      for (int i = 0; i < iterations; ++i) {
+        int const s = distribution(random);
+        Instant const t = Instant() + s * Second;
+        if (j % 4 == 0) {
+          // A forgetter.  Take a snapshot of the protections that are
+          // definitely established before the request.
+          std::vector<std::int64_t> epochs;
+          std::vector<int> starts;
+          for (auto const& protection : protections) {
+            epochs.push_back(protection.epoch);
+            starts.push_back(protection.start);
+          }
+          ++callbacks_requested;
+          protector_.RunWhenUnprotected(
+              t,
+              [s, epochs, starts, &protections, &callbacks_run, &violated]() {
+                for (int k = 0; k < number_of_threads; ++k) {
+                  if (epochs[k] % 2 == 1 && starts[k] < s &&
+                      protections[k].epoch == epochs[k]) {
+                    violated = true;
+                  }
+                }
+                ++callbacks_run;
+              });
+        } else {
+          auto& protection = protections[j];
+          protector_.Protect(t);
+          protection.start = s;
+          ++protection.epoch;
+          std::this_thread::yield();
+          ++protection.epoch;
+          protector_.Unprotect(t);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(callbacks_requested, callbacks_run);
+  EXPECT_FALSE(violated);
+}
+
 }  // namespace physics
 }  // namespace principia
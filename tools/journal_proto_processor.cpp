@@ -543,6 +543,37 @@ void JournalProtoProcessor::ProcessRequiredFixed64Field(
       [](std::string const& expr) {
         return "SerializePointer(" + expr + ")";
       };
+
+  // Special handling for buffers provided by the caller: these are seen from
+  // the C# as arrays, which are pinned during the call.  Only their address is
+  // journaled, the player allocates a buffer of the right size.
+  if (options.HasExtension(journal::serialization::size)) {
+    CHECK_EQ(in_message_name, descriptor->containing_type()->name())
+        << descriptor->full_name() << " must be an in field to have a size";
+    CHECK(options.HasExtension(journal::serialization::pointer_to) &&
+          !options.HasExtension(journal::serialization::disposable) &&
+          !options.HasExtension(journal::serialization::is_subject) &&
+          !options.HasExtension(journal::serialization::is_consumed) &&
+          !options.HasExtension(journal::serialization::is_produced))
+        << descriptor->full_name()
+        << " must only have a (pointer_to) option to have a size";
+    field_cs_custom_marshaler_.erase(descriptor);
+    field_cs_predefined_marshaler_[descriptor] = "UnmanagedType.LPArray";
+    field_cs_type_[descriptor] = "[In, Out] " + pointer_to + "[]";
+
+    std::string const size_getter =
+        ToLower(descriptor->containing_type()->name()) + "." +
+        options.GetExtension(journal::serialization::size) + "()";
+    std::string const storage_name = descriptor->name() + "_storage";
+    field_cxx_deserialization_storage_name_[descriptor] = storage_name;
+    field_cxx_deserialization_storage_type_[descriptor] =
+        "std::vector<" + pointer_to + ">";
+    field_cxx_deserializer_fn_[descriptor] =
+        [size_getter, storage_name](std::string const& expr) {
+          return "(" + storage_name + ".resize(" + size_getter + "), " +
+                 storage_name + ".data())";
+        };
+  }
 }
 
 void JournalProtoProcessor::ProcessRequiredMessageField(